@@ -0,0 +1,126 @@
+/** @file bench.c
+ * Implementacja wspólnych narzędzi programów mierzących wydajność.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "bench.h"
+
+/**
+ * Stan generatora liczb losowych.
+ */
+static uint64_t benchState = 1;
+
+/**
+ * @brief Wypisuje instrukcję użycia programu.
+ *
+ * @param[in] program - nazwa programu;
+ * @param[in] options - parametry;
+ * @param[in] count - liczba parametrów.
+ */
+static void printUsage(char const *program, BenchOption const *options,
+                       size_t count) {
+    fprintf(stderr, "usage: %s", program);
+    for (size_t i = 0; i < count; ++i) {
+        fprintf(stderr, " [-%c N]", options[i].flag);
+    }
+
+    fprintf(stderr, "\n");
+    for (size_t i = 0; i < count; ++i) {
+        fprintf(stderr, "  -%c  %s (default %zu)\n", options[i].flag,
+                options[i].description, *options[i].value);
+    }
+}
+
+extern bool benchParse(int argc, char *argv[], BenchOption const *options,
+                       size_t count) {
+    for (int i = 1; i < argc; i += 2) {
+        size_t j = 0;
+
+        if (argv[i][0] == '-' && argv[i][1] != '\0' && argv[i][2] == '\0') {
+            while (j < count && options[j].flag != argv[i][1]) {
+                j++;
+            }
+        }
+        else {
+            j = count;
+        }
+
+        char *end = NULL;
+        if (j < count && i + 1 < argc) {
+            *options[j].value = strtoull(argv[i + 1], &end, 10);
+        }
+
+        if (end == NULL || end == argv[i + 1] || *end != '\0') {
+            printUsage(argv[0], options, count);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+extern double benchNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+extern void benchSeed(uint64_t seed) {
+    benchState = seed * UINT64_C(0x9E3779B97F4A7C15) + 1;
+}
+
+/**
+ * @brief Losuje 64-bitowe słowo (xorshift64*).
+ * @return Wylosowane słowo.
+ */
+static uint64_t nextRandom(void) {
+    benchState ^= benchState >> 12;
+    benchState ^= benchState << 25;
+    benchState ^= benchState >> 27;
+
+    return benchState * UINT64_C(0x2545F4914F6CDD1D);
+}
+
+extern size_t benchBelow(size_t bound) {
+    return (size_t) ((nextRandom() >> 11) % bound);
+}
+
+extern double benchUniform(void) {
+    return (double) (nextRandom() >> 11) / 9007199254740992.0;
+}
+
+extern void benchNumber(char *buffer, size_t minLength, size_t maxLength) {
+    size_t length = minLength + benchBelow(maxLength - minLength + 1);
+
+    for (size_t i = 0; i < length; ++i) {
+        buffer[i] = (char) ('0' + benchBelow(10));
+    }
+
+    buffer[length] = '\0';
+}
+
+extern size_t benchHeapBytes(void) {
+#ifdef __GLIBC__
+    // Bloki alokowane przez mmap nie są wliczane do uordblks.
+    struct mallinfo2 info = mallinfo2();
+
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,96 @@
+/** @file bench.h
+ * Wspólne narzędzia programów mierzących wydajność biblioteki.
+ *
+ * Programy w katalogu bench są deterministyczne (korzystają z własnego
+ * generatora liczb losowych), przyjmują parametry w postaci `-x liczba`
+ * i wypisują wyniki na standardowe wyjście, po jednym pomiarze w wierszu.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Rozmiar buforów na numery generowane w programach.
+ */
+#define BENCH_NUMBER_SIZE 32
+
+/**
+ * @brief Parametr liczbowy programu.
+ */
+typedef struct BenchOption {
+    /// Znak opcji (np. 'n' dla `-n`).
+    char flag;
+    /// Wartość parametru (domyślna, zastępowana wartością z argumentów).
+    size_t *value;
+    /// Opis parametru wypisywany w instrukcji użycia.
+    char const *description;
+} BenchOption;
+
+/**
+ * @brief Odczytuje parametry programu.
+ *
+ * Przy niepoprawnych argumentach wypisuje instrukcję użycia na standardowe
+ * wyjście diagnostyczne.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty;
+ * @param[in, out] options - parametry;
+ * @param[in] count - liczba parametrów.
+ * @return Wartość @p true jeśli argumenty są poprawne,
+ *         wartość @p false w przeciwnym wypadku.
+ */
+bool benchParse(int argc, char *argv[], BenchOption const *options,
+                size_t count);
+
+/**
+ * @brief Zwraca bieżący czas monotoniczny.
+ * @return Czas w sekundach.
+ */
+double benchNow(void);
+
+/**
+ * @brief Ustawia ziarno generatora liczb losowych.
+ *
+ * @param[in] seed - ziarno.
+ */
+void benchSeed(uint64_t seed);
+
+/**
+ * @brief Losuje liczbę.
+ *
+ * @param[in] bound - ograniczenie (dodatnie).
+ * @return Liczba z przedziału [0, @p bound).
+ */
+size_t benchBelow(size_t bound);
+
+/**
+ * @brief Losuje liczbę z rozkładu jednostajnego na [0, 1).
+ * @return Wylosowana liczba.
+ */
+double benchUniform(void);
+
+/**
+ * @brief Losuje numer z cyfr od 0 do 9.
+ *
+ * @param[out] buffer - bufor na numer (co najmniej @p maxLength + 1 znaków);
+ * @param[in] minLength - najmniejsza długość numeru (dodatnia);
+ * @param[in] maxLength - największa długość numeru.
+ */
+void benchNumber(char *buffer, size_t minLength, size_t maxLength);
+
+/**
+ * @brief Zwraca liczbę bajtów zajętych na stercie.
+ * @return Liczba bajtów lub 0, jeśli biblioteka standardowa
+ *         nie udostępnia tej informacji.
+ */
+size_t benchHeapBytes(void);
+
+#endif /* __BENCH_H__ */
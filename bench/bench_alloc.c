@@ -0,0 +1,139 @@
+/** @file bench_alloc.c
+ * Porównanie alokatorów (zob. allocator.h): systemowego, puli i areny.
+ *
+ * Dla każdego alokatora program wczytuje losowe przekierowania, a następnie
+ * wykonuje zapytania phfwdGet i phfwdReverse. Wypisuje średni czas operacji
+ * oraz zajętą pamięć (dla areny liczbę przydzielonych z niej bajtów,
+ * dla pozostałych przyrost sterty).
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "allocator.h"
+#include "bench.h"
+#include "phone_forward.h"
+
+/**
+ * Rozmiar fragmentu areny.
+ */
+#define BENCH_ARENA_CHUNK (1 << 20)
+
+/**
+ * @brief Parametry pomiaru.
+ */
+typedef struct AllocWorkload {
+    /// Liczba przekierowań.
+    size_t forwards;
+    /// Liczba zapytań phfwdGet.
+    size_t gets;
+    /// Liczba zapytań phfwdReverse.
+    size_t reverses;
+    /// Ziarno generatora liczb losowych.
+    size_t seed;
+} AllocWorkload;
+
+/**
+ * @brief Mierzy jeden alokator i wypisuje wynik.
+ *
+ * @param[in] name - nazwa alokatora;
+ * @param[in] alloc - alokator;
+ * @param[in] arena - wartość @p true, jeśli @p alloc jest areną;
+ * @param[in] work - parametry pomiaru.
+ * @return Wartość @p true jeśli pomiar się udał,
+ *         wartość @p false jeśli nie udało się alokować pamięci.
+ */
+static bool measure(char const *name, PhfwdAllocator const *alloc,
+                    bool arena, AllocWorkload const *work) {
+    size_t heap = benchHeapBytes();
+    PhoneForward *pf = phfwdNewWithAllocator(alloc);
+    if (pf == NULL) {
+        return false;
+    }
+
+    benchSeed(work->seed);
+
+    char num1[BENCH_NUMBER_SIZE];
+    char num2[BENCH_NUMBER_SIZE];
+    double start = benchNow();
+    for (size_t i = 0; i < work->forwards; ++i) {
+        benchNumber(num1, 3, 10);
+        benchNumber(num2, 3, 10);
+        phfwdAdd(pf, num1, num2);
+    }
+    double addTime = benchNow() - start;
+
+    size_t used = (arena ? phfwdArenaUsed(alloc) : benchHeapBytes() - heap);
+
+    start = benchNow();
+    for (size_t i = 0; i < work->gets; ++i) {
+        benchNumber(num1, 12, 12);
+        phnumDelete(phfwdGet(pf, num1));
+    }
+    double getTime = benchNow() - start;
+
+    start = benchNow();
+    for (size_t i = 0; i < work->reverses; ++i) {
+        benchNumber(num1, 10, 10);
+        phnumDelete(phfwdReverse(pf, num1));
+    }
+    double reverseTime = benchNow() - start;
+
+    phfwdDelete(pf);
+
+    printf("%-8s add %.2f us/op, get %.2f us/op, reverse %.2f us/op, "
+           "%.1f MB\n", name,
+           work->forwards > 0 ? addTime * 1e6 / work->forwards : 0.0,
+           work->gets > 0 ? getTime * 1e6 / work->gets : 0.0,
+           work->reverses > 0 ? reverseTime * 1e6 / work->reverses : 0.0,
+           used / 1e6);
+
+    return true;
+}
+
+/**
+ * @brief Wykonuje pomiar.
+ *
+ * Parametry: -n liczba przekierowań, -g liczba zapytań phfwdGet o losowe
+ * numery dwunastocyfrowe, -r liczba zapytań phfwdReverse o losowe numery
+ * dziesięciocyfrowe, -s ziarno.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty.
+ * @return Kod zakończenia programu.
+ */
+int main(int argc, char *argv[]) {
+    AllocWorkload work = {300000, 1000000, 100000, 1};
+    BenchOption const options[] = {
+        {'n', &work.forwards, "number of forwards"},
+        {'g', &work.gets, "number of phfwdGet calls"},
+        {'r', &work.reverses, "number of phfwdReverse calls"},
+        {'s', &work.seed, "random seed"},
+    };
+
+    if (!benchParse(argc, argv, options,
+                    sizeof(options) / sizeof(*options))) {
+        return EXIT_FAILURE;
+    }
+
+    if (!measure("system", &phfwdSystemAllocator, false, &work)) {
+        return EXIT_FAILURE;
+    }
+
+    PhfwdAllocator *pool = phfwdPoolNew(0);
+    bool ok = (pool != NULL && measure("pool", pool, false, &work));
+    phfwdPoolDelete(pool);
+    if (!ok) {
+        return EXIT_FAILURE;
+    }
+
+    PhfwdAllocator *arena = phfwdArenaNew(BENCH_ARENA_CHUNK);
+    ok = (arena != NULL && measure("arena", arena, true, &work));
+    phfwdArenaDelete(arena);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,243 @@
+/** @file bench_cache.c
+ * Pomiar pamięci podręcznej wyników phfwdGet (zob. phfwdEnableCache)
+ * przy zapytaniach o rozkładzie Zipfa (s = 1).
+ *
+ * Pomiar jest wykonywany dla dwóch drzew: płytkiego (przekierowania
+ * z prefiksów sześciocyfrowych, numery dziesięciocyfrowe) i głębokiego
+ * (przekierowania z prefiksów dwunastocyfrowych, numery czternastocyfrowe),
+ * oraz dla kilku pojemności pamięci podręcznej. Dla każdego wariantu
+ * wypisywany jest średni czas zapytania i statystyki z phfwdCacheStats.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "phone_forward.h"
+#include "phone_forward_tuning.h"
+
+/**
+ * @brief Drzewo, na którym wykonywany jest pomiar.
+ */
+typedef struct CacheShape {
+    /// Nazwa drzewa.
+    char const *name;
+    /// Liczba przekierowań.
+    size_t forwards;
+    /// Długość prefiksów przekierowywanych.
+    size_t prefixLength;
+    /// Długość numerów w zapytaniach.
+    size_t numberLength;
+} CacheShape;
+
+/**
+ * @brief Wylosowane zapytania.
+ */
+typedef struct CacheQueries {
+    /// Różne numery (numer o randze @p i pod indeksem @p i).
+    char (*numbers)[BENCH_NUMBER_SIZE];
+    /// Liczba różnych numerów.
+    size_t count;
+    /// Rangi kolejnych zapytań.
+    size_t *ranks;
+    /// Liczba zapytań.
+    size_t gets;
+} CacheQueries;
+
+/**
+ * @brief Losuje rangi zapytań z rozkładu Zipfa (s = 1).
+ *
+ * @param[out] ranks - tablica na rangi;
+ * @param[in] gets - liczba zapytań;
+ * @param[in] count - liczba różnych numerów.
+ * @return Wartość @p true jeśli rangi zostały wylosowane,
+ *         wartość @p false jeśli nie udało się alokować pamięci.
+ */
+static bool zipfRanks(size_t *ranks, size_t gets, size_t count) {
+    double *cdf = malloc(count * sizeof(double));
+    if (cdf == NULL) {
+        return false;
+    }
+
+    double sum = 0;
+    for (size_t i = 0; i < count; ++i) {
+        sum += 1.0 / (double) (i + 1);
+        cdf[i] = sum;
+    }
+
+    for (size_t i = 0; i < gets; ++i) {
+        double target = benchUniform() * sum;
+        size_t low = 0;
+        size_t high = count - 1;
+
+        while (low < high) {
+            size_t middle = low + (high - low) / 2;
+
+            if (cdf[middle] <= target) {
+                low = middle + 1;
+            }
+            else {
+                high = middle;
+            }
+        }
+
+        ranks[i] = low;
+    }
+
+    free(cdf);
+
+    return true;
+}
+
+/**
+ * @brief Tworzy strukturę o danym kształcie i losuje zapytania.
+ *
+ * Numery w zapytaniach zaczynają się od prefiksów przekierowywanych,
+ * więc każde zapytanie przechodzi drzewo na pełną głębokość.
+ *
+ * @param[in] shape - kształt drzewa;
+ * @param[in, out] queries - zapytania (z ustawionymi licznikami).
+ * @return Wskaźnik na strukturę lub NULL, gdy nie udało się alokować
+ *         pamięci.
+ */
+static PhoneForward *build(CacheShape const *shape, CacheQueries *queries) {
+    PhoneForward *pf = phfwdNew();
+    char (*prefixes)[BENCH_NUMBER_SIZE] =
+        malloc(shape->forwards * BENCH_NUMBER_SIZE);
+    if (pf == NULL || prefixes == NULL) {
+        phfwdDelete(pf);
+        free(prefixes);
+        return NULL;
+    }
+
+    char target[BENCH_NUMBER_SIZE];
+    for (size_t i = 0; i < shape->forwards; ++i) {
+        benchNumber(prefixes[i], shape->prefixLength, shape->prefixLength);
+        benchNumber(target, 3, shape->prefixLength);
+        phfwdAdd(pf, prefixes[i], target);
+    }
+
+    size_t suffix = shape->numberLength - shape->prefixLength;
+    for (size_t i = 0; i < queries->count; ++i) {
+        char *number = queries->numbers[i];
+
+        strcpy(number, prefixes[benchBelow(shape->forwards)]);
+        benchNumber(number + shape->prefixLength, suffix, suffix);
+    }
+
+    free(prefixes);
+
+    if (!zipfRanks(queries->ranks, queries->gets, queries->count)) {
+        phfwdDelete(pf);
+        return NULL;
+    }
+
+    return pf;
+}
+
+/**
+ * @brief Mierzy zapytania przy danej pojemności pamięci podręcznej
+ * i wypisuje wynik.
+ *
+ * @param[in, out] pf - struktura;
+ * @param[in] queries - zapytania;
+ * @param[in] capacity - pojemność pamięci podręcznej (0 ją wyłącza).
+ * @return Wartość @p true jeśli pomiar się udał,
+ *         wartość @p false jeśli nie udało się alokować pamięci.
+ */
+static bool measure(PhoneForward *pf, CacheQueries const *queries,
+                    size_t capacity) {
+    if (!phfwdEnableCache(pf, capacity)) {
+        return false;
+    }
+
+    double start = benchNow();
+    for (size_t i = 0; i < queries->gets; ++i) {
+        phnumDelete(phfwdGet(pf, queries->numbers[queries->ranks[i]]));
+    }
+    double time = benchNow() - start;
+
+    PhfwdCacheStats stats;
+    if (!phfwdCacheStats(pf, &stats)) {
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    unsigned long long total = stats.hits + stats.misses;
+    printf("  cache %7zu: %.1f ns/get, %llu hits, %llu misses (%.1f%% hits),"
+           " %llu evictions\n", capacity,
+           queries->gets > 0 ? time * 1e9 / queries->gets : 0.0,
+           stats.hits, stats.misses,
+           total > 0 ? 100.0 * stats.hits / total : 0.0, stats.evictions);
+
+    return true;
+}
+
+/**
+ * @brief Wykonuje pomiar.
+ *
+ * Parametry: -n liczba różnych numerów, -g liczba zapytań, -f liczba
+ * przekierowań płytkiego drzewa (głębokie ma ich trzy czwarte), -s ziarno.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty.
+ * @return Kod zakończenia programu.
+ */
+int main(int argc, char *argv[]) {
+    size_t numbers = 1000000;
+    size_t gets = 4000000;
+    size_t forwards = 200000;
+    size_t seed = 1;
+    BenchOption const options[] = {
+        {'n', &numbers, "number of distinct numbers"},
+        {'g', &gets, "number of phfwdGet calls"},
+        {'f', &forwards, "number of forwards in the shallow trie"},
+        {'s', &seed, "random seed"},
+    };
+
+    if (!benchParse(argc, argv, options, sizeof(options) / sizeof(*options))
+        || numbers == 0 || gets == 0 || forwards < 4) {
+        return EXIT_FAILURE;
+    }
+
+    CacheShape const shapes[] = {
+        {"shallow", forwards, 6, 10},
+        {"deep", forwards - forwards / 4, 12, 14},
+    };
+    size_t const capacities[] = {0, 65536, 262144};
+
+    CacheQueries queries = {
+        malloc(numbers * BENCH_NUMBER_SIZE), numbers,
+        malloc(gets * sizeof(size_t)), gets,
+    };
+    bool ok = (queries.numbers != NULL && queries.ranks != NULL);
+
+    benchSeed(seed);
+
+    for (size_t i = 0; ok && i < sizeof(shapes) / sizeof(*shapes); ++i) {
+        PhoneForward *pf = build(&shapes[i], &queries);
+        ok = (pf != NULL);
+
+        if (ok) {
+            printf("%s trie (%zu forwards from %zu-digit prefixes, "
+                   "%zu-digit numbers)\n", shapes[i].name, shapes[i].forwards,
+                   shapes[i].prefixLength, shapes[i].numberLength);
+        }
+
+        for (size_t j = 0;
+             ok && j < sizeof(capacities) / sizeof(*capacities); ++j) {
+            ok = measure(pf, &queries, capacities[j]);
+        }
+
+        phfwdDelete(pf);
+    }
+
+    free(queries.numbers);
+    free(queries.ranks);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
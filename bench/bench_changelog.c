@@ -0,0 +1,220 @@
+/** @file bench_changelog.c
+ * Pomiar synchronizacji repliki dziennikiem modyfikacji
+ * (zob. phone_forward_changelog.h) w porównaniu z pełną kopią struktury.
+ *
+ * Struktura główna dostaje przekierowania z prefiksów od 3 do 7 cyfr
+ * na numery od 7 do 10 cyfr, a replika powstaje jako jej kopia. Następnie
+ * struktura główna wykonuje kolejne serie modyfikacji (90% dodań, 10%
+ * wywołań phfwdRemove), po każdej serii eksportowane są modyfikacje od
+ * ostatniej synchronizacji i odtwarzane w replice.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "phone_forward.h"
+#include "phone_forward_bulk.h"
+#include "phone_forward_changelog.h"
+
+/**
+ * @brief Bufor sklejający wyeksportowane rekordy.
+ */
+typedef struct ChangeBuffer {
+    /// Rekordy.
+    unsigned char *data;
+    /// Łączny rozmiar rekordów w bajtach.
+    size_t size;
+    /// Pojemność bufora w bajtach.
+    size_t capacity;
+} ChangeBuffer;
+
+/**
+ * @brief Dopisuje rekord do bufora (zob. PhfwdChangeCallback).
+ *
+ * @param[in, out] context - bufor;
+ * @param[in] data - rekord;
+ * @param[in] size - rozmiar rekordu.
+ * @return Wartość @p true jeśli rekord został dopisany,
+ *         wartość @p false jeśli nie udało się alokować pamięci.
+ */
+static bool appendChange(void *context, void const *data, size_t size) {
+    ChangeBuffer *buffer = context;
+
+    if (buffer->size + size > buffer->capacity) {
+        size_t capacity = 2 * (buffer->size + size);
+        unsigned char *grown = realloc(buffer->data, capacity);
+        if (grown == NULL) {
+            return false;
+        }
+
+        buffer->data = grown;
+        buffer->capacity = capacity;
+    }
+
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+
+    return true;
+}
+
+/**
+ * @brief Dodaje przekierowanie do struktury i dolicza rozmiar jego zapisu
+ * (zob. PhfwdForwardCallback).
+ *
+ * @param[in, out] context - para: struktura i licznik bajtów;
+ * @param[in] num1 - numer przekierowywany;
+ * @param[in] num2 - cel przekierowania.
+ * @return Wartość @p true.
+ */
+static bool copyForward(void *context, char const *num1, char const *num2) {
+    void **pair = context;
+    size_t *bytes = pair[1];
+
+    phfwdAdd(pair[0], num1, num2);
+    *bytes += strlen(num1) + strlen(num2) + 2;
+
+    return true;
+}
+
+/**
+ * @brief Wykonuje serię losowych modyfikacji.
+ *
+ * @param[in, out] pf - struktura;
+ * @param[in] count - liczba modyfikacji.
+ */
+static void churn(PhoneForward *pf, size_t count) {
+    char num1[BENCH_NUMBER_SIZE];
+    char num2[BENCH_NUMBER_SIZE];
+
+    for (size_t i = 0; i < count; ++i) {
+        benchNumber(num1, 3, 7);
+
+        if (benchBelow(10) == 0) {
+            phfwdRemove(pf, num1);
+        }
+        else {
+            benchNumber(num2, 7, 10);
+            phfwdAdd(pf, num1, num2);
+        }
+    }
+}
+
+/**
+ * @brief Dodaje losowe przekierowania.
+ *
+ * @param[in, out] pf - struktura;
+ * @param[in] forwards - liczba przekierowań;
+ * @param[in] seed - ziarno.
+ * @return Średni czas phfwdAdd w mikrosekundach.
+ */
+static double fill(PhoneForward *pf, size_t forwards, size_t seed) {
+    char num1[BENCH_NUMBER_SIZE];
+    char num2[BENCH_NUMBER_SIZE];
+
+    benchSeed(seed);
+
+    double start = benchNow();
+    for (size_t i = 0; i < forwards; ++i) {
+        benchNumber(num1, 3, 7);
+        benchNumber(num2, 7, 10);
+        phfwdAdd(pf, num1, num2);
+    }
+
+    return (benchNow() - start) * 1e6 / forwards;
+}
+
+/**
+ * @brief Wykonuje pomiar.
+ *
+ * Parametry: -n liczba przekierowań, -l rozmiar dziennika w bajtach,
+ * -c liczba modyfikacji w najmniejszej serii (kolejne są dziesięciokrotnie
+ * większe), -r liczba serii, -s ziarno.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty.
+ * @return Kod zakończenia programu.
+ */
+int main(int argc, char *argv[]) {
+    size_t forwards = 300000;
+    size_t capacity = 16 << 20;
+    size_t changes = 100;
+    size_t rounds = 3;
+    size_t seed = 1;
+    BenchOption const options[] = {
+        {'n', &forwards, "number of forwards"},
+        {'l', &capacity, "change log capacity in bytes"},
+        {'c', &changes, "changes in the smallest batch"},
+        {'r', &rounds, "number of batches (each ten times larger)"},
+        {'s', &seed, "random seed"},
+    };
+
+    if (!benchParse(argc, argv, options, sizeof(options) / sizeof(*options))
+        || forwards == 0 || changes == 0) {
+        return EXIT_FAILURE;
+    }
+
+    PhoneForward *plain = phfwdNew();
+    PhoneForward *pf = phfwdNew();
+    PhoneForward *copy = phfwdNew();
+    ChangeBuffer buffer = {NULL, 0, 0};
+    if (plain == NULL || pf == NULL || copy == NULL
+        || !phfwdChangeLogEnable(pf, capacity)) {
+        phfwdDelete(plain);
+        phfwdDelete(pf);
+        phfwdDelete(copy);
+        return EXIT_FAILURE;
+    }
+
+    double plainAdd = fill(plain, forwards, seed);
+    double loggedAdd = fill(pf, forwards, seed);
+    phfwdDelete(plain);
+    printf("add         %.2f us without log, %.2f us with log\n",
+           plainAdd, loggedAdd);
+
+    size_t bytes = 0;
+    void *pair[] = {copy, &bytes};
+    double start = benchNow();
+    phfwdForEach(pf, "", copyForward, pair);
+    double rebuildTime = benchNow() - start;
+    phfwdDelete(copy);
+    printf("full dump   %.1f MB, rebuild %.0f ms\n", bytes / 1e6,
+           rebuildTime * 1e3);
+
+    PhoneForward *replica = phfwdClone(pf);
+    size_t lastTime = phfwdTime(pf);
+    bool ok = (replica != NULL);
+
+    benchSeed(seed + 1);
+    for (size_t r = 0; ok && r < rounds; ++r, changes *= 10) {
+        churn(pf, changes);
+
+        buffer.size = 0;
+        start = benchNow();
+        ok = phfwdChangesSince(pf, lastTime, appendChange, &buffer);
+        double exportTime = benchNow() - start;
+
+        start = benchNow();
+        ok = ok && phfwdApplyChanges(replica, buffer.data, buffer.size,
+                                     &lastTime);
+        double applyTime = benchNow() - start;
+
+        if (ok) {
+            printf("churn %6zu %.1f KB (%.1f B/change), export %.3f ms, "
+                   "apply %.1f ms\n", changes, buffer.size / 1e3,
+                   (double) buffer.size / changes, exportTime * 1e3,
+                   applyTime * 1e3);
+        }
+    }
+
+    free(buffer.data);
+    phfwdDelete(replica);
+    phfwdDelete(pf);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
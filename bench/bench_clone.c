@@ -0,0 +1,155 @@
+/** @file bench_clone.c
+ * Pomiar czasu phfwdClone w zależności od liczby wierzchołków drzewa,
+ * w porównaniu z odtworzeniem struktury przez powtórzenie tych samych
+ * wywołań phfwdAdd.
+ *
+ * Struktury budowane są z losowych kluczy dziewięciocyfrowych
+ * przekierowywanych na numery siedmiocyfrowe, raz lub wielokrotnie
+ * (kolejne przekierowania z tego samego klucza zastępują poprzednie,
+ * ale pozostawiają w drzewie wierzchołki dawnych celów).
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "node.h"
+#include "phone_forward.h"
+#include "phone_forward_bulk.h"
+
+/**
+ * @brief Buduje strukturę.
+ *
+ * Ten sam @p seed daje ten sam ciąg wywołań phfwdAdd: w każdej rundzie
+ * klucze są przekierowywane w tej samej kolejności na nowe, losowe cele.
+ *
+ * @param[in] keys - klucze;
+ * @param[in] count - liczba kluczy;
+ * @param[in] rounds - liczba przekierowań z każdego klucza;
+ * @param[in] seed - ziarno.
+ * @return Wskaźnik na strukturę lub NULL, gdy nie udało się alokować
+ *         pamięci.
+ */
+static PhoneForward *build(char (*keys)[BENCH_NUMBER_SIZE], size_t count,
+                           size_t rounds, size_t seed) {
+    PhoneForward *pf = phfwdNew();
+    if (pf == NULL) {
+        return NULL;
+    }
+
+    benchSeed(seed);
+
+    char target[BENCH_NUMBER_SIZE];
+    for (size_t r = 0; r < rounds; ++r) {
+        for (size_t i = 0; i < count; ++i) {
+            benchNumber(target, 7, 7);
+            phfwdAdd(pf, keys[i], target);
+        }
+    }
+
+    return pf;
+}
+
+/**
+ * @brief Liczy wierzchołki drzewa struktury.
+ *
+ * @param[in] pf - struktura.
+ * @return Liczba wierzchołków.
+ */
+static size_t countNodes(PhoneForward const *pf) {
+    size_t count = 0;
+
+    for (Node const *node = pf->rootNode; node != NULL;
+         node = nodeNextPreorder(node)) {
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Mierzy jedną strukturę i wypisuje wynik.
+ *
+ * @param[in] keys - klucze;
+ * @param[in] count - liczba kluczy;
+ * @param[in] rounds - liczba przekierowań z każdego klucza;
+ * @param[in] seed - ziarno.
+ * @return Wartość @p true jeśli pomiar się udał,
+ *         wartość @p false jeśli nie udało się alokować pamięci.
+ */
+static bool measure(char (*keys)[BENCH_NUMBER_SIZE], size_t count,
+                    size_t rounds, size_t seed) {
+    double start = benchNow();
+    PhoneForward *pf = build(keys, count, rounds, seed);
+    double replayTime = benchNow() - start;
+    if (pf == NULL) {
+        return false;
+    }
+
+    start = benchNow();
+    PhoneForward *clone = phfwdClone(pf);
+    double cloneTime = benchNow() - start;
+
+    size_t nodes = countNodes(pf);
+    phfwdDelete(clone);
+    phfwdDelete(pf);
+
+    if (clone == NULL) {
+        return false;
+    }
+
+    printf("%7zu keys x %2zu adds, %8zu nodes: clone %8.1f ms, "
+           "replay %8.1f ms\n", count, rounds, nodes, cloneTime * 1e3,
+           replayTime * 1e3);
+
+    return true;
+}
+
+/**
+ * @brief Wykonuje pomiar.
+ *
+ * Parametry: -n największa liczba kluczy (mierzone są też struktury
+ * dziesięciokrotnie mniejsze), -c liczba przekierowań z każdego klucza
+ * w strukturach z historią zmian, -s ziarno.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty.
+ * @return Kod zakończenia programu.
+ */
+int main(int argc, char *argv[]) {
+    size_t keys = 100000;
+    size_t churn = 10;
+    size_t seed = 1;
+    BenchOption const options[] = {
+        {'n', &keys, "largest number of keys"},
+        {'c', &churn, "adds per key in the churned tables"},
+        {'s', &seed, "random seed"},
+    };
+
+    if (!benchParse(argc, argv, options, sizeof(options) / sizeof(*options))
+        || keys < 10 || churn == 0) {
+        return EXIT_FAILURE;
+    }
+
+    char (*numbers)[BENCH_NUMBER_SIZE] = malloc(keys * BENCH_NUMBER_SIZE);
+    bool ok = (numbers != NULL);
+
+    benchSeed(seed);
+    for (size_t i = 0; ok && i < keys; ++i) {
+        benchNumber(numbers[i], 9, 9);
+    }
+
+    size_t const rounds[] = {1, churn};
+    for (size_t r = 0; ok && r < sizeof(rounds) / sizeof(*rounds); ++r) {
+        ok = measure(numbers, keys / 10, rounds[r], seed + 1)
+             && measure(numbers, keys, rounds[r], seed + 1);
+    }
+
+    free(numbers);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,141 @@
+/** @file bench_compact.c
+ * Pomiar kompaktowania (zob. phfwdCompact) struktury po wielu zmianach:
+ * zajęta sterta i czas zapytań phfwdGet przed pełnym przejściem
+ * kompaktowania i po nim.
+ *
+ * Struktura dostaje N przekierowań z losowych numerów od 7 do 10 cyfr,
+ * następnie N/2 wywołań phfwdRemove na losowych z tych numerów i kolejne
+ * N przekierowań. Zapytania dotyczą numerów przedłużających numery
+ * z pierwszej partii.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "phone_forward.h"
+#include "phone_forward_bulk.h"
+
+/**
+ * Liczba wierzchołków odwiedzanych przez jedno wywołanie phfwdCompact.
+ */
+#define BENCH_COMPACT_BUDGET 4096
+
+/**
+ * @brief Mierzy zapytania phfwdGet o numery przedłużające klucze
+ * o dwie losowe cyfry.
+ *
+ * @param[in] pf - struktura;
+ * @param[in] keys - klucze;
+ * @param[in] count - liczba kluczy;
+ * @param[in] gets - liczba zapytań;
+ * @param[in] seed - ziarno (te same zapytania dla tego samego ziarna).
+ * @return Średni czas zapytania w nanosekundach.
+ */
+static double measureGets(PhoneForward const *pf,
+                          char (*keys)[BENCH_NUMBER_SIZE], size_t count,
+                          size_t gets, size_t seed) {
+    char num[BENCH_NUMBER_SIZE];
+
+    benchSeed(seed);
+
+    double start = benchNow();
+    for (size_t i = 0; i < gets; ++i) {
+        size_t length = strlen(strcpy(num, keys[benchBelow(count)]));
+
+        benchNumber(num + length, 2, 2);
+        phnumDelete(phfwdGet(pf, num));
+    }
+
+    return gets > 0 ? (benchNow() - start) * 1e9 / gets : 0.0;
+}
+
+/**
+ * @brief Wykonuje pomiar.
+ *
+ * Parametry: -n liczba przekierowań w każdej partii, -g liczba zapytań
+ * phfwdGet w każdym pomiarze, -s ziarno.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty.
+ * @return Kod zakończenia programu.
+ */
+int main(int argc, char *argv[]) {
+    size_t forwards = 1000000;
+    size_t gets = 1000000;
+    size_t seed = 1;
+    BenchOption const options[] = {
+        {'n', &forwards, "number of forwards in each batch"},
+        {'g', &gets, "number of phfwdGet calls per measurement"},
+        {'s', &seed, "random seed"},
+    };
+
+    if (!benchParse(argc, argv, options, sizeof(options) / sizeof(*options))
+        || forwards == 0) {
+        return EXIT_FAILURE;
+    }
+
+    size_t heap = benchHeapBytes();
+    PhoneForward *pf = phfwdNew();
+    char (*keys)[BENCH_NUMBER_SIZE] = malloc(forwards * BENCH_NUMBER_SIZE);
+    if (pf == NULL || keys == NULL) {
+        phfwdDelete(pf);
+        free(keys);
+        return EXIT_FAILURE;
+    }
+
+    // Tablica kluczy nie jest częścią struktury.
+    heap += forwards * BENCH_NUMBER_SIZE;
+    benchSeed(seed);
+
+    char num[BENCH_NUMBER_SIZE];
+    char target[BENCH_NUMBER_SIZE];
+    for (size_t i = 0; i < forwards; ++i) {
+        benchNumber(keys[i], 7, 10);
+        benchNumber(target, 6, 6);
+        phfwdAdd(pf, keys[i], target);
+    }
+
+    for (size_t i = 0; i < forwards / 2; ++i) {
+        phfwdRemove(pf, keys[benchBelow(forwards)]);
+    }
+
+    for (size_t i = 0; i < forwards; ++i) {
+        benchNumber(num, 7, 10);
+        benchNumber(target, 6, 6);
+        phfwdAdd(pf, num, target);
+    }
+
+    size_t heapBefore = benchHeapBytes() - heap;
+    double getBefore = measureGets(pf, keys, forwards, gets, seed + 1);
+
+    size_t calls = 1;
+    double start = benchNow();
+    while (!phfwdCompact(pf, BENCH_COMPACT_BUDGET)) {
+        calls++;
+    }
+    double compactTime = benchNow() - start;
+
+    size_t heapAfter = benchHeapBytes() - heap;
+    double getAfter = measureGets(pf, keys, forwards, gets, seed + 1);
+
+    start = benchNow();
+    phfwdCompact(pf, SIZE_MAX);
+    double secondTime = benchNow() - start;
+
+    printf("heap %.1f MB -> %.1f MB\n", heapBefore / 1e6, heapAfter / 1e6);
+    printf("get %.0f ns -> %.0f ns\n", getBefore, getAfter);
+    printf("compaction %.3f s in %zu calls, second pass %.3f s\n",
+           compactTime, calls, secondTime);
+
+    free(keys);
+    phfwdDelete(pf);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,169 @@
+/** @file bench_diff.c
+ * Pomiar phfwdDiff (zob. phone_forward_bulk.h) w zależności od liczby
+ * różnic między strukturami, w porównaniu z dwoma pełnymi przejściami
+ * phfwdForEach, oraz średni czas modyfikacji struktury utrzymującej skróty
+ * poddrzew.
+ *
+ * Struktura dostaje przekierowania z losowych numerów dziewięciocyfrowych
+ * na losowe numery siedmiocyfrowe. Dla każdej liczby modyfikacji k
+ * porównywana jest z kopią (phfwdClone), na której wykonano k modyfikacji:
+ * 9/10 przekierowań losowych kluczy struktury na nowe cele i 1/10 wywołań
+ * phfwdRemove na kluczach struktury.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "phone_forward.h"
+#include "phone_forward_bulk.h"
+
+/**
+ * @brief Zlicza różnice (zob. PhfwdDiffCallback).
+ *
+ * @param[in, out] context - licznik różnic;
+ * @param[in] num - numer przekierowywany;
+ * @param[in] before - przekierowanie w pierwszej strukturze (lub NULL);
+ * @param[in] after - przekierowanie w drugiej strukturze (lub NULL).
+ * @return Wartość @p true.
+ */
+static bool countDiff(void *context, char const *num, char const *before,
+                      char const *after) {
+    (void) num;
+    (void) before;
+    (void) after;
+    ++*(size_t *) context;
+
+    return true;
+}
+
+/**
+ * @brief Zlicza przekierowania (zob. PhfwdForwardCallback).
+ *
+ * @param[in, out] context - licznik przekierowań;
+ * @param[in] num1 - numer przekierowywany;
+ * @param[in] num2 - cel przekierowania.
+ * @return Wartość @p true.
+ */
+static bool countForward(void *context, char const *num1, char const *num2) {
+    (void) num1;
+    (void) num2;
+    ++*(size_t *) context;
+
+    return true;
+}
+
+/**
+ * @brief Wykonuje losowe modyfikacje kluczy struktury.
+ *
+ * @param[in, out] pf - struktura;
+ * @param[in] keys - klucze;
+ * @param[in] count - liczba kluczy;
+ * @param[in] changes - liczba modyfikacji.
+ */
+static void mutate(PhoneForward *pf, char (*keys)[BENCH_NUMBER_SIZE],
+                   size_t count, size_t changes) {
+    char target[BENCH_NUMBER_SIZE];
+
+    for (size_t i = 0; i < changes; ++i) {
+        char const *key = keys[benchBelow(count)];
+
+        if (benchBelow(10) == 0) {
+            phfwdRemove(pf, key);
+        }
+        else {
+            benchNumber(target, 7, 7);
+            phfwdAdd(pf, key, target);
+        }
+    }
+}
+
+/**
+ * @brief Wykonuje pomiar.
+ *
+ * Parametry: -n liczba przekierowań, -k największa liczba modyfikacji
+ * kopii (mierzone są 0, 10, 1000 itd. aż do tej liczby), -m liczba
+ * modyfikacji w pomiarze ich średniego czasu, -s ziarno.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty.
+ * @return Kod zakończenia programu.
+ */
+int main(int argc, char *argv[]) {
+    size_t count = 300000;
+    size_t maxChanges = 100000;
+    size_t mix = 1000000;
+    size_t seed = 1;
+    BenchOption const options[] = {
+        {'n', &count, "number of forwards"},
+        {'k', &maxChanges, "largest number of mutations of the copy"},
+        {'m', &mix, "add/remove calls in the mutation timing"},
+        {'s', &seed, "random seed"},
+    };
+
+    if (!benchParse(argc, argv, options, sizeof(options) / sizeof(*options))
+        || count == 0 || mix == 0) {
+        return EXIT_FAILURE;
+    }
+
+    char (*keys)[BENCH_NUMBER_SIZE] = malloc(count * BENCH_NUMBER_SIZE);
+    PhoneForward *pf = phfwdNew();
+    bool ok = (keys != NULL && pf != NULL);
+
+    benchSeed(seed);
+
+    char target[BENCH_NUMBER_SIZE];
+    for (size_t i = 0; ok && i < count; ++i) {
+        benchNumber(keys[i], 9, 9);
+        benchNumber(target, 7, 7);
+        ok = phfwdAdd(pf, keys[i], target);
+    }
+
+    for (size_t changes = 0; ok && changes <= maxChanges;
+         changes = (changes == 0 ? 10 : 100 * changes)) {
+        PhoneForward *copy = phfwdClone(pf);
+        ok = (copy != NULL);
+
+        if (ok) {
+            mutate(copy, keys, count, changes);
+
+            size_t diffs = 0;
+            double start = benchNow();
+            ok = phfwdDiff(pf, copy, countDiff, &diffs);
+            double diffTime = benchNow() - start;
+
+            if (ok) {
+                printf("k=%-7zu %6zu diffs  %9.3f ms\n", changes, diffs,
+                       diffTime * 1e3);
+            }
+        }
+
+        if (ok && changes == 0) {
+            size_t forwards = 0;
+            double start = benchNow();
+            ok = phfwdForEach(pf, "", countForward, &forwards)
+                 && phfwdForEach(copy, "", countForward, &forwards);
+
+            printf("two full phfwdForEach %.0f ms\n",
+                   (benchNow() - start) * 1e3);
+        }
+
+        phfwdDelete(copy);
+    }
+
+    if (ok) {
+        double start = benchNow();
+        mutate(pf, keys, count, mix);
+        printf("add/remove mix %.2f us per call\n",
+               (benchNow() - start) * 1e6 / mix);
+    }
+
+    phfwdDelete(pf);
+    free(keys);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,154 @@
+/** @file bench_engine.c
+ * Porównanie silników wyszukiwania najdłuższego prefiksu
+ * (zob. phfwdNewWithEngine): drzewa i tablic haszujących.
+ *
+ * Obie struktury dostają ten sam plan numeracji: przekierowania
+ * z prefiksów od 3 do 7 cyfr na numery od 7 do 10 cyfr. Mierzone są
+ * wczytanie przekierowań, zapytania phfwdGet o numery przedłużające
+ * prefiks przekierowywany lub cel przekierowania oraz usuwanie
+ * przekierowań z prefiksów czterocyfrowych.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "phone_forward.h"
+#include "phone_forward_tuning.h"
+
+/**
+ * @brief Parametry pomiaru.
+ */
+typedef struct EngineWorkload {
+    /// Liczba przekierowań.
+    size_t forwards;
+    /// Liczba zapytań phfwdGet każdego rodzaju.
+    size_t gets;
+    /// Liczba wywołań phfwdRemove.
+    size_t removes;
+    /// Ziarno generatora liczb losowych.
+    size_t seed;
+    /// Prefiksy przekierowywane.
+    char (*sources)[BENCH_NUMBER_SIZE];
+    /// Cele przekierowań.
+    char (*targets)[BENCH_NUMBER_SIZE];
+} EngineWorkload;
+
+/**
+ * @brief Mierzy zapytania phfwdGet o numery przedłużające dane prefiksy
+ * do długości od 12 do 15 cyfr.
+ *
+ * @param[in] pf - struktura;
+ * @param[in] prefixes - prefiksy;
+ * @param[in] work - parametry pomiaru.
+ * @return Średni czas zapytania w mikrosekundach.
+ */
+static double measureGets(PhoneForward const *pf,
+                          char (*prefixes)[BENCH_NUMBER_SIZE],
+                          EngineWorkload const *work) {
+    char num[BENCH_NUMBER_SIZE];
+
+    double start = benchNow();
+    for (size_t i = 0; i < work->gets; ++i) {
+        char const *prefix = prefixes[benchBelow(work->forwards)];
+        size_t length = strlen(strcpy(num, prefix));
+        size_t extra = 12 - length + benchBelow(4);
+
+        benchNumber(num + length, extra, extra);
+        phnumDelete(phfwdGet(pf, num));
+    }
+
+    return work->gets > 0 ? (benchNow() - start) * 1e6 / work->gets : 0.0;
+}
+
+/**
+ * @brief Mierzy jeden silnik i wypisuje wynik.
+ *
+ * @param[in] name - nazwa silnika;
+ * @param[in] engine - silnik;
+ * @param[in] work - parametry pomiaru.
+ * @return Wartość @p true jeśli pomiar się udał,
+ *         wartość @p false jeśli nie udało się alokować pamięci.
+ */
+static bool measure(char const *name, PhfwdEngine engine,
+                    EngineWorkload const *work) {
+    PhoneForward *pf = phfwdNewWithEngine(engine);
+    if (pf == NULL) {
+        return false;
+    }
+
+    double start = benchNow();
+    for (size_t i = 0; i < work->forwards; ++i) {
+        phfwdAdd(pf, work->sources[i], work->targets[i]);
+    }
+    double addTime = (benchNow() - start) * 1e6 / work->forwards;
+
+    benchSeed(work->seed + 1);
+    double sourceTime = measureGets(pf, work->sources, work);
+    double targetTime = measureGets(pf, work->targets, work);
+
+    char num[BENCH_NUMBER_SIZE];
+    start = benchNow();
+    for (size_t i = 0; i < work->removes; ++i) {
+        benchNumber(num, 4, 4);
+        phfwdRemove(pf, num);
+    }
+    double removeTime = benchNow() - start;
+
+    phfwdDelete(pf);
+
+    printf("%-5s add %.2f us, get under source %.2f us, "
+           "get under target %.2f us, remove %.2f us\n", name, addTime,
+           sourceTime, targetTime,
+           work->removes > 0 ? removeTime * 1e6 / work->removes : 0.0);
+
+    return true;
+}
+
+/**
+ * @brief Wykonuje pomiar.
+ *
+ * Parametry: -n liczba przekierowań, -g liczba zapytań phfwdGet każdego
+ * rodzaju, -r liczba usunięć prefiksów czterocyfrowych, -s ziarno.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty.
+ * @return Kod zakończenia programu.
+ */
+int main(int argc, char *argv[]) {
+    EngineWorkload work = {300000, 2000000, 10000, 1, NULL, NULL};
+    BenchOption const options[] = {
+        {'n', &work.forwards, "number of forwards"},
+        {'g', &work.gets, "number of phfwdGet calls of each kind"},
+        {'r', &work.removes, "number of phfwdRemove calls"},
+        {'s', &work.seed, "random seed"},
+    };
+
+    if (!benchParse(argc, argv, options, sizeof(options) / sizeof(*options))
+        || work.forwards == 0) {
+        return EXIT_FAILURE;
+    }
+
+    work.sources = malloc(work.forwards * BENCH_NUMBER_SIZE);
+    work.targets = malloc(work.forwards * BENCH_NUMBER_SIZE);
+    bool ok = (work.sources != NULL && work.targets != NULL);
+
+    benchSeed(work.seed);
+    for (size_t i = 0; ok && i < work.forwards; ++i) {
+        benchNumber(work.sources[i], 3, 7);
+        benchNumber(work.targets[i], 7, 10);
+    }
+
+    ok = ok && measure("trie", PHFWD_ENGINE_TRIE, &work);
+    ok = ok && measure("hash", PHFWD_ENGINE_HASH, &work);
+
+    free(work.sources);
+    free(work.targets);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,143 @@
+/** @file bench_expiry.c
+ * Pomiar wygasania przekierowań (zob. phone_forward_expiry.h): koszt
+ * phfwdAdvanceClock przy przesuwaniu zegara o jedną jednostkę, przy
+ * przesunięciu, w którym nic nie wygasa, i przy jednym przeskoku
+ * wycofującym wszystkie przekierowania z terminem.
+ *
+ * Struktura dostaje N przekierowań bez terminu i N przekierowań z terminem
+ * z rozkładu jednostajnego na [1, T], wszystkie z losowych numerów
+ * dziewięciocyfrowych na numery dziewięciocyfrowe.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "phone_forward.h"
+#include "phone_forward_changelog.h"
+#include "phone_forward_expiry.h"
+
+/**
+ * @brief Tworzy strukturę z przekierowaniami bez terminu i z terminem.
+ *
+ * Ten sam @p seed daje ten sam ciąg wywołań.
+ *
+ * @param[in] forwards - liczba przekierowań każdego rodzaju;
+ * @param[in] first - najwcześniejszy termin;
+ * @param[in] span - liczba możliwych terminów;
+ * @param[in] seed - ziarno.
+ * @return Wskaźnik na strukturę lub NULL, gdy nie udało się alokować
+ *         pamięci.
+ */
+static PhoneForward *build(size_t forwards, size_t first, size_t span,
+                           size_t seed) {
+    PhoneForward *pf = phfwdNew();
+    if (pf == NULL) {
+        return NULL;
+    }
+
+    char num[BENCH_NUMBER_SIZE];
+    char target[BENCH_NUMBER_SIZE];
+
+    benchSeed(seed);
+    for (size_t i = 0; i < forwards; ++i) {
+        benchNumber(num, 9, 9);
+        benchNumber(target, 9, 9);
+        phfwdAdd(pf, num, target);
+
+        benchNumber(num, 9, 9);
+        benchNumber(target, 9, 9);
+        phfwdAddWithExpiry(pf, num, target, first + benchBelow(span));
+    }
+
+    return pf;
+}
+
+/**
+ * @brief Wykonuje pomiar.
+ *
+ * Parametry: -n liczba przekierowań każdego rodzaju, -t najpóźniejszy
+ * termin T (domyślnie liczba sekund tygodnia), -i liczba przesunięć zegara
+ * w pomiarze przesunięć, w których nic nie wygasa, -s ziarno.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty.
+ * @return Kod zakończenia programu.
+ */
+int main(int argc, char *argv[]) {
+    size_t forwards = 500000;
+    size_t horizon = 7 * 24 * 3600;
+    size_t idle = 1000000;
+    size_t seed = 1;
+    BenchOption const options[] = {
+        {'n', &forwards, "number of permanent and of expiring forwards"},
+        {'t', &horizon, "latest deadline"},
+        {'i', &idle, "clock steps with nothing due"},
+        {'s', &seed, "random seed"},
+    };
+
+    if (!benchParse(argc, argv, options, sizeof(options) / sizeof(*options))
+        || forwards == 0 || horizon == 0 || idle == 0) {
+        return EXIT_FAILURE;
+    }
+
+    PhoneForward *pf = build(forwards, 1, horizon, seed);
+    bool ok = (pf != NULL);
+
+    if (ok) {
+        size_t before = phfwdTime(pf);
+        double start = benchNow();
+        for (size_t now = 1; ok && now <= horizon; ++now) {
+            ok = phfwdAdvanceClock(pf, now);
+        }
+        double time = benchNow() - start;
+        size_t retired = phfwdTime(pf) - before;
+
+        printf("tick by tick %zu steps, %zu retired, %.3f s "
+               "(%.2f us per retired forward)\n", horizon, retired, time,
+               retired > 0 ? time * 1e6 / retired : 0.0);
+    }
+
+    phfwdDelete(pf);
+
+    pf = (ok ? build(forwards, 1000 * horizon, horizon, seed) : NULL);
+    ok = (pf != NULL);
+
+    if (ok) {
+        size_t before = phfwdTime(pf);
+        double start = benchNow();
+        for (size_t now = 1; ok && now <= idle; ++now) {
+            ok = phfwdAdvanceClock(pf, now);
+        }
+        double time = benchNow() - start;
+
+        ok = ok && (phfwdTime(pf) == before);
+        printf("nothing due  %zu steps, %.0f ns per step\n", idle,
+               time * 1e9 / idle);
+    }
+
+    phfwdDelete(pf);
+
+    pf = (ok ? build(forwards, 1, horizon, seed) : NULL);
+    ok = (pf != NULL);
+
+    if (ok) {
+        size_t before = phfwdTime(pf);
+        double start = benchNow();
+        ok = phfwdAdvanceClock(pf, horizon);
+        double time = benchNow() - start;
+        size_t retired = phfwdTime(pf) - before;
+
+        printf("single jump  %zu retired, %.3f s "
+               "(%.2f us per retired forward)\n", retired, time,
+               retired > 0 ? time * 1e6 / retired : 0.0);
+    }
+
+    phfwdDelete(pf);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,137 @@
+/** @file bench_foreach.c
+ * Pomiar przeglądania wszystkich przekierowań przez phfwdForEach
+ * (zob. phone_forward_bulk.h) dla dwóch rozkładów kluczy: kolejnych
+ * numerów dziewięciocyfrowych przekierowanych na kilka wspólnych celów
+ * (gęste zakresy) oraz losowych numerów dziewięciocyfrowych przekierowanych
+ * na losowe numery siedmiocyfrowe.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "phone_forward.h"
+#include "phone_forward_bulk.h"
+
+/**
+ * Najmniejszy klucz zakresu kolejnych numerów.
+ */
+#define BENCH_DENSE_FIRST 100000000
+
+/**
+ * @brief Liczniki przeglądania.
+ */
+typedef struct EachCount {
+    /// Liczba przekierowań.
+    size_t forwards;
+    /// Łączna liczba cyfr numerów.
+    size_t digits;
+} EachCount;
+
+/**
+ * @brief Zlicza przekierowania i ich cyfry (zob. PhfwdForwardCallback).
+ *
+ * @param[in, out] context - liczniki (EachCount);
+ * @param[in] num1 - numer przekierowywany;
+ * @param[in] num2 - cel przekierowania.
+ * @return Wartość @p true.
+ */
+static bool countDigits(void *context, char const *num1, char const *num2) {
+    EachCount *count = context;
+
+    count->forwards++;
+    count->digits += strlen(num1) + strlen(num2);
+
+    return true;
+}
+
+/**
+ * @brief Mierzy przeglądanie wszystkich przekierowań i wypisuje wynik.
+ *
+ * @param[in] name - nazwa rozkładu kluczy;
+ * @param[in] pf - struktura.
+ * @return Wartość @p true, jeśli przeglądanie się powiodło.
+ */
+static bool measure(char const *name, PhoneForward const *pf) {
+    EachCount count = {0, 0};
+
+    double start = benchNow();
+    bool ok = phfwdForEach(pf, "", countDigits, &count);
+    double time = benchNow() - start;
+
+    if (ok && count.forwards > 0) {
+        printf("%-7s %zu forwards (%.1f MB of digits), %.3f s, "
+               "%.0f ns per forward\n", name, count.forwards,
+               count.digits / 1e6, time, time * 1e9 / count.forwards);
+    }
+
+    return ok;
+}
+
+/**
+ * @brief Wykonuje pomiar.
+ *
+ * Parametry: -d liczba kolejnych kluczy, -t liczba wspólnych celów, -r
+ * liczba losowych kluczy, -s ziarno.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty.
+ * @return Kod zakończenia programu.
+ */
+int main(int argc, char *argv[]) {
+    size_t dense = 5000000;
+    size_t targets = 5;
+    size_t random = 1000000;
+    size_t seed = 1;
+    BenchOption const options[] = {
+        {'d', &dense, "number of sequential keys"},
+        {'t', &targets, "number of targets of sequential keys"},
+        {'r', &random, "number of random keys"},
+        {'s', &seed, "random seed"},
+    };
+
+    if (!benchParse(argc, argv, options, sizeof(options) / sizeof(*options))
+        || dense == 0 || dense > BENCH_DENSE_FIRST * 8 || targets == 0
+        || random == 0) {
+        return EXIT_FAILURE;
+    }
+
+    char (*pool)[BENCH_NUMBER_SIZE] = malloc(targets * BENCH_NUMBER_SIZE);
+    PhoneForward *pf = phfwdNew();
+    bool ok = (pool != NULL && pf != NULL);
+
+    benchSeed(seed);
+    for (size_t i = 0; ok && i < targets; ++i) {
+        benchNumber(pool[i], 7, 7);
+    }
+
+    char num[BENCH_NUMBER_SIZE];
+    for (size_t i = 0; ok && i < dense; ++i) {
+        snprintf(num, sizeof(num), "%zu", BENCH_DENSE_FIRST + i);
+        ok = phfwdAdd(pf, num, pool[i % targets]);
+    }
+
+    ok = ok && measure("dense", pf);
+    phfwdDelete(pf);
+
+    pf = (ok ? phfwdNew() : NULL);
+    ok = (pf != NULL);
+
+    char target[BENCH_NUMBER_SIZE];
+    for (size_t i = 0; ok && i < random; ++i) {
+        benchNumber(num, 9, 9);
+        benchNumber(target, 7, 7);
+        ok = phfwdAdd(pf, num, target);
+    }
+
+    ok = ok && measure("random", pf);
+    phfwdDelete(pf);
+    free(pool);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
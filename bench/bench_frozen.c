@@ -0,0 +1,150 @@
+/** @file bench_frozen.c
+ * Porównanie struktury modyfikowalnej z jej postacią zamrożoną
+ * (zob. phone_forward_frozen.h): zajęta pamięć, czas zamrażania i czasy
+ * zapytań phfwdGet, phfwdReverse oraz phfwdGetReverse.
+ *
+ * Pamięć struktury modyfikowalnej to liczba bajtów przydzielonych z areny,
+ * z której korzysta; pamięć postaci zamrożonej podaje phfwdFrozenSize.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "allocator.h"
+#include "bench.h"
+#include "phone_forward.h"
+#include "phone_forward_frozen.h"
+
+/**
+ * Rozmiar fragmentu areny.
+ */
+#define BENCH_ARENA_CHUNK (1 << 20)
+
+/**
+ * Funkcja zapytania struktury modyfikowalnej.
+ */
+typedef PhoneNumbers *(*MutableQuery)(PhoneForward const *pf,
+                                      char const *num);
+
+/**
+ * Funkcja zapytania postaci zamrożonej.
+ */
+typedef PhoneNumbers *(*FrozenQuery)(PhfwdFrozen const *frozen,
+                                     char const *num);
+
+/**
+ * @brief Mierzy zapytania obu postaci i wypisuje wynik.
+ *
+ * Obie postaci dostają ten sam ciąg losowych numerów.
+ *
+ * @param[in] name - nazwa zapytania;
+ * @param[in] pf - struktura modyfikowalna;
+ * @param[in] mutableQuery - zapytanie struktury modyfikowalnej;
+ * @param[in] frozen - postać zamrożona;
+ * @param[in] frozenQuery - zapytanie postaci zamrożonej;
+ * @param[in] count - liczba zapytań;
+ * @param[in] seed - ziarno.
+ */
+static void measure(char const *name, PhoneForward const *pf,
+                    MutableQuery mutableQuery, PhfwdFrozen const *frozen,
+                    FrozenQuery frozenQuery, size_t count, size_t seed) {
+    char num[BENCH_NUMBER_SIZE];
+
+    benchSeed(seed);
+    double start = benchNow();
+    for (size_t i = 0; i < count; ++i) {
+        benchNumber(num, 7, 12);
+        phnumDelete(mutableQuery(pf, num));
+    }
+    double mutableTime = benchNow() - start;
+
+    benchSeed(seed);
+    start = benchNow();
+    for (size_t i = 0; i < count; ++i) {
+        benchNumber(num, 7, 12);
+        phnumDelete(frozenQuery(frozen, num));
+    }
+    double frozenTime = benchNow() - start;
+
+    printf("%-11s mutable %.2f us/op, frozen %.2f us/op\n", name,
+           count > 0 ? mutableTime * 1e6 / count : 0.0,
+           count > 0 ? frozenTime * 1e6 / count : 0.0);
+}
+
+/**
+ * @brief Wykonuje pomiar.
+ *
+ * Parametry: -n liczba przekierowań (numery od 7 do 10 cyfr), -g liczba
+ * zapytań phfwdGet, -r liczba zapytań phfwdReverse i phfwdGetReverse,
+ * -s ziarno. Numery w zapytaniach mają od 7 do 12 cyfr.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty.
+ * @return Kod zakończenia programu.
+ */
+int main(int argc, char *argv[]) {
+    size_t forwards = 300000;
+    size_t gets = 1000000;
+    size_t reverses = 200000;
+    size_t seed = 1;
+    BenchOption const options[] = {
+        {'n', &forwards, "number of forwards"},
+        {'g', &gets, "number of get calls"},
+        {'r', &reverses, "number of reverse and getReverse calls"},
+        {'s', &seed, "random seed"},
+    };
+
+    if (!benchParse(argc, argv, options,
+                    sizeof(options) / sizeof(*options))) {
+        return EXIT_FAILURE;
+    }
+
+    PhfwdAllocator *arena = phfwdArenaNew(BENCH_ARENA_CHUNK);
+    PhoneForward *pf = (arena == NULL ? NULL : phfwdNewWithAllocator(arena));
+    if (pf == NULL) {
+        phfwdArenaDelete(arena);
+        return EXIT_FAILURE;
+    }
+
+    benchSeed(seed);
+
+    char num1[BENCH_NUMBER_SIZE];
+    char num2[BENCH_NUMBER_SIZE];
+    for (size_t i = 0; i < forwards; ++i) {
+        benchNumber(num1, 7, 10);
+        benchNumber(num2, 7, 10);
+        phfwdAdd(pf, num1, num2);
+    }
+
+    size_t used = phfwdArenaUsed(arena);
+
+    double start = benchNow();
+    PhfwdFrozen *frozen = phfwdFreeze(pf);
+    double freezeTime = benchNow() - start;
+    if (frozen == NULL) {
+        phfwdDelete(pf);
+        phfwdArenaDelete(arena);
+        return EXIT_FAILURE;
+    }
+
+    size_t size = phfwdFrozenSize(frozen);
+    printf("memory      mutable %.1f MB, frozen %.1f MB (%.1fx)\n",
+           used / 1e6, size / 1e6, size > 0 ? (double) used / size : 0.0);
+    printf("freeze      %.3f s\n", freezeTime);
+
+    measure("get", pf, phfwdGet, frozen, phfwdFrozenGet, gets, seed + 1);
+    measure("reverse", pf, phfwdReverse, frozen, phfwdFrozenReverse,
+            reverses, seed + 2);
+    measure("getReverse", pf, phfwdGetReverse, frozen, phfwdFrozenGetReverse,
+            reverses, seed + 3);
+
+    phfwdFrozenDelete(frozen);
+    phfwdDelete(pf);
+    phfwdArenaDelete(arena);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,212 @@
+/** @file bench_history.c
+ * Pomiar historii przekierowań (zob. phone_forward_history.h): pamięć
+ * zastąpionych przekierowań w porównaniu z pełną kopią struktury, czas
+ * phfwdGetAt i phfwdReverseAt w minionej chwili w porównaniu z phfwdGet
+ * i phfwdReverse oraz pamięć po usunięciu historii.
+ *
+ * Struktura dostaje przekierowania z losowych numerów dziewięciocyfrowych
+ * na numery z puli tej samej wielkości, a następnie kolejne rundy zmian:
+ * przekierowania istniejących kluczy na nowe cele i wywołania phfwdRemove
+ * na istniejących kluczach. Ten sam ciąg modyfikacji jest wykonywany
+ * na strukturze bez historii i na strukturze z historią.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "phone_forward.h"
+#include "phone_forward_changelog.h"
+#include "phone_forward_history.h"
+
+/**
+ * @brief Wykonuje ciąg modyfikacji.
+ *
+ * Ten sam @p seed daje ten sam ciąg modyfikacji.
+ *
+ * @param[in, out] pf - struktura;
+ * @param[in] keys - klucze;
+ * @param[in] targets - pula celów;
+ * @param[in] count - liczba kluczy i celów;
+ * @param[in] rounds - liczba rund zmian;
+ * @param[in] changes - liczba przekierowań na nowe cele w każdej rundzie
+ *                      (wywołań phfwdRemove jest dziesięć razy mniej);
+ * @param[in] seed - ziarno;
+ * @param[out] times - czasy struktury po wypełnieniu i po każdej rundzie
+ *                     (@p rounds + 1 wartości);
+ * @return Liczba zastąpionych lub usuniętych przekierowań.
+ */
+static size_t mutate(PhoneForward *pf, char (*keys)[BENCH_NUMBER_SIZE],
+                     char (*targets)[BENCH_NUMBER_SIZE], size_t count,
+                     size_t rounds, size_t changes, size_t seed,
+                     size_t *times) {
+    bool *live = calloc(count, sizeof(bool));
+    size_t superseded = 0;
+
+    if (live == NULL) {
+        return 0;
+    }
+
+    benchSeed(seed);
+    for (size_t i = 0; i < count; ++i) {
+        live[i] = phfwdAdd(pf, keys[i], targets[benchBelow(count)]);
+    }
+    times[0] = phfwdTime(pf);
+
+    for (size_t r = 1; r <= rounds; ++r) {
+        for (size_t i = 0; i < changes + changes / 10; ++i) {
+            size_t key = benchBelow(count);
+
+            superseded += live[key];
+            if (i < changes) {
+                live[key] = phfwdAdd(pf, keys[key], targets[benchBelow(count)]);
+            }
+            else {
+                phfwdRemove(pf, keys[key]);
+                live[key] = false;
+            }
+        }
+
+        times[r] = phfwdTime(pf);
+    }
+
+    free(live);
+
+    return superseded;
+}
+
+/**
+ * @brief Mierzy zapytania o stan struktury w zadanej chwili.
+ *
+ * @param[in] pf - struktura;
+ * @param[in] numbers - numery, o które pytają zapytania;
+ * @param[in] count - liczba numerów;
+ * @param[in] queries - liczba zapytań;
+ * @param[in] time - chwila (SIZE_MAX dla phfwdGet i phfwdReverse);
+ * @param[in] reverse - czy mierzone są zapytania o przekierowania wstecz;
+ * @param[in] seed - ziarno (te same zapytania dla tego samego ziarna).
+ * @return Średni czas zapytania w mikrosekundach.
+ */
+static double measure(PhoneForward const *pf,
+                      char (*numbers)[BENCH_NUMBER_SIZE], size_t count,
+                      size_t queries, size_t time, bool reverse,
+                      size_t seed) {
+    benchSeed(seed);
+
+    double start = benchNow();
+    for (size_t i = 0; i < queries; ++i) {
+        char const *num = numbers[benchBelow(count)];
+
+        if (time == SIZE_MAX) {
+            phnumDelete(reverse ? phfwdReverse(pf, num) : phfwdGet(pf, num));
+        }
+        else {
+            phnumDelete(reverse ? phfwdReverseAt(pf, num, time)
+                                : phfwdGetAt(pf, num, time));
+        }
+    }
+
+    return (benchNow() - start) * 1e6 / queries;
+}
+
+/**
+ * @brief Wykonuje pomiar.
+ *
+ * Parametry: -n liczba kluczy, -r liczba rund zmian, -c liczba
+ * przekierowań na nowe cele w każdej rundzie, -q liczba zapytań w każdym
+ * pomiarze, -s ziarno.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty.
+ * @return Kod zakończenia programu.
+ */
+int main(int argc, char *argv[]) {
+    size_t count = 100000;
+    size_t rounds = 5;
+    size_t changes = 10000;
+    size_t queries = 1000000;
+    size_t seed = 1;
+    BenchOption const options[] = {
+        {'n', &count, "number of keys"},
+        {'r', &rounds, "number of rounds of changes"},
+        {'c', &changes, "re-pointed keys per round"},
+        {'q', &queries, "number of queries per measurement"},
+        {'s', &seed, "random seed"},
+    };
+
+    if (!benchParse(argc, argv, options, sizeof(options) / sizeof(*options))
+        || count == 0 || rounds == 0 || queries == 0) {
+        return EXIT_FAILURE;
+    }
+
+    char (*keys)[BENCH_NUMBER_SIZE] = malloc(count * BENCH_NUMBER_SIZE);
+    char (*targets)[BENCH_NUMBER_SIZE] = malloc(count * BENCH_NUMBER_SIZE);
+    size_t *times = malloc((rounds + 1) * sizeof(size_t));
+    if (keys == NULL || targets == NULL || times == NULL) {
+        free(keys);
+        free(targets);
+        free(times);
+        return EXIT_FAILURE;
+    }
+
+    benchSeed(seed);
+    for (size_t i = 0; i < count; ++i) {
+        benchNumber(keys[i], 9, 9);
+        benchNumber(targets[i], 9, 9);
+    }
+
+    size_t heap = benchHeapBytes();
+    PhoneForward *plain = phfwdNew();
+    bool ok = (plain != NULL);
+    if (ok) {
+        mutate(plain, keys, targets, count, rounds, changes, seed + 1, times);
+    }
+    size_t plainHeap = benchHeapBytes() - heap;
+
+    heap = benchHeapBytes();
+    PhoneForward *pf = (ok ? phfwdNew() : NULL);
+    ok = (pf != NULL && phfwdHistoryEnable(pf));
+    size_t superseded = 0;
+    if (ok) {
+        superseded = mutate(pf, keys, targets, count, rounds, changes,
+                            seed + 1, times);
+        ok = (phfwdHistoryHorizon(pf) == 0);
+    }
+    size_t historyHeap = benchHeapBytes() - heap;
+
+    if (ok) {
+        size_t past = times[rounds / 2];
+        size_t overhead = historyHeap - plainHeap;
+
+        printf("heap        %.1f MB without history, +%.1f MB history for "
+               "%zu superseded forwards (%.0f B each)\n", plainHeap / 1e6,
+               overhead / 1e6, superseded,
+               superseded > 0 ? (double) overhead / superseded : 0.0);
+        printf("get         %.2f us now, %.2f us at time %zu of %zu\n",
+               measure(pf, keys, count, queries, SIZE_MAX, false, seed),
+               measure(pf, keys, count, queries, past, false, seed), past,
+               phfwdTime(pf));
+        printf("reverse     %.2f us now, %.2f us at time %zu of %zu\n",
+               measure(pf, targets, count, queries, SIZE_MAX, true, seed),
+               measure(pf, targets, count, queries, past, true, seed), past,
+               phfwdTime(pf));
+
+        phfwdPruneHistory(pf, phfwdTime(pf));
+        printf("prune       %.1f MB with history -> %.1f MB, %.1f MB "
+               "without history\n", historyHeap / 1e6,
+               (benchHeapBytes() - heap) / 1e6, plainHeap / 1e6);
+    }
+
+    phfwdDelete(plain);
+    phfwdDelete(pf);
+    free(keys);
+    free(targets);
+    free(times);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
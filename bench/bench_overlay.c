@@ -0,0 +1,161 @@
+/** @file bench_overlay.c
+ * Pomiar nakładek (zob. phone_forward_overlay.h): pamięć zajmowana przez
+ * nakładki w porównaniu ze strukturą bazową oraz czas zapytań do nakładek
+ * w porównaniu z zapytaniami do struktury bazowej.
+ *
+ * Struktura bazowa dostaje przekierowania z losowych numerów
+ * dziewięciocyfrowych na numery z puli tej samej wielkości. Każda nakładka
+ * wykonuje własne modyfikacje: 9/10 przekierowań losowych kluczy bazy
+ * na cele z puli i 1/10 wywołań phfwdOverlayRemove na kluczach bazy.
+ * Zapytania dotyczą losowych kluczy (phfwdGet) i celów z puli
+ * (phfwdReverse).
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "phone_forward.h"
+#include "phone_forward_overlay.h"
+
+/**
+ * @brief Mierzy zapytania do struktury bazowej lub do nakładek.
+ *
+ * @param[in] base - struktura bazowa;
+ * @param[in] overlays - nakładki (NULL dla zapytań do bazy);
+ * @param[in] count - liczba nakładek;
+ * @param[in] numbers - numery, o które pytają zapytania;
+ * @param[in] size - liczba numerów;
+ * @param[in] queries - liczba zapytań;
+ * @param[in] reverse - czy mierzone są zapytania o przekierowania wstecz;
+ * @param[in] seed - ziarno (te same zapytania dla tego samego ziarna).
+ * @return Średni czas zapytania w mikrosekundach.
+ */
+static double measure(PhoneForward const *base, PhfwdOverlay **overlays,
+                      size_t count, char (*numbers)[BENCH_NUMBER_SIZE],
+                      size_t size, size_t queries, bool reverse,
+                      size_t seed) {
+    benchSeed(seed);
+
+    double start = benchNow();
+    for (size_t i = 0; i < queries; ++i) {
+        char const *num = numbers[benchBelow(size)];
+
+        if (overlays == NULL) {
+            phnumDelete(reverse ? phfwdReverse(base, num)
+                                : phfwdGet(base, num));
+        }
+        else {
+            PhfwdOverlay const *overlay = overlays[i % count];
+
+            phnumDelete(reverse ? phfwdOverlayReverse(overlay, num)
+                                : phfwdOverlayGet(overlay, num));
+        }
+    }
+
+    return (benchNow() - start) * 1e6 / queries;
+}
+
+/**
+ * @brief Wykonuje pomiar.
+ *
+ * Parametry: -n liczba przekierowań struktury bazowej, -k liczba nakładek,
+ * -m liczba modyfikacji każdej nakładki, -q liczba zapytań w każdym
+ * pomiarze, -s ziarno.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty.
+ * @return Kod zakończenia programu.
+ */
+int main(int argc, char *argv[]) {
+    size_t forwards = 1000000;
+    size_t count = 20;
+    size_t changes = 2000;
+    size_t queries = 1000000;
+    size_t seed = 1;
+    BenchOption const options[] = {
+        {'n', &forwards, "number of base forwards"},
+        {'k', &count, "number of overlays"},
+        {'m', &changes, "mutations per overlay"},
+        {'q', &queries, "number of queries per measurement"},
+        {'s', &seed, "random seed"},
+    };
+
+    if (!benchParse(argc, argv, options, sizeof(options) / sizeof(*options))
+        || forwards == 0 || count == 0 || queries == 0) {
+        return EXIT_FAILURE;
+    }
+
+    char (*keys)[BENCH_NUMBER_SIZE] = malloc(forwards * BENCH_NUMBER_SIZE);
+    char (*targets)[BENCH_NUMBER_SIZE] = malloc(forwards * BENCH_NUMBER_SIZE);
+    PhfwdOverlay **overlays = calloc(count, sizeof(PhfwdOverlay *));
+    if (keys == NULL || targets == NULL || overlays == NULL) {
+        free(keys);
+        free(targets);
+        free(overlays);
+        return EXIT_FAILURE;
+    }
+
+    benchSeed(seed);
+    for (size_t i = 0; i < forwards; ++i) {
+        benchNumber(keys[i], 9, 9);
+        benchNumber(targets[i], 9, 9);
+    }
+
+    size_t heap = benchHeapBytes();
+    PhoneForward *base = phfwdNew();
+    bool ok = (base != NULL);
+    for (size_t i = 0; ok && i < forwards; ++i) {
+        phfwdAdd(base, keys[i], targets[benchBelow(forwards)]);
+    }
+    size_t baseHeap = benchHeapBytes() - heap;
+
+    heap = benchHeapBytes();
+    for (size_t j = 0; ok && j < count; ++j) {
+        overlays[j] = phfwdOverlayNew(base);
+        ok = (overlays[j] != NULL);
+
+        for (size_t i = 0; ok && i < changes; ++i) {
+            char const *key = keys[benchBelow(forwards)];
+
+            if (benchBelow(10) == 0) {
+                phfwdOverlayRemove(overlays[j], key);
+            }
+            else {
+                phfwdOverlayAdd(overlays[j], key,
+                                targets[benchBelow(forwards)]);
+            }
+        }
+    }
+    size_t overlayHeap = benchHeapBytes() - heap;
+
+    if (ok) {
+        printf("heap     base %.1f MB, %.2f MB per overlay\n",
+               baseHeap / 1e6, overlayHeap / 1e6 / count);
+        printf("get      %.2f us base, %.2f us overlay\n",
+               measure(base, NULL, count, keys, forwards, queries, false,
+                       seed),
+               measure(base, overlays, count, keys, forwards, queries, false,
+                       seed));
+        printf("reverse  %.2f us base, %.2f us overlay\n",
+               measure(base, NULL, count, targets, forwards, queries, true,
+                       seed),
+               measure(base, overlays, count, targets, forwards, queries,
+                       true, seed));
+    }
+
+    for (size_t j = 0; j < count; ++j) {
+        phfwdOverlayDelete(overlays[j]);
+    }
+
+    phfwdDelete(base);
+    free(keys);
+    free(targets);
+    free(overlays);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,245 @@
+/** @file bench_resolve.c
+ * Pomiar phfwdResolve w porównaniu z pętlą wywołań phfwdGet, stosującą
+ * przekierowania dopóty, dopóki zmieniają numer.
+ *
+ * Pomiar jest wykonywany dla dwóch planów numeracji: łańcuchów
+ * przekierowań między numerami dziewięciocyfrowymi (zapytania o początki
+ * niewielkiej liczby często odpytywanych łańcuchów albo jednostajnie
+ * o początki wszystkich łańcuchów) oraz przekierowań z prefiksów od 4 do 7 cyfr
+ * na numery od 7 do 10 cyfr (zapytania o losowe numery dwunastocyfrowe,
+ * których łańcuchy zależą zwykle od dalszych cyfr numeru).
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "phone_forward.h"
+#include "phone_forward_query.h"
+
+/**
+ * Najdłuższy łańcuch przekierowań między numerami dziewięciocyfrowymi.
+ */
+#define BENCH_CHAIN_MAX 6
+
+/**
+ * @brief Stosuje przekierowania wywołaniami phfwdGet.
+ *
+ * @param[in] pf - struktura;
+ * @param[in] num - numer;
+ * @param[in] maxHops - największa liczba przekierowań.
+ * @return Liczba wykonanych przekierowań (@p maxHops + 1, jeśli łańcuch
+ *         jest dłuższy).
+ */
+static size_t getLoop(PhoneForward const *pf, char const *num,
+                      size_t maxHops) {
+    PhoneNumbers *previous = NULL;
+    PhoneNumbers *current = phfwdGet(pf, num);
+    char const *last = num;
+    size_t hops = 0;
+
+    while (current != NULL && hops <= maxHops) {
+        char const *next = phnumGet(current, 0);
+        if (strcmp(next, last) == 0) {
+            break;
+        }
+
+        hops++;
+        phnumDelete(previous);
+        previous = current;
+        last = next;
+        current = phfwdGet(pf, next);
+    }
+
+    phnumDelete(previous);
+    phnumDelete(current);
+
+    return hops;
+}
+
+/**
+ * @brief Mierzy jeden zestaw zapytań i wypisuje wynik.
+ *
+ * @param[in] name - nazwa zestawu;
+ * @param[in, out] pf - struktura;
+ * @param[in] queries - zapytania;
+ * @param[in] count - liczba zapytań;
+ * @param[in] maxHops - największa liczba przekierowań.
+ */
+static void measure(char const *name, PhoneForward *pf,
+                    char (*queries)[BENCH_NUMBER_SIZE], size_t count,
+                    size_t maxHops) {
+    double start = benchNow();
+    for (size_t i = 0; i < count; ++i) {
+        phnumDelete(phfwdGet(pf, queries[i]));
+    }
+    double getTime = benchNow() - start;
+
+    size_t hops = 0;
+    start = benchNow();
+    for (size_t i = 0; i < count; ++i) {
+        hops += getLoop(pf, queries[i], maxHops);
+    }
+    double loopTime = benchNow() - start;
+
+    start = benchNow();
+    for (size_t i = 0; i < count; ++i) {
+        phnumDelete(phfwdResolve(pf, queries[i], maxHops));
+    }
+    double resolveTime = benchNow() - start;
+
+    printf("%-8s %.2f hops, get %.2f us, get loop %.2f us, "
+           "resolve %.2f us\n", name, (double) hops / count,
+           getTime * 1e6 / count, loopTime * 1e6 / count,
+           resolveTime * 1e6 / count);
+}
+
+/**
+ * @brief Tworzy łańcuchy przekierowań między losowymi numerami.
+ *
+ * Łańcuchy mają od 1 do @ref BENCH_CHAIN_MAX przekierowań.
+ *
+ * @param[in] numbers - liczba numerów we wszystkich łańcuchach;
+ * @param[out] sources - początki łańcuchów;
+ * @param[out] chains - liczba łańcuchów.
+ * @return Wskaźnik na strukturę lub NULL, gdy nie udało się alokować
+ *         pamięci.
+ */
+static PhoneForward *buildChains(size_t numbers,
+                                 char (*sources)[BENCH_NUMBER_SIZE],
+                                 size_t *chains) {
+    PhoneForward *pf = phfwdNew();
+    if (pf == NULL) {
+        return NULL;
+    }
+
+    char num[BENCH_NUMBER_SIZE];
+    char next[BENCH_NUMBER_SIZE];
+    size_t used = 0;
+
+    *chains = 0;
+    while (used + BENCH_CHAIN_MAX + 1 <= numbers) {
+        size_t length = 1 + benchBelow(BENCH_CHAIN_MAX);
+
+        benchNumber(num, 9, 9);
+        strcpy(sources[(*chains)++], num);
+
+        for (size_t i = 0; i < length; ++i) {
+            benchNumber(next, 9, 9);
+            phfwdAdd(pf, num, next);
+            strcpy(num, next);
+        }
+
+        used += length + 1;
+    }
+
+    return pf;
+}
+
+/**
+ * @brief Tworzy plan numeracji z przekierowań prefiksów.
+ *
+ * @param[in] forwards - liczba przekierowań.
+ * @return Wskaźnik na strukturę lub NULL, gdy nie udało się alokować
+ *         pamięci.
+ */
+static PhoneForward *buildPlan(size_t forwards) {
+    PhoneForward *pf = phfwdNew();
+    if (pf == NULL) {
+        return NULL;
+    }
+
+    char num[BENCH_NUMBER_SIZE];
+    char target[BENCH_NUMBER_SIZE];
+    for (size_t i = 0; i < forwards; ++i) {
+        benchNumber(num, 4, 7);
+        benchNumber(target, 7, 10);
+        phfwdAdd(pf, num, target);
+    }
+
+    return pf;
+}
+
+/**
+ * @brief Wykonuje pomiar.
+ *
+ * Parametry: -n liczba numerów w łańcuchach, -t liczba często
+ * odpytywanych łańcuchów, -p liczba przekierowań planu z prefiksów,
+ * -q liczba zapytań w każdym zestawie, -m największa liczba przekierowań
+ * (parametr @p maxHops), -s ziarno.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty.
+ * @return Kod zakończenia programu.
+ */
+int main(int argc, char *argv[]) {
+    size_t numbers = 1000000;
+    size_t hot = 20000;
+    size_t prefixes = 50000;
+    size_t count = 1000000;
+    size_t maxHops = 16;
+    size_t seed = 1;
+    BenchOption const options[] = {
+        {'n', &numbers, "number of 9-digit numbers in chains"},
+        {'t', &hot, "number of hot chains"},
+        {'p', &prefixes, "number of prefix forwards"},
+        {'q', &count, "number of queries per measurement"},
+        {'m', &maxHops, "maxHops argument"},
+        {'s', &seed, "random seed"},
+    };
+
+    if (!benchParse(argc, argv, options, sizeof(options) / sizeof(*options))
+        || numbers <= BENCH_CHAIN_MAX || hot == 0 || count == 0) {
+        return EXIT_FAILURE;
+    }
+
+    char (*sources)[BENCH_NUMBER_SIZE] = malloc(numbers * BENCH_NUMBER_SIZE);
+    char (*queries)[BENCH_NUMBER_SIZE] = malloc(count * BENCH_NUMBER_SIZE);
+    if (sources == NULL || queries == NULL) {
+        free(sources);
+        free(queries);
+        return EXIT_FAILURE;
+    }
+
+    benchSeed(seed);
+
+    size_t chains;
+    PhoneForward *pf = buildChains(numbers, sources, &chains);
+    bool ok = (pf != NULL);
+
+    if (ok) {
+        hot = (hot < chains ? hot : chains);
+        for (size_t i = 0; i < count; ++i) {
+            strcpy(queries[i], sources[benchBelow(hot)]);
+        }
+        measure("hot", pf, queries, count, maxHops);
+
+        for (size_t i = 0; i < count; ++i) {
+            strcpy(queries[i], sources[benchBelow(chains)]);
+        }
+        measure("uniform", pf, queries, count, maxHops);
+    }
+
+    phfwdDelete(pf);
+
+    pf = (ok ? buildPlan(prefixes) : NULL);
+    ok = (pf != NULL);
+
+    if (ok) {
+        for (size_t i = 0; i < count; ++i) {
+            benchNumber(queries[i], 12, 12);
+        }
+        measure("prefixes", pf, queries, count, maxHops);
+    }
+
+    phfwdDelete(pf);
+    free(sources);
+    free(queries);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,205 @@
+/** @file bench_sharded.c
+ * Pomiar przepustowości modyfikacji struktury podzielonej na części
+ * (zob. phone_forward_sharded.h) w zależności od liczby wątków piszących,
+ * w porównaniu z jedną strukturą chronioną wspólnym muteksem.
+ *
+ * Każdy wątek wykonuje swoją część wspólnego ciągu modyfikacji: 7/8 dodań
+ * przekierowań z numerów dziewięciocyfrowych na numery od 7 do 10 cyfr
+ * i 1/8 wywołań phfwdRemove na prefiksach siedmiocyfrowych. Pierwsze cyfry
+ * numerów mają rozkład jednostajny. Modyfikacje są losowane przed
+ * pomiarem, a każdy pomiar zaczyna się od pustej struktury.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "phone_forward.h"
+#include "phone_forward_sharded.h"
+
+/**
+ * @brief Modyfikacja struktury.
+ */
+typedef struct ShardedOp {
+    /// Numer przekierowywany lub prefiks usuwanych przekierowań.
+    char num1[BENCH_NUMBER_SIZE];
+    /// Cel przekierowania (pusty dla phfwdRemove).
+    char num2[BENCH_NUMBER_SIZE];
+} ShardedOp;
+
+/**
+ * @brief Stan wątku piszącego.
+ */
+typedef struct ShardedWorker {
+    /// Modyfikacje wątku.
+    ShardedOp const *ops;
+    /// Liczba modyfikacji.
+    size_t count;
+    /// Struktura podzielona na części (lub NULL).
+    PhfwdSharded *sharded;
+    /// Struktura chroniona muteksem @p lock (jeśli @p sharded to NULL).
+    PhoneForward *pf;
+    /// Muteks struktury @p pf.
+    pthread_mutex_t *lock;
+} ShardedWorker;
+
+/**
+ * @brief Wątek piszący: wykonuje swoje modyfikacje.
+ *
+ * @param[in] arg - stan wątku.
+ * @return NULL.
+ */
+static void *workerMain(void *arg) {
+    ShardedWorker const *worker = arg;
+
+    for (size_t i = 0; i < worker->count; ++i) {
+        ShardedOp const *op = &worker->ops[i];
+
+        if (worker->sharded != NULL) {
+            if (op->num2[0] == '\0') {
+                phfwdShardedRemove(worker->sharded, op->num1);
+            }
+            else {
+                phfwdShardedAdd(worker->sharded, op->num1, op->num2);
+            }
+            continue;
+        }
+
+        pthread_mutex_lock(worker->lock);
+        if (op->num2[0] == '\0') {
+            phfwdRemove(worker->pf, op->num1);
+        }
+        else {
+            phfwdAdd(worker->pf, op->num1, op->num2);
+        }
+        pthread_mutex_unlock(worker->lock);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Wykonuje modyfikacje zadaną liczbą wątków.
+ *
+ * @param[in] ops - modyfikacje;
+ * @param[in] count - liczba modyfikacji;
+ * @param[in] threads - liczba wątków;
+ * @param[in] sharded - czy modyfikowana jest struktura podzielona
+ *                      na części (a nie struktura ze wspólnym muteksem).
+ * @return Liczba modyfikacji na sekundę lub 0, gdy nie udało się alokować
+ *         pamięci albo utworzyć wątków.
+ */
+static double run(ShardedOp const *ops, size_t count, size_t threads,
+                  bool sharded) {
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    ShardedWorker *workers = malloc(threads * sizeof(ShardedWorker));
+    pthread_t *ids = malloc(threads * sizeof(pthread_t));
+    PhfwdSharded *shards = (sharded ? phfwdShardedNew() : NULL);
+    PhoneForward *pf = (sharded ? NULL : phfwdNew());
+
+    if (workers == NULL || ids == NULL || (shards == NULL && pf == NULL)) {
+        free(workers);
+        free(ids);
+        phfwdShardedDelete(shards);
+        phfwdDelete(pf);
+        return 0.0;
+    }
+
+    for (size_t i = 0; i < threads; ++i) {
+        size_t begin = count * i / threads;
+        size_t end = count * (i + 1) / threads;
+
+        workers[i] = (ShardedWorker) {ops + begin, end - begin, shards, pf,
+                                      &lock};
+    }
+
+    size_t started = 0;
+    double start = benchNow();
+    while (started < threads
+           && pthread_create(&ids[started], NULL, workerMain,
+                             &workers[started]) == 0) {
+        started++;
+    }
+
+    for (size_t i = 0; i < started; ++i) {
+        pthread_join(ids[i], NULL);
+    }
+    double time = benchNow() - start;
+
+    free(workers);
+    free(ids);
+    phfwdShardedDelete(shards);
+    phfwdDelete(pf);
+
+    return started == threads ? count / time : 0.0;
+}
+
+/**
+ * @brief Wykonuje pomiar.
+ *
+ * Parametry: -n liczba modyfikacji w każdym pomiarze, -t największa
+ * liczba wątków (mierzone są wszystkie liczby od 1), -s ziarno.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty.
+ * @return Kod zakończenia programu.
+ */
+int main(int argc, char *argv[]) {
+    size_t count = 400000;
+    size_t maxThreads = 8;
+    size_t seed = 1;
+    BenchOption const options[] = {
+        {'n', &count, "number of mutations per measurement"},
+        {'t', &maxThreads, "largest number of writer threads"},
+        {'s', &seed, "random seed"},
+    };
+
+    if (!benchParse(argc, argv, options, sizeof(options) / sizeof(*options))
+        || count == 0 || maxThreads == 0) {
+        return EXIT_FAILURE;
+    }
+
+    ShardedOp *ops = malloc(count * sizeof(ShardedOp));
+    if (ops == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    benchSeed(seed);
+    for (size_t i = 0; i < count; ++i) {
+        if (benchBelow(8) == 0) {
+            benchNumber(ops[i].num1, 7, 7);
+            ops[i].num2[0] = '\0';
+        }
+        else {
+            benchNumber(ops[i].num1, 9, 9);
+            benchNumber(ops[i].num2, 7, 10);
+        }
+    }
+
+    printf("%7s %14s %14s %9s\n", "threads", "mutex [op/s]", "sharded [op/s]",
+           "scaling");
+
+    bool ok = true;
+    double single = 0.0;
+    for (size_t threads = 1; ok && threads <= maxThreads; ++threads) {
+        double locked = run(ops, count, threads, false);
+        double sharded = run(ops, count, threads, true);
+
+        ok = (locked > 0.0 && sharded > 0.0);
+        single = (threads == 1 ? sharded : single);
+
+        if (ok) {
+            printf("%7zu %14.0f %14.0f %9.2f\n", threads, locked, sharded,
+                   sharded / single);
+        }
+    }
+
+    free(ops);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,167 @@
+/** @file bench_store.c
+ * Pomiar magazynu tabel ze wspólnymi poddrzewami
+ * (zob. phone_forward_store.h): pamięć magazynu w porównaniu
+ * z osobnymi strukturami i z tabelami bez współdzielenia, czas importu,
+ * modyfikacji z kopiowaniem ścieżki i zapytań phfwdStoreGet.
+ *
+ * Każdy region ma te same przekierowania wspólne i własne przekierowania
+ * regionalne, wszystkie z losowych numerów dziewięciocyfrowych na numery
+ * dziewięciocyfrowe. Struktura każdego regionu jest budowana osobno,
+ * importowana do magazynu i usuwana. Po imporcie tabele dostają losowe
+ * przekierowania regionalne.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "phone_forward.h"
+#include "phone_forward_store.h"
+
+/**
+ * @brief Tworzy strukturę regionu.
+ *
+ * @param[in] shared - liczba przekierowań wspólnych;
+ * @param[in] regional - liczba przekierowań regionalnych;
+ * @param[in] seed - ziarno przekierowań wspólnych;
+ * @param[in] region - numer regionu.
+ * @return Wskaźnik na strukturę lub NULL, gdy nie udało się alokować
+ *         pamięci.
+ */
+static PhoneForward *buildRegion(size_t shared, size_t regional,
+                                 size_t seed, size_t region) {
+    PhoneForward *pf = phfwdNew();
+    if (pf == NULL) {
+        return NULL;
+    }
+
+    char num[BENCH_NUMBER_SIZE];
+    char target[BENCH_NUMBER_SIZE];
+
+    benchSeed(seed);
+    for (size_t i = 0; i < shared; ++i) {
+        benchNumber(num, 9, 9);
+        benchNumber(target, 9, 9);
+        phfwdAdd(pf, num, target);
+    }
+
+    benchSeed(seed + 1 + region);
+    for (size_t i = 0; i < regional; ++i) {
+        benchNumber(num, 9, 9);
+        benchNumber(target, 9, 9);
+        phfwdAdd(pf, num, target);
+    }
+
+    return pf;
+}
+
+/**
+ * @brief Wypisuje pamięć magazynu.
+ *
+ * @param[in] label - opis pomiaru;
+ * @param[in] store - magazyn.
+ */
+static void printStats(char const *label, PhfwdStore const *store) {
+    PhfwdStoreStats stats;
+
+    phfwdStoreStats(store, &stats);
+    printf("%-11s %zu tables, %.1f MB, %.1f MB unshared (%.0f%% saved)\n",
+           label, stats.tables, stats.bytes / 1e6, stats.unsharedBytes / 1e6,
+           100.0 - 100.0 * stats.bytes / stats.unsharedBytes);
+}
+
+/**
+ * @brief Wykonuje pomiar.
+ *
+ * Parametry: -r liczba regionów, -n liczba przekierowań wspólnych, -l
+ * liczba przekierowań regionalnych, -a liczba przekierowań dodawanych
+ * po imporcie, -q liczba zapytań, -s ziarno.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty.
+ * @return Kod zakończenia programu.
+ */
+int main(int argc, char *argv[]) {
+    size_t regions = 16;
+    size_t shared = 100000;
+    size_t regional = 5000;
+    size_t adds = 100000;
+    size_t queries = 1000000;
+    size_t seed = 1;
+    BenchOption const options[] = {
+        {'r', &regions, "number of regions"},
+        {'n', &shared, "forwards shared by all regions"},
+        {'l', &regional, "forwards of each region"},
+        {'a', &adds, "forwards added after import"},
+        {'q', &queries, "number of queries"},
+        {'s', &seed, "random seed"},
+    };
+
+    if (!benchParse(argc, argv, options, sizeof(options) / sizeof(*options))
+        || regions == 0 || queries == 0) {
+        return EXIT_FAILURE;
+    }
+
+    PhfwdStore *store = phfwdStoreNew();
+    PhfwdStoreTable **tables = calloc(regions, sizeof(PhfwdStoreTable *));
+    bool ok = (store != NULL && tables != NULL);
+
+    size_t instances = 0;
+    double importTime = 0.0;
+    for (size_t r = 0; ok && r < regions; ++r) {
+        size_t heap = benchHeapBytes();
+        PhoneForward *pf = buildRegion(shared, regional, seed, r);
+        instances += benchHeapBytes() - heap;
+
+        double start = benchNow();
+        tables[r] = phfwdStoreImport(store, pf);
+        importTime += benchNow() - start;
+
+        ok = (tables[r] != NULL);
+        phfwdDelete(pf);
+    }
+
+    if (ok) {
+        printf("instances   %zu tables, %.1f MB\n", regions, instances / 1e6);
+        printStats("store", store);
+        printf("import      %.0f ms per table\n", importTime * 1e3 / regions);
+
+        char num[BENCH_NUMBER_SIZE];
+        char target[BENCH_NUMBER_SIZE];
+
+        benchSeed(seed + regions + 1);
+        double start = benchNow();
+        for (size_t i = 0; i < adds; ++i) {
+            benchNumber(num, 9, 9);
+            benchNumber(target, 9, 9);
+            phfwdStoreAdd(tables[i % regions], num, target);
+        }
+        double addTime = benchNow() - start;
+
+        printf("add         %.2f us copy-on-write\n",
+               adds > 0 ? addTime * 1e6 / adds : 0.0);
+        printStats("after adds", store);
+
+        // Zapytania o klucze przekierowań wspólnych (w kolejności
+        // z buildRegion).
+        benchSeed(seed);
+        start = benchNow();
+        for (size_t i = 0; i < queries; ++i) {
+            benchNumber(num, 9, 9);
+            benchNumber(target, 9, 9);
+            phnumDelete(phfwdStoreGet(tables[i % regions], num));
+        }
+
+        printf("get         %.2f us\n",
+               (benchNow() - start) * 1e6 / queries);
+    }
+
+    phfwdStoreDelete(store);
+    free(tables);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
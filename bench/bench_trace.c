@@ -0,0 +1,95 @@
+/** @file bench_trace.c
+ * Pomiar narzutu instrumentacji czasów wykonania operacji (zob. trace.h).
+ *
+ * Ten sam program jest budowany dwukrotnie: jako @p bench_trace
+ * z biblioteką bez instrumentacji oraz jako @p bench_trace_on z biblioteką
+ * skompilowaną z makrem @p PHFWD_TRACE. Porównanie czasów obu wersji
+ * (również przy różnych wartościach parametru -k) daje narzut pomiarów.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "phone_forward.h"
+#include "trace.h"
+
+/**
+ * @brief Wykonuje pomiar.
+ *
+ * Parametry: -n liczba przekierowań, -g liczba zapytań phfwdGet o losowe
+ * numery dwunastocyfrowe, -r liczba zapytań phfwdReverse o losowe numery
+ * dziesięciocyfrowe, -k wykładnik próbkowania (zob. phfwdTraceSetSampling),
+ * -s ziarno.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty.
+ * @return Kod zakończenia programu.
+ */
+int main(int argc, char *argv[]) {
+    size_t forwards = 200000;
+    size_t gets = 1000000;
+    size_t reverses = 200000;
+    size_t sampling = 0;
+    size_t seed = 1;
+    BenchOption const options[] = {
+        {'n', &forwards, "number of forwards"},
+        {'g', &gets, "number of phfwdGet calls"},
+        {'r', &reverses, "number of phfwdReverse calls"},
+        {'k', &sampling, "trace one in 2^k operations"},
+        {'s', &seed, "random seed"},
+    };
+
+    if (!benchParse(argc, argv, options, sizeof(options) / sizeof(*options))
+        || sampling > 31) {
+        return EXIT_FAILURE;
+    }
+
+    PhoneForward *pf = phfwdNew();
+    if (pf == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    phfwdTraceSetSampling((unsigned) sampling);
+    benchSeed(seed);
+
+    char num1[BENCH_NUMBER_SIZE];
+    char num2[BENCH_NUMBER_SIZE];
+    for (size_t i = 0; i < forwards; ++i) {
+        benchNumber(num1, 3, 7);
+        benchNumber(num2, 3, 7);
+        phfwdAdd(pf, num1, num2);
+    }
+
+    double start = benchNow();
+    for (size_t i = 0; i < gets; ++i) {
+        benchNumber(num1, 12, 12);
+        phnumDelete(phfwdGet(pf, num1));
+    }
+    double getTime = benchNow() - start;
+
+    start = benchNow();
+    for (size_t i = 0; i < reverses; ++i) {
+        benchNumber(num1, 10, 10);
+        phnumDelete(phfwdReverse(pf, num1));
+    }
+    double reverseTime = benchNow() - start;
+
+    printf("trace %s, sampling 1/%zu\n",
+           phfwdTraceEnabled() ? "on" : "off", (size_t) 1 << sampling);
+    printf("get %.1f ns/op\n", gets > 0 ? getTime * 1e9 / gets : 0.0);
+    printf("reverse %.1f ns/op\n",
+           reverses > 0 ? reverseTime * 1e9 / reverses : 0.0);
+
+    if (phfwdTraceEnabled()) {
+        phfwdTraceExport(stdout);
+    }
+
+    phfwdDelete(pf);
+
+    return EXIT_SUCCESS;
+}
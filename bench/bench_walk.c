@@ -0,0 +1,129 @@
+/** @file bench_walk.c
+ * Pomiar liczby kroków przejścia drzewa w phfwdGet (zob. findLastFwdPrefix
+ * i ograniczenie @p fwdDepthBelow).
+ *
+ * Program korzysta z biblioteki z instrumentacją (licznik
+ * PHFWD_TRACE_WALK_STEPS, zob. trace.h) i porównuje liczbę odwiedzonych
+ * wierzchołków z liczbą wierzchołków pełnej ścieżki numeru w drzewie,
+ * którą przeszłoby przejście bez wczesnego zakończenia.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "node.h"
+#include "phone_forward.h"
+#include "trace.h"
+#include "utils.h"
+
+/**
+ * @brief Liczy wierzchołki ścieżki numeru w drzewie (od korzenia
+ * do najgłębszego istniejącego wierzchołka, co najwyżej na głębokości
+ * długości numeru).
+ *
+ * @param[in] pf - struktura;
+ * @param[in] num - numer.
+ * @return Liczba wierzchołków ścieżki.
+ */
+static size_t fullWalk(PhoneForward const *pf, char const *num) {
+    Node const *node = pf->rootNode;
+    size_t steps = 0;
+
+    for (; node != NULL; num++) {
+        steps++;
+
+        if (*num == '\0') {
+            break;
+        }
+
+        node = node->children[toInt(*num)];
+    }
+
+    return steps;
+}
+
+/**
+ * @brief Wykonuje pomiar.
+ *
+ * Parametry: -n liczba przekierowań (z prefiksów od 3 do 7 cyfr na numery
+ * od 9 do 12 cyfr), -g liczba zapytań phfwdGet o numery od 12 do 15 cyfr
+ * przedłużające cele przekierowań, -s ziarno.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty.
+ * @return Kod zakończenia programu.
+ */
+int main(int argc, char *argv[]) {
+    size_t forwards = 300000;
+    size_t gets = 2000000;
+    size_t seed = 1;
+    BenchOption const options[] = {
+        {'n', &forwards, "number of forwards"},
+        {'g', &gets, "number of phfwdGet calls"},
+        {'s', &seed, "random seed"},
+    };
+
+    if (!benchParse(argc, argv, options, sizeof(options) / sizeof(*options))
+        || forwards == 0) {
+        return EXIT_FAILURE;
+    }
+
+    if (!phfwdTraceEnabled()) {
+        fprintf(stderr, "%s: built without PHFWD_TRACE\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    PhoneForward *pf = phfwdNew();
+    char (*targets)[BENCH_NUMBER_SIZE] = malloc(forwards * BENCH_NUMBER_SIZE);
+    if (pf == NULL || targets == NULL) {
+        phfwdDelete(pf);
+        free(targets);
+        return EXIT_FAILURE;
+    }
+
+    benchSeed(seed);
+
+    char num[BENCH_NUMBER_SIZE];
+    for (size_t i = 0; i < forwards; ++i) {
+        benchNumber(num, 3, 7);
+        benchNumber(targets[i], 9, 12);
+        phfwdAdd(pf, num, targets[i]);
+    }
+
+    // Czasy operacji nie są tu potrzebne, a liczniki nie są próbkowane.
+    phfwdTraceSetSampling(31);
+    phfwdTraceReset();
+
+    size_t full = 0;
+    double start = benchNow();
+    for (size_t i = 0; i < gets; ++i) {
+        size_t length = strlen(strcpy(num, targets[benchBelow(forwards)]));
+        size_t extra = (length < 12 ? 12 - length : 0) + benchBelow(4);
+
+        benchNumber(num + length, extra, extra);
+        phnumDelete(phfwdGet(pf, num));
+        full += fullWalk(pf, num);
+    }
+    double time = benchNow() - start;
+
+    uint64_t walks = phfwdTraceCounter(PHFWD_TRACE_WALKS);
+    uint64_t steps = phfwdTraceCounter(PHFWD_TRACE_WALK_STEPS);
+    printf("walks %llu, steps %.2f per walk, full walk %.2f per walk, "
+           "%.1f%% eliminated\n", (unsigned long long) walks,
+           walks > 0 ? (double) steps / walks : 0.0,
+           gets > 0 ? (double) full / gets : 0.0,
+           full > 0 ? 100.0 * (1.0 - (double) steps / full) : 0.0);
+    printf("get %.1f ns/op (including the full walk)\n",
+           gets > 0 ? time * 1e9 / gets : 0.0);
+
+    free(targets);
+    phfwdDelete(pf);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,82 @@
+#!/bin/sh
+# Skalowanie phone_forward_cdr z liczbą wątków.
+#
+# Generuje deterministyczny plik przekierowań i plik rekordów, a następnie
+# przepisuje rekordy z opcją -t 1..N i wypisuje przepustowość oraz
+# przyspieszenie względem jednego wątku. Wyniki wszystkich przebiegów
+# muszą być identyczne.
+#
+# Użycie: cdr_scaling.sh PROGRAM [MAKS_WĄTKÓW] [LICZBA_REKORDÓW] [POWTÓRZENIA]
+#
+# PROGRAM to ścieżka do phone_forward_cdr. Domyślnie N to liczba
+# procesorów, rekordów jest 2000000, a każdy pomiar to mediana
+# z 3 powtórzeń.
+
+set -eu
+
+if [ $# -lt 1 ]; then
+    echo "usage: $0 PHONE_FORWARD_CDR [MAX_THREADS] [RECORDS] [REPEATS]" >&2
+    exit 1
+fi
+
+program=$1
+maxThreads=${2:-$(getconf _NPROCESSORS_ONLN)}
+records=${3:-2000000}
+repeats=${4:-3}
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# 100000 przekierowań z prefiksów 4-7 cyfrowych na prefiksy 2-4 cyfrowe
+# zaczynające się od zera (więc różne od przekierowywanych).
+awk 'BEGIN {
+    srand(1);
+    for (i = 0; i < 100000; ++i) {
+        from = 1 + int(rand() * 9); to = "0";
+        for (j = 3 + int(rand() * 4); j > 0; --j) from = from int(rand() * 10);
+        for (j = 1 + int(rand() * 3); j > 0; --j) to = to int(rand() * 10);
+        print from " > " to;
+    }
+}' > "$work/forwards"
+
+# Rekordy CSV: identyfikator, numer, numer, czas trwania; przepisywane
+# jest pole 1.
+awk -v records="$records" 'BEGIN {
+    srand(2);
+    for (i = 0; i < records; ++i) {
+        caller = ""; callee = "";
+        for (j = 0; j < 10; ++j) caller = caller int(rand() * 10);
+        for (j = 0; j < 10; ++j) callee = callee int(rand() * 10);
+        print i "," caller "," callee "," int(rand() * 3600);
+    }
+}' > "$work/records"
+
+printf '%8s %10s %8s\n' threads MB/s speedup
+base=
+threads=1
+while [ "$threads" -le "$maxThreads" ]; do
+    rates=
+    repeat=0
+    while [ "$repeat" -lt "$repeats" ]; do
+        "$program" "$work/forwards" "$work/records" -t "$threads" -f 1 -s \
+            > "$work/out.$threads" 2> "$work/stats"
+        rate=$(sed -n 's/.*, \([0-9.]*\) MB\/s,.*/\1/p' "$work/stats")
+        rates="$rates $rate"
+        repeat=$((repeat + 1))
+    done
+
+    if [ "$threads" -gt 1 ]; then
+        cmp -s "$work/out.1" "$work/out.$threads" || {
+            echo "output with $threads threads differs" >&2
+            exit 1
+        }
+        rm -f "$work/out.$threads"
+    fi
+
+    rate=$(echo "$rates" | tr ' ' '\n' | sed '/^$/d' | sort -n \
+           | awk '{ r[NR] = $1 } END { print r[int((NR + 1) / 2)] }')
+    base=${base:-$rate}
+    printf '%8d %10.1f %8.2f\n' "$threads" "$rate" \
+        "$(awk -v r="$rate" -v b="$base" 'BEGIN { print r / b }')"
+    threads=$((threads + 1))
+done
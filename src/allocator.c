@@ -0,0 +1,519 @@
+/** @file allocator.c
+ * Implementacja wymiennych alokatorów pamięci.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "allocator.h"
+
+/// Rozmiar nagłówka bloku (zachowuje wyrównanie do 16 bajtów).
+#define HEADER_SIZE 16
+
+/// Domyślny rozmiar fragmentu areny.
+#define ARENA_DEFAULT_CHUNK (64 * 1024)
+
+/// Domyślny rozmiar bloku puli (wierzchołek oraz tablica jego dzieci).
+#define POOL_DEFAULT_BLOCK 112
+
+/// Liczba bloków przydzielanych naraz do puli.
+#define POOL_BLOCKS_PER_CHUNK 512
+
+/**
+ * @brief Zaokrągla rozmiar w górę do wielokrotności nagłówka.
+ *
+ * @param[in] size - rozmiar.
+ * @return Zaokrąglony rozmiar.
+ */
+static inline size_t alignUp(size_t size) {
+    return (size + HEADER_SIZE - 1) & ~((size_t) HEADER_SIZE - 1);
+}
+
+/**
+ * @brief Odczytuje rozmiar zapisany w nagłówku bloku.
+ *
+ * @param[in] ptr - blok.
+ * @return Rozmiar bloku podany przy alokacji.
+ */
+static inline size_t blockSizeOf(void *ptr) {
+    return *(size_t *) ((char *) ptr - HEADER_SIZE);
+}
+
+/**
+ * @brief Zapisuje rozmiar w nagłówku i zwraca wskaźnik na dane bloku.
+ *
+ * @param[in, out] raw - początek nagłówka;
+ * @param[in] size - rozmiar bloku.
+ * @return Wskaźnik na dane bloku.
+ */
+static inline void *blockInit(void *raw, size_t size) {
+    *(size_t *) raw = size;
+
+    return (char *) raw + HEADER_SIZE;
+}
+
+/**
+ * @brief Alokacja przez malloc (parametr @p ctx jest ignorowany).
+ *
+ * @param[in] ctx - nieużywany;
+ * @param[in] size - rozmiar w bajtach.
+ * @return Wskaźnik na pamięć lub NULL.
+ */
+static void *systemAlloc(void *ctx, size_t size) {
+    (void) ctx;
+
+    return malloc(size);
+}
+
+/**
+ * @brief Zmiana rozmiaru przez realloc (parametr @p ctx jest ignorowany).
+ *
+ * @param[in] ctx - nieużywany;
+ * @param[in] ptr - blok;
+ * @param[in] size - nowy rozmiar w bajtach.
+ * @return Wskaźnik na blok lub NULL.
+ */
+static void *systemRealloc(void *ctx, void *ptr, size_t size) {
+    (void) ctx;
+
+    return realloc(ptr, size);
+}
+
+/**
+ * @brief Zwolnienie przez free (parametr @p ctx jest ignorowany).
+ *
+ * @param[in] ctx - nieużywany;
+ * @param[in] ptr - blok.
+ */
+static void systemFree(void *ctx, void *ptr) {
+    (void) ctx;
+
+    free(ptr);
+}
+
+PhfwdAllocator const phfwdSystemAllocator = {
+    systemAlloc, systemRealloc, systemFree, NULL
+};
+
+extern void *memCalloc(PhfwdAllocator const *alloc, size_t count, size_t size) {
+    if (size != 0 && count > SIZE_MAX / size) {
+        return NULL;
+    }
+
+    void *ptr = memAlloc(alloc, count * size);
+    if (ptr != NULL) {
+        memset(ptr, 0, count * size);
+    }
+
+    return ptr;
+}
+
+/**
+ * @brief Fragment pamięci areny.
+ */
+typedef struct ArenaChunk {
+    /// Poprzedni fragment.
+    struct ArenaChunk *prev;
+    /// Pojemność fragmentu (bez tego nagłówka).
+    size_t capacity;
+    /// Liczba zajętych bajtów.
+    size_t used;
+} ArenaChunk;
+
+/**
+ * @brief Stan areny.
+ */
+typedef struct Arena {
+    /// Tablica funkcji udostępniana użytkownikowi (musi być pierwsza).
+    PhfwdAllocator allocator;
+    /// Bieżący (ostatni) fragment.
+    ArenaChunk *chunk;
+    /// Minimalny rozmiar nowego fragmentu.
+    size_t chunkSize;
+    /// Liczba bajtów przydzielonych od ostatniego wyczyszczenia.
+    size_t used;
+} Arena;
+
+/// Rozmiar nagłówka fragmentu areny (wyrównany).
+#define CHUNK_HEADER_SIZE alignUp(sizeof(ArenaChunk))
+
+/**
+ * @brief Zwraca początek danych fragmentu.
+ *
+ * @param[in] chunk - fragment.
+ * @return Wskaźnik na pierwszy bajt danych.
+ */
+static inline char *chunkData(ArenaChunk *chunk) {
+    return (char *) chunk + CHUNK_HEADER_SIZE;
+}
+
+/**
+ * @brief Sprawdza, czy blok leży na szczycie bieżącego fragmentu areny.
+ *
+ * @param[in] arena - arena;
+ * @param[in] ptr - blok.
+ * @return Wartość @p true jeśli za blokiem nie przydzielono nic więcej,
+ *         wartość @p false w przeciwnym wypadku.
+ */
+static inline bool arenaAtTop(Arena *arena, void *ptr) {
+    ArenaChunk *chunk = arena->chunk;
+
+    return chunk != NULL && (char *) ptr + alignUp(blockSizeOf(ptr)) ==
+                            chunkData(chunk) + chunk->used;
+}
+
+/**
+ * @brief Przydziela blok z bieżącego fragmentu areny (w razie potrzeby
+ * dokłada nowy fragment).
+ *
+ * @param[in, out] ctx - arena;
+ * @param[in] size - rozmiar w bajtach.
+ * @return Wskaźnik na blok lub NULL.
+ */
+static void *arenaAlloc(void *ctx, size_t size) {
+    Arena *arena = ctx;
+    size_t needed = HEADER_SIZE + alignUp(size);
+    if (needed < size) {
+        return NULL;
+    }
+
+    ArenaChunk *chunk = arena->chunk;
+    if (chunk == NULL || chunk->capacity - chunk->used < needed) {
+        size_t capacity = (needed > arena->chunkSize ?
+                           needed : arena->chunkSize);
+        ArenaChunk *fresh = malloc(CHUNK_HEADER_SIZE + capacity);
+        if (fresh == NULL) {
+            return NULL;
+        }
+
+        fresh->prev = chunk;
+        fresh->capacity = capacity;
+        fresh->used = 0;
+        arena->chunk = fresh;
+        chunk = fresh;
+    }
+
+    void *ptr = blockInit(chunkData(chunk) + chunk->used, size);
+    chunk->used += needed;
+    arena->used += needed;
+
+    return ptr;
+}
+
+/**
+ * @brief Zwalnia blok areny.
+ *
+ * @param[in, out] ctx - arena;
+ * @param[in] ptr - blok.
+ */
+static void arenaFree(void *ctx, void *ptr) {
+    Arena *arena = ctx;
+
+    // Oddać można tylko blok ze szczytu fragmentu; wyniki tymczasowe
+    // zwalniane są w kolejności odwrotnej do alokacji, więc w typowym
+    // przypadku cała zajęta przez nie pamięć wraca do areny.
+    if (ptr != NULL && arenaAtTop(arena, ptr)) {
+        size_t needed = HEADER_SIZE + alignUp(blockSizeOf(ptr));
+        arena->chunk->used -= needed;
+        arena->used -= needed;
+    }
+}
+
+/**
+ * @brief Zmienia rozmiar bloku areny (w miejscu, jeśli to możliwe).
+ *
+ * @param[in, out] ctx - arena;
+ * @param[in] ptr - blok;
+ * @param[in] size - nowy rozmiar w bajtach.
+ * @return Wskaźnik na blok lub NULL.
+ */
+static void *arenaRealloc(void *ctx, void *ptr, size_t size) {
+    Arena *arena = ctx;
+    if (ptr == NULL) {
+        return arenaAlloc(ctx, size);
+    }
+
+    size_t oldSize = blockSizeOf(ptr);
+
+    // Blok ze szczytu powiększamy w miejscu, jeśli zmieści się we fragmencie.
+    if (arenaAtTop(arena, ptr)) {
+        ArenaChunk *chunk = arena->chunk;
+        size_t oldNeeded = HEADER_SIZE + alignUp(oldSize);
+        size_t newNeeded = HEADER_SIZE + alignUp(size);
+
+        if (newNeeded >= size &&
+            chunk->capacity - (chunk->used - oldNeeded) >= newNeeded) {
+            chunk->used = chunk->used - oldNeeded + newNeeded;
+            arena->used = arena->used - oldNeeded + newNeeded;
+            blockInit((char *) ptr - HEADER_SIZE, size);
+
+            return ptr;
+        }
+    }
+
+    void *fresh = arenaAlloc(ctx, size);
+    if (fresh == NULL) {
+        return NULL;
+    }
+
+    memcpy(fresh, ptr, (oldSize < size ? oldSize : size));
+
+    return fresh;
+}
+
+extern PhfwdAllocator *phfwdArenaNew(size_t chunkSize) {
+    Arena *arena = malloc(sizeof(Arena));
+    if (arena == NULL) {
+        return NULL;
+    }
+
+    arena->allocator.alloc = arenaAlloc;
+    arena->allocator.realloc = arenaRealloc;
+    arena->allocator.free = arenaFree;
+    arena->allocator.ctx = arena;
+    arena->chunk = NULL;
+    arena->chunkSize = (chunkSize == 0 ? ARENA_DEFAULT_CHUNK : chunkSize);
+    arena->used = 0;
+
+    return &arena->allocator;
+}
+
+extern void phfwdArenaReset(PhfwdAllocator *arena) {
+    if (arena == NULL) {
+        return;
+    }
+
+    Arena *state = arena->ctx;
+    ArenaChunk *chunk = state->chunk;
+
+    // Zachowujemy najstarszy fragment, pozostałe oddajemy systemowi.
+    while (chunk != NULL && chunk->prev != NULL) {
+        ArenaChunk *prev = chunk->prev;
+        free(chunk);
+        chunk = prev;
+    }
+
+    if (chunk != NULL) {
+        chunk->used = 0;
+    }
+
+    state->chunk = chunk;
+    state->used = 0;
+}
+
+extern size_t phfwdArenaUsed(PhfwdAllocator const *arena) {
+    if (arena == NULL) {
+        return 0;
+    }
+
+    return ((Arena const *) arena->ctx)->used;
+}
+
+extern void phfwdArenaDelete(PhfwdAllocator *arena) {
+    if (arena == NULL) {
+        return;
+    }
+
+    Arena *state = arena->ctx;
+    ArenaChunk *chunk = state->chunk;
+    while (chunk != NULL) {
+        ArenaChunk *prev = chunk->prev;
+        free(chunk);
+        chunk = prev;
+    }
+
+    free(state);
+}
+
+/**
+ * @brief Wolny blok puli (lista jednokierunkowa wewnątrz wolnych bloków).
+ */
+typedef struct PoolBlock {
+    /// Następny wolny blok.
+    struct PoolBlock *next;
+} PoolBlock;
+
+/**
+ * @brief Fragment pamięci puli.
+ */
+typedef struct PoolChunk {
+    /// Poprzedni fragment.
+    struct PoolChunk *prev;
+} PoolChunk;
+
+/**
+ * @brief Stan puli.
+ */
+typedef struct Pool {
+    /// Tablica funkcji udostępniana użytkownikowi (musi być pierwsza).
+    PhfwdAllocator allocator;
+    /// Rozmiar danych bloku.
+    size_t blockSize;
+    /// Lista wolnych bloków (wskaźniki na nagłówki).
+    PoolBlock *freeList;
+    /// Lista fragmentów.
+    PoolChunk *chunks;
+} Pool;
+
+/**
+ * @brief Uzupełnia listę wolnych bloków nowym fragmentem.
+ *
+ * @param[in, out] pool - pula.
+ * @return Wartość @p true jeśli udało się alokować pamięć,
+ *         wartość @p false w przeciwnym wypadku.
+ */
+static bool poolRefill(Pool *pool) {
+    size_t stride = HEADER_SIZE + pool->blockSize;
+    size_t chunkHeader = alignUp(sizeof(PoolChunk));
+    PoolChunk *chunk = malloc(chunkHeader + stride * POOL_BLOCKS_PER_CHUNK);
+    if (chunk == NULL) {
+        return false;
+    }
+
+    chunk->prev = pool->chunks;
+    pool->chunks = chunk;
+
+    char *data = (char *) chunk + chunkHeader;
+    for (size_t i = POOL_BLOCKS_PER_CHUNK; i > 0; --i) {
+        PoolBlock *block = (PoolBlock *) (data + (i - 1) * stride);
+        block->next = pool->freeList;
+        pool->freeList = block;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Przydziela blok z puli (lub z malloc dla dużych żądań).
+ *
+ * @param[in, out] ctx - pula;
+ * @param[in] size - rozmiar w bajtach.
+ * @return Wskaźnik na blok lub NULL.
+ */
+static void *poolAlloc(void *ctx, size_t size) {
+    Pool *pool = ctx;
+
+    // Duże bloki obsługuje malloc; rozmiar w nagłówku pozwala je odróżnić.
+    if (size > pool->blockSize) {
+        if (size + HEADER_SIZE < size) {
+            return NULL;
+        }
+
+        void *raw = malloc(HEADER_SIZE + size);
+
+        return (raw == NULL ? NULL : blockInit(raw, size));
+    }
+
+    if (pool->freeList == NULL && !poolRefill(pool)) {
+        return NULL;
+    }
+
+    PoolBlock *block = pool->freeList;
+    pool->freeList = block->next;
+
+    return blockInit(block, size);
+}
+
+/**
+ * @brief Zwraca blok do puli (lub do systemu dla dużych bloków).
+ *
+ * @param[in, out] ctx - pula;
+ * @param[in] ptr - blok.
+ */
+static void poolFree(void *ctx, void *ptr) {
+    Pool *pool = ctx;
+    if (ptr == NULL) {
+        return;
+    }
+
+    void *raw = (char *) ptr - HEADER_SIZE;
+    if (blockSizeOf(ptr) > pool->blockSize) {
+        free(raw);
+        return;
+    }
+
+    PoolBlock *block = raw;
+    block->next = pool->freeList;
+    pool->freeList = block;
+}
+
+/**
+ * @brief Zmienia rozmiar bloku puli.
+ *
+ * @param[in, out] ctx - pula;
+ * @param[in] ptr - blok;
+ * @param[in] size - nowy rozmiar w bajtach.
+ * @return Wskaźnik na blok lub NULL.
+ */
+static void *poolRealloc(void *ctx, void *ptr, size_t size) {
+    Pool *pool = ctx;
+    if (ptr == NULL) {
+        return poolAlloc(ctx, size);
+    }
+
+    size_t oldSize = blockSizeOf(ptr);
+
+    // Blok puli mieści każdy rozmiar nie większy niż blockSize.
+    if (oldSize <= pool->blockSize && size <= pool->blockSize) {
+        blockInit((char *) ptr - HEADER_SIZE, size);
+        return ptr;
+    }
+
+    if (oldSize > pool->blockSize && size > pool->blockSize) {
+        if (size + HEADER_SIZE < size) {
+            return NULL;
+        }
+
+        void *raw = realloc((char *) ptr - HEADER_SIZE, HEADER_SIZE + size);
+
+        return (raw == NULL ? NULL : blockInit(raw, size));
+    }
+
+    void *fresh = poolAlloc(ctx, size);
+    if (fresh == NULL) {
+        return NULL;
+    }
+
+    memcpy(fresh, ptr, (oldSize < size ? oldSize : size));
+    poolFree(ctx, ptr);
+
+    return fresh;
+}
+
+extern PhfwdAllocator *phfwdPoolNew(size_t blockSize) {
+    Pool *pool = malloc(sizeof(Pool));
+    if (pool == NULL) {
+        return NULL;
+    }
+
+    pool->allocator.alloc = poolAlloc;
+    pool->allocator.realloc = poolRealloc;
+    pool->allocator.free = poolFree;
+    pool->allocator.ctx = pool;
+    pool->blockSize = alignUp(blockSize == 0 ? POOL_DEFAULT_BLOCK : blockSize);
+    pool->freeList = NULL;
+    pool->chunks = NULL;
+
+    return &pool->allocator;
+}
+
+extern void phfwdPoolDelete(PhfwdAllocator *pool) {
+    if (pool == NULL) {
+        return;
+    }
+
+    Pool *state = pool->ctx;
+    PoolChunk *chunk = state->chunks;
+    while (chunk != NULL) {
+        PoolChunk *prev = chunk->prev;
+        free(chunk);
+        chunk = prev;
+    }
+
+    free(state);
+}
@@ -0,0 +1,169 @@
+/** @file allocator.h
+ * Interfejs wymiennych alokatorów pamięci.
+ *
+ * Każda struktura PhoneForward korzysta z jednego alokatora, przez który
+ * przechodzą wszystkie jej alokacje: wierzchołki, zbiory przekierowań wstecz,
+ * kursory oraz zwracane struktury PhoneNumbers wraz z napisami.
+ * Alokator musi istnieć co najmniej tak długo, jak struktura
+ * i wszystkie zwrócone przez nią wyniki.
+ *
+ * Poza alokatorem systemowym dostępne są dwie gotowe implementacje:
+ * arena (alokacja przez przesunięcie wskaźnika, zwalnianie całości naraz)
+ * oraz pula bloków o stałym rozmiarze. Żadna z nich nie jest bezpieczna
+ * wielowątkowo.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __ALLOCATOR_H__
+#define __ALLOCATOR_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "phone_forward.h"
+
+/**
+ * @brief Tablica funkcji alokatora.
+ *
+ * Funkcje mają semantykę odpowiednio malloc, realloc i free;
+ * pierwszym argumentem każdej z nich jest pole @p ctx.
+ */
+typedef struct PhfwdAllocator {
+    /// Alokuje @p size bajtów; zwraca NULL przy braku pamięci.
+    void *(*alloc)(void *ctx, size_t size);
+    /// Zmienia rozmiar bloku; przy niepowodzeniu zwraca NULL
+    /// i pozostawia oryginalny blok nienaruszony.
+    void *(*realloc)(void *ctx, void *ptr, size_t size);
+    /// Zwalnia blok (nic nie robi dla NULL).
+    void (*free)(void *ctx, void *ptr);
+    /// Stan alokatora przekazywany do powyższych funkcji.
+    void *ctx;
+} PhfwdAllocator;
+
+/**
+ * Alokator korzystający bezpośrednio z malloc, realloc i free.
+ */
+extern PhfwdAllocator const phfwdSystemAllocator;
+
+/** @brief Tworzy nową strukturę korzystającą z podanego alokatora.
+ * Tworzy nową strukturę niezawierającą żadnych przekierowań. Wszystkie
+ * alokacje struktury, również zwracanych przez nią ciągów numerów
+ * @p PhoneNumbers, przechodzą przez @p alloc, który musi istnieć dopóki
+ * istnieje struktura lub którykolwiek z jej wyników.
+ * @param[in] alloc – wskaźnik na alokator.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
+ *         alokować pamięci lub @p alloc ma wartość NULL.
+ */
+PhoneForward * phfwdNewWithAllocator(PhfwdAllocator const *alloc);
+
+/**
+ * @brief Alokuje pamięć za pomocą alokatora.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in] size - rozmiar w bajtach.
+ * @return Wskaźnik na pamięć lub NULL, gdy nie udało się jej alokować.
+ */
+static inline void *memAlloc(PhfwdAllocator const *alloc, size_t size) {
+    return alloc->alloc(alloc->ctx, size);
+}
+
+/**
+ * @brief Alokuje wyzerowaną tablicę za pomocą alokatora.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in] count - liczba elementów;
+ * @param[in] size - rozmiar jednego elementu.
+ * @return Wskaźnik na pamięć lub NULL, gdy nie udało się jej alokować.
+ */
+void *memCalloc(PhfwdAllocator const *alloc, size_t count, size_t size);
+
+/**
+ * @brief Zmienia rozmiar bloku pamięci za pomocą alokatora.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in] ptr - blok (lub NULL);
+ * @param[in] size - nowy rozmiar w bajtach.
+ * @return Wskaźnik na blok lub NULL, gdy nie udało się alokować pamięci
+ *         (oryginalny blok pozostaje wtedy ważny).
+ */
+static inline void *memRealloc(PhfwdAllocator const *alloc,
+                               void *ptr, size_t size) {
+    return alloc->realloc(alloc->ctx, ptr, size);
+}
+
+/**
+ * @brief Zwalnia pamięć za pomocą alokatora.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in] ptr - zwalniany blok (lub NULL).
+ */
+static inline void memFree(PhfwdAllocator const *alloc, void *ptr) {
+    alloc->free(alloc->ctx, ptr);
+}
+
+/**
+ * @brief Tworzy arenę.
+ *
+ * Pamięć jest przydzielana z kolejnych fragmentów o rozmiarze co najmniej
+ * @p chunkSize przez przesunięcie wskaźnika. Zwalnianie pojedynczych bloków
+ * oddaje pamięć tylko wtedy, gdy blok leży na szczycie areny (zwalnianie
+ * w kolejności odwrotnej do alokacji odzyskuje więc całą pamięć);
+ * całą pamięć oddaje @ref phfwdArenaReset lub @ref phfwdArenaDelete.
+ *
+ * @param[in] chunkSize - rozmiar fragmentu (0 oznacza rozmiar domyślny).
+ * @return Wskaźnik na alokator lub NULL, gdy nie udało się alokować pamięci.
+ */
+PhfwdAllocator *phfwdArenaNew(size_t chunkSize);
+
+/**
+ * @brief Unieważnia wszystkie bloki areny, zachowując jej pierwszy fragment.
+ *
+ * Wszystkie struktury korzystające z areny muszą zostać wcześniej porzucone.
+ *
+ * @param[in, out] arena - alokator utworzony przez @ref phfwdArenaNew.
+ */
+void phfwdArenaReset(PhfwdAllocator *arena);
+
+/**
+ * @brief Zwraca liczbę bajtów przydzielonych z areny od jej wyczyszczenia.
+ *
+ * @param[in] arena - alokator utworzony przez @ref phfwdArenaNew.
+ * @return Liczba bajtów (łącznie z nagłówkami bloków).
+ */
+size_t phfwdArenaUsed(PhfwdAllocator const *arena);
+
+/**
+ * @brief Usuwa arenę wraz z całą przydzieloną z niej pamięcią.
+ *
+ * @param[in] arena - alokator utworzony przez @ref phfwdArenaNew
+ *                    (lub NULL).
+ */
+void phfwdArenaDelete(PhfwdAllocator *arena);
+
+/**
+ * @brief Tworzy pulę bloków o stałym rozmiarze.
+ *
+ * Żądania nie większe niż @p blockSize są obsługiwane z listy wolnych
+ * bloków (uzupełnianej całymi fragmentami), większe przekazywane są
+ * do malloc. Zwolnione bloki wracają do puli i są ponownie używane.
+ *
+ * @param[in] blockSize - rozmiar bloku w bajtach (0 oznacza rozmiar
+ *                        domyślny, wystarczający dla wierzchołka drzewa).
+ * @return Wskaźnik na alokator lub NULL, gdy nie udało się alokować pamięci.
+ */
+PhfwdAllocator *phfwdPoolNew(size_t blockSize);
+
+/**
+ * @brief Usuwa pulę wraz ze wszystkimi jej fragmentami.
+ *
+ * Bloki większe niż rozmiar bloku puli pochodzą z malloc i muszą zostać
+ * zwolnione wcześniej (robi to między innymi @ref phfwdDelete).
+ *
+ * @param[in] pool - alokator utworzony przez @ref phfwdPoolNew (lub NULL).
+ */
+void phfwdPoolDelete(PhfwdAllocator *pool);
+
+#endif /* __ALLOCATOR_H__ */
@@ -0,0 +1,388 @@
+/** @file cache.c
+ * Implementacja pamięci podręcznej wyników funkcji phfwdGet.
+ *
+ * Pamięć podręczna jest czterodrożna i zbiorowo-skojarzeniowa: numer
+ * trafia do zbioru wyznaczonego funkcją haszującą, a w obrębie zbioru
+ * usuwany jest najdawniej używany z czterech wpisów. Zbiór zajmuje dwie
+ * linie pamięci podręcznej procesora, więc trafienie nie dotyka żadnych
+ * innych miejsc w pamięci.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cache.h"
+#include "utils.h"
+
+/// Liczba wpisów w jednym zbiorze.
+#define CACHE_WAYS 4
+
+/// Liczba muteksów (każdy chroni co szesnasty zbiór).
+#define CACHE_SHARDS 16
+
+/// Liczba poziomów liczników generacji (długości prefiksów 1, 2 i 3).
+#define CACHE_GEN_LEVELS 3
+
+/// Łączna liczba liczników generacji (12 + 12^2 + 12^3).
+#define CACHE_GENS (12 + 144 + 1728)
+
+/// Spakowany pusty napis - oznaczenie wolnego wpisu.
+#define CACHE_EMPTY UINT64_MAX
+
+/// Wyrównanie zbiorów (rozmiar linii pamięci podręcznej procesora).
+#define CACHE_LINE 64
+
+/**
+ * @brief Zbiór czterech wpisów.
+ *
+ * Numery i wyniki zapisane są po cztery bity na cyfrę, a nieużywane
+ * cyfry wypełnione są wartością 15, więc długość jest częścią zapisu.
+ */
+typedef struct CacheSet {
+    /// Spakowane numery.
+    uint64_t keys[CACHE_WAYS];
+    /// Spakowane wyniki.
+    uint64_t values[CACHE_WAYS];
+    /// Sumy liczników generacji prefiksów numerów z chwili zapisania.
+    uint32_t stamps[CACHE_WAYS];
+    /// Liczba późniejszych użyć innych wpisów zbioru (wiek wpisu).
+    uint8_t ages[CACHE_WAYS];
+    /// Dopełnienie do dwóch linii pamięci podręcznej procesora.
+    uint8_t padding[2 * CACHE_LINE - CACHE_WAYS * 21];
+} CacheSet;
+
+/**
+ * @brief Muteks wraz ze statystykami chronionych przez niego zbiorów.
+ */
+typedef struct CacheShard {
+    /// Muteks.
+    pthread_mutex_t lock;
+    /// Liczba trafień.
+    uint64_t hits;
+    /// Liczba chybień (łącznie z nieaktualnymi wpisami).
+    uint64_t misses;
+    /// Liczba znalezionych, ale nieaktualnych wpisów.
+    uint64_t stale;
+    /// Liczba wpisów usuniętych z braku miejsca.
+    uint64_t evictions;
+    /// Liczba zajętych wpisów.
+    size_t entries;
+} CacheShard;
+
+/**
+ * Pamięć podręczna wyników phfwdGet.
+ */
+struct PhfwdCache {
+    /// Alokator pamięci podręcznej.
+    PhfwdAllocator const *alloc;
+    /// Zaalokowany blok pamięci zbiorów (przed wyrównaniem).
+    void *memory;
+    /// Zbiory wpisów.
+    CacheSet *sets;
+    /// Maska wyznaczająca zbiór z wartości funkcji haszującej.
+    size_t setMask;
+    /// Muteksy i statystyki.
+    CacheShard shards[CACHE_SHARDS];
+    /// Liczniki generacji prefiksów długości 1, 2 i 3 (kolejno).
+    uint32_t gens[CACHE_GENS];
+};
+
+/**
+ * @brief Pakuje numer po cztery bity na cyfrę.
+ *
+ * @param[in] num - numer;
+ * @param[in] length - długość numeru (co najwyżej @ref CACHE_MAX_DIGITS).
+ * @return Spakowany numer.
+ */
+static uint64_t cachePack(char const *num, size_t length) {
+    uint64_t packed = CACHE_EMPTY;
+
+    for (size_t i = 0; i < length; ++i) {
+        packed &= ~((uint64_t) 15 << (4 * i));
+        packed |= (uint64_t) toInt(num[i]) << (4 * i);
+    }
+
+    return packed;
+}
+
+/**
+ * @brief Rozpakowuje numer.
+ *
+ * @param[in] packed - spakowany numer;
+ * @param[out] num - bufor na numer zakończony znakiem '\0'.
+ */
+static void cacheUnpack(uint64_t packed, char *num) {
+    size_t length = 0;
+
+    while (length < CACHE_MAX_DIGITS && (packed & 15) != 15) {
+        num[length++] = toChar(packed & 15);
+        packed >>= 4;
+    }
+
+    num[length] = '\0';
+}
+
+/**
+ * @brief Funkcja haszująca spakowanego numeru.
+ *
+ * @param[in] key - spakowany numer.
+ * @return Wartość funkcji haszującej.
+ */
+static uint64_t cacheHash(uint64_t key) {
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ull;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebull;
+    key ^= key >> 31;
+
+    return key;
+}
+
+/**
+ * @brief Wyznacza sumę liczników generacji prefiksów numeru.
+ *
+ * Liczniki tylko rosną, więc każda modyfikacja prefiksu numeru zmienia
+ * sumę (z dokładnością do przepełnienia po @f$2^{32}@f$ modyfikacjach).
+ *
+ * @param[in] cache - pamięć podręczna;
+ * @param[in] num - numer;
+ * @param[in] length - długość numeru.
+ * @return Suma liczników.
+ */
+static uint32_t cacheStamp(PhfwdCache const *cache, char const *num,
+                           size_t length) {
+    static size_t const offsets[CACHE_GEN_LEVELS] = {0, 12, 12 + 144};
+    uint32_t stamp = 0;
+    size_t index = 0;
+
+    for (size_t level = 0; level < CACHE_GEN_LEVELS && level < length;
+         ++level) {
+        index = index * 12 + toInt(num[level]);
+        stamp += cache->gens[offsets[level] + index];
+    }
+
+    return stamp;
+}
+
+/**
+ * @brief Oznacza wpis zbioru jako ostatnio używany.
+ *
+ * @param[in, out] set - zbiór;
+ * @param[in] way - indeks wpisu w zbiorze.
+ */
+static void cacheTouch(CacheSet *set, size_t way) {
+    for (size_t i = 0; i < CACHE_WAYS; ++i) {
+        if (set->ages[i] < UINT8_MAX) {
+            set->ages[i]++;
+        }
+    }
+
+    set->ages[way] = 0;
+}
+
+/*
+ * Zbiory alokujemy z zapasem, aby wyrównać je do linii pamięci podręcznej
+ * procesora niezależnie od alokatora.
+ */
+extern PhfwdCache *cacheNew(PhfwdAllocator const *alloc, size_t capacity) {
+    if (capacity == 0 || capacity > SIZE_MAX / 2 / sizeof(CacheSet)) {
+        return NULL;
+    }
+
+    size_t sets = CACHE_SHARDS;
+    while (sets * CACHE_WAYS < capacity) {
+        sets *= 2;
+    }
+
+    PhfwdCache *cache = memAlloc(alloc, sizeof(PhfwdCache));
+    if (cache == NULL) {
+        return NULL;
+    }
+
+    cache->memory = memAlloc(alloc, sets * sizeof(CacheSet) + CACHE_LINE);
+    if (cache->memory == NULL) {
+        memFree(alloc, cache);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < CACHE_SHARDS; ++i) {
+        if (pthread_mutex_init(&cache->shards[i].lock, NULL) != 0) {
+            while (i-- > 0) {
+                pthread_mutex_destroy(&cache->shards[i].lock);
+            }
+
+            memFree(alloc, cache->memory);
+            memFree(alloc, cache);
+            return NULL;
+        }
+
+        cache->shards[i].hits = 0;
+        cache->shards[i].misses = 0;
+        cache->shards[i].stale = 0;
+        cache->shards[i].evictions = 0;
+        cache->shards[i].entries = 0;
+    }
+
+    uintptr_t address = (uintptr_t) cache->memory;
+    address = (address + CACHE_LINE - 1) & ~(uintptr_t) (CACHE_LINE - 1);
+
+    cache->alloc = alloc;
+    cache->sets = (CacheSet *) address;
+    cache->setMask = sets - 1;
+    memset(cache->gens, 0, sizeof(cache->gens));
+
+    for (size_t i = 0; i < sets; ++i) {
+        for (size_t way = 0; way < CACHE_WAYS; ++way) {
+            cache->sets[i].keys[way] = CACHE_EMPTY;
+            cache->sets[i].ages[way] = UINT8_MAX;
+        }
+    }
+
+    return cache;
+}
+
+extern void cacheDelete(PhfwdCache *cache) {
+    if (cache == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < CACHE_SHARDS; ++i) {
+        pthread_mutex_destroy(&cache->shards[i].lock);
+    }
+
+    memFree(cache->alloc, cache->memory);
+    memFree(cache->alloc, cache);
+}
+
+extern bool cacheLookup(PhfwdCache *cache, char const *num, size_t length,
+                        char *result) {
+    if (length > CACHE_MAX_DIGITS) {
+        return false;
+    }
+
+    uint64_t key = cachePack(num, length);
+    size_t setIndex = cacheHash(key) & cache->setMask;
+    CacheSet *set = &cache->sets[setIndex];
+    CacheShard *shard = &cache->shards[setIndex % CACHE_SHARDS];
+    uint32_t stamp = cacheStamp(cache, num, length);
+    bool found = false;
+
+    pthread_mutex_lock(&shard->lock);
+
+    for (size_t way = 0; way < CACHE_WAYS; ++way) {
+        if (set->keys[way] != key) {
+            continue;
+        }
+
+        if (set->stamps[way] == stamp) {
+            cacheUnpack(set->values[way], result);
+            cacheTouch(set, way);
+            found = true;
+        }
+        else {
+            shard->stale++;
+        }
+
+        break;
+    }
+
+    if (found) {
+        shard->hits++;
+    }
+    else {
+        shard->misses++;
+    }
+
+    pthread_mutex_unlock(&shard->lock);
+
+    return found;
+}
+
+/*
+ * Wpis o tym samym numerze jest nadpisywany; w przeciwnym wypadku
+ * zajmowany jest najstarszy wpis zbioru (wolne wpisy mają wiek maksymalny).
+ */
+extern void cacheStore(PhfwdCache *cache, char const *num, size_t length,
+                       char const *result, size_t resultLength) {
+    if (length > CACHE_MAX_DIGITS || resultLength > CACHE_MAX_DIGITS) {
+        return;
+    }
+
+    uint64_t key = cachePack(num, length);
+    size_t setIndex = cacheHash(key) & cache->setMask;
+    CacheSet *set = &cache->sets[setIndex];
+    CacheShard *shard = &cache->shards[setIndex % CACHE_SHARDS];
+    uint32_t stamp = cacheStamp(cache, num, length);
+
+    pthread_mutex_lock(&shard->lock);
+
+    size_t victim = 0;
+    for (size_t way = 0; way < CACHE_WAYS; ++way) {
+        if (set->keys[way] == key) {
+            victim = way;
+            break;
+        }
+
+        if (set->ages[way] > set->ages[victim]) {
+            victim = way;
+        }
+    }
+
+    if (set->keys[victim] == CACHE_EMPTY) {
+        shard->entries++;
+    }
+    else if (set->keys[victim] != key) {
+        shard->evictions++;
+    }
+
+    set->keys[victim] = key;
+    set->values[victim] = cachePack(result, resultLength);
+    set->stamps[victim] = stamp;
+    cacheTouch(set, victim);
+
+    pthread_mutex_unlock(&shard->lock);
+}
+
+/*
+ * Licznik prefiksu długości co najwyżej 3 odpowiada dokładnie
+ * modyfikowanemu prefiksowi; dłuższe prefiksy unieważniają wszystkie
+ * numery o tych samych trzech pierwszych cyfrach.
+ */
+extern void cacheInvalidate(PhfwdCache *cache, char const *num,
+                            size_t length) {
+    static size_t const offsets[CACHE_GEN_LEVELS] = {0, 12, 12 + 144};
+    size_t level = min(length, CACHE_GEN_LEVELS);
+    size_t index = 0;
+
+    if (level == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < level; ++i) {
+        index = index * 12 + toInt(num[i]);
+    }
+
+    cache->gens[offsets[level - 1] + index]++;
+}
+
+extern void cacheStats(PhfwdCache *cache, PhfwdCacheStats *stats) {
+    memset(stats, 0, sizeof(PhfwdCacheStats));
+    stats->capacity = (cache->setMask + 1) * CACHE_WAYS;
+
+    for (size_t i = 0; i < CACHE_SHARDS; ++i) {
+        CacheShard *shard = &cache->shards[i];
+
+        pthread_mutex_lock(&shard->lock);
+        stats->hits += shard->hits;
+        stats->misses += shard->misses;
+        stats->stale += shard->stale;
+        stats->evictions += shard->evictions;
+        stats->entries += shard->entries;
+        pthread_mutex_unlock(&shard->lock);
+    }
+}
@@ -0,0 +1,111 @@
+/** @file cache.h
+ * Interfejs pamięci podręcznej wyników funkcji phfwdGet.
+ *
+ * Pamięć podręczna ma ograniczony rozmiar ustalany przy jej tworzeniu
+ * i jest podzielona na niezależne części (każda z własnym muteksem),
+ * dzięki czemu może być używana przez wiele wątków wywołujących
+ * równocześnie phfwdGet. Przechowywane są jedynie numery i wyniki
+ * nie dłuższe niż @ref CACHE_MAX_DIGITS cyfr, zapisane po cztery bity
+ * na cyfrę.
+ *
+ * Wpisy unieważniane są licznikami generacji prefiksów długości 1, 2 i 3:
+ * modyfikacja przekierowań z prefiksu @p p zwiększa licznik prefiksu @p p
+ * (lub, dla dłuższych @p p, jego trzycyfrowego prefiksu), a wpis jest
+ * ważny, dopóki liczniki prefiksów jego numeru się nie zmieniły. Modyfikacje
+ * nie przeglądają więc zawartości pamięci podręcznej.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __CACHE_H__
+#define __CACHE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "phone_forward.h"
+#include "phone_forward_tuning.h"
+#include "allocator.h"
+
+/**
+ * Największa długość numeru (i wyniku) przechowywanego w pamięci podręcznej.
+ */
+#define CACHE_MAX_DIGITS 16
+
+struct PhfwdCache;
+/**
+ * Definiuje pamięć podręczną wyników phfwdGet.
+ */
+typedef struct PhfwdCache PhfwdCache;
+
+/**
+ * @brief Tworzy pustą pamięć podręczną.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in] capacity - największa liczba przechowywanych wyników.
+ * @return Wskaźnik na pamięć podręczną lub NULL, gdy nie udało się
+ *         alokować pamięci.
+ */
+PhfwdCache *cacheNew(PhfwdAllocator const *alloc, size_t capacity);
+
+/**
+ * @brief Usuwa pamięć podręczną.
+ *
+ * @param[in] cache - usuwana pamięć podręczna (lub NULL).
+ */
+void cacheDelete(PhfwdCache *cache);
+
+/**
+ * @brief Wyszukuje wynik phfwdGet dla numeru.
+ *
+ * @param[in, out] cache - pamięć podręczna;
+ * @param[in] num - numer;
+ * @param[in] length - długość numeru;
+ * @param[out] result - bufor na wynik (co najmniej
+ *                      @ref CACHE_MAX_DIGITS + 1 znaków).
+ * @return Wartość @p true jeśli znaleziono aktualny wynik (zapisany
+ *         w @p result i zakończony znakiem '\0'),
+ *         wartość @p false w przeciwnym wypadku.
+ */
+bool cacheLookup(PhfwdCache *cache, char const *num, size_t length,
+                 char *result);
+
+/**
+ * @brief Zapamiętuje wynik phfwdGet dla numeru.
+ *
+ * Numery lub wyniki dłuższe niż @ref CACHE_MAX_DIGITS są pomijane.
+ * Przy braku miejsca usuwany jest najdawniej używany wpis spośród
+ * wpisów, które mogą przechowywać dany numer.
+ *
+ * @param[in, out] cache - pamięć podręczna;
+ * @param[in] num - numer;
+ * @param[in] length - długość numeru;
+ * @param[in] result - wynik phfwdGet;
+ * @param[in] resultLength - długość wyniku.
+ */
+void cacheStore(PhfwdCache *cache, char const *num, size_t length,
+                char const *result, size_t resultLength);
+
+/**
+ * @brief Unieważnia wyniki numerów o danym prefiksie.
+ *
+ * Wywoływana przy każdej modyfikacji przekierowań z prefiksu @p num.
+ * Nie może być wykonywana równocześnie z innymi operacjami.
+ *
+ * @param[in, out] cache - pamięć podręczna;
+ * @param[in] num - prefiks, którego przekierowania się zmieniły;
+ * @param[in] length - długość prefiksu.
+ */
+void cacheInvalidate(PhfwdCache *cache, char const *num, size_t length);
+
+/**
+ * @brief Zwraca statystyki pamięci podręcznej.
+ *
+ * @param[in] cache - pamięć podręczna;
+ * @param[out] stats - statystyki.
+ */
+void cacheStats(PhfwdCache *cache, PhfwdCacheStats *stats);
+
+#endif /* __CACHE_H__ */
@@ -0,0 +1,536 @@
+/** @file changelog.c
+ * Implementacja dziennika modyfikacji oraz eksportu i odtwarzania zmian.
+ *
+ * Wpis dziennika to rekord w postaci opisanej przy @ref phfwdChangesSince,
+ * po którym następują cztery bajty z długością rekordu. Dzięki nim dziennik
+ * można przeglądać od najnowszego wpisu wstecz, więc wyszukanie pierwszej
+ * modyfikacji po zadanym czasie zależy jedynie od liczby późniejszych
+ * modyfikacji. Wpisy zajmują spójny fragment bufora; gdy na końcu bufora
+ * brakuje miejsca, najstarsze wpisy są usuwane, dopóki zajęte nie będą
+ * najwyżej trzy czwarte bufora, a pozostałe przesuwane na jego początek.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "phone_forward_changelog.h"
+#include "changelog.h"
+#include "expiry.h"
+#include "node.h"
+#include "utils.h"
+
+/// Oznaczenie rekordu dodania przekierowania.
+#define CHANGE_ADD 1
+
+/// Oznaczenie rekordu wyczyszczenia poddrzewa.
+#define CHANGE_REMOVE 2
+
+/// Oznaczenie rekordu wygaśnięcia przekierowania.
+#define CHANGE_EXPIRE 3
+
+/// Rozmiar długości rekordu zapisanej za nim w dzienniku.
+#define CHANGE_TRAILER 4
+
+/**
+ * Dziennik modyfikacji.
+ */
+struct ChangeLog {
+    /// Alokator dziennika.
+    PhfwdAllocator const *alloc;
+    /// Bufor wpisów.
+    uint8_t *bytes;
+    /// Rozmiar bufora.
+    size_t capacity;
+    /// Początek najstarszego wpisu.
+    size_t start;
+    /// Koniec najnowszego wpisu.
+    size_t end;
+    /// Dziennik zawiera wszystkie modyfikacje późniejsze niż ten czas.
+    size_t coveredFrom;
+};
+
+/**
+ * @brief Wyznacza liczbę bajtów liczby zapisanej po siedem bitów na bajt.
+ *
+ * @param[in] value - liczba.
+ * @return Liczba bajtów.
+ */
+static size_t varintSize(uint64_t value) {
+    size_t size = 1;
+
+    while (value >= 128) {
+        value >>= 7;
+        size++;
+    }
+
+    return size;
+}
+
+/**
+ * @brief Zapisuje liczbę po siedem bitów na bajt, od najmłodszych bitów;
+ * najstarszy bit bajtu oznacza, że liczba ma kolejne bajty.
+ *
+ * @param[out] out - bufor;
+ * @param[in] value - liczba.
+ * @return Liczba zapisanych bajtów.
+ */
+static size_t varintWrite(uint8_t *out, uint64_t value) {
+    size_t size = 0;
+
+    while (value >= 128) {
+        out[size++] = (uint8_t) (value | 128);
+        value >>= 7;
+    }
+
+    out[size++] = (uint8_t) value;
+
+    return size;
+}
+
+/**
+ * @brief Odczytuje liczbę zapisaną funkcją @ref varintWrite.
+ *
+ * @param[in] data - bufor;
+ * @param[in] size - rozmiar bufora;
+ * @param[in, out] position - pozycja odczytu;
+ * @param[out] value - odczytana liczba.
+ * @return Wartość @p true jeśli odczyt się powiódł,
+ *         wartość @p false jeśli dane są niepoprawne.
+ */
+static bool varintRead(uint8_t const *data, size_t size, size_t *position,
+                       uint64_t *value) {
+    *value = 0;
+
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (*position >= size) {
+            return false;
+        }
+
+        uint8_t byte = data[(*position)++];
+        *value |= (uint64_t) (byte & 127) << shift;
+
+        if (byte < 128) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Wyznacza rozmiar zapisu numeru (długość i cyfry po dwie na bajt).
+ *
+ * @param[in] length - długość numeru.
+ * @return Rozmiar zapisu.
+ */
+static size_t numberSize(size_t length) {
+    return varintSize(length) + (length + 1) / 2;
+}
+
+/**
+ * @brief Zapisuje numer: długość, a następnie cyfry po dwie na bajt
+ * (pierwsza na młodszych czterech bitach).
+ *
+ * @param[out] out - bufor;
+ * @param[in] num - numer;
+ * @param[in] length - długość numeru.
+ * @return Liczba zapisanych bajtów.
+ */
+static size_t numberWrite(uint8_t *out, char const *num, size_t length) {
+    size_t size = varintWrite(out, length);
+
+    for (size_t i = 0; i < length; i += 2) {
+        uint8_t byte = (uint8_t) toInt(num[i]);
+
+        if (i + 1 < length) {
+            byte |= (uint8_t) (toInt(num[i + 1]) << 4);
+        }
+
+        out[size++] = byte;
+    }
+
+    return size;
+}
+
+/**
+ * @brief Odczytuje długość numeru i pomija jego cyfry.
+ *
+ * @param[in] data - bufor;
+ * @param[in] size - rozmiar bufora;
+ * @param[in, out] position - pozycja odczytu (przesuwana za numer);
+ * @param[out] length - długość numeru;
+ * @param[out] digits - pozycja pierwszego bajtu cyfr.
+ * @return Wartość @p true jeśli odczyt się powiódł,
+ *         wartość @p false jeśli dane są niepoprawne.
+ */
+static bool numberSkip(uint8_t const *data, size_t size, size_t *position,
+                       size_t *length, size_t *digits) {
+    uint64_t value;
+
+    if (!varintRead(data, size, position, &value) || value == 0
+        || value > SIZE_MAX - 1 || (value + 1) / 2 > size - *position) {
+        return false;
+    }
+
+    *length = (size_t) value;
+    *digits = *position;
+    *position += (*length + 1) / 2;
+
+    return true;
+}
+
+/**
+ * @brief Rekord modyfikacji odczytany z postaci binarnej.
+ */
+typedef struct ChangeRecord {
+    /// Rodzaj rekordu (@ref CHANGE_ADD, @ref CHANGE_REMOVE lub
+    /// @ref CHANGE_EXPIRE).
+    uint8_t type;
+    /// Czas struktury po modyfikacji.
+    size_t time;
+    /// Długość pierwszego numeru.
+    size_t length1;
+    /// Pozycja cyfr pierwszego numeru.
+    size_t digits1;
+    /// Długość drugiego numeru (0 dla usunięcia i wygaśnięcia).
+    size_t length2;
+    /// Pozycja cyfr drugiego numeru.
+    size_t digits2;
+    /// Rozmiar rekordu.
+    size_t size;
+} ChangeRecord;
+
+/**
+ * @brief Odczytuje nagłówek rekordu i długości jego numerów.
+ *
+ * @param[in] data - bufor;
+ * @param[in] size - rozmiar bufora;
+ * @param[in] position - początek rekordu;
+ * @param[out] record - odczytany rekord.
+ * @return Wartość @p true jeśli odczyt się powiódł,
+ *         wartość @p false jeśli dane są niepoprawne.
+ */
+static bool recordRead(uint8_t const *data, size_t size, size_t position,
+                       ChangeRecord *record) {
+    size_t begin = position;
+    uint64_t time;
+
+    if (position >= size) {
+        return false;
+    }
+
+    record->type = data[position++];
+    if ((record->type != CHANGE_ADD && record->type != CHANGE_REMOVE
+         && record->type != CHANGE_EXPIRE)
+        || !varintRead(data, size, &position, &time) || time > SIZE_MAX
+        || !numberSkip(data, size, &position,
+                       &record->length1, &record->digits1)) {
+        return false;
+    }
+
+    record->time = (size_t) time;
+    record->length2 = 0;
+    record->digits2 = position;
+
+    if (record->type == CHANGE_ADD
+        && !numberSkip(data, size, &position,
+                       &record->length2, &record->digits2)) {
+        return false;
+    }
+
+    record->size = position - begin;
+
+    return true;
+}
+
+/**
+ * @brief Odczytuje cyfry numeru zapisanego funkcją @ref numberWrite.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in] digits - pierwszy bajt cyfr;
+ * @param[in] length - długość numeru.
+ * @return Numer lub NULL, gdy nie udało się alokować pamięci lub cyfry są
+ *         niepoprawne.
+ */
+static char *numberRead(PhfwdAllocator const *alloc, uint8_t const *digits,
+                        size_t length) {
+    char *num = memAlloc(alloc, sizeof(char) * (length + 1));
+    if (num == NULL) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < length; ++i) {
+        int digit = (digits[i / 2] >> (4 * (i % 2))) & 15;
+
+        if (digit > 11) {
+            memFree(alloc, num);
+            return NULL;
+        }
+
+        num[i] = toChar(digit);
+    }
+
+    num[length] = '\0';
+
+    return num;
+}
+
+extern ChangeLog *changeLogNew(PhfwdAllocator const *alloc, size_t capacity,
+                               size_t time) {
+    ChangeLog *log = memAlloc(alloc, sizeof(ChangeLog));
+    if (log == NULL) {
+        return NULL;
+    }
+
+    log->bytes = memAlloc(alloc, capacity);
+    if (log->bytes == NULL) {
+        memFree(alloc, log);
+        return NULL;
+    }
+
+    log->alloc = alloc;
+    log->capacity = capacity;
+    log->start = 0;
+    log->end = 0;
+    log->coveredFrom = time;
+
+    return log;
+}
+
+extern void changeLogDelete(ChangeLog *log) {
+    if (log == NULL) {
+        return;
+    }
+
+    memFree(log->alloc, log->bytes);
+    memFree(log->alloc, log);
+}
+
+/**
+ * @brief Usuwa najstarszy wpis dziennika.
+ *
+ * @param[in, out] log - niepusty dziennik.
+ */
+static void changeLogEvict(ChangeLog *log) {
+    ChangeRecord record;
+
+    recordRead(log->bytes, log->end, log->start, &record);
+    log->coveredFrom = record.time;
+    log->start += record.size + CHANGE_TRAILER;
+}
+
+/**
+ * @brief Zapisuje w dzienniku rekord modyfikacji.
+ *
+ * Wpis większy od całego bufora nie zostaje zapisany, ale dziennik
+ * przestaje wtedy obejmować wszystkie wcześniejsze modyfikacje.
+ *
+ * @param[in, out] log - dziennik;
+ * @param[in] type - rodzaj rekordu;
+ * @param[in] time - czas struktury po modyfikacji;
+ * @param[in] num1 - pierwszy numer;
+ * @param[in] length1 - długość @p num1;
+ * @param[in] num2 - drugi numer (NULL, jeśli rekord go nie ma);
+ * @param[in] length2 - długość @p num2.
+ */
+static void changeLogWrite(ChangeLog *log, uint8_t type, size_t time,
+                           char const *num1, size_t length1,
+                           char const *num2, size_t length2) {
+    size_t size = 1 + varintSize(time) + numberSize(length1)
+                  + (num2 == NULL ? 0 : numberSize(length2));
+
+    if (size + CHANGE_TRAILER > log->capacity) {
+        log->start = log->end = 0;
+        log->coveredFrom = time;
+        return;
+    }
+
+    if (log->end + size + CHANGE_TRAILER > log->capacity) {
+        while (log->start < log->end && log->end - log->start + size
+               + CHANGE_TRAILER > log->capacity - log->capacity / 4) {
+            changeLogEvict(log);
+        }
+
+        memmove(log->bytes, log->bytes + log->start, log->end - log->start);
+        log->end -= log->start;
+        log->start = 0;
+    }
+
+    uint8_t *out = log->bytes + log->end;
+    size_t position = 0;
+
+    out[position++] = type;
+    position += varintWrite(out + position, time);
+    position += numberWrite(out + position, num1, length1);
+    if (num2 != NULL) {
+        position += numberWrite(out + position, num2, length2);
+    }
+
+    uint32_t trailer = (uint32_t) size;
+    memcpy(out + position, &trailer, CHANGE_TRAILER);
+    log->end += size + CHANGE_TRAILER;
+}
+
+extern void changeLogAppend(ChangeLog *log, size_t time,
+                            char const *num1, size_t length1,
+                            char const *num2, size_t length2) {
+    changeLogWrite(log, (num2 == NULL ? CHANGE_REMOVE : CHANGE_ADD), time,
+                   num1, length1, num2, length2);
+}
+
+extern void changeLogAppendExpiry(ChangeLog *log, size_t time,
+                                  char const *num, size_t length) {
+    changeLogWrite(log, CHANGE_EXPIRE, time, num, length, NULL, 0);
+}
+
+extern bool phfwdChangeLogEnable(PhoneForward *pf, size_t capacity) {
+    if (pf == NULL || capacity > UINT32_MAX) {
+        return false;
+    }
+
+    ChangeLog *log = NULL;
+    if (capacity > 0) {
+        log = changeLogNew(pf->alloc, capacity, pf->time);
+        if (log == NULL) {
+            return false;
+        }
+    }
+
+    changeLogDelete(pf->changeLog);
+    pf->changeLog = log;
+
+    return true;
+}
+
+extern size_t phfwdTime(PhoneForward const *pf) {
+    return (pf == NULL ? 0 : pf->time);
+}
+
+/*
+ * Pierwszy wpis po czasie time znajdujemy, przeglądając wpisy od najnowszego.
+ */
+extern bool phfwdChangesSince(PhoneForward const *pf, size_t time,
+                              PhfwdChangeCallback callback, void *context) {
+    if (pf == NULL || pf->changeLog == NULL || callback == NULL
+        || time < pf->changeLog->coveredFrom) {
+        return false;
+    }
+
+    ChangeLog const *log = pf->changeLog;
+    size_t position = log->end;
+
+    while (position > log->start) {
+        uint32_t size;
+        ChangeRecord record;
+
+        memcpy(&size, log->bytes + position - CHANGE_TRAILER,
+               CHANGE_TRAILER);
+        recordRead(log->bytes, log->end,
+                   position - CHANGE_TRAILER - size, &record);
+        if (record.time <= time) {
+            break;
+        }
+
+        position -= CHANGE_TRAILER + size;
+    }
+
+    while (position < log->end) {
+        ChangeRecord record;
+
+        recordRead(log->bytes, log->end, position, &record);
+        if (!callback(context, log->bytes + position, record.size)) {
+            return false;
+        }
+
+        position += record.size + CHANGE_TRAILER;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Odtwarza wygaśnięcie przekierowania z numeru.
+ *
+ * Nic nie robi, jeśli z numeru nie ma aktualnego przekierowania.
+ *
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania;
+ * @param[in] num - numer.
+ */
+static void expireByNumber(PhoneForward *pf, char const *num) {
+    Node *node = pf->rootNode;
+
+    for (size_t i = 0; num[i] != '\0' && node != NULL; ++i) {
+        node = node->children[toInt(num[i])];
+    }
+
+    if (node == NULL || node->fwd == NULL) {
+        return;
+    }
+
+    Backward current = {node, node->fwdTime};
+    if (isBackwardLive(&current)) {
+        expiryRetire(pf, node, num);
+    }
+}
+
+/*
+ * Rekordy odtwarzamy funkcjami phfwdAdd, phfwdRemove i expiryRetire, więc
+ * trafiają one również do dziennika repliki, jeśli jest włączony.
+ */
+extern bool phfwdApplyChanges(PhoneForward *pf, void const *data, size_t size,
+                              size_t *lastTime) {
+    if (pf == NULL || (data == NULL && size > 0) || lastTime == NULL) {
+        return false;
+    }
+
+    uint8_t const *bytes = data;
+    size_t position = 0;
+
+    while (position < size) {
+        ChangeRecord record;
+
+        if (!recordRead(bytes, size, position, &record)) {
+            return false;
+        }
+
+        position += record.size;
+        if (record.time <= *lastTime) {
+            continue;
+        }
+
+        char *num1 = numberRead(pf->alloc, bytes + record.digits1,
+                                record.length1);
+        char *num2 = NULL;
+        bool applied = (num1 != NULL);
+
+        if (applied && record.type == CHANGE_ADD) {
+            num2 = numberRead(pf->alloc, bytes + record.digits2,
+                              record.length2);
+            applied = (num2 != NULL && phfwdAdd(pf, num1, num2));
+        }
+        else if (applied && record.type == CHANGE_EXPIRE) {
+            applied = epochReserve(pf, 1);
+            if (applied) {
+                expireByNumber(pf, num1);
+            }
+        }
+        else if (applied) {
+            phfwdRemove(pf, num1);
+        }
+
+        memFree(pf->alloc, num1);
+        memFree(pf->alloc, num2);
+
+        if (!applied) {
+            return false;
+        }
+
+        *lastTime = record.time;
+    }
+
+    return true;
+}
@@ -0,0 +1,79 @@
+/** @file changelog.h
+ * Interfejs ograniczonego dziennika modyfikacji struktury przechowującej
+ * przekierowania.
+ *
+ * Dziennik przechowuje ostatnie modyfikacje w buforze o stałym rozmiarze,
+ * zapisane w tej samej zwartej postaci binarnej, w której przekazuje je
+ * phfwdChangesSince. Gdy brakuje miejsca, usuwane są najstarsze wpisy.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __CHANGELOG_H__
+#define __CHANGELOG_H__
+
+#include <stddef.h>
+
+#include "phone_forward.h"
+#include "allocator.h"
+
+struct ChangeLog;
+/**
+ * Definiuje dziennik modyfikacji.
+ */
+typedef struct ChangeLog ChangeLog;
+
+/**
+ * @brief Tworzy pusty dziennik.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in] capacity - rozmiar bufora w bajtach;
+ * @param[in] time - czas struktury (dziennik zawiera wszystkie późniejsze
+ *                   modyfikacje).
+ * @return Wskaźnik na dziennik lub NULL, gdy nie udało się alokować pamięci.
+ */
+ChangeLog *changeLogNew(PhfwdAllocator const *alloc, size_t capacity,
+                        size_t time);
+
+/**
+ * @brief Usuwa dziennik.
+ *
+ * @param[in] log - usuwany dziennik (lub NULL).
+ */
+void changeLogDelete(ChangeLog *log);
+
+/**
+ * @brief Zapisuje w dzienniku dodanie przekierowania lub wyczyszczenie
+ * poddrzewa.
+ *
+ * Nie alokuje pamięci.
+ *
+ * @param[in, out] log - dziennik;
+ * @param[in] time - czas struktury po modyfikacji;
+ * @param[in] num1 - numer, z którego dodano przekierowanie, lub prefiks
+ *                   usuwanych przekierowań;
+ * @param[in] length1 - długość @p num1;
+ * @param[in] num2 - numer, na który dodano przekierowanie (NULL dla
+ *                   usunięcia);
+ * @param[in] length2 - długość @p num2.
+ */
+void changeLogAppend(ChangeLog *log, size_t time,
+                     char const *num1, size_t length1,
+                     char const *num2, size_t length2);
+
+/**
+ * @brief Zapisuje w dzienniku wygaśnięcie przekierowania.
+ *
+ * Nie alokuje pamięci.
+ *
+ * @param[in, out] log - dziennik;
+ * @param[in] time - czas struktury po modyfikacji;
+ * @param[in] num - numer, z którego wygasło przekierowanie;
+ * @param[in] length - długość @p num.
+ */
+void changeLogAppendExpiry(ChangeLog *log, size_t time,
+                           char const *num, size_t length);
+
+#endif /* __CHANGELOG_H__ */
@@ -0,0 +1,258 @@
+/** @file clone.c
+ * Implementacja kopiowania struktury przechowującej przekierowania.
+ *
+ * Kopia ma dokładnie te same wierzchołki co oryginał (również te, których
+ * przekierowania zostały usunięte lub zastąpione), z tymi samymi czasami,
+ * więc wszystkie zależności między czasami przekierowań i wyczyszczeń
+ * pozostają prawdziwe. Jedyne przejście drzewa oryginału w porządku
+ * preorder kopiuje wierzchołki i zapisuje pary (wierzchołek, kopia) na
+ * liście. Z listy budowane jest odwzorowanie wierzchołków, po czym drugie
+ * przejście, już tylko po liście, przepina przekierowania i kopiuje całymi
+ * blokami zbiory przekierowań wstecz, zastępując wierzchołki źródłowe ich
+ * obrazami. Indeks haszujący i koło czasowe kopiowane są w ten sam sposób.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include "phone_forward.h"
+#include "phone_forward_bulk.h"
+#include "phone_forward_tuning.h"
+#include "node.h"
+#include "utils.h"
+
+/**
+ * @brief Kopiuje pola wierzchołka.
+ *
+ * Przekierowanie i zbiór przekierowań wstecz kopii są tymczasowo
+ * przekierowaniem i zbiorem oryginału (dzięki temu przy ich przepinaniu
+ * nie trzeba wracać do wierzchołków oryginału), historia kopii jest pusta,
+ * a sama kopia nie leży w bloku wierzchołków.
+ *
+ * @param[out] copy - kopia;
+ * @param[in] node - kopiowany wierzchołek;
+ * @param[in] children - pusta tablica synów kopii;
+ * @param[in] father - ojciec kopii.
+ */
+static void copyNode(Node *copy, Node const *node, Node **children,
+                     Node *father) {
+    *copy = *node;
+
+    copy->children = children;
+    copy->father = father;
+    copy->history = NULL;
+    copy->packed = false;
+}
+
+/**
+ * @brief Lista par wierzchołek oryginału - jego kopia w porządku preorder.
+ */
+typedef struct CopyList {
+    /// Pary wierzchołków.
+    NodeMapEntry *pairs;
+    /// Liczba par.
+    size_t count;
+    /// Pojemność tablicy @p pairs.
+    size_t capacity;
+} CopyList;
+
+/**
+ * @brief Dopisuje parę wierzchołków do listy.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in, out] list - lista;
+ * @param[in] from - wierzchołek oryginału;
+ * @param[in] to - jego kopia.
+ * @return Wartość @p true, jeśli operacja się powiodła,
+ *         wartość @p false, gdy nie udało się alokować pamięci.
+ */
+static bool copyListAppend(PhfwdAllocator const *alloc, CopyList *list,
+                           Node const *from, Node *to) {
+    if (list->count == list->capacity) {
+        size_t capacity = max(2 * list->capacity, 64);
+        NodeMapEntry *pairs = memRealloc(alloc, list->pairs,
+                                         capacity * sizeof(NodeMapEntry));
+        if (pairs == NULL) {
+            return false;
+        }
+
+        list->pairs = pairs;
+        list->capacity = capacity;
+    }
+
+    list->pairs[list->count++] = (NodeMapEntry) {from, to};
+
+    return true;
+}
+
+/**
+ * @brief Kopiuje wierzchołki drzewa.
+ *
+ * Ojca kopii wierzchołka znajdujemy, wracając w górę od kopii poprzedniego
+ * wierzchołka w porządku preorder. Przy niepowodzeniu kopia zawiera część
+ * wierzchołków (wszystkie są na liście).
+ *
+ * @param[in, out] clone - kopia z pustym drzewem;
+ * @param[in] pf - kopiowana struktura;
+ * @param[in, out] list - pusta lista par wierzchołków.
+ * @return Wartość @p true, jeśli operacja się powiodła,
+ *         wartość @p false, gdy nie udało się alokować pamięci.
+ */
+static bool copyNodes(PhoneForward *clone, PhoneForward const *pf,
+                      CopyList *list) {
+    PhfwdAllocator const *alloc = clone->alloc;
+    Node const *node = pf->rootNode;
+    Node *previous = clone->rootNode;
+
+    if (!copyListAppend(alloc, list, node, previous)) {
+        return false;
+    }
+
+    copyNode(previous, node, previous->children, NULL);
+
+    while ((node = nodeNextPreorder(node)) != NULL) {
+        Node *copy = memAlloc(alloc, sizeof(Node));
+        Node **children = memCalloc(alloc, 12, sizeof(Node *));
+
+        if (copy == NULL || children == NULL
+            || !copyListAppend(alloc, list, node, copy)) {
+            memFree(alloc, copy);
+            memFree(alloc, children);
+            return false;
+        }
+
+        Node *father = previous;
+        while (father->depth >= node->depth) {
+            father = father->father;
+        }
+
+        copyNode(copy, node, children, father);
+        father->children[toInt(node->digit)] = copy;
+        previous = copy;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Przepina przekierowania kopii i kopiuje zbiory przekierowań wstecz.
+ *
+ * Kopie zawsze przestają współdzielić zbiory z oryginałem; przy
+ * niepowodzeniu (lub gdy nie ma odwzorowania) część zbiorów jest pusta,
+ * a kopia nadaje się jedynie do usunięcia.
+ *
+ * @param[in] alloc - alokator kopii;
+ * @param[in] list - lista wszystkich par wierzchołków;
+ * @param[in] map - odwzorowanie wierzchołków (lub NULL, jeśli nie udało się
+ *                  go utworzyć).
+ * @return Wartość @p true, jeśli operacja się powiodła,
+ *         wartość @p false, gdy nie udało się alokować pamięci.
+ */
+static bool linkNodes(PhfwdAllocator const *alloc, CopyList const *list,
+                      NodeMap const *map) {
+    bool ok = true;
+
+    for (size_t i = 0; i < list->count; ++i) {
+        Node *copy = list->pairs[i].to;
+        BackwardSet const *set = copy->backwards;
+
+        copy->backwards = NULL;
+        ok = (ok && map != NULL
+              && bwdSetCopy(alloc, &copy->backwards, set, map));
+        copy->fwd = (ok ? nodeMapFind(map, copy->fwd) : NULL);
+    }
+
+    return ok;
+}
+
+/**
+ * @brief Tworzy struktury pomocnicze kopii.
+ *
+ * Pamięć podręczna kopii jest pusta, a tablica skoków budowana jest od
+ * nowa dla drzewa kopii.
+ *
+ * @param[in, out] clone - kopia z kompletnym drzewem;
+ * @param[in] pf - kopiowana struktura;
+ * @param[in] map - odwzorowanie wierzchołków.
+ * @return Wartość @p true, jeśli operacja się powiodła,
+ *         wartość @p false, gdy nie udało się alokować pamięci.
+ */
+static bool copyIndexes(PhoneForward *clone, PhoneForward const *pf,
+                        NodeMap const *map) {
+    if (pf->cache != NULL) {
+        PhfwdCacheStats stats;
+
+        cacheStats(pf->cache, &stats);
+        if ((clone->cache = cacheNew(clone->alloc, stats.capacity)) == NULL) {
+            return false;
+        }
+    }
+
+    if (pf->jump != NULL) {
+        clone->jump = jumpNew(clone->alloc, clone->rootNode, pf->jump->depth);
+        if (clone->jump == NULL) {
+            return false;
+        }
+    }
+
+    if (pf->lpm != NULL && (clone->lpm = lpmClone(pf->lpm, map)) == NULL) {
+        return false;
+    }
+
+    if (pf->expiry != NULL
+        && (clone->expiry = expiryClone(pf->expiry, map)) == NULL) {
+        return false;
+    }
+
+    if (!epochClone(clone, pf)) {
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Odwzorowanie wierzchołków budowane jest dopiero po skopiowaniu drzewa,
+ * kiedy znana jest liczba wierzchołków, więc nie musi rosnąć.
+ */
+extern PhoneForward *phfwdClone(PhoneForward const *pf) {
+    if (pf == NULL) {
+        return NULL;
+    }
+
+    PhoneForward *clone = phfwdNewWithAllocator(pf->alloc);
+    if (clone == NULL) {
+        return NULL;
+    }
+
+    CopyList list = {NULL, 0, 0};
+    NodeMap map = {pf->alloc, NULL, 0};
+    bool ok = (copyNodes(clone, pf, &list)
+               && nodeMapInit(pf->alloc, &map, list.count));
+
+    for (size_t i = 0; ok && i < list.count; ++i) {
+        nodeMapInsert(&map, list.pairs[i].from, list.pairs[i].to);
+    }
+
+    // Przepinamy również po niepowodzeniu, żeby usuwana kopia nie zwolniła
+    // zbiorów oryginału.
+    ok = (linkNodes(clone->alloc, &list, ok ? &map : NULL) && ok
+          && copyIndexes(clone, pf, &map));
+
+    nodeMapClear(&map);
+    memFree(pf->alloc, list.pairs);
+
+    if (!ok) {
+        phfwdDelete(clone);
+        return NULL;
+    }
+
+    clone->time = pf->time;
+    clone->epoch = pf->epoch;
+    clone->epochBase = pf->epochBase;
+    clone->maxFwdDepth = pf->maxFwdDepth;
+    clone->lastRemoveTime = pf->lastRemoveTime;
+
+    return clone;
+}
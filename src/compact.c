@@ -0,0 +1,523 @@
+/** @file compact.c
+ * Implementacja przyrostowego kompaktowania struktury.
+ *
+ * Kolejne wywołania phfwdCompact przechodzą drzewo w porządku preorder,
+ * wracając do ojca po wskaźniku @p father (jak phfwdDelete), a między
+ * wywołaniami pamiętają jedynie bieżący wierzchołek i cyfrę kolejnego syna.
+ * Modyfikacje struktury nie zwalniają istniejących wierzchołków, więc
+ * zapamiętany wierzchołek pozostaje ważny.
+ *
+ * Przy wejściu do wierzchołka usuwamy jego nieaktualne przekierowanie,
+ * a przy powrocie wyznaczamy od nowa jego ograniczenie @p fwdDepthBelow.
+ * Wierzchołek, który został liściem, z którego ani do którego nie prowadzi
+ * żadne przekierowanie, zwalniamy, a pozostałe przenosimy do bloku.
+ * Przeniesienie przepina wszystkie wskaźniki na wierzchołek: ojca, synów,
+ * element zbioru przekierowań wstecz celu, przekierowania wierzchołków
+ * z jego własnego zbioru oraz pozycje indeksów. Historia i koło czasowe nie
+ * pozwalają odnaleźć odwołań do danego wierzchołka, więc wierzchołki
+ * z historią i z oczekującymi terminami (zob. @p expiryPins) pozostają
+ * na miejscu.
+ *
+ * Blok mieści @ref COMPACT_SLAB_NODES wierzchołków wraz z ich tablicami
+ * synów, zajmowanych w kolejności powrotów z wierzchołków (postorder), więc
+ * wierzchołki poddrzewa leżą obok siebie. Blok zwalniamy, gdy nie zostanie
+ * w nim żaden wierzchołek drzewa, a wierzchołki z bloków zajętych w mniej
+ * niż połowie przenosimy ponownie.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "phone_forward.h"
+#include "phone_forward_bulk.h"
+#include "compact.h"
+#include "node.h"
+#include "utils.h"
+
+/// Liczba wierzchołków jednego bloku.
+#define COMPACT_SLAB_NODES 1024
+
+/// Najdłuższy numer wierzchołka, do którego mogą odwoływać się indeksy
+/// struktury (tablica skoków, indeks haszujący i pamięć domknięć).
+#define COMPACT_INDEX_DIGITS RESOLVE_MAX_DIGITS
+
+/**
+ * @brief Wierzchołek w bloku wraz ze swoją tablicą synów.
+ */
+typedef struct CompactSlot {
+    /// Wierzchołek.
+    Node node;
+    /// Tablica synów wierzchołka.
+    Node *children[12];
+} CompactSlot;
+
+/**
+ * @brief Blok wierzchołków.
+ */
+typedef struct NodeSlab {
+    /// Liczba zajętych pozycji (zajmowanych kolejno od początku bloku).
+    size_t used;
+    /// Liczba wierzchołków bloku, które wciąż należą do drzewa.
+    size_t live;
+    /// Pozycje bloku.
+    CompactSlot slots[COMPACT_SLAB_NODES];
+} NodeSlab;
+
+/**
+ * Stan kompaktowania struktury.
+ */
+struct Compactor {
+    /// Alokator struktury.
+    PhfwdAllocator const *alloc;
+    /// Bloki posortowane według adresów.
+    NodeSlab **slabs;
+    /// Liczba bloków.
+    size_t slabCount;
+    /// Pojemność tablicy @p slabs.
+    size_t slabCapacity;
+    /// Blok, do którego trafiają przenoszone wierzchołki (lub NULL).
+    NodeSlab *open;
+    /// Wierzchołek, na którym przerwano przejście (NULL, jeśli kolejne
+    /// wywołanie zaczyna nowe przejście).
+    Node *cursor;
+    /// Cyfra kolejnego syna wierzchołka @p cursor do odwiedzenia.
+    int next;
+};
+
+/**
+ * @brief Tworzy stan kompaktowania bez bloków.
+ *
+ * @param[in] alloc - alokator.
+ * @return Wskaźnik na stan lub NULL, gdy nie udało się alokować pamięci.
+ */
+static Compactor *compactNew(PhfwdAllocator const *alloc) {
+    Compactor *compactor = memAlloc(alloc, sizeof(Compactor));
+    if (compactor == NULL) {
+        return NULL;
+    }
+
+    compactor->alloc = alloc;
+    compactor->slabs = NULL;
+    compactor->slabCount = 0;
+    compactor->slabCapacity = 0;
+    compactor->open = NULL;
+    compactor->cursor = NULL;
+    compactor->next = 0;
+
+    return compactor;
+}
+
+extern void compactDelete(Compactor *compactor) {
+    if (compactor == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < compactor->slabCount; ++i) {
+        memFree(compactor->alloc, compactor->slabs[i]);
+    }
+
+    memFree(compactor->alloc, compactor->slabs);
+    memFree(compactor->alloc, compactor);
+}
+
+/**
+ * @brief Wyznacza liczbę bloków o adresach nie większych niż dany.
+ *
+ * @param[in] compactor - stan kompaktowania;
+ * @param[in] address - adres.
+ * @return Liczba bloków leżących w pamięci nie dalej niż @p address.
+ */
+static size_t slabsBefore(Compactor const *compactor, void const *address) {
+    size_t low = 0;
+    size_t high = compactor->slabCount;
+
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+
+        if ((uintptr_t) compactor->slabs[middle] <= (uintptr_t) address) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+/**
+ * @brief Wyznacza blok, w którym leży wierzchołek.
+ *
+ * @param[in] compactor - stan kompaktowania;
+ * @param[in] node - wierzchołek z bloku.
+ * @return Indeks bloku.
+ */
+static size_t slabOf(Compactor const *compactor, Node const *node) {
+    return slabsBefore(compactor, node) - 1;
+}
+
+/**
+ * @brief Zwalnia blok.
+ *
+ * @param[in, out] compactor - stan kompaktowania;
+ * @param[in] index - indeks bloku bez wierzchołków drzewa.
+ */
+static void slabDrop(Compactor *compactor, size_t index) {
+    NodeSlab *slab = compactor->slabs[index];
+
+    if (slab == compactor->open) {
+        compactor->open = NULL;
+    }
+
+    compactor->slabCount--;
+    memmove(compactor->slabs + index, compactor->slabs + index + 1,
+            (compactor->slabCount - index) * sizeof(NodeSlab *));
+    memFree(compactor->alloc, slab);
+}
+
+/**
+ * @brief Zajmuje w bloku pozycję dla przenoszonego wierzchołka.
+ *
+ * W razie potrzeby alokuje nowy blok, który staje się blokiem otwartym.
+ *
+ * @param[in, out] compactor - stan kompaktowania.
+ * @return Wskaźnik na pozycję lub NULL, gdy nie udało się alokować pamięci.
+ */
+static CompactSlot *slotReserve(Compactor *compactor) {
+    NodeSlab *open = compactor->open;
+
+    if (open == NULL || open->used == COMPACT_SLAB_NODES) {
+        if (compactor->slabCount == compactor->slabCapacity) {
+            size_t capacity = max(2 * compactor->slabCapacity, 16);
+            NodeSlab **slabs = memRealloc(compactor->alloc, compactor->slabs,
+                                          capacity * sizeof(NodeSlab *));
+            if (slabs == NULL) {
+                return NULL;
+            }
+
+            compactor->slabs = slabs;
+            compactor->slabCapacity = capacity;
+        }
+
+        open = memAlloc(compactor->alloc, sizeof(NodeSlab));
+        if (open == NULL) {
+            return NULL;
+        }
+
+        // Poprzedni otwarty blok mógł już zostać opróżniony.
+        if (compactor->open != NULL && compactor->open->live == 0) {
+            slabDrop(compactor, slabsBefore(compactor, compactor->open) - 1);
+        }
+
+        size_t index = slabsBefore(compactor, open);
+        memmove(compactor->slabs + index + 1, compactor->slabs + index,
+                (compactor->slabCount - index) * sizeof(NodeSlab *));
+        compactor->slabs[index] = open;
+        compactor->slabCount++;
+
+        open->used = 0;
+        open->live = 0;
+        compactor->open = open;
+    }
+
+    open->live++;
+
+    return &open->slots[open->used++];
+}
+
+/**
+ * @brief Sprawdza, czy wierzchołek warto przenieść.
+ *
+ * @param[in] compactor - stan kompaktowania;
+ * @param[in] node - wierzchołek.
+ * @return Wartość @p true, jeśli wierzchołek nie leży w bloku lub leży
+ *         w zamkniętym bloku zajętym w mniej niż połowie,
+ *         wartość @p false w przeciwnym wypadku.
+ */
+static bool isScattered(Compactor const *compactor, Node const *node) {
+    if (!node->packed) {
+        return true;
+    }
+
+    NodeSlab const *slab = compactor->slabs[slabOf(compactor, node)];
+
+    return slab != compactor->open && 2 * slab->live < slab->used;
+}
+
+/**
+ * @brief Zwalnia pamięć odłączonego wierzchołka.
+ *
+ * @param[in, out] compactor - stan kompaktowania;
+ * @param[in] node - wierzchołek, do którego nic się już nie odwołuje.
+ */
+static void nodeRelease(Compactor *compactor, Node *node) {
+    if (!node->packed) {
+        memFree(compactor->alloc, node->children);
+        memFree(compactor->alloc, node);
+        return;
+    }
+
+    size_t index = slabOf(compactor, node);
+    NodeSlab *slab = compactor->slabs[index];
+
+    if (--slab->live == 0 && slab != compactor->open) {
+        slabDrop(compactor, index);
+    }
+}
+
+/**
+ * @brief Wyznacza największy czas wyczyszczenia wierzchołka i jego
+ * przodków.
+ *
+ * @param[in] node - wierzchołek.
+ * @return Największy czas wyczyszczenia na trasie od korzenia.
+ */
+static Epoch maxDeleteTime(Node const *node) {
+    Epoch maxDelete = 0;
+
+    for (; node != NULL; node = node->father) {
+        maxDelete = (Epoch) max(maxDelete, node->deleteTime);
+    }
+
+    return maxDelete;
+}
+
+/**
+ * @brief Sprawdza, czy wierzchołka nie trzeba zostawiać na miejscu.
+ *
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania;
+ * @param[in] node - wierzchołek.
+ * @return Wartość @p true, jeśli wierzchołek można przenieść lub zwolnić,
+ *         wartość @p false w przeciwnym wypadku.
+ */
+static bool isMovable(PhoneForward const *pf, Node const *node) {
+    return node != pf->rootNode && node->history == NULL
+           && node->expiryPins == 0;
+}
+
+/**
+ * @brief Aktualizuje indeksy struktury po przeniesieniu lub odłączeniu
+ * wierzchołka.
+ *
+ * Nie alokuje pamięci: indeks haszujący zawiera już numer aktualnego
+ * przekierowania, więc zmienia się jedynie jego wierzchołek.
+ *
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania;
+ * @param[in] node - przeniesiony lub odłączony wierzchołek;
+ * @param[in] live - czy z wierzchołka jest aktualne przekierowanie.
+ */
+static void refreshIndexes(PhoneForward *pf, Node *node, bool live) {
+    char num[COMPACT_INDEX_DIGITS];
+    size_t length = node->depth;
+
+    if (length > COMPACT_INDEX_DIGITS
+        || (pf->lpm == NULL && pf->resolve == NULL && pf->jump == NULL)) {
+        return;
+    }
+
+    nodeWrite(node, num);
+
+    if (live && pf->lpm != NULL && length <= LPM_MAX_DIGITS) {
+        bool created;
+        lpmInsert(pf->lpm, num, length, node, &created);
+    }
+
+    // Pamięć domknięć rozpoznaje prefiksy po adresach wierzchołków.
+    if (live && pf->resolve != NULL) {
+        resolveInvalidate(pf->resolve, num, length);
+    }
+
+    if (pf->jump != NULL && length <= pf->jump->depth) {
+        jumpRefresh(pf->jump, pf->rootNode, num, length);
+    }
+}
+
+/**
+ * @brief Usuwa z wierzchołka przekierowanie, które przestało być aktualne.
+ *
+ * Przy włączonej historii przekierowanie usuwamy dopiero wtedy, gdy
+ * przestało być aktualne nie później niż w chwili horyzontu (o wcześniejsze
+ * chwile nie można pytać).
+ *
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania;
+ * @param[in, out] node - wierzchołek.
+ * @return Wartość @p true, jeśli z wierzchołka jest aktualne przekierowanie,
+ *         wartość @p false w przeciwnym wypadku.
+ */
+static bool pruneFwd(PhoneForward *pf, Node *node) {
+    if (node->fwd == NULL) {
+        return false;
+    }
+
+    Epoch maxDelete = maxDeleteTime(node);
+    if (node->fwdTime > maxDelete) {
+        return true;
+    }
+
+    if (pf->history == NULL || maxDelete <= pf->history->horizon) {
+        bwdSetErase(pf->alloc, &node->fwd->backwards, node);
+        node->fwd = NULL;
+        node->fwdTime = 0;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Przenosi wierzchołek do otwartego bloku.
+ *
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania;
+ * @param[in] node - przenoszony wierzchołek;
+ * @param[in] live - czy z wierzchołka jest aktualne przekierowanie.
+ * @return Przeniesiony wierzchołek lub @p node, jeśli nie udało się alokować
+ *         bloku.
+ */
+static Node *nodeMove(PhoneForward *pf, Node *node, bool live) {
+    CompactSlot *slot = slotReserve(pf->compact);
+    if (slot == NULL) {
+        return node;
+    }
+
+    // Element zbioru celu wyszukujemy, póki wskaźniki drzewa są spójne.
+    Backward *entry = NULL;
+    if (node->fwd != NULL) {
+        BackwardSet *set = node->fwd->backwards;
+        bool found;
+        BwdSetPosition position = bwdSetLowerBound(set, node, &found);
+
+        entry = (found ? bwdSetGet(set, position) : NULL);
+    }
+
+    Node *moved = &slot->node;
+    *moved = *node;
+    moved->children = slot->children;
+    moved->packed = true;
+    memcpy(slot->children, node->children, sizeof(slot->children));
+
+    moved->father->children[toInt(moved->digit)] = moved;
+    for (size_t i = 0; i < 12; ++i) {
+        if (moved->children[i] != NULL) {
+            moved->children[i]->father = moved;
+        }
+    }
+
+    if (entry != NULL) {
+        entry->fwdFrom = moved;
+    }
+
+    BackwardSet const *set = moved->backwards;
+    BwdSetPosition position = {0, 0};
+    Backward *bwd;
+    for (; (bwd = bwdSetGet(set, position)) != NULL;
+         bwdSetNext(set, &position)) {
+        bwd->fwdFrom->fwd = moved;
+    }
+
+    refreshIndexes(pf, moved, live);
+    nodeRelease(pf->compact, node);
+
+    return moved;
+}
+
+/**
+ * @brief Odwiedza wierzchołek po odwiedzeniu jego poddrzewa.
+ *
+ * Ograniczenie @p fwdDepthBelow wyznaczamy od nowa na podstawie synów,
+ * dzięki czemu przestają je zawyżać przekierowania, które nie są już
+ * aktualne. Niepotrzebny wierzchołek zwalniamy, a pozostałe przenosimy
+ * dopiero teraz, by nie zajmować w blokach miejsca wierzchołkami, które
+ * zostaną zwolnione.
+ *
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania;
+ * @param[in, out] node - wierzchołek.
+ */
+static void nodeLeave(PhoneForward *pf, Node *node) {
+    bool leaf = true;
+    bool live = (node->fwd != NULL && node->fwdTime > maxDeleteTime(node));
+    size_t below = (live ? node->depth : 0);
+
+    for (size_t i = 0; i < 12; ++i) {
+        if (node->children[i] != NULL) {
+            leaf = false;
+            below = max(below, node->children[i]->fwdDepthBelow);
+        }
+    }
+
+    node->fwdDepthBelow = (uint32_t) below;
+
+    if (!isMovable(pf, node)) {
+        return;
+    }
+
+    if (leaf && node->fwd == NULL && node->backwards == NULL) {
+        node->father->children[toInt(node->digit)] = NULL;
+        refreshIndexes(pf, node, false);
+        nodeRelease(pf->compact, node);
+    }
+    else if (isScattered(pf->compact, node)) {
+        nodeMove(pf, node, live);
+    }
+}
+
+/*
+ * Budżet ogranicza liczbę wejść do wierzchołków; każdy powrót odpowiada
+ * wcześniejszemu wejściu (lub jednemu z przodków wierzchołka, na którym
+ * przerwano przejście).
+ */
+extern bool phfwdCompact(PhoneForward *pf, size_t budget) {
+    if (pf == NULL) {
+        return false;
+    }
+
+    if (pf->compact == NULL && (pf->compact = compactNew(pf->alloc)) == NULL) {
+        return false;
+    }
+
+    Compactor *compactor = pf->compact;
+    Node *node = pf->rootNode;
+    int next = 0;
+    bool finished = false;
+
+    if (compactor->cursor != NULL) {
+        node = compactor->cursor;
+        next = compactor->next;
+    }
+
+    for (size_t visited = 0; ; ) {
+        while (next < 12 && node->children[next] == NULL) {
+            next++;
+        }
+
+        if (next < 12) {
+            if (visited == budget) {
+                break;
+            }
+
+            visited++;
+            node = node->children[next];
+            pruneFwd(pf, node);
+            next = 0;
+            continue;
+        }
+
+        if (node == pf->rootNode) {
+            nodeLeave(pf, node);
+            finished = true;
+            break;
+        }
+
+        Node *father = node->father;
+        next = toInt(node->digit) + 1;
+        nodeLeave(pf, node);
+        node = father;
+    }
+
+    compactor->cursor = (finished ? NULL : node);
+    compactor->next = next;
+
+    return finished;
+}
@@ -0,0 +1,36 @@
+/** @file compact.h
+ * Interfejs przyrostowego kompaktowania struktury przechowującej
+ * przekierowania.
+ *
+ * Kompaktowanie usuwa nieaktualne przekierowania i niepotrzebne już
+ * wierzchołki, a pozostałe wierzchołki przenosi do bloków, w których leżą
+ * w kolejności przejścia drzewa. Wierzchołki z bloków (z ustawionym polem
+ * @p packed) nie są zwalniane osobno, lecz razem z blokiem.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __COMPACT_H__
+#define __COMPACT_H__
+
+#include "phone_forward.h"
+#include "allocator.h"
+
+struct Compactor;
+/**
+ * Definiuje stan kompaktowania struktury.
+ */
+typedef struct Compactor Compactor;
+
+/**
+ * @brief Usuwa stan kompaktowania wraz ze wszystkimi blokami wierzchołków.
+ *
+ * Wierzchołki z bloków nie mogą być później używane.
+ *
+ * @param[in] compactor - usuwany stan (lub NULL).
+ */
+void compactDelete(Compactor *compactor);
+
+#endif /* __COMPACT_H__ */
@@ -0,0 +1,399 @@
+/** @file diff.c
+ * Implementacja skrótów zawartości poddrzew i porównywania struktur.
+ *
+ * Skrót numeru jest sumą skrótów par (pozycja, cyfra), więc można go
+ * wyznaczyć zarówno z napisu, jak i idąc od wierzchołka do korzenia.
+ * Usunięcie poddrzewa jest leniwe, więc skróty wierzchołków wewnątrz
+ * wyczyszczonego poddrzewa pozostają stare; skrót jest aktualny, jeśli
+ * zmieniono go później niż wyczyszczono którykolwiek z przodków
+ * wierzchołka. Nieaktualny skrót oznacza poddrzewo bez aktualnych
+ * przekierowań (każde dodanie zmienia skróty całej ścieżki).
+ *
+ * Porównanie przechodzi oba drzewa równocześnie w porządku preorder,
+ * z jawnym stosem par wierzchołków, i nie wchodzi do par poddrzew
+ * o równych skrótach. Różne zbiory przekierowań mają równe skróty
+ * z prawdopodobieństwem rzędu @f$2^{-64}@f$.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <string.h>
+
+#include "phone_forward_bulk.h"
+#include "diff.h"
+#include "node.h"
+#include "utils.h"
+
+/**
+ * @brief Miesza bity liczby (funkcja końcowa SplitMix64).
+ *
+ * @param[in] x - liczba.
+ * @return Wymieszana liczba.
+ */
+static uint64_t diffMix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief Wyznacza skrót cyfry na pozycji numeru.
+ *
+ * @param[in] position - pozycja cyfry (od zera);
+ * @param[in] digit - cyfra.
+ * @return Skrót cyfry.
+ */
+static uint64_t digitHash(size_t position, char digit) {
+    return diffMix(((uint64_t) position << 4) | (uint64_t) toInt(digit));
+}
+
+/**
+ * @brief Wyznacza skrót numeru wierzchołka.
+ *
+ * @param[in] node - wierzchołek.
+ * @return Skrót numeru (równy skrótowi napisu z tymi cyframi).
+ */
+static uint64_t nodeNumHash(Node const *node) {
+    uint64_t hash = diffMix(node->depth);
+
+    for (; node->father != NULL; node = node->father) {
+        hash += digitHash(node->depth - 1, node->digit);
+    }
+
+    return hash;
+}
+
+/*
+ * Numer przekierowania i numer docelowy mieszamy niesymetrycznie, żeby
+ * przekierowania a -> b i b -> a miały różne skróty.
+ */
+extern uint64_t diffFwdHash(char const *num, size_t length,
+                            Node const *target) {
+    uint64_t hash = diffMix(length);
+
+    for (size_t i = 0; i < length; ++i) {
+        hash += digitHash(i, num[i]);
+    }
+
+    return diffMix(hash ^ diffMix(nodeNumHash(target) + 1));
+}
+
+extern uint64_t diffSubtreeHash(Node const *root, char const *num,
+                                size_t length) {
+    Node const *node = root;
+    size_t maxDelete = 0;
+
+    for (size_t i = 0; i < length; ++i) {
+        maxDelete = max(maxDelete, node->deleteTime);
+        node = node->children[toInt(num[i])];
+    }
+
+    return (node->hashTime < maxDelete ? 0 : node->contentHash);
+}
+
+extern void diffUpdatePath(Node *root, char const *num, size_t length,
+                           uint64_t delta, Epoch time) {
+    Node *node = root;
+    size_t maxDelete = 0;
+
+    for (size_t i = 0; ; ++i) {
+        if (node->hashTime < maxDelete) {
+            node->contentHash = 0;
+        }
+
+        node->contentHash += delta;
+        node->hashTime = time;
+
+        if (i == length) {
+            return;
+        }
+
+        maxDelete = max(maxDelete, node->deleteTime);
+        node = node->children[toInt(num[i])];
+    }
+}
+
+/**
+ * @brief Para odpowiadających sobie wierzchołków porównywanych drzew.
+ */
+typedef struct DiffFrame {
+    /// Wierzchołek pierwszego drzewa (NULL, jeśli go nie ma lub jego
+    /// poddrzewo nie ma aktualnych przekierowań).
+    Node const *first;
+    /// Wierzchołek drugiego drzewa (jak wyżej).
+    Node const *second;
+    /// Największy czas wyczyszczenia na ścieżce do @p first (włącznie).
+    size_t firstDelete;
+    /// Największy czas wyczyszczenia na ścieżce do @p second (włącznie).
+    size_t secondDelete;
+    /// Kolejna cyfra do porównania.
+    int next;
+} DiffFrame;
+
+/**
+ * @brief Bufor na numer docelowy przekierowania.
+ */
+typedef struct DiffBuffer {
+    /// Znaki numeru.
+    char *data;
+    /// Pojemność bufora.
+    size_t capacity;
+} DiffBuffer;
+
+/**
+ * @brief Zapisuje numer wierzchołka do bufora.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in, out] buffer - bufor;
+ * @param[in] node - wierzchołek (lub NULL);
+ * @param[out] ok - ustawiane na @p false, gdy nie udało się alokować
+ *                  pamięci.
+ * @return Wskaźnik na numer lub NULL dla @p node równego NULL i gdy nie
+ *         udało się alokować pamięci.
+ */
+static char const *bufferWrite(PhfwdAllocator const *alloc,
+                               DiffBuffer *buffer, Node const *node,
+                               bool *ok) {
+    if (node == NULL) {
+        return NULL;
+    }
+
+    if (node->depth >= buffer->capacity) {
+        char *data = memRealloc(alloc, buffer->data, 2 * node->depth);
+        if (data == NULL) {
+            *ok = false;
+            return NULL;
+        }
+
+        buffer->data = data;
+        buffer->capacity = 2 * node->depth;
+    }
+
+    buffer->data[nodeWrite(node, buffer->data)] = '\0';
+
+    return buffer->data;
+}
+
+/**
+ * @brief Sprawdza, czy wierzchołki dwóch drzew reprezentują ten sam numer.
+ *
+ * @param[in] first - wierzchołek pierwszego drzewa;
+ * @param[in] second - wierzchołek drugiego drzewa.
+ * @return Wartość @p true, jeśli numery są równe,
+ *         wartość @p false w przeciwnym wypadku.
+ */
+static bool sameNumber(Node const *first, Node const *second) {
+    if (first->depth != second->depth) {
+        return false;
+    }
+
+    for (; first->father != NULL;
+         first = first->father, second = second->father) {
+        if (first->digit != second->digit) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Wyznacza syna, jeśli w jego poddrzewie mogą być aktualne
+ * przekierowania.
+ *
+ * @param[in] node - wierzchołek (lub NULL);
+ * @param[in] digit - cyfra syna.
+ * @return Syn lub NULL.
+ */
+static Node const *liveChild(Node const *node, int digit) {
+    if (node == NULL) {
+        return NULL;
+    }
+
+    Node const *child = node->children[digit];
+
+    return (child != NULL && child->fwdDepthBelow >= child->depth ?
+            child : NULL);
+}
+
+/**
+ * @brief Wyznacza aktualny skrót poddrzewa.
+ *
+ * @param[in] node - wierzchołek (lub NULL);
+ * @param[in] maxDelete - największy czas wyczyszczenia przodków.
+ * @return Skrót poddrzewa (zero dla pustego).
+ */
+static uint64_t liveHash(Node const *node, size_t maxDelete) {
+    return (node == NULL || node->hashTime < maxDelete ?
+            0 : node->contentHash);
+}
+
+/**
+ * @brief Wyznacza cel aktualnego przekierowania z wierzchołka.
+ *
+ * @param[in] node - wierzchołek (lub NULL);
+ * @param[in] maxDelete - największy czas wyczyszczenia na ścieżce
+ *                        do wierzchołka (włącznie).
+ * @return Cel przekierowania lub NULL, jeśli nie ma aktualnego.
+ */
+static Node const *liveTarget(Node const *node, size_t maxDelete) {
+    if (node == NULL || node->fwd == NULL || node->fwdTime <= maxDelete) {
+        return NULL;
+    }
+
+    return node->fwd;
+}
+
+/**
+ * @brief Stan porównania.
+ */
+typedef struct DiffState {
+    /// Alokator pierwszej struktury.
+    PhfwdAllocator const *alloc;
+    /// Cyfry numeru bieżącej pary wierzchołków.
+    char *key;
+    /// Numer docelowy w pierwszej strukturze.
+    DiffBuffer before;
+    /// Numer docelowy w drugiej strukturze.
+    DiffBuffer after;
+    /// Funkcja otrzymująca różnice.
+    PhfwdDiffCallback callback;
+    /// Kontekst przekazywany do @p callback.
+    void *context;
+} DiffState;
+
+/**
+ * @brief Przekazuje różnicę przekierowań z pary wierzchołków.
+ *
+ * @param[in, out] state - stan porównania;
+ * @param[in] frame - para wierzchołków;
+ * @param[out] ok - ustawiane na @p false, gdy nie udało się alokować
+ *                  pamięci.
+ * @return Wartość @p false, jeśli porównanie należy przerwać,
+ *         wartość @p true w przeciwnym wypadku.
+ */
+static bool emitFrame(DiffState *state, DiffFrame const *frame, bool *ok) {
+    Node const *before = liveTarget(frame->first, frame->firstDelete);
+    Node const *after = liveTarget(frame->second, frame->secondDelete);
+
+    if (before == NULL && after == NULL) {
+        return true;
+    }
+
+    if (before != NULL && after != NULL && sameNumber(before, after)) {
+        return true;
+    }
+
+    char const *beforeNum = bufferWrite(state->alloc, &state->before,
+                                        before, ok);
+    char const *afterNum = bufferWrite(state->alloc, &state->after,
+                                       after, ok);
+    if (!*ok) {
+        return false;
+    }
+
+    Node const *node = (frame->first != NULL ? frame->first : frame->second);
+    state->key[node->depth] = '\0';
+
+    return state->callback(state->context, state->key, beforeNum, afterNum);
+}
+
+/**
+ * @brief Porównuje drzewa.
+ *
+ * @param[in, out] state - stan porównania;
+ * @param[in, out] frames - stos par wierzchołków (z miejscem na
+ *                          największą głębokość przekierowań obu struktur);
+ * @param[in] first - pierwsza struktura;
+ * @param[in] second - druga struktura.
+ * @return Wartość @p true, jeśli przekazano wszystkie różnice,
+ *         wartość @p false, jeśli nie udało się alokować pamięci lub
+ *         funkcja przerwała porównanie.
+ */
+static bool diffTrees(DiffState *state, DiffFrame *frames,
+                      PhoneForward const *first, PhoneForward const *second) {
+    bool ok = true;
+    size_t top = 0;
+
+    frames[0] = (DiffFrame) {first->rootNode, second->rootNode,
+                             first->rootNode->deleteTime,
+                             second->rootNode->deleteTime, 0};
+
+    if (first->rootNode->contentHash == second->rootNode->contentHash) {
+        return true;
+    }
+
+    while (true) {
+        DiffFrame *frame = &frames[top];
+
+        if (frame->next == 12) {
+            if (top == 0) {
+                return true;
+            }
+
+            top--;
+            continue;
+        }
+
+        int digit = frame->next++;
+        Node const *firstChild = liveChild(frame->first, digit);
+        Node const *secondChild = liveChild(frame->second, digit);
+
+        if (liveHash(firstChild, frame->firstDelete)
+            == liveHash(secondChild, frame->secondDelete)) {
+            continue;
+        }
+
+        DiffFrame *child = &frames[++top];
+        *child = (DiffFrame) {firstChild, secondChild, frame->firstDelete,
+                              frame->secondDelete, 0};
+
+        if (firstChild != NULL) {
+            child->firstDelete = max(child->firstDelete,
+                                     firstChild->deleteTime);
+        }
+
+        if (secondChild != NULL) {
+            child->secondDelete = max(child->secondDelete,
+                                      secondChild->deleteTime);
+        }
+
+        state->key[top - 1] = toChar(digit);
+
+        if (!emitFrame(state, child, &ok)) {
+            return false;
+        }
+    }
+}
+
+/*
+ * Koszt zależy od liczby wierzchołków na ścieżkach do różniących się
+ * przekierowań, a nie od rozmiaru struktur.
+ */
+extern bool phfwdDiff(PhoneForward const *first, PhoneForward const *second,
+                      PhfwdDiffCallback callback, void *context) {
+    if (first == NULL || second == NULL || callback == NULL) {
+        return false;
+    }
+
+    PhfwdAllocator const *alloc = first->alloc;
+    size_t depth = max(first->maxFwdDepth, second->maxFwdDepth);
+
+    DiffState state = {alloc, memAlloc(alloc, depth + 1), {NULL, 0},
+                       {NULL, 0}, callback, context};
+    DiffFrame *frames = memAlloc(alloc, (depth + 1) * sizeof(DiffFrame));
+
+    bool result = (state.key != NULL && frames != NULL
+                   && diffTrees(&state, frames, first, second));
+
+    memFree(alloc, state.key);
+    memFree(alloc, frames);
+    memFree(alloc, state.before.data);
+    memFree(alloc, state.after.data);
+
+    return result;
+}
@@ -0,0 +1,60 @@
+/** @file diff.h
+ * Interfejs skrótów zawartości poddrzew, pozwalających porównywać
+ * struktury z pominięciem identycznych poddrzew.
+ *
+ * Skrót przekierowania zależy jedynie od numerów, z którego i do którego
+ * prowadzi, a skrót poddrzewa jest sumą (modulo @f$2^{64}@f$) skrótów jego
+ * aktualnych przekierowań, więc nie zależy od kolejności modyfikacji, które
+ * do niego doprowadziły. Każda zmiana zbioru aktualnych przekierowań
+ * (phfwdAdd, phfwdRemove, expiryRetire) poprawia skróty wierzchołków na
+ * ścieżce od korzenia.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __DIFF_H__
+#define __DIFF_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "phone_forward.h"
+#include "epoch.h"
+
+/**
+ * @brief Wyznacza skrót przekierowania.
+ *
+ * @param[in] num - numer, z którego wychodzi przekierowanie;
+ * @param[in] length - długość numeru @p num;
+ * @param[in] target - wierzchołek, do którego prowadzi przekierowanie.
+ * @return Skrót przekierowania.
+ */
+uint64_t diffFwdHash(char const *num, size_t length, Node const *target);
+
+/**
+ * @brief Wyznacza skrót poddrzewa wierzchołka.
+ *
+ * @param[in] root - korzeń drzewa;
+ * @param[in] num - numer istniejącego wierzchołka;
+ * @param[in] length - długość numeru.
+ * @return Suma skrótów aktualnych przekierowań z poddrzewa wierzchołka.
+ */
+uint64_t diffSubtreeHash(Node const *root, char const *num, size_t length);
+
+/**
+ * @brief Zmienia skróty wierzchołków na ścieżce numeru.
+ *
+ * Nieaktualne skróty zerujemy przed zmianą.
+ *
+ * @param[in, out] root - korzeń drzewa;
+ * @param[in] num - numer istniejącego wierzchołka;
+ * @param[in] length - długość numeru;
+ * @param[in] delta - zmiana sumy skrótów (modulo @f$2^{64}@f$);
+ * @param[in] time - czas struktury po modyfikacji.
+ */
+void diffUpdatePath(Node *root, char const *num, size_t length,
+                    uint64_t delta, Epoch time);
+
+#endif /* __DIFF_H__ */
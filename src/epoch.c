@@ -0,0 +1,287 @@
+/** @file epoch.c
+ * Implementacja czasów przechowywanych w wierzchołkach.
+ *
+ * Przenumerowanie zbiera wszystkie przechowywane epoki, sortuje je
+ * i zastępuje każdą jej pozycją w posortowanym ciągu bez powtórzeń, więc
+ * porządek (i równość) epok pozostaje zachowany, a kolejne epoki zaczynają
+ * się zaraz za największą z nich. Czasy struktury odpowiadające
+ * przenumerowanym epokom trafiają do tablicy @p epochTimes; późniejsze
+ * epoki rosną razem z czasem struktury, więc ich czasy wynikają z różnicy
+ * z bieżącą epoką.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "epoch.h"
+#include "node.h"
+#include "utils.h"
+
+/**
+ * @brief Zebrane epoki.
+ */
+typedef struct EpochList {
+    /// Alokator struktury.
+    PhfwdAllocator const *alloc;
+    /// Zebrane epoki.
+    Epoch *values;
+    /// Liczba zebranych epok.
+    size_t count;
+    /// Pojemność tablicy @p values.
+    size_t capacity;
+    /// Czy udało się zebrać wszystkie epoki.
+    bool ok;
+} EpochList;
+
+/**
+ * @brief Posortowane epoki bez powtórzeń.
+ */
+typedef struct EpochMap {
+    /// Epoki (rosnąco, pierwszą jest 0).
+    Epoch const *values;
+    /// Liczba epok.
+    size_t count;
+} EpochMap;
+
+/**
+ * @brief Dopisuje niezerową epokę do listy.
+ *
+ * @param[in] epoch - epoka;
+ * @param[in, out] context - lista epok (@ref EpochList).
+ */
+static void collectEpoch(Epoch *epoch, void *context) {
+    EpochList *list = context;
+
+    if (*epoch == 0 || !list->ok) {
+        return;
+    }
+
+    if (list->count == list->capacity) {
+        size_t capacity = max(2 * list->capacity, 64);
+        Epoch *values = memRealloc(list->alloc, list->values,
+                                   capacity * sizeof(Epoch));
+        if (values == NULL) {
+            list->ok = false;
+            return;
+        }
+
+        list->values = values;
+        list->capacity = capacity;
+    }
+
+    list->values[list->count++] = *epoch;
+}
+
+/**
+ * @brief Zastępuje epokę jej pozycją w posortowanym ciągu epok.
+ *
+ * @param[in, out] epoch - epoka (występująca w ciągu);
+ * @param[in] context - posortowany ciąg epok (@ref EpochMap).
+ */
+static void remapEpoch(Epoch *epoch, void *context) {
+    EpochMap const *map = context;
+    size_t low = 0;
+    size_t high = map->count - 1;
+
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+
+        if (map->values[middle] < *epoch) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    *epoch = (Epoch) low;
+}
+
+/**
+ * @brief Porównuje epoki (dla qsort).
+ *
+ * @param[in] first - wskaźnik na pierwszą epokę;
+ * @param[in] second - wskaźnik na drugą epokę.
+ * @return Wartość ujemna, zero lub dodatnia, jeśli pierwsza epoka jest
+ *         odpowiednio mniejsza, równa lub większa od drugiej.
+ */
+static int compareEpochs(void const *first, void const *second) {
+    Epoch a = *(Epoch const *) first;
+    Epoch b = *(Epoch const *) second;
+
+    return (a > b) - (a < b);
+}
+
+/**
+ * @brief Odwiedza wszystkie epoki przechowywane przez strukturę.
+ *
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania;
+ * @param[in] visit - funkcja odwiedzająca;
+ * @param[in, out] context - kontekst przekazywany do @p visit.
+ */
+static void visitEpochs(PhoneForward *pf, EpochVisitor visit, void *context) {
+    for (Node *node = pf->rootNode; node != NULL;
+         node = nodeNextPreorder(node)) {
+        visit(&node->fwdTime, context);
+        visit(&node->deleteTime, context);
+        visit(&node->hashTime, context);
+
+        BackwardSet *set = node->backwards;
+        if (set == NULL) {
+            continue;
+        }
+
+        visit(&set->oldestTime, context);
+        for (size_t i = 0; i < set->blockCount; ++i) {
+            BackwardBlock *block = set->blocks[i];
+
+            for (size_t j = 0; j < block->count; ++j) {
+                visit(&block->items[j].fwdTime, context);
+            }
+        }
+    }
+
+    if (pf->history != NULL) {
+        historyVisitEpochs(pf->history, visit, context);
+    }
+
+    if (pf->expiry != NULL) {
+        expiryVisitEpochs(pf->expiry, visit, context);
+    }
+
+    visit(&pf->lastRemoveTime, context);
+    visit(&pf->epoch, context);
+}
+
+/**
+ * @brief Przenumerowuje epoki struktury.
+ *
+ * Przy niepowodzeniu struktura pozostaje nienaruszona.
+ *
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania.
+ * @return Wartość @p true, jeśli operacja się powiodła,
+ *         wartość @p false, gdy nie udało się alokować pamięci.
+ */
+static bool epochRebase(PhoneForward *pf) {
+    EpochList list = {pf->alloc, NULL, 0, 0, true};
+
+    visitEpochs(pf, collectEpoch, &list);
+
+    size_t *times = (list.ok ? memAlloc(pf->alloc, (list.count + 1)
+                                                   * sizeof(size_t))
+                             : NULL);
+    if (times == NULL) {
+        memFree(pf->alloc, list.values);
+        return false;
+    }
+
+    qsort(list.values, list.count, sizeof(Epoch), compareEpochs);
+
+    // Ciąg bez powtórzeń budujemy w miejscu, poprzedzając go zerem.
+    size_t count = 0;
+    for (size_t i = 0; i < list.count; ++i) {
+        if (count == 0 || list.values[count - 1] != list.values[i]) {
+            list.values[count++] = list.values[i];
+        }
+    }
+
+    times[0] = 0;
+    for (size_t i = count; i > 0; --i) {
+        list.values[i] = list.values[i - 1];
+        times[i] = epochTime(pf, list.values[i]);
+    }
+    list.values[0] = 0;
+
+    EpochMap map = {list.values, count + 1};
+    visitEpochs(pf, remapEpoch, &map);
+
+    memFree(pf->alloc, list.values);
+    memFree(pf->alloc, pf->epochTimes);
+    pf->epochTimes = times;
+    pf->epochBase = pf->epoch;
+
+    // Tablica skoków przechowuje największe czasy wyczyszczeń.
+    if (pf->jump != NULL) {
+        jumpRefresh(pf->jump, pf->rootNode, "", 0);
+    }
+
+    return true;
+}
+
+/*
+ * Przenumerowanie odbywa się dopiero wtedy, gdy epok zabrakłoby
+ * w trakcie modyfikacji.
+ */
+extern bool epochReserve(PhoneForward *pf, size_t count) {
+    if (count <= (size_t) (EPOCH_LIMIT - pf->epoch)) {
+        return true;
+    }
+
+    return epochRebase(pf) && count <= (size_t) (EPOCH_LIMIT - pf->epoch);
+}
+
+extern Epoch epochTick(PhoneForward *pf) {
+    pf->time++;
+
+    return ++pf->epoch;
+}
+
+extern size_t epochTime(PhoneForward const *pf, Epoch epoch) {
+    if (epoch >= pf->epochBase) {
+        return pf->time - (pf->epoch - epoch);
+    }
+
+    return pf->epochTimes[epoch];
+}
+
+/*
+ * Przed pierwszym przenumerowaniem epoki są równe czasom struktury;
+ * wcześniejsze czasy wyszukujemy binarnie w tablicy.
+ */
+extern Epoch epochAt(PhoneForward const *pf, size_t time) {
+    if (time >= pf->time) {
+        return pf->epoch;
+    }
+
+    size_t baseTime = epochTime(pf, pf->epochBase);
+    if (time >= baseTime) {
+        return (Epoch) (pf->epochBase + (time - baseTime));
+    }
+
+    // Liczba przenumerowanych epok o czasach nie większych niż time
+    // (co najmniej jedna, bo epoce 0 odpowiada czas 0).
+    size_t low = 0;
+    size_t high = pf->epochBase;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+
+        if (pf->epochTimes[middle] <= time) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    return (Epoch) (low - 1);
+}
+
+extern bool epochClone(PhoneForward *clone, PhoneForward const *pf) {
+    if (pf->epochTimes == NULL) {
+        return true;
+    }
+
+    size_t size = ((size_t) pf->epochBase + 1) * sizeof(size_t);
+    clone->epochTimes = memAlloc(clone->alloc, size);
+    if (clone->epochTimes == NULL) {
+        return false;
+    }
+
+    memcpy(clone->epochTimes, pf->epochTimes, size);
+
+    return true;
+}
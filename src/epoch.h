@@ -0,0 +1,102 @@
+/** @file epoch.h
+ * Interfejs czasów przechowywanych w wierzchołkach.
+ *
+ * Wierzchołki, zbiory przekierowań wstecz, historia i koło czasowe
+ * przechowują czasy jako 32-bitowe epoki. Epoka rośnie razem z czasem
+ * struktury (phfwdTime), a gdy miałaby przekroczyć @ref EPOCH_LIMIT,
+ * wszystkie przechowywane epoki są przenumerowywane kolejnymi liczbami
+ * z zachowaniem porządku. Czasy struktury odpowiadające przenumerowanym
+ * epokom zapamiętujemy w tablicy, więc czasy widoczne w interfejsie
+ * pozostają bez zmian.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __EPOCH_H__
+#define __EPOCH_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "phone_forward.h"
+
+/**
+ * Czas przechowywany w wierzchołkach (0 oznacza brak zdarzenia).
+ */
+typedef uint32_t Epoch;
+
+#ifndef EPOCH_LIMIT
+/**
+ * Największa epoka; po jej osiągnięciu epoki są przenumerowywane.
+ */
+#define EPOCH_LIMIT UINT32_MAX
+#endif
+
+/**
+ * @brief Funkcja odwiedzająca przechowywaną epokę.
+ *
+ * @param[in, out] epoch - odwiedzana epoka;
+ * @param[in, out] context - kontekst odwiedzania.
+ */
+typedef void (*EpochVisitor)(Epoch *epoch, void *context);
+
+/**
+ * @brief Zapewnia, że kolejne modyfikacje zmieszczą się w zakresie epok.
+ *
+ * W razie potrzeby przenumerowuje epoki struktury.
+ *
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania;
+ * @param[in] count - liczba kolejnych modyfikacji.
+ * @return Wartość @p true, jeśli @p count kolejnych wywołań
+ *         @ref epochTick nie przekroczy @ref EPOCH_LIMIT,
+ *         wartość @p false, gdy nie udało się alokować pamięci lub
+ *         przechowywanych epok jest zbyt wiele.
+ */
+bool epochReserve(PhoneForward *pf, size_t count);
+
+/**
+ * @brief Zwiększa czas struktury.
+ *
+ * Wymaga wcześniejszego zarezerwowania epoki (@ref epochReserve).
+ *
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania.
+ * @return Nowa epoka struktury.
+ */
+Epoch epochTick(PhoneForward *pf);
+
+/**
+ * @brief Wyznacza czas struktury odpowiadający epoce.
+ *
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania;
+ * @param[in] epoch - epoka nie większa od bieżącej.
+ * @return Czas struktury.
+ */
+size_t epochTime(PhoneForward const *pf, Epoch epoch);
+
+/**
+ * @brief Wyznacza epokę obowiązującą w danej chwili.
+ *
+ * Dla każdej przechowywanej epoki @p e zachodzi
+ * @p e <= epochAt(pf, time) wtedy i tylko wtedy, gdy
+ * epochTime(pf, e) <= time.
+ *
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania;
+ * @param[in] time - czas struktury.
+ * @return Największa epoka, której czas nie jest większy niż @p time.
+ */
+Epoch epochAt(PhoneForward const *pf, size_t time);
+
+/**
+ * @brief Kopiuje tablicę czasów przenumerowanych epok.
+ *
+ * @param[in, out] clone - kopia struktury (bez tablicy czasów);
+ * @param[in] pf - kopiowana struktura.
+ * @return Wartość @p true, jeśli operacja się powiodła,
+ *         wartość @p false, gdy nie udało się alokować pamięci.
+ */
+bool epochClone(PhoneForward *clone, PhoneForward const *pf);
+
+#endif /* __EPOCH_H__ */
@@ -0,0 +1,489 @@
+/** @file expiry.c
+ * Implementacja przekierowań z terminem wygaśnięcia.
+ *
+ * Terminy przechowywane są w hierarchicznym kole czasowym o
+ * @ref EXPIRY_LEVELS poziomach po @ref EXPIRY_SLOTS pozycji. Termin @p d
+ * przy zegarze @p now trafia na poziom grupy sześciu bitów, w której
+ * najstarszy bit @p d różni się od @p now, i na pozycję równą tej grupie
+ * bitów @p d. Wszystkie terminy poziomu @p L mają więc starsze grupy równe
+ * zegarowi, a grupę @p L większą od jego grupy.
+ *
+ * Przy przesunięciu zegara z @p old na @p now terminy poziomu @p L mijają
+ * w całości, jeśli starsze grupy @p now i @p old się różnią. W przeciwnym
+ * wypadku mijają terminy pozycji mniejszych od grupy @p L zegara @p now,
+ * terminy z pozycji równej tej grupie trafiają na niższe poziomy (lub
+ * mijają), a pozostałe zostają na miejscu. Poziomy przeglądamy od
+ * najniższego, więc przeniesione terminy nie są sprawdzane ponownie,
+ * a niepuste pozycje wyznaczają maski bitowe poziomów. Każdy termin jest
+ * przenoszony najwyżej @ref EXPIRY_LEVELS razy, a przesunięcie zegara
+ * kosztuje O(liczba poziomów + liczba przeniesionych i minionych terminów).
+ *
+ * Zastąpienie lub usunięcie przekierowania nie usuwa jego terminu: termin
+ * pamięta czas dodania przekierowania i po upływie jest pomijany, jeśli
+ * przekierowanie wierzchołka zostało w międzyczasie zmienione.
+ *
+ * Wierzchołek zlicza odwołujące się do niego terminy w @p expiryPins, by
+ * kompaktowanie, które nie może przepiąć terminów, pozostawiało go na
+ * miejscu bez przeglądania koła.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "phone_forward_expiry.h"
+#include "expiry.h"
+#include "node.h"
+#include "utils.h"
+
+/// Liczba bitów terminu wyznaczających pozycję na jednym poziomie.
+#define EXPIRY_BITS 6
+
+/// Liczba pozycji jednego poziomu.
+#define EXPIRY_SLOTS (1 << EXPIRY_BITS)
+
+/// Liczba poziomów (obejmujących wszystkie bity terminu).
+#define EXPIRY_LEVELS \
+    ((sizeof(size_t) * CHAR_BIT + EXPIRY_BITS - 1) / EXPIRY_BITS)
+
+/// Oznaczenie braku terminu na liście.
+#define EXPIRY_NONE UINT32_MAX
+
+/**
+ * @brief Termin wygaśnięcia przekierowania.
+ */
+typedef struct ExpiryTimer {
+    /// Wierzchołek, z którego jest przekierowanie.
+    Node *node;
+    /// Czas dodania przekierowania.
+    Epoch fwdTime;
+    /// Termin wygaśnięcia.
+    size_t deadline;
+    /// Kolejny termin na liście (lub @ref EXPIRY_NONE).
+    uint32_t next;
+} ExpiryTimer;
+
+/**
+ * Koło czasowe terminów wygaśnięcia.
+ */
+struct ExpiryWheel {
+    /// Alokator koła.
+    PhfwdAllocator const *alloc;
+    /// Zegar.
+    size_t now;
+    /// Maski niepustych pozycji kolejnych poziomów.
+    uint64_t occupied[EXPIRY_LEVELS];
+    /// Pierwsze terminy list kolejnych pozycji.
+    uint32_t heads[EXPIRY_LEVELS][EXPIRY_SLOTS];
+    /// Terminy (zajęte i wolne).
+    ExpiryTimer *timers;
+    /// Liczba użytych elementów tablicy @p timers.
+    uint32_t used;
+    /// Pojemność tablicy @p timers.
+    uint32_t capacity;
+    /// Pierwszy wolny termin (lub @ref EXPIRY_NONE).
+    uint32_t freeList;
+    /// Liczba terminów w kole.
+    size_t pending;
+};
+
+/**
+ * @brief Tworzy puste koło czasowe.
+ *
+ * @param[in] alloc - alokator.
+ * @return Wskaźnik na koło lub NULL, gdy nie udało się alokować pamięci.
+ */
+static ExpiryWheel *expiryNew(PhfwdAllocator const *alloc) {
+    ExpiryWheel *wheel = memAlloc(alloc, sizeof(ExpiryWheel));
+    if (wheel == NULL) {
+        return NULL;
+    }
+
+    wheel->alloc = alloc;
+    wheel->now = 0;
+    wheel->timers = NULL;
+    wheel->used = 0;
+    wheel->capacity = 0;
+    wheel->freeList = EXPIRY_NONE;
+    wheel->pending = 0;
+
+    for (size_t level = 0; level < EXPIRY_LEVELS; ++level) {
+        wheel->occupied[level] = 0;
+
+        for (size_t slot = 0; slot < EXPIRY_SLOTS; ++slot) {
+            wheel->heads[level][slot] = EXPIRY_NONE;
+        }
+    }
+
+    return wheel;
+}
+
+/*
+ * Terminy (również wolne) zachowują swoje indeksy, więc listy pozycji
+ * i lista wolnych terminów kopiowane są bez zmian.
+ */
+extern ExpiryWheel *expiryClone(ExpiryWheel const *wheel, NodeMap const *map) {
+    ExpiryWheel *copy = memAlloc(wheel->alloc, sizeof(ExpiryWheel));
+    if (copy == NULL) {
+        return NULL;
+    }
+
+    *copy = *wheel;
+    copy->timers = NULL;
+
+    if (wheel->capacity > 0) {
+        copy->timers = memAlloc(wheel->alloc,
+                                wheel->capacity * sizeof(ExpiryTimer));
+        if (copy->timers == NULL) {
+            memFree(wheel->alloc, copy);
+            return NULL;
+        }
+
+        memcpy(copy->timers, wheel->timers, wheel->used * sizeof(ExpiryTimer));
+    }
+
+    for (uint32_t i = 0; i < wheel->used; ++i) {
+        copy->timers[i].node = nodeMapFind(map, wheel->timers[i].node);
+    }
+
+    return copy;
+}
+
+extern void expiryDelete(ExpiryWheel *wheel) {
+    if (wheel == NULL) {
+        return;
+    }
+
+    memFree(wheel->alloc, wheel->timers);
+    memFree(wheel->alloc, wheel);
+}
+
+/*
+ * Odwiedzamy również wolne terminy (ich czasy nie są już używane).
+ */
+extern void expiryVisitEpochs(ExpiryWheel *wheel, EpochVisitor visit,
+                              void *context) {
+    for (uint32_t i = 0; i < wheel->used; ++i) {
+        visit(&wheel->timers[i].fwdTime, context);
+    }
+}
+
+/**
+ * @brief Zapewnia miejsce na kolejny termin.
+ *
+ * @param[in, out] wheel - koło czasowe.
+ * @return Wartość @p true, jeśli jest wolny termin, wartość @p false,
+ *         gdy nie udało się alokować pamięci.
+ */
+static bool expiryReserve(ExpiryWheel *wheel) {
+    if (wheel->freeList != EXPIRY_NONE || wheel->used < wheel->capacity) {
+        return true;
+    }
+
+    if (wheel->capacity >= EXPIRY_NONE / 2) {
+        return false;
+    }
+
+    uint32_t capacity = (wheel->capacity == 0 ? 64 : 2 * wheel->capacity);
+    ExpiryTimer *timers = memRealloc(wheel->alloc, wheel->timers,
+                                     capacity * sizeof(ExpiryTimer));
+    if (timers == NULL) {
+        return false;
+    }
+
+    wheel->timers = timers;
+    wheel->capacity = capacity;
+
+    return true;
+}
+
+/**
+ * @brief Umieszcza termin na pozycji wyznaczonej względem zegara.
+ *
+ * @param[in, out] wheel - koło czasowe;
+ * @param[in] index - indeks terminu późniejszego niż zegar.
+ */
+static void expiryPlace(ExpiryWheel *wheel, uint32_t index) {
+    ExpiryTimer *timer = &wheel->timers[index];
+    uint64_t diff = (uint64_t) (timer->deadline ^ wheel->now);
+    size_t level = (size_t) (63 - __builtin_clzll(diff)) / EXPIRY_BITS;
+    size_t slot = (timer->deadline >> (level * EXPIRY_BITS))
+                  & (EXPIRY_SLOTS - 1);
+
+    timer->next = wheel->heads[level][slot];
+    wheel->heads[level][slot] = index;
+    wheel->occupied[level] |= (uint64_t) 1 << slot;
+}
+
+/**
+ * @brief Dodaje termin do koła (po udanym @ref expiryReserve).
+ *
+ * @param[in, out] wheel - koło czasowe;
+ * @param[in] node - wierzchołek, z którego jest przekierowanie;
+ * @param[in] deadline - termin późniejszy niż zegar.
+ */
+static void expiryInsert(ExpiryWheel *wheel, Node *node, size_t deadline) {
+    uint32_t index = wheel->freeList;
+
+    if (index != EXPIRY_NONE) {
+        wheel->freeList = wheel->timers[index].next;
+    }
+    else {
+        index = wheel->used++;
+    }
+
+    if (node->expiryPins < NODE_MAX_PINS) {
+        node->expiryPins++;
+    }
+
+    wheel->timers[index].node = node;
+    wheel->timers[index].fwdTime = node->fwdTime;
+    wheel->timers[index].deadline = deadline;
+    expiryPlace(wheel, index);
+    wheel->pending++;
+}
+
+/**
+ * @brief Wyznacza starsze grupy bitów zegara ponad danym poziomem.
+ *
+ * @param[in] now - zegar;
+ * @param[in] level - poziom.
+ * @return Bity zegara starsze od grupy poziomu @p level.
+ */
+static size_t expiryHigh(size_t now, size_t level) {
+    size_t shift = (level + 1) * EXPIRY_BITS;
+
+    return (shift >= sizeof(size_t) * CHAR_BIT ? 0 : now >> shift);
+}
+
+/**
+ * @brief Przesuwa zegar koła, zbierając minione terminy.
+ *
+ * @param[in, out] wheel - koło czasowe;
+ * @param[in] now - nowy zegar (późniejszy niż dotychczasowy).
+ * @return Pierwszy z minionych terminów połączonych w listę
+ *         (lub @ref EXPIRY_NONE).
+ */
+static uint32_t expiryAdvance(ExpiryWheel *wheel, size_t now) {
+    size_t old = wheel->now;
+    uint32_t expired = EXPIRY_NONE;
+
+    wheel->now = now;
+
+    for (size_t level = 0; level < EXPIRY_LEVELS; ++level) {
+        size_t shift = level * EXPIRY_BITS;
+        size_t digit = (now >> shift) & (EXPIRY_SLOTS - 1);
+        uint64_t taken = wheel->occupied[level];
+
+        if (expiryHigh(old, level) == expiryHigh(now, level)) {
+            taken &= (digit == EXPIRY_SLOTS - 1 ?
+                      UINT64_MAX : ((uint64_t) 2 << digit) - 1);
+        }
+
+        wheel->occupied[level] &= ~taken;
+
+        while (taken != 0) {
+            size_t slot = (size_t) __builtin_ctzll(taken);
+            uint32_t index = wheel->heads[level][slot];
+
+            taken &= taken - 1;
+            wheel->heads[level][slot] = EXPIRY_NONE;
+
+            while (index != EXPIRY_NONE) {
+                ExpiryTimer *timer = &wheel->timers[index];
+                uint32_t next = timer->next;
+
+                if (timer->deadline <= now) {
+                    timer->next = expired;
+                    expired = index;
+                }
+                else {
+                    expiryPlace(wheel, index);
+                }
+
+                index = next;
+            }
+        }
+    }
+
+    return expired;
+}
+
+/**
+ * @brief Zwalnia termin.
+ *
+ * Wolny termin nie odwołuje się do wierzchołka.
+ *
+ * @param[in, out] wheel - koło czasowe;
+ * @param[in] index - indeks terminu wyjętego z koła.
+ */
+static void expiryRelease(ExpiryWheel *wheel, uint32_t index) {
+    Node *node = wheel->timers[index].node;
+
+    if (node->expiryPins < NODE_MAX_PINS) {
+        node->expiryPins--;
+    }
+
+    wheel->timers[index].node = NULL;
+    wheel->timers[index].next = wheel->freeList;
+    wheel->freeList = index;
+    wheel->pending--;
+}
+
+/**
+ * @brief Wyszukuje istniejący wierzchołek numeru.
+ *
+ * @param[in] root - korzeń drzewa;
+ * @param[in] num - poprawny numer.
+ * @return Wierzchołek numeru lub NULL, jeśli go nie ma.
+ */
+static Node *findNode(Node *root, char const *num) {
+    Node *node = root;
+
+    for (size_t i = 0; num[i] != '\0' && node != NULL; ++i) {
+        node = node->children[toInt(num[i])];
+    }
+
+    return node;
+}
+
+/*
+ * Odpowiada części phfwdAdd wykonywanej po zmianie przekierowania.
+ */
+extern void expiryRetire(PhoneForward *pf, Node *node, char const *num) {
+    Node *target = node->fwd;
+    size_t length = node->depth;
+
+    if (pf->lpm != NULL && length <= LPM_MAX_DIGITS) {
+        lpmErase(pf->lpm, num, length);
+    }
+
+    bwdSetErase(pf->alloc, &target->backwards, node);
+
+    Epoch epoch = epochTick(pf);
+    diffUpdatePath(pf->rootNode, num, length,
+                   -diffFwdHash(num, length, target), epoch);
+
+    if (pf->history != NULL) {
+        historyRecordVersion(pf->history, node, target, node->fwdTime,
+                             epoch);
+    }
+
+    // Ograniczenia fwdDepthBelow pozostają zawyżone, co jest bezpieczne.
+    node->fwd = NULL;
+
+    if (pf->cache != NULL) {
+        cacheInvalidate(pf->cache, num, length);
+    }
+
+    if (pf->resolve != NULL) {
+        resolveInvalidate(pf->resolve, num, length);
+    }
+
+    if (pf->changeLog != NULL) {
+        changeLogAppendExpiry(pf->changeLog, pf->time, num, length);
+    }
+
+    if (pf->jump != NULL) {
+        jumpRefresh(pf->jump, pf->rootNode, num, length);
+    }
+}
+
+/*
+ * Miejsce na termin rezerwujemy przed dodaniem przekierowania, więc po
+ * udanym dodaniu wstawienie terminu nie może się już nie udać.
+ */
+extern bool phfwdAddWithExpiry(PhoneForward *pf, char const *num1,
+                               char const *num2, size_t deadline) {
+    if (pf == NULL) {
+        return false;
+    }
+
+    if (pf->expiry == NULL) {
+        pf->expiry = expiryNew(pf->alloc);
+        if (pf->expiry == NULL) {
+            return false;
+        }
+    }
+
+    if (deadline <= pf->expiry->now || !expiryReserve(pf->expiry)
+        || !phfwdAdd(pf, num1, num2)) {
+        return false;
+    }
+
+    expiryInsert(pf->expiry, findNode(pf->rootNode, num1), deadline);
+
+    return true;
+}
+
+/*
+ * Przekierowanie wygasa, jeśli od dodania terminu nie zostało zastąpione
+ * ani usunięte; pozostałe terminy są jedynie zwalniane.
+ */
+extern bool phfwdAdvanceClock(PhoneForward *pf, size_t now) {
+    if (pf == NULL) {
+        return false;
+    }
+
+    if (pf->expiry == NULL) {
+        pf->expiry = expiryNew(pf->alloc);
+        if (pf->expiry == NULL) {
+            return false;
+        }
+    }
+
+    ExpiryWheel *wheel = pf->expiry;
+    if (now < wheel->now) {
+        return false;
+    }
+
+    if (now == wheel->now) {
+        return true;
+    }
+
+    if (wheel->pending == 0) {
+        wheel->now = now;
+        return true;
+    }
+
+    // Epoki rezerwujemy dla wszystkich terminów, które mogą wygasnąć.
+    if (!epochReserve(pf, wheel->pending)) {
+        return false;
+    }
+
+    // Bufor na numer dowolnego wierzchołka, z którego jest przekierowanie.
+    char *num = memAlloc(pf->alloc, pf->maxFwdDepth + 1);
+    if (num == NULL) {
+        return false;
+    }
+
+    uint32_t index = expiryAdvance(wheel, now);
+
+    while (index != EXPIRY_NONE) {
+        ExpiryTimer const *timer = &wheel->timers[index];
+        uint32_t next = timer->next;
+        Node *node = timer->node;
+        Backward current = {node, timer->fwdTime};
+
+        if (node->fwd != NULL && node->fwdTime == timer->fwdTime
+            && isBackwardLive(&current)) {
+            num[nodeWrite(node, num)] = '\0';
+            expiryRetire(pf, node, num);
+        }
+
+        expiryRelease(wheel, index);
+        index = next;
+    }
+
+    memFree(pf->alloc, num);
+
+    return true;
+}
+
+extern size_t phfwdClock(PhoneForward const *pf) {
+    return (pf == NULL || pf->expiry == NULL ? 0 : pf->expiry->now);
+}
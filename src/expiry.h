@@ -0,0 +1,72 @@
+/** @file expiry.h
+ * Interfejs wygasania przekierowań: hierarchicznego koła czasowego
+ * terminów oraz wycofywania pojedynczego przekierowania.
+ *
+ * Terminy wyrażone są w jednostkach zegara ustawianego przez
+ * phfwdAdvanceClock, niezależnego od czasu logicznego struktury.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __EXPIRY_H__
+#define __EXPIRY_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "phone_forward.h"
+#include "allocator.h"
+#include "epoch.h"
+
+struct ExpiryWheel;
+/**
+ * Definiuje koło czasowe terminów wygaśnięcia przekierowań.
+ */
+typedef struct ExpiryWheel ExpiryWheel;
+
+struct NodeMap;
+
+/**
+ * @brief Kopiuje koło czasowe dla kopii drzewa.
+ *
+ * @param[in] wheel - kopiowane koło;
+ * @param[in] map - odwzorowanie wierzchołków drzewa na wierzchołki kopii.
+ * @return Wskaźnik na kopię lub NULL, gdy nie udało się alokować pamięci.
+ */
+ExpiryWheel *expiryClone(ExpiryWheel const *wheel, struct NodeMap const *map);
+
+/**
+ * @brief Usuwa koło czasowe.
+ *
+ * @param[in] wheel - usuwane koło (lub NULL).
+ */
+void expiryDelete(ExpiryWheel *wheel);
+
+/**
+ * @brief Odwiedza czasy dodania przekierowań zapamiętane w terminach.
+ *
+ * @param[in, out] wheel - koło czasowe;
+ * @param[in] visit - funkcja odwiedzająca;
+ * @param[in, out] context - kontekst przekazywany do @p visit.
+ */
+void expiryVisitEpochs(ExpiryWheel *wheel, EpochVisitor visit, void *context);
+
+/**
+ * @brief Wycofuje aktualne przekierowanie z wierzchołka.
+ *
+ * W odróżnieniu od phfwdRemove nie dotyczy przekierowań z poddrzewa
+ * wierzchołka. Przekierowanie jest usuwane ze zbioru przekierowań wstecz
+ * swojego celu i ze wszystkich pomocniczych struktur, a czas struktury
+ * zwiększa się o jeden (epoka musi być wcześniej zarezerwowana, zob.
+ * @ref epochReserve). Nie alokuje pamięci poza historią przekierowań
+ * (zob. @ref historyRecordVersion).
+ *
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania;
+ * @param[in, out] node - wierzchołek z aktualnym przekierowaniem;
+ * @param[in] num - numer wierzchołka (@p node->depth znaków).
+ */
+void expiryRetire(PhoneForward *pf, Node *node, char const *num);
+
+#endif /* __EXPIRY_H__ */
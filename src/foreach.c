@@ -0,0 +1,247 @@
+/** @file foreach.c
+ * Implementacja przeglądania wszystkich aktualnych przekierowań.
+ *
+ * Drzewo przechodzimy w porządku preorder (synowie w kolejności
+ * @ref toInt), wracając do ojca po wskaźniku @p father, więc przejście nie
+ * potrzebuje stosu wierzchołków. Na bieżącej ścieżce pamiętamy jedynie
+ * cyfry numeru i największe czasy wyczyszczenia przodków (po jednej
+ * pozycji na poziom); poddrzewa bez aktualnych przekierowań pomijamy
+ * (zob. @p fwdDepthBelow).
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include "phone_forward.h"
+#include "phone_forward_bulk.h"
+#include "node.h"
+#include "utils.h"
+
+/**
+ * Największa długość numerów, dla której bufory przejścia mieszczą się
+ * na stosie; dłuższe numery wymagają alokacji buforów.
+ */
+#define FOREACH_STACK_DIGITS 64
+
+/**
+ * @brief Stan przejścia.
+ */
+typedef struct ForEachState {
+    /// Alokator struktury.
+    PhfwdAllocator const *alloc;
+    /// Cyfry numeru bieżącego wierzchołka.
+    char *key;
+    /// Największe czasy wyczyszczenia na ścieżce; pozycja @p d dotyczy
+    /// przodków bieżącego wierzchołka z głębokości co najwyżej @p d.
+    size_t *maxDelete;
+    /// Numer, na który przekierowany był ostatnio przekazany numer.
+    char *target;
+    /// Pojemność bufora @p target.
+    size_t targetCapacity;
+    /// Wierzchołek numeru zapisanego w @p target (NULL, jeśli żaden).
+    Node const *lastTarget;
+    /// Bufor @p target na stosie (zwalniamy jedynie inne bufory).
+    char *stackTarget;
+} ForEachState;
+
+/**
+ * @brief Zapisuje numer docelowy przekierowania.
+ *
+ * Kolejne przekierowania często prowadzą do tego samego numeru, który
+ * zapisujemy wtedy tylko raz.
+ *
+ * @param[in, out] state - stan przejścia;
+ * @param[in] target - wierzchołek numeru docelowego.
+ * @return Wartość @p true, jeśli operacja się powiodła,
+ *         wartość @p false, gdy nie udało się alokować pamięci.
+ */
+static bool writeTarget(ForEachState *state, Node const *target) {
+    if (target == state->lastTarget) {
+        return true;
+    }
+
+    if (target->depth >= state->targetCapacity) {
+        char *buffer = memAlloc(state->alloc, 2 * target->depth);
+        if (buffer == NULL) {
+            return false;
+        }
+
+        if (state->target != state->stackTarget) {
+            memFree(state->alloc, state->target);
+        }
+
+        state->target = buffer;
+        state->targetCapacity = 2 * target->depth;
+    }
+
+    state->target[nodeWrite(target, state->target)] = '\0';
+    state->lastTarget = target;
+
+    return true;
+}
+
+/**
+ * @brief Przekazuje przekierowanie z wierzchołka, jeśli jest aktualne.
+ *
+ * @param[in, out] state - stan przejścia (z uzupełnioną ścieżką do
+ *                         wierzchołka);
+ * @param[in] node - wierzchołek;
+ * @param[in] callback - funkcja otrzymująca przekierowania;
+ * @param[in] context - kontekst przekazywany do @p callback;
+ * @param[out] ok - ustawiane na @p false, gdy nie udało się alokować
+ *                  pamięci.
+ * @return Wartość @p false, jeśli przejście należy przerwać,
+ *         wartość @p true w przeciwnym wypadku.
+ */
+static bool visitNode(ForEachState *state, Node const *node,
+                      PhfwdForwardCallback callback, void *context,
+                      bool *ok) {
+    if (node->fwd == NULL || node->fwdTime <= state->maxDelete[node->depth]) {
+        return true;
+    }
+
+    if (!writeTarget(state, node->fwd)) {
+        *ok = false;
+        return false;
+    }
+
+    state->key[node->depth] = '\0';
+
+    return callback(context, state->key, state->target);
+}
+
+/**
+ * @brief Wyznacza kolejnego syna z aktualnymi przekierowaniami w poddrzewie.
+ *
+ * @param[in] node - wierzchołek;
+ * @param[in] first - cyfra, od której szukamy.
+ * @return Syn lub NULL, jeśli takiego nie ma.
+ */
+static Node const *nextLiveChild(Node const *node, int first) {
+    if (node->fwdDepthBelow <= node->depth) {
+        return NULL;
+    }
+
+    for (int digit = first; digit < 12; ++digit) {
+        Node const *child = node->children[digit];
+
+        if (child != NULL && child->fwdDepthBelow >= child->depth) {
+            return child;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Przechodzi poddrzewo wierzchołka.
+ *
+ * @param[in, out] state - stan przejścia (z uzupełnioną ścieżką do
+ *                         @p start);
+ * @param[in] start - korzeń przechodzonego poddrzewa;
+ * @param[in] callback - funkcja otrzymująca przekierowania;
+ * @param[in] context - kontekst przekazywany do @p callback.
+ * @return Wartość @p true, jeśli przekazano wszystkie przekierowania,
+ *         wartość @p false, jeśli nie udało się alokować pamięci lub
+ *         @p callback przerwał przejście.
+ */
+static bool traverse(ForEachState *state, Node const *start,
+                     PhfwdForwardCallback callback, void *context) {
+    bool ok = true;
+    Node const *node = start;
+    int first = 0;
+
+    if (!visitNode(state, node, callback, context, &ok)) {
+        return false;
+    }
+
+    while (true) {
+        Node const *child = nextLiveChild(node, first);
+
+        if (child != NULL) {
+            size_t depth = child->depth;
+
+            state->key[depth - 1] = child->digit;
+            state->maxDelete[depth] = max(state->maxDelete[depth - 1],
+                                          child->deleteTime);
+
+            if (!visitNode(state, child, callback, context, &ok)) {
+                return false;
+            }
+
+            node = child;
+            first = 0;
+        }
+        else if (node == start) {
+            return ok;
+        }
+        else {
+            first = toInt(node->digit) + 1;
+            node = node->father;
+        }
+    }
+}
+
+/*
+ * Bufory mieszczą się na stosie, jeśli przekierowania wychodzą z numerów
+ * o co najwyżej @ref FOREACH_STACK_DIGITS cyfrach i prowadzą do takich
+ * numerów.
+ */
+extern bool phfwdForEach(PhoneForward const *pf, char const *prefix,
+                         PhfwdForwardCallback callback, void *context) {
+    if (pf == NULL || prefix == NULL || callback == NULL
+        || (*prefix != '\0' && !ifNumOk(prefix))) {
+        return false;
+    }
+
+    size_t length = stringLength(prefix);
+    if (length > pf->maxFwdDepth) {
+        return true;
+    }
+
+    char stackKey[FOREACH_STACK_DIGITS + 1];
+    size_t stackMaxDelete[FOREACH_STACK_DIGITS + 1];
+    char stackTarget[FOREACH_STACK_DIGITS + 1];
+
+    ForEachState state = {pf->alloc, stackKey, stackMaxDelete, stackTarget,
+                          FOREACH_STACK_DIGITS + 1, NULL, stackTarget};
+
+    if (pf->maxFwdDepth > FOREACH_STACK_DIGITS) {
+        state.key = memAlloc(pf->alloc, pf->maxFwdDepth + 1);
+        state.maxDelete = memCalloc(pf->alloc, pf->maxFwdDepth + 1,
+                                    sizeof(size_t));
+
+        if (state.key == NULL || state.maxDelete == NULL) {
+            memFree(pf->alloc, state.key);
+            memFree(pf->alloc, state.maxDelete);
+            return false;
+        }
+    }
+
+    Node const *node = pf->rootNode;
+    state.maxDelete[0] = node->deleteTime;
+
+    for (size_t i = 0; i < length && node != NULL; ++i) {
+        node = node->children[toInt(prefix[i])];
+        if (node != NULL) {
+            state.key[i] = prefix[i];
+            state.maxDelete[i + 1] = max(state.maxDelete[i],
+                                         node->deleteTime);
+        }
+    }
+
+    bool result = (node == NULL || node->fwdDepthBelow < node->depth
+                   || traverse(&state, node, callback, context));
+
+    if (state.key != stackKey) {
+        memFree(pf->alloc, state.key);
+        memFree(pf->alloc, state.maxDelete);
+    }
+
+    if (state.target != stackTarget) {
+        memFree(pf->alloc, state.target);
+    }
+
+    return result;
+}
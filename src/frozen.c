@@ -0,0 +1,857 @@
+/** @file frozen.c
+ * Implementacja zamrożonej, niemodyfikowalnej postaci struktury
+ * przechowującej przekierowania.
+ *
+ * Kluczami są numery wszystkich aktualnych źródeł i celów przekierowań,
+ * posortowane i ponumerowane od zera. Drzewo TRIE kluczy zapisane jest
+ * w tablicach w porządku BFS: synowie wierzchołka zajmują kolejne pozycje,
+ * więc wierzchołek przechowuje jedynie maskę cyfr swoich synów i indeks
+ * pierwszego syna, a indeks syna o cyfrze @p d to indeks pierwszego syna
+ * powiększony o liczbę mniejszych cyfr w masce. Przekierowania wstecz
+ * zapisane są w jednej tablicy źródeł posortowanej według celów
+ * (i w obrębie celu według numerów źródeł).
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "phone_forward.h"
+#include "phone_forward_frozen.h"
+#include "node.h"
+#include "phnum.h"
+#include "utils.h"
+
+/**
+ * Oznaczenie braku klucza lub przekierowania.
+ */
+#define FROZEN_NONE UINT32_MAX
+
+/**
+ * @brief Wierzchołek zamrożonego drzewa TRIE.
+ */
+typedef struct FrozenNode {
+    /// Indeks pierwszego syna.
+    uint32_t firstChild;
+    /// Klucz reprezentowany przez wierzchołek (lub @ref FROZEN_NONE).
+    uint32_t key;
+    /// Maska cyfr synów.
+    uint16_t childMask;
+} FrozenNode;
+
+/**
+ * Zamrożona postać struktury przechowującej przekierowania.
+ */
+struct PhfwdFrozen {
+    /// Alokator struktury i zwracanych wyników.
+    PhfwdAllocator const *alloc;
+
+    /// Liczba wierzchołków drzewa.
+    size_t nodeCount;
+    /// Wierzchołki drzewa w porządku BFS.
+    FrozenNode *nodes;
+
+    /// Liczba kluczy.
+    size_t keyCount;
+    /// Cele przekierowań z kluczy (lub @ref FROZEN_NONE).
+    uint32_t *fwdTargets;
+    /// Początki przedziałów tablicy @p bwdSources (@p keyCount + 1 pozycji).
+    uint32_t *bwdOffsets;
+    /// Źródła przekierowań na kolejne klucze.
+    uint32_t *bwdSources;
+    /// Początki numerów kluczy w tablicy @p digits
+    /// (@p keyCount + 1 pozycji).
+    uint32_t *keyOffsets;
+    /// Cyfry wszystkich kluczy.
+    char *digits;
+};
+
+/**
+ * @brief Klucze zamrażanej struktury.
+ */
+typedef struct FrozenKeys {
+    /// Wierzchołki kluczy w porządku leksykograficznym.
+    Node const **nodes;
+    /// Cele aktualnych przekierowań z kluczy (NULL, jeśli ich nie ma).
+    Node const **targets;
+    /// Liczba kluczy.
+    size_t count;
+    /// Pojemność tablic @p nodes i @p targets.
+    size_t capacity;
+} FrozenKeys;
+
+/**
+ * @brief Sprawdza, czy na wierzchołek istnieje aktualne przekierowanie.
+ *
+ * @param[in] set - zbiór przekierowań wstecz wierzchołka.
+ * @return Wartość @p true jeśli zbiór zawiera aktualne przekierowanie,
+ *         wartość @p false w przeciwnym wypadku.
+ */
+static bool hasLiveBackward(BackwardSet const *set) {
+    BwdSetPosition position = {0, 0};
+    Backward const *bwd;
+
+    while ((bwd = bwdSetGet(set, position)) != NULL) {
+        if (isBackwardLive(bwd)) {
+            return true;
+        }
+
+        bwdSetNext(set, &position);
+    }
+
+    return false;
+}
+
+/**
+ * @brief Dopisuje klucz.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in, out] keys - klucze;
+ * @param[in] node - wierzchołek klucza;
+ * @param[in] target - cel przekierowania z klucza lub NULL.
+ * @return Wartość @p true jeśli operacja się powiodła,
+ *         wartość @p false jeśli nie udało się alokować pamięci.
+ */
+static bool frozenKeysAppend(PhfwdAllocator const *alloc, FrozenKeys *keys,
+                             Node const *node, Node const *target) {
+    if (keys->count == keys->capacity) {
+        size_t capacity = (keys->capacity == 0 ? 8 : 2 * keys->capacity);
+        Node const **nodes = memRealloc(alloc, keys->nodes,
+                                        capacity * sizeof(Node const *));
+        if (nodes == NULL) {
+            return false;
+        }
+
+        keys->nodes = nodes;
+
+        Node const **targets = memRealloc(alloc, keys->targets,
+                                          capacity * sizeof(Node const *));
+        if (targets == NULL) {
+            return false;
+        }
+
+        keys->targets = targets;
+        keys->capacity = capacity;
+    }
+
+    keys->nodes[keys->count] = node;
+    keys->targets[keys->count] = target;
+    keys->count++;
+
+    return true;
+}
+
+/**
+ * @brief Zbiera klucze: aktualne źródła i cele przekierowań.
+ *
+ * Drzewo przeglądane jest w porządku preorder, więc klucze są zbierane
+ * już posortowane.
+ *
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania;
+ * @param[out] keys - zebrane klucze (początkowo puste).
+ * @return Wartość @p true jeśli operacja się powiodła,
+ *         wartość @p false jeśli nie udało się alokować pamięci.
+ */
+static bool collectKeys(PhoneForward const *pf, FrozenKeys *keys) {
+    PhfwdAllocator const *alloc = pf->alloc;
+    size_t depthCapacity = 8;
+    // Największe czasy wyczyszczenia na trasie od korzenia.
+    size_t *maxDelete = memAlloc(alloc, depthCapacity * sizeof(size_t));
+    if (maxDelete == NULL) {
+        return false;
+    }
+
+    Node const *node = pf->rootNode;
+    maxDelete[0] = node->deleteTime;
+
+    while ((node = nodeNextPreorder(node)) != NULL) {
+        size_t depth = node->depth;
+
+        if (depth == depthCapacity) {
+            size_t *grown = memRealloc(alloc, maxDelete,
+                                       2 * depthCapacity * sizeof(size_t));
+            if (grown == NULL) {
+                memFree(alloc, maxDelete);
+                return false;
+            }
+
+            maxDelete = grown;
+            depthCapacity *= 2;
+        }
+
+        maxDelete[depth] = max(maxDelete[depth - 1], node->deleteTime);
+
+        bool isSource = (node->fwd != NULL
+                         && node->fwdTime > maxDelete[depth]);
+        bool isTarget = (node->backwards != NULL
+                         && hasLiveBackward(node->backwards));
+
+        if ((isSource || isTarget)
+            && !frozenKeysAppend(alloc, keys, node,
+                                 isSource ? node->fwd : NULL)) {
+            memFree(alloc, maxDelete);
+            return false;
+        }
+    }
+
+    memFree(alloc, maxDelete);
+
+    return true;
+}
+
+/**
+ * @brief Funkcja haszująca wskaźnika na wierzchołek.
+ *
+ * @param[in] node - wierzchołek;
+ * @param[in] mask - maska rozmiaru tablicy.
+ * @return Indeks w tablicy haszującej.
+ */
+static size_t nodeHash(Node const *node, size_t mask) {
+    uint64_t hash = (uint64_t) (uintptr_t) node;
+
+    hash ^= hash >> 17;
+    hash *= 0x9e3779b97f4a7c15ull;
+
+    return (size_t) (hash >> 32) & mask;
+}
+
+/**
+ * @brief Alokuje tablicę (co najmniej jednoelementową).
+ *
+ * @param[in] alloc - alokator;
+ * @param[in] count - liczba elementów;
+ * @param[in] size - rozmiar elementu.
+ * @return Wskaźnik na tablicę lub NULL, gdy nie udało się alokować pamięci.
+ */
+static void *frozenArray(PhfwdAllocator const *alloc,
+                         size_t count, size_t size) {
+    return memAlloc(alloc, max(count, 1) * size);
+}
+
+/**
+ * @brief Wyznacza indeksy celów przekierowań.
+ *
+ * Indeks klucza wierzchołka docelowego wyznaczany jest za pomocą
+ * tymczasowej tablicy haszującej z adresowaniem otwartym.
+ *
+ * @param[in, out] frozen - budowana struktura;
+ * @param[in] keys - klucze.
+ * @return Wartość @p true jeśli operacja się powiodła,
+ *         wartość @p false jeśli nie udało się alokować pamięci.
+ */
+static bool frozenResolveTargets(PhfwdFrozen *frozen,
+                                 FrozenKeys const *keys) {
+    size_t size = 16;
+    while (size < 2 * keys->count) {
+        size *= 2;
+    }
+
+    uint32_t *slots = memAlloc(frozen->alloc, size * sizeof(uint32_t));
+    if (slots == NULL) {
+        return false;
+    }
+
+    for (size_t i = 0; i < size; ++i) {
+        slots[i] = FROZEN_NONE;
+    }
+
+    for (size_t i = 0; i < keys->count; ++i) {
+        size_t slot = nodeHash(keys->nodes[i], size - 1);
+
+        while (slots[slot] != FROZEN_NONE) {
+            slot = (slot + 1) & (size - 1);
+        }
+
+        slots[slot] = i;
+    }
+
+    for (size_t i = 0; i < keys->count; ++i) {
+        Node const *target = keys->targets[i];
+
+        frozen->fwdTargets[i] = FROZEN_NONE;
+        if (target == NULL) {
+            continue;
+        }
+
+        size_t slot = nodeHash(target, size - 1);
+        while (keys->nodes[slots[slot]] != target) {
+            slot = (slot + 1) & (size - 1);
+        }
+
+        frozen->fwdTargets[i] = slots[slot];
+    }
+
+    memFree(frozen->alloc, slots);
+
+    return true;
+}
+
+/**
+ * @brief Wypełnia tablice kluczy i przekierowań.
+ *
+ * @param[in, out] frozen - budowana struktura;
+ * @param[in] keys - klucze.
+ * @return Wartość @p true jeśli operacja się powiodła,
+ *         wartość @p false jeśli nie udało się alokować pamięci
+ *         lub struktura jest zbyt duża.
+ */
+static bool frozenBuildKeys(PhfwdFrozen *frozen, FrozenKeys const *keys) {
+    PhfwdAllocator const *alloc = frozen->alloc;
+    size_t keyCount = keys->count;
+    size_t totalDigits = 0;
+
+    for (size_t i = 0; i < keyCount; ++i) {
+        totalDigits += keys->nodes[i]->depth;
+    }
+
+    if (keyCount >= FROZEN_NONE / 2 || totalDigits >= FROZEN_NONE) {
+        return false;
+    }
+
+    frozen->keyCount = keyCount;
+    frozen->fwdTargets = frozenArray(alloc, keyCount, sizeof(uint32_t));
+    frozen->bwdOffsets = frozenArray(alloc, keyCount + 1, sizeof(uint32_t));
+    frozen->bwdSources = frozenArray(alloc, keyCount, sizeof(uint32_t));
+    frozen->keyOffsets = frozenArray(alloc, keyCount + 1, sizeof(uint32_t));
+    frozen->digits = frozenArray(alloc, totalDigits, sizeof(char));
+    if (frozen->fwdTargets == NULL || frozen->bwdOffsets == NULL
+        || frozen->bwdSources == NULL || frozen->keyOffsets == NULL
+        || frozen->digits == NULL || !frozenResolveTargets(frozen, keys)) {
+        return false;
+    }
+
+    frozen->keyOffsets[0] = 0;
+    for (size_t i = 0; i < keyCount; ++i) {
+        frozen->bwdOffsets[i] = 0;
+        frozen->keyOffsets[i + 1] = frozen->keyOffsets[i]
+                                    + nodeWrite(keys->nodes[i], frozen->digits
+                                                + frozen->keyOffsets[i]);
+    }
+
+    frozen->bwdOffsets[keyCount] = 0;
+    for (size_t i = 0; i < keyCount; ++i) {
+        if (frozen->fwdTargets[i] != FROZEN_NONE) {
+            frozen->bwdOffsets[frozen->fwdTargets[i] + 1]++;
+        }
+    }
+
+    for (size_t i = 0; i < keyCount; ++i) {
+        frozen->bwdOffsets[i + 1] += frozen->bwdOffsets[i];
+    }
+
+    // Źródła przeglądamy rosnąco, więc w obrębie celu pozostają posortowane.
+    // Pozycje bwdOffsets[to] są przy tym tymczasowo przesuwane do przodu.
+    for (size_t from = 0; from < keyCount; ++from) {
+        uint32_t to = frozen->fwdTargets[from];
+
+        if (to != FROZEN_NONE) {
+            frozen->bwdSources[frozen->bwdOffsets[to]++] = from;
+        }
+    }
+
+    for (size_t i = keyCount; i > 0; --i) {
+        frozen->bwdOffsets[i] = frozen->bwdOffsets[i - 1];
+    }
+
+    frozen->bwdOffsets[0] = 0;
+
+    return true;
+}
+
+/**
+ * @brief Zwraca cyfrę klucza na danej pozycji.
+ *
+ * @param[in] frozen - zamrożona struktura;
+ * @param[in] key - indeks klucza;
+ * @param[in] position - pozycja cyfry (mniejsza od długości klucza).
+ * @return Wartość cyfry (0-11).
+ */
+static int keyDigit(PhfwdFrozen const *frozen, size_t key, size_t position) {
+    return toInt(frozen->digits[frozen->keyOffsets[key] + position]);
+}
+
+/**
+ * @brief Buduje drzewo TRIE posortowanych kluczy.
+ *
+ * Wierzchołek odpowiada przedziałowi kluczy o wspólnym prefiksie;
+ * jego synowie powstają z podziału przedziału według kolejnej cyfry
+ * i są dopisywani na koniec tablic, co daje porządek BFS.
+ *
+ * @param[in, out] frozen - budowana struktura z wypełnionymi kluczami.
+ * @return Wartość @p true jeśli operacja się powiodła,
+ *         wartość @p false jeśli nie udało się alokować pamięci.
+ */
+static bool frozenBuildTrie(PhfwdFrozen *frozen) {
+    PhfwdAllocator const *alloc = frozen->alloc;
+    // Każdy wierzchołek poza korzeniem odpowiada co najmniej jednej cyfrze.
+    size_t bound = frozen->keyOffsets[frozen->keyCount] + 1;
+
+    uint32_t *low = frozenArray(alloc, bound, sizeof(uint32_t));
+    uint32_t *high = frozenArray(alloc, bound, sizeof(uint32_t));
+    frozen->nodes = frozenArray(alloc, bound, sizeof(FrozenNode));
+    if (low == NULL || high == NULL || frozen->nodes == NULL) {
+        memFree(alloc, low);
+        memFree(alloc, high);
+        return false;
+    }
+
+    size_t nodeCount = 1;
+    low[0] = 0;
+    high[0] = frozen->keyCount;
+
+    // Głębokość wierzchołka to długość wspólnego prefiksu jego przedziału;
+    // rośnie o jeden przy przejściu do kolejnego poziomu BFS.
+    size_t depth = 0;
+    size_t levelEnd = 1;
+
+    for (size_t node = 0; node < nodeCount; ++node) {
+        if (node == levelEnd) {
+            depth++;
+            levelEnd = nodeCount;
+        }
+
+        size_t first = low[node];
+        size_t last = high[node];
+        uint16_t mask = 0;
+
+        frozen->nodes[node].key = FROZEN_NONE;
+        if (first < last && frozen->keyOffsets[first + 1]
+                            - frozen->keyOffsets[first] == depth) {
+            frozen->nodes[node].key = first++;
+        }
+
+        frozen->nodes[node].firstChild = nodeCount;
+        while (first < last) {
+            int digit = keyDigit(frozen, first, depth);
+            size_t end = first + 1;
+
+            while (end < last && keyDigit(frozen, end, depth) == digit) {
+                end++;
+            }
+
+            mask |= (uint16_t) (1u << digit);
+            low[nodeCount] = first;
+            high[nodeCount] = end;
+            nodeCount++;
+            first = end;
+        }
+
+        frozen->nodes[node].childMask = mask;
+    }
+
+    memFree(alloc, low);
+    memFree(alloc, high);
+
+    frozen->nodeCount = nodeCount;
+
+    // Przy niepowodzeniu zmniejszenia zostaje dotychczasowa tablica.
+    FrozenNode *nodes = memRealloc(alloc, frozen->nodes,
+                                   nodeCount * sizeof(FrozenNode));
+    frozen->nodes = (nodes == NULL ? frozen->nodes : nodes);
+
+    return true;
+}
+
+/*
+ * Budowa składa się z zebrania posortowanych kluczy, wypełnienia tablic
+ * kluczy i przekierowań wstecz oraz budowy drzewa TRIE kluczy.
+ */
+extern PhfwdFrozen *phfwdFreeze(PhoneForward const *pf) {
+    if (pf == NULL) {
+        return NULL;
+    }
+
+    PhfwdAllocator const *alloc = pf->alloc;
+    PhfwdFrozen *frozen = memCalloc(alloc, 1, sizeof(PhfwdFrozen));
+    if (frozen == NULL) {
+        return NULL;
+    }
+
+    frozen->alloc = alloc;
+
+    FrozenKeys keys = {NULL, NULL, 0, 0};
+    bool built = collectKeys(pf, &keys)
+                 && frozenBuildKeys(frozen, &keys)
+                 && frozenBuildTrie(frozen);
+
+    memFree(alloc, keys.nodes);
+    memFree(alloc, keys.targets);
+
+    if (!built) {
+        phfwdFrozenDelete(frozen);
+        return NULL;
+    }
+
+    return frozen;
+}
+
+extern void phfwdFrozenDelete(PhfwdFrozen *frozen) {
+    if (frozen == NULL) {
+        return;
+    }
+
+    PhfwdAllocator const *alloc = frozen->alloc;
+
+    memFree(alloc, frozen->nodes);
+    memFree(alloc, frozen->fwdTargets);
+    memFree(alloc, frozen->bwdOffsets);
+    memFree(alloc, frozen->bwdSources);
+    memFree(alloc, frozen->keyOffsets);
+    memFree(alloc, frozen->digits);
+    memFree(alloc, frozen);
+}
+
+extern size_t phfwdFrozenSize(PhfwdFrozen const *frozen) {
+    if (frozen == NULL) {
+        return 0;
+    }
+
+    return sizeof(PhfwdFrozen)
+           + frozen->nodeCount * sizeof(FrozenNode)
+           + frozen->keyCount * sizeof(uint32_t)
+           + 2 * (frozen->keyCount + 1) * sizeof(uint32_t)
+           + frozen->bwdOffsets[frozen->keyCount] * sizeof(uint32_t)
+           + frozen->keyOffsets[frozen->keyCount] * sizeof(char);
+}
+
+/**
+ * @brief Przechodzi do syna wierzchołka.
+ *
+ * @param[in] frozen - zamrożona struktura;
+ * @param[in] node - wierzchołek;
+ * @param[in] digit - cyfra syna (0-11).
+ * @return Indeks syna lub @ref FROZEN_NONE, jeśli go nie ma.
+ */
+static uint32_t frozenChild(PhfwdFrozen const *frozen, uint32_t node,
+                            int digit) {
+    unsigned mask = frozen->nodes[node].childMask;
+
+    if ((mask & (1u << digit)) == 0) {
+        return FROZEN_NONE;
+    }
+
+    return frozen->nodes[node].firstChild
+           + __builtin_popcount(mask & ((1u << digit) - 1));
+}
+
+/**
+ * @brief Znajduje najdłuższy prefiks numeru, z którego jest przekierowanie.
+ *
+ * @param[in] frozen - zamrożona struktura;
+ * @param[in] num - numer;
+ * @param[in] length - długość numeru;
+ * @param[out] fwdLength - długość znalezionego prefiksu.
+ * @return Indeks klucza prefiksu lub @ref FROZEN_NONE, jeśli numer
+ *         nie jest przekierowany.
+ */
+static uint32_t frozenFindLastFwd(PhfwdFrozen const *frozen, char const *num,
+                                  size_t length, size_t *fwdLength) {
+    uint32_t result = FROZEN_NONE;
+    uint32_t node = 0;
+
+    for (size_t i = 1; i <= length; ++i) {
+        node = frozenChild(frozen, node, toInt(num[i - 1]));
+        if (node == FROZEN_NONE) {
+            break;
+        }
+
+        uint32_t key = frozen->nodes[node].key;
+        if (key != FROZEN_NONE && frozen->fwdTargets[key] != FROZEN_NONE) {
+            result = key;
+            *fwdLength = i;
+        }
+    }
+
+    return result;
+}
+
+/*
+ * Wynik to numer celu przekierowania z najdłuższego prefiksu
+ * z dopisaną resztą numeru.
+ */
+extern PhoneNumbers *phfwdFrozenGet(PhfwdFrozen const *frozen,
+                                    char const *num) {
+    if (frozen == NULL) {
+        return NULL;
+    }
+
+    PhoneNumbers *result = phnumNew(frozen->alloc);
+    if (result == NULL || !ifNumOk(num)) {
+        return result;
+    }
+
+    size_t length = stringLength(num);
+    size_t fwdLength = 0;
+    uint32_t source = frozenFindLastFwd(frozen, num, length, &fwdLength);
+
+    char const *prefix = num;
+    size_t prefixLength = 0;
+    if (source != FROZEN_NONE) {
+        uint32_t target = frozen->fwdTargets[source];
+
+        prefix = frozen->digits + frozen->keyOffsets[target];
+        prefixLength = frozen->keyOffsets[target + 1]
+                       - frozen->keyOffsets[target];
+    }
+
+    size_t resultLength = prefixLength + length - fwdLength;
+    char *resultString = memAlloc(frozen->alloc, resultLength + 1);
+    if (resultString == NULL) {
+        phnumDelete(result);
+        return NULL;
+    }
+
+    memcpy(resultString, prefix, prefixLength);
+    memcpy(resultString + prefixLength, num + fwdLength, length - fwdLength);
+    resultString[resultLength] = '\0';
+
+    if (!phnumAdd(result, resultString)) {
+        memFree(frozen->alloc, resultString);
+        phnumDelete(result);
+        return NULL;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Porównuje numery na potrzeby funkcji qsort.
+ *
+ * @param[in] num1 - wskaźnik na pierwszy numer;
+ * @param[in] num2 - wskaźnik na drugi numer.
+ * @return Wynik funkcji compareNumbers.
+ */
+static int compareCandidates(void const *num1, void const *num2) {
+    char const *string1 = *(char const *const *) num1;
+    char const *string2 = *(char const *const *) num2;
+
+    return compareNumbers(string1, stringLength(string1),
+                          string2, stringLength(string2));
+}
+
+/**
+ * @brief Zwalnia tablicę kandydatów.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in] candidates - tablica kandydatów;
+ * @param[in] count - liczba kandydatów.
+ */
+static void freeCandidates(PhfwdAllocator const *alloc, char **candidates,
+                           size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        memFree(alloc, candidates[i]);
+    }
+
+    memFree(alloc, candidates);
+}
+
+/**
+ * @brief Wyznacza posortowany wynik phfwdReverse bez powtórzeń.
+ *
+ * @param[in] frozen - zamrożona struktura;
+ * @param[in] num - poprawny numer;
+ * @param[in] length - długość numeru;
+ * @param[out] count - liczba wyznaczonych numerów.
+ * @return Tablica numerów lub NULL, gdy nie udało się alokować pamięci.
+ */
+static char **frozenCandidates(PhfwdFrozen const *frozen, char const *num,
+                               size_t length, size_t *count) {
+    PhfwdAllocator const *alloc = frozen->alloc;
+    size_t total = 1;
+    uint32_t node = 0;
+
+    for (size_t i = 0; i < length; ++i) {
+        node = frozenChild(frozen, node, toInt(num[i]));
+        if (node == FROZEN_NONE) {
+            break;
+        }
+
+        uint32_t key = frozen->nodes[node].key;
+        if (key != FROZEN_NONE) {
+            total += frozen->bwdOffsets[key + 1] - frozen->bwdOffsets[key];
+        }
+    }
+
+    char **candidates = memAlloc(alloc, total * sizeof(char *));
+    if (candidates == NULL) {
+        return NULL;
+    }
+
+    *count = 0;
+    candidates[(*count)++] = copyString(alloc, num);
+    if (candidates[0] == NULL) {
+        memFree(alloc, candidates);
+        return NULL;
+    }
+
+    node = 0;
+    for (size_t i = 0; i < length; ++i) {
+        node = frozenChild(frozen, node, toInt(num[i]));
+        if (node == FROZEN_NONE) {
+            break;
+        }
+
+        uint32_t key = frozen->nodes[node].key;
+        if (key == FROZEN_NONE) {
+            continue;
+        }
+
+        for (uint32_t j = frozen->bwdOffsets[key];
+             j < frozen->bwdOffsets[key + 1]; ++j) {
+            uint32_t source = frozen->bwdSources[j];
+            char const *sourceDigits = frozen->digits
+                                       + frozen->keyOffsets[source];
+            size_t sourceLength = frozen->keyOffsets[source + 1]
+                                  - frozen->keyOffsets[source];
+            size_t candidateLength = sourceLength + length - i - 1;
+            char *candidate = memAlloc(alloc, candidateLength + 1);
+            if (candidate == NULL) {
+                freeCandidates(alloc, candidates, *count);
+                return NULL;
+            }
+
+            memcpy(candidate, sourceDigits, sourceLength);
+            memcpy(candidate + sourceLength, num + i + 1, length - i - 1);
+            candidate[candidateLength] = '\0';
+            candidates[(*count)++] = candidate;
+        }
+    }
+
+    qsort(candidates, *count, sizeof(char *), compareCandidates);
+
+    size_t unique = 0;
+    for (size_t i = 0; i < *count; ++i) {
+        if (unique > 0 && strcmp(candidates[unique - 1], candidates[i]) == 0) {
+            memFree(alloc, candidates[i]);
+        }
+        else {
+            candidates[unique++] = candidates[i];
+        }
+    }
+
+    *count = unique;
+
+    return candidates;
+}
+
+/**
+ * @brief Sprawdza, czy phfwdGet przekierowuje numer na zadany numer.
+ *
+ * @param[in] frozen - zamrożona struktura;
+ * @param[in] candidate - sprawdzany numer;
+ * @param[in] num - zadany numer;
+ * @param[in] length - długość zadanego numeru.
+ * @return Wartość @p true jeśli wynikiem phfwdGet dla @p candidate jest
+ *         @p num, wartość @p false w przeciwnym wypadku.
+ */
+static bool frozenForwardsTo(PhfwdFrozen const *frozen, char const *candidate,
+                             char const *num, size_t length) {
+    size_t candidateLength = stringLength(candidate);
+    size_t fwdLength = 0;
+    uint32_t source = frozenFindLastFwd(frozen, candidate, candidateLength,
+                                        &fwdLength);
+
+    if (source == FROZEN_NONE) {
+        return candidateLength == length
+               && memcmp(candidate, num, length) == 0;
+    }
+
+    uint32_t target = frozen->fwdTargets[source];
+    size_t targetLength = frozen->keyOffsets[target + 1]
+                          - frozen->keyOffsets[target];
+
+    return targetLength + candidateLength - fwdLength == length
+           && memcmp(frozen->digits + frozen->keyOffsets[target],
+                     num, targetLength) == 0
+           && memcmp(candidate + fwdLength, num + targetLength,
+                     candidateLength - fwdLength) == 0;
+}
+
+/**
+ * @brief Przenosi wybrane numery z tablicy kandydatów do wyniku.
+ *
+ * Tablica kandydatów jest zwalniana niezależnie od wyniku.
+ *
+ * @param[in] frozen - zamrożona struktura;
+ * @param[in] candidates - tablica kandydatów (NULL oznacza błąd alokacji);
+ * @param[in] count - liczba kandydatów;
+ * @param[in] num - zadany numer lub NULL, jeśli przenoszeni są wszyscy
+ *                  kandydaci; w przeciwnym wypadku przenoszeni są jedynie
+ *                  kandydaci przekierowywani na @p num.
+ * @return Wskaźnik na strukturę z numerami lub NULL,
+ *         gdy nie udało się alokować pamięci.
+ */
+static PhoneNumbers *frozenCollect(PhfwdFrozen const *frozen,
+                                   char **candidates, size_t count,
+                                   char const *num) {
+    PhfwdAllocator const *alloc = frozen->alloc;
+    PhoneNumbers *result = (candidates == NULL ? NULL : phnumNew(alloc));
+    if (result == NULL) {
+        if (candidates != NULL) {
+            freeCandidates(alloc, candidates, count);
+        }
+
+        return NULL;
+    }
+
+    size_t length = (num == NULL ? 0 : stringLength(num));
+    for (size_t i = 0; i < count; ++i) {
+        if (num != NULL && !frozenForwardsTo(frozen, candidates[i],
+                                             num, length)) {
+            memFree(alloc, candidates[i]);
+            continue;
+        }
+
+        if (!phnumAdd(result, candidates[i])) {
+            while (i < count) {
+                memFree(alloc, candidates[i++]);
+            }
+
+            memFree(alloc, candidates);
+            phnumDelete(result);
+            return NULL;
+        }
+    }
+
+    memFree(alloc, candidates);
+
+    return result;
+}
+
+extern PhoneNumbers *phfwdFrozenReverse(PhfwdFrozen const *frozen,
+                                        char const *num) {
+    if (frozen == NULL) {
+        return NULL;
+    }
+
+    if (!ifNumOk(num)) {
+        return phnumNew(frozen->alloc);
+    }
+
+    size_t count = 0;
+    char **candidates = frozenCandidates(frozen, num, stringLength(num),
+                                         &count);
+
+    return frozenCollect(frozen, candidates, count, NULL);
+}
+
+extern PhoneNumbers *phfwdFrozenGetReverse(PhfwdFrozen const *frozen,
+                                           char const *num) {
+    if (frozen == NULL) {
+        return NULL;
+    }
+
+    if (!ifNumOk(num)) {
+        return phnumNew(frozen->alloc);
+    }
+
+    size_t count = 0;
+    char **candidates = frozenCandidates(frozen, num, stringLength(num),
+                                         &count);
+
+    return frozenCollect(frozen, candidates, count, num);
+}
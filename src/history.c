@@ -0,0 +1,722 @@
+/** @file history.c
+ * Implementacja historii przekierowań oraz zapytań o przekierowania
+ * z minionych chwil.
+ *
+ * Przekierowanie z wierzchołka @p s było aktualne w chwili @p t, jeśli
+ * zostało dodane nie później niż w chwili @p t, nie zostało do tej chwili
+ * zastąpione, a żaden przodek @p s (łącznie z nim samym) nie był od jego
+ * dodania do chwili @p t czyszczony. Czasy wyczyszczeń wierzchołka rosną,
+ * więc wystarczy porównać czas dodania z ostatnim wyczyszczeniem
+ * nie późniejszym niż @p t.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "phone_forward_history.h"
+#include "history.h"
+#include "node.h"
+#include "phnum.h"
+#include "utils.h"
+
+/// Początkowa pojemność tablic historii wierzchołka.
+#define HISTORY_MIN_CAPACITY 2
+
+extern History *historyNew(PhfwdAllocator const *alloc, Epoch horizon) {
+    History *history = memAlloc(alloc, sizeof(History));
+    if (history == NULL) {
+        return NULL;
+    }
+
+    history->alloc = alloc;
+    history->horizon = horizon;
+    history->nodes = NULL;
+    history->count = 0;
+    history->capacity = 0;
+
+    return history;
+}
+
+/**
+ * @brief Zwalnia historię wierzchołka.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in, out] node - wierzchołek (jego historia staje się pusta).
+ */
+static void nodeHistoryFree(PhfwdAllocator const *alloc, Node *node) {
+    NodeHistory *nodeHistory = node->history;
+
+    memFree(alloc, nodeHistory->versions);
+    memFree(alloc, nodeHistory->removals);
+    memFree(alloc, nodeHistory->sources);
+    memFree(alloc, nodeHistory);
+    node->history = NULL;
+}
+
+extern void historyDelete(History *history) {
+    if (history == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < history->count; ++i) {
+        nodeHistoryFree(history->alloc, history->nodes[i]);
+    }
+
+    memFree(history->alloc, history->nodes);
+    memFree(history->alloc, history);
+}
+
+/**
+ * @brief Zapewnia miejsce na kolejny element tablicy historii wierzchołka.
+ *
+ * Pojemność tablicy o @p count elementach to najmniejsza potęga dwójki nie
+ * mniejsza niż @p count (i niż @ref HISTORY_MIN_CAPACITY), więc tablica
+ * jest powiększana, gdy liczba elementów osiągnie taką potęgę. Usunięcie
+ * elementów nie zmniejsza tablicy, więc jej rzeczywista pojemność może być
+ * większa.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in, out] array - tablica;
+ * @param[in] count - liczba elementów tablicy;
+ * @param[in] size - rozmiar elementu.
+ * @return Wartość @p true, jeśli w tablicy jest miejsce na kolejny element,
+ *         wartość @p false, gdy nie udało się alokować pamięci (tablica
+ *         pozostaje wtedy nienaruszona).
+ */
+static bool reserveOne(PhfwdAllocator const *alloc, void **array,
+                       uint32_t count, size_t size) {
+    if (count == UINT32_MAX) {
+        return false;
+    }
+
+    if (count != 0 && (count < HISTORY_MIN_CAPACITY
+                       || (count & (count - 1)) != 0)) {
+        return true;
+    }
+
+    size_t capacity = (count == 0 ? HISTORY_MIN_CAPACITY : 2 * (size_t) count);
+    void *grown = memRealloc(alloc, *array, capacity * size);
+    if (grown == NULL) {
+        return false;
+    }
+
+    *array = grown;
+
+    return true;
+}
+
+/**
+ * @brief Zwraca historię wierzchołka, w razie potrzeby ją tworząc.
+ *
+ * @param[in, out] history - historia;
+ * @param[in, out] node - wierzchołek.
+ * @return Historia wierzchołka lub NULL, gdy nie udało się alokować pamięci.
+ */
+static NodeHistory *historyOf(History *history, Node *node) {
+    if (node->history != NULL) {
+        return node->history;
+    }
+
+    if (history->count == history->capacity) {
+        size_t capacity = (history->capacity == 0 ?
+                           HISTORY_MIN_CAPACITY : 2 * history->capacity);
+        Node **nodes = memRealloc(history->alloc, history->nodes,
+                                  capacity * sizeof(Node *));
+        if (nodes == NULL) {
+            return NULL;
+        }
+
+        history->nodes = nodes;
+        history->capacity = capacity;
+    }
+
+    NodeHistory *nodeHistory = memCalloc(history->alloc, 1,
+                                         sizeof(NodeHistory));
+    if (nodeHistory == NULL) {
+        return NULL;
+    }
+
+    history->nodes[history->count++] = node;
+    node->history = nodeHistory;
+
+    return nodeHistory;
+}
+
+/**
+ * @brief Zapamiętuje wierzchołek, którego przekierowanie prowadziło
+ * do danego wierzchołka.
+ *
+ * @param[in, out] history - historia;
+ * @param[in, out] target - wierzchołek docelowy;
+ * @param[in] source - wierzchołek źródłowy.
+ * @return Wartość @p true, jeśli operacja się powiodła,
+ *         wartość @p false, gdy nie udało się alokować pamięci.
+ */
+static bool addSource(History *history, Node *target, Node *source) {
+    NodeHistory *nodeHistory = historyOf(history, target);
+    if (nodeHistory == NULL) {
+        return false;
+    }
+
+    // Wielokrotne przekierowania z tego samego wierzchołka z rzędu
+    // wystarczy zapamiętać raz.
+    if (nodeHistory->sourceCount > 0
+        && nodeHistory->sources[nodeHistory->sourceCount - 1] == source) {
+        return true;
+    }
+
+    if (!reserveOne(history->alloc, (void **) &nodeHistory->sources,
+                    nodeHistory->sourceCount, sizeof(Node *))) {
+        return false;
+    }
+
+    nodeHistory->sources[nodeHistory->sourceCount++] = source;
+
+    return true;
+}
+
+/*
+ * Przy braku pamięci przesuwamy horyzont, zamiast przerywać modyfikację
+ * struktury.
+ */
+extern void historyRecordVersion(History *history, Node *source, Node *fwd,
+                                 Epoch from, Epoch until) {
+    NodeHistory *nodeHistory = historyOf(history, source);
+
+    if (nodeHistory == NULL
+        || !reserveOne(history->alloc, (void **) &nodeHistory->versions,
+                       nodeHistory->versionCount, sizeof(HistoryVersion))) {
+        history->horizon = (Epoch) max(history->horizon, until);
+        return;
+    }
+
+    HistoryVersion *version =
+        &nodeHistory->versions[nodeHistory->versionCount++];
+    version->fwd = fwd;
+    version->from = from;
+    version->until = until;
+
+    if (!addSource(history, fwd, source)) {
+        history->horizon = (Epoch) max(history->horizon, until);
+    }
+}
+
+/*
+ * Przy braku pamięci przesuwamy horyzont, zamiast przerywać modyfikację
+ * struktury.
+ */
+extern void historyRecordRemoval(History *history, Node *node, Epoch time,
+                                 Epoch now) {
+    NodeHistory *nodeHistory = historyOf(history, node);
+
+    if (nodeHistory == NULL
+        || !reserveOne(history->alloc, (void **) &nodeHistory->removals,
+                       nodeHistory->removalCount, sizeof(Epoch))) {
+        history->horizon = (Epoch) max(history->horizon, now);
+        return;
+    }
+
+    nodeHistory->removals[nodeHistory->removalCount++] = time;
+}
+
+/*
+ * Wcześniejsze czasy wyczyszczenia wyszukujemy binarnie.
+ */
+extern Epoch historyRemovalAt(Node const *node, Epoch time) {
+    if (node->deleteTime <= time) {
+        return node->deleteTime;
+    }
+
+    NodeHistory const *nodeHistory = node->history;
+    if (nodeHistory == NULL) {
+        return 0;
+    }
+
+    // Liczba wcześniejszych czasów nie większych niż time.
+    size_t low = 0;
+    size_t high = nodeHistory->removalCount;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+
+        if (nodeHistory->removals[middle] <= time) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    return (low == 0 ? 0 : nodeHistory->removals[low - 1]);
+}
+
+/*
+ * Zastąpione przekierowania wyszukujemy binarnie według czasu dodania.
+ */
+extern Node *historyFwdAt(Node const *node, Epoch time, Epoch maxRemoval) {
+    if (node->fwd != NULL && node->fwdTime <= time) {
+        return (node->fwdTime > maxRemoval ? node->fwd : NULL);
+    }
+
+    NodeHistory const *nodeHistory = node->history;
+    if (nodeHistory == NULL) {
+        return NULL;
+    }
+
+    // Liczba zastąpionych przekierowań dodanych nie później niż time.
+    size_t low = 0;
+    size_t high = nodeHistory->versionCount;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+
+        if (nodeHistory->versions[middle].from <= time) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    if (low == 0) {
+        return NULL;
+    }
+
+    HistoryVersion const *version = &nodeHistory->versions[low - 1];
+    if (version->until <= time || version->from <= maxRemoval) {
+        return NULL;
+    }
+
+    return version->fwd;
+}
+
+/**
+ * @brief Para wierzchołków zapamiętanego przekierowania.
+ */
+typedef struct HistoryPair {
+    /// Wierzchołek źródłowy (NULL dla pustej pozycji zbioru).
+    Node const *source;
+    /// Wierzchołek docelowy.
+    Node const *target;
+} HistoryPair;
+
+/**
+ * @brief Wyznacza pozycję pary w zbiorze par.
+ *
+ * @param[in] source - wierzchołek źródłowy;
+ * @param[in] target - wierzchołek docelowy;
+ * @param[in] mask - maska liczby pozycji.
+ * @return Indeks pierwszej pozycji do sprawdzenia.
+ */
+static size_t pairSlot(Node const *source, Node const *target, size_t mask) {
+    uint64_t key = (uint64_t) (uintptr_t) source * 0x9e3779b97f4a7c15ull
+                   ^ (uint64_t) (uintptr_t) target;
+
+    key ^= key >> 29;
+    key *= 0xbf58476d1ce4e5b9ull;
+    key ^= key >> 32;
+
+    return (size_t) key & mask;
+}
+
+/**
+ * @brief Wyszukuje w zbiorze par pozycję pary.
+ *
+ * @param[in] pairs - zbiór par (z co najmniej jedną pustą pozycją);
+ * @param[in] mask - maska liczby pozycji;
+ * @param[in] source - wierzchołek źródłowy;
+ * @param[in] target - wierzchołek docelowy.
+ * @return Pozycja pary lub, jeśli jej nie ma, pierwsza pusta pozycja.
+ */
+static HistoryPair *pairFind(HistoryPair *pairs, size_t mask,
+                             Node const *source, Node const *target) {
+    size_t slot = pairSlot(source, target, mask);
+
+    while (pairs[slot].source != NULL && (pairs[slot].source != source
+                                          || pairs[slot].target != target)) {
+        slot = (slot + 1) & mask;
+    }
+
+    return &pairs[slot];
+}
+
+/**
+ * @brief Usuwa z historii wierzchołki źródłowe, których żadne zapamiętane
+ * przekierowanie nie prowadzi już do danego wierzchołka.
+ *
+ * Wierzchołki źródłowe są jedynie kandydatami sprawdzanymi przez
+ * @ref phfwdReverseAt, więc gdy nie uda się alokować pamięci na zbiór par,
+ * pozostają wszystkie.
+ *
+ * @param[in, out] history - historia.
+ */
+static void pruneSources(History *history) {
+    size_t versions = 0;
+    for (size_t i = 0; i < history->count; ++i) {
+        versions += history->nodes[i]->history->versionCount;
+    }
+
+    size_t size = HISTORY_MIN_CAPACITY;
+    while (size <= 2 * versions) {
+        size *= 2;
+    }
+
+    HistoryPair *pairs = memCalloc(history->alloc, size, sizeof(HistoryPair));
+    if (pairs == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < history->count; ++i) {
+        Node const *node = history->nodes[i];
+        NodeHistory const *nodeHistory = node->history;
+
+        for (size_t j = 0; j < nodeHistory->versionCount; ++j) {
+            Node const *target = nodeHistory->versions[j].fwd;
+            HistoryPair *pair = pairFind(pairs, size - 1, node, target);
+
+            pair->source = node;
+            pair->target = target;
+        }
+    }
+
+    for (size_t i = 0; i < history->count; ++i) {
+        Node const *node = history->nodes[i];
+        NodeHistory *nodeHistory = node->history;
+
+        uint32_t kept = 0;
+        for (size_t j = 0; j < nodeHistory->sourceCount; ++j) {
+            Node *source = nodeHistory->sources[j];
+
+            if (pairFind(pairs, size - 1, source, node)->source != NULL) {
+                nodeHistory->sources[kept++] = source;
+            }
+        }
+
+        nodeHistory->sourceCount = kept;
+    }
+
+    memFree(history->alloc, pairs);
+}
+
+/*
+ * Najpierw usuwamy nieaktualne przekierowania i czasy wyczyszczeń
+ * wszystkich wierzchołków, a dopiero potem wierzchołki źródłowe, bo te
+ * zależą od przekierowań innych wierzchołków. Na koniec zwalniamy puste
+ * historie.
+ */
+extern void historyPrune(History *history, Epoch horizon) {
+    history->horizon = (Epoch) max(history->horizon, horizon);
+    horizon = history->horizon;
+
+    for (size_t i = 0; i < history->count; ++i) {
+        NodeHistory *nodeHistory = history->nodes[i]->history;
+
+        size_t dropped = 0;
+        while (dropped < nodeHistory->versionCount
+               && nodeHistory->versions[dropped].until <= horizon) {
+            dropped++;
+        }
+
+        if (dropped > 0) {
+            nodeHistory->versionCount -= dropped;
+            memmove(nodeHistory->versions, nodeHistory->versions + dropped,
+                    nodeHistory->versionCount * sizeof(HistoryVersion));
+        }
+
+        // Ostatnie wyczyszczenie przed horyzontem może jeszcze unieważniać
+        // przekierowania dodane wcześniej.
+        dropped = 0;
+        while (dropped + 1 < nodeHistory->removalCount
+               && nodeHistory->removals[dropped + 1] <= horizon) {
+            dropped++;
+        }
+        if (history->nodes[i]->deleteTime <= horizon) {
+            dropped = nodeHistory->removalCount;
+        }
+
+        if (dropped > 0) {
+            nodeHistory->removalCount -= dropped;
+            memmove(nodeHistory->removals, nodeHistory->removals + dropped,
+                    nodeHistory->removalCount * sizeof(Epoch));
+        }
+    }
+
+    pruneSources(history);
+
+    size_t kept = 0;
+    for (size_t i = 0; i < history->count; ++i) {
+        Node *node = history->nodes[i];
+        NodeHistory *nodeHistory = node->history;
+
+        if (nodeHistory->versionCount == 0 && nodeHistory->removalCount == 0
+            && nodeHistory->sourceCount == 0) {
+            nodeHistoryFree(history->alloc, node);
+            continue;
+        }
+
+        // Opróżnione tablice zwalniamy (pozostałych nie zmniejszamy).
+        if (nodeHistory->versionCount == 0) {
+            memFree(history->alloc, nodeHistory->versions);
+            nodeHistory->versions = NULL;
+        }
+        if (nodeHistory->removalCount == 0) {
+            memFree(history->alloc, nodeHistory->removals);
+            nodeHistory->removals = NULL;
+        }
+        if (nodeHistory->sourceCount == 0) {
+            memFree(history->alloc, nodeHistory->sources);
+            nodeHistory->sources = NULL;
+        }
+
+        history->nodes[kept++] = node;
+    }
+
+    history->count = kept;
+}
+
+extern void historyVisitEpochs(History *history, EpochVisitor visit,
+                               void *context) {
+    visit(&history->horizon, context);
+
+    for (size_t i = 0; i < history->count; ++i) {
+        NodeHistory *nodeHistory = history->nodes[i]->history;
+
+        for (size_t j = 0; j < nodeHistory->versionCount; ++j) {
+            visit(&nodeHistory->versions[j].from, context);
+            visit(&nodeHistory->versions[j].until, context);
+        }
+
+        for (size_t j = 0; j < nodeHistory->removalCount; ++j) {
+            visit(&nodeHistory->removals[j], context);
+        }
+    }
+}
+
+/**
+ * @brief Zwraca horyzont historii struktury.
+ *
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania.
+ * @return Najwcześniejsza chwila, o którą można pytać.
+ */
+static size_t horizonOf(PhoneForward const *pf) {
+    return (pf->history == NULL ?
+            pf->time : epochTime(pf, pf->history->horizon));
+}
+
+/*
+ * Przechodzimy całą ścieżkę numeru (ograniczenia fwdDepthBelow opisują
+ * jedynie obecny stan struktury).
+ */
+extern PhoneNumbers *phfwdGetAt(PhoneForward const *pf, char const *num,
+                                size_t time) {
+    if (pf == NULL) {
+        return NULL;
+    }
+
+    if (time >= pf->time) {
+        return phfwdGet(pf, num);
+    }
+
+    if (!ifNumOk(num) || time < horizonOf(pf)) {
+        return phnumNew(pf->alloc);
+    }
+
+    size_t length = stringLength(num);
+    Epoch epoch = epochAt(pf, time);
+    Node const *node = pf->rootNode;
+    Node const *lastFwd = NULL;
+    Node const *target = NULL;
+    Epoch maxRemoval = 0;
+
+    for (size_t i = 0; i < length; ++i) {
+        node = node->children[toInt(num[i])];
+        if (node == NULL) {
+            break;
+        }
+
+        maxRemoval = (Epoch) max(maxRemoval, historyRemovalAt(node, epoch));
+
+        Node const *fwd = historyFwdAt(node, epoch, maxRemoval);
+        if (fwd != NULL) {
+            lastFwd = node;
+            target = fwd;
+        }
+    }
+
+    size_t prefixLength = (lastFwd == NULL ? 0 : lastFwd->depth);
+    size_t fwdLength = (target == NULL ? 0 : target->depth);
+    char *resultString = memAlloc(pf->alloc,
+                                  fwdLength + length - prefixLength + 1);
+    PhoneNumbers *result = phnumNew(pf->alloc);
+
+    if (resultString == NULL || result == NULL) {
+        memFree(pf->alloc, resultString);
+        phnumDelete(result);
+        return NULL;
+    }
+
+    if (target != NULL) {
+        nodeWrite(target, resultString);
+    }
+    memcpy(resultString + fwdLength, num + prefixLength,
+           length - prefixLength + 1);
+
+    if (!phnumAdd(result, resultString)) {
+        memFree(pf->alloc, resultString);
+        phnumDelete(result);
+        return NULL;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Sprawdza, czy w danej chwili aktualne było przekierowanie
+ * z wierzchołka do danego wierzchołka.
+ *
+ * @param[in] source - wierzchołek źródłowy;
+ * @param[in] target - wierzchołek docelowy;
+ * @param[in] time - chwila (epoka).
+ * @return Wartość @p true, jeśli przekierowanie było aktualne,
+ *         wartość @p false w przeciwnym wypadku.
+ */
+static bool wasFwdAt(Node const *source, Node const *target, Epoch time) {
+    Epoch maxRemoval = 0;
+
+    for (Node const *node = source; node != NULL; node = node->father) {
+        maxRemoval = (Epoch) max(maxRemoval, historyRemovalAt(node, time));
+    }
+
+    return historyFwdAt(source, time, maxRemoval) == target;
+}
+
+/**
+ * @brief Dodaje do wyniku numer powstały z zamiany prefiksu.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in, out] result - wynik;
+ * @param[in] source - wierzchołek nowego prefiksu;
+ * @param[in] rest - reszta numeru (za zamienianym prefiksem).
+ * @return Wartość @p true, jeśli operacja się powiodła,
+ *         wartość @p false, gdy nie udało się alokować pamięci.
+ */
+static bool addReplaced(PhfwdAllocator const *alloc, PhoneNumbers *result,
+                        Node const *source, char const *rest) {
+    size_t restLength = stringLength(rest);
+    char *number = memAlloc(alloc, source->depth + restLength + 1);
+    if (number == NULL) {
+        return false;
+    }
+
+    nodeWrite(source, number);
+    memcpy(number + source->depth, rest, restLength + 1);
+
+    if (!phnumAdd(result, number)) {
+        memFree(alloc, number);
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Kandydatami dla prefiksu są wierzchołki z jego zbioru przekierowań wstecz
+ * (aktualne przekierowania do prefiksu) oraz z jego historii (zastąpione
+ * przekierowania do prefiksu); każdego sprawdzamy w chwili time.
+ */
+extern PhoneNumbers *phfwdReverseAt(PhoneForward const *pf, char const *num,
+                                    size_t time) {
+    if (pf == NULL) {
+        return NULL;
+    }
+
+    if (time >= pf->time) {
+        return phfwdReverse(pf, num);
+    }
+
+    if (!ifNumOk(num) || time < horizonOf(pf)) {
+        return phnumNew(pf->alloc);
+    }
+
+    PhoneNumbers *result = phnumNew(pf->alloc);
+    char *copy = copyString(pf->alloc, num);
+    if (result == NULL || !phnumAdd(result, copy)) {
+        memFree(pf->alloc, copy);
+        phnumDelete(result);
+        return NULL;
+    }
+
+    bool ok = true;
+    Epoch epoch = epochAt(pf, time);
+    Node const *node = pf->rootNode;
+
+    for (size_t i = 0; num[i] != '\0' && ok; ++i) {
+        node = node->children[toInt(num[i])];
+        if (node == NULL) {
+            break;
+        }
+
+        BackwardSet const *set = node->backwards;
+        BwdSetPosition position = {0, 0};
+        Backward const *bwd;
+
+        for (; ok && (bwd = bwdSetGet(set, position)) != NULL;
+             bwdSetNext(set, &position)) {
+            if (wasFwdAt(bwd->fwdFrom, node, epoch)) {
+                ok = addReplaced(pf->alloc, result, bwd->fwdFrom,
+                                 num + i + 1);
+            }
+        }
+
+        NodeHistory const *nodeHistory = node->history;
+        for (size_t j = 0; nodeHistory != NULL
+                           && j < nodeHistory->sourceCount && ok; ++j) {
+            Node const *source = nodeHistory->sources[j];
+
+            if (wasFwdAt(source, node, epoch)) {
+                ok = addReplaced(pf->alloc, result, source, num + i + 1);
+            }
+        }
+    }
+
+    if (!ok) {
+        phnumDelete(result);
+        return NULL;
+    }
+
+    phnumSort(result);
+
+    return phnumRemoveDuplicates(result);
+}
+
+/*
+ * Ponowne włączenie zachowuje dotychczasową historię.
+ */
+extern bool phfwdHistoryEnable(PhoneForward *pf) {
+    if (pf == NULL) {
+        return false;
+    }
+
+    if (pf->history == NULL) {
+        pf->history = historyNew(pf->alloc, pf->epoch);
+    }
+
+    return pf->history != NULL;
+}
+
+extern size_t phfwdHistoryHorizon(PhoneForward const *pf) {
+    return (pf == NULL ? 0 : horizonOf(pf));
+}
+
+/*
+ * Horyzont nie może przekroczyć bieżącego czasu struktury.
+ */
+extern void phfwdPruneHistory(PhoneForward *pf, size_t horizon) {
+    if (pf == NULL || pf->history == NULL) {
+        return;
+    }
+
+    historyPrune(pf->history, epochAt(pf, horizon));
+}
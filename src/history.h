@@ -0,0 +1,165 @@
+/** @file history.h
+ * Interfejs historii przekierowań, pozwalającej wyznaczać przekierowania
+ * z dowolnej chwili nie wcześniejszej niż horyzont historii.
+ *
+ * Stan struktury w chwili @p t to stan po wszystkich modyfikacjach o czasie
+ * nie większym niż @p t. Aktualne przekierowanie i ostatnie wyczyszczenie
+ * wierzchołka przechowywane są jak dotąd w samym wierzchołku, a historia
+ * wierzchołka przechowuje jedynie to, co zostało nadpisane: zastąpione
+ * przekierowania (w kolejności czasów dodania), wcześniejsze czasy
+ * wyczyszczenia oraz wierzchołki, których zastąpione przekierowania
+ * prowadziły do tego wierzchołka. Historię mają tylko wierzchołki, których
+ * dotyczyły zastąpienia lub ponowne wyczyszczenia, więc pamięć rośnie
+ * z liczbą modyfikacji, a nie z liczbą zapamiętanych chwil. Chwile
+ * przechowywane są jako epoki (zob. epoch.h).
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __HISTORY_H__
+#define __HISTORY_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "phone_forward.h"
+#include "allocator.h"
+#include "epoch.h"
+
+/**
+ * @brief Zastąpione przekierowanie wierzchołka.
+ */
+typedef struct HistoryVersion {
+    /// Wierzchołek, na który prowadziło przekierowanie.
+    Node *fwd;
+    /// Czas dodania przekierowania.
+    Epoch from;
+    /// Czas zastąpienia przekierowania.
+    Epoch until;
+} HistoryVersion;
+
+/**
+ * @brief Historia wierzchołka.
+ *
+ * Pojemności tablic wynikają z liczby ich elementów (zob. history.c).
+ */
+typedef struct NodeHistory {
+    /// Zastąpione przekierowania, posortowane według czasu dodania.
+    HistoryVersion *versions;
+    /// Wcześniejsze czasy wyczyszczenia wierzchołka (rosnąco).
+    Epoch *removals;
+    /// Wierzchołki, których zastąpione przekierowania prowadziły do tego
+    /// wierzchołka (mogą się powtarzać).
+    Node **sources;
+    /// Liczba zastąpionych przekierowań.
+    uint32_t versionCount;
+    /// Liczba wcześniejszych czasów wyczyszczenia.
+    uint32_t removalCount;
+    /// Liczba wierzchołków @p sources.
+    uint32_t sourceCount;
+} NodeHistory;
+
+/**
+ * @brief Historia przekierowań struktury.
+ */
+typedef struct History {
+    /// Alokator struktury.
+    PhfwdAllocator const *alloc;
+    /// Najwcześniejsza chwila, dla której historia jest pełna.
+    Epoch horizon;
+    /// Wierzchołki z historią.
+    Node **nodes;
+    /// Liczba wierzchołków z historią.
+    size_t count;
+    /// Pojemność tablicy @p nodes.
+    size_t capacity;
+} History;
+
+/**
+ * @brief Tworzy pustą historię.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in] horizon - chwila włączenia historii.
+ * @return Wskaźnik na historię lub NULL, gdy nie udało się alokować pamięci.
+ */
+History *historyNew(PhfwdAllocator const *alloc, Epoch horizon);
+
+/**
+ * @brief Usuwa historię wszystkich wierzchołków.
+ *
+ * @param[in] history - usuwana historia (lub NULL).
+ */
+void historyDelete(History *history);
+
+/**
+ * @brief Zapamiętuje zastąpione przekierowanie.
+ *
+ * Przy braku pamięci historia sprzed @p until jest tracona (horyzont
+ * przesuwa się do @p until).
+ *
+ * @param[in, out] history - historia;
+ * @param[in, out] source - wierzchołek, z którego prowadziło przekierowanie;
+ * @param[in, out] fwd - wierzchołek, do którego prowadziło przekierowanie;
+ * @param[in] from - czas dodania przekierowania;
+ * @param[in] until - czas zastąpienia przekierowania.
+ */
+void historyRecordVersion(History *history, Node *source, Node *fwd,
+                          Epoch from, Epoch until);
+
+/**
+ * @brief Zapamiętuje nadpisywany czas wyczyszczenia wierzchołka.
+ *
+ * Przy braku pamięci historia sprzed @p now jest tracona.
+ *
+ * @param[in, out] history - historia;
+ * @param[in, out] node - wierzchołek;
+ * @param[in] time - nadpisywany czas wyczyszczenia;
+ * @param[in] now - czas nowego wyczyszczenia.
+ */
+void historyRecordRemoval(History *history, Node *node, Epoch time,
+                          Epoch now);
+
+/**
+ * @brief Wyznacza ostatnie wyczyszczenie wierzchołka do danej chwili.
+ *
+ * @param[in] node - wierzchołek;
+ * @param[in] time - chwila.
+ * @return Największy czas wyczyszczenia wierzchołka nie większy niż
+ *         @p time lub zero, jeśli go nie ma.
+ */
+Epoch historyRemovalAt(Node const *node, Epoch time);
+
+/**
+ * @brief Wyznacza przekierowanie wierzchołka w danej chwili.
+ *
+ * @param[in] node - wierzchołek;
+ * @param[in] time - chwila;
+ * @param[in] maxRemoval - ostatnie wyczyszczenie wierzchołka lub jego
+ *                         przodka do chwili @p time.
+ * @return Wierzchołek, na który prowadziło aktualne w chwili @p time
+ *         przekierowanie, lub NULL, jeśli go nie było.
+ */
+Node *historyFwdAt(Node const *node, Epoch time, Epoch maxRemoval);
+
+/**
+ * @brief Usuwa historię potrzebną jedynie dla chwil wcześniejszych niż
+ * horyzont.
+ *
+ * @param[in, out] history - historia;
+ * @param[in] horizon - nowy horyzont (nie mniejszy niż dotychczasowy).
+ */
+void historyPrune(History *history, Epoch horizon);
+
+/**
+ * @brief Odwiedza wszystkie epoki przechowywane w historii.
+ *
+ * @param[in, out] history - historia;
+ * @param[in] visit - funkcja odwiedzająca;
+ * @param[in, out] context - kontekst przekazywany do @p visit.
+ */
+void historyVisitEpochs(History *history, EpochVisitor visit, void *context);
+
+#endif /* __HISTORY_H__ */
@@ -0,0 +1,100 @@
+/** @file jump.c
+ * Implementacja tablicy skoków.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include "jump.h"
+#include "node.h"
+
+/**
+ * @brief Wyznacza liczbę pozycji tablicy.
+ *
+ * @param[in] depth - długość prefiksów.
+ * @return Liczba @f$12^{depth}@f$.
+ */
+static size_t jumpSize(size_t depth) {
+    size_t size = 1;
+
+    for (size_t i = 0; i < depth; ++i) {
+        size *= 12;
+    }
+
+    return size;
+}
+
+/**
+ * @brief Wyznacza pozycję tablicy od nowa.
+ *
+ * Przechodzi trasę od korzenia do prefiksu tak samo jak wyszukiwanie
+ * ostatniego przekierowania w phfwdGet.
+ *
+ * @param[in, out] table - tablica skoków;
+ * @param[in] root - korzeń drzewa;
+ * @param[in] index - indeks pozycji.
+ */
+static void jumpCompute(JumpTable *table, Node const *root, size_t index) {
+    JumpEntry *entry = &table->entries[index];
+    size_t divisor = jumpSize(table->depth);
+    Node *node = (Node *) root;
+
+    entry->lastFwd = NULL;
+    entry->maxTime = 0;
+
+    for (size_t i = 0; i < table->depth && node != NULL; ++i) {
+        entry->maxTime = max(entry->maxTime, node->deleteTime);
+
+        if (node->fwd != NULL && node->fwdTime > entry->maxTime) {
+            entry->lastFwd = node;
+        }
+
+        divisor /= 12;
+        node = node->children[(index / divisor) % 12];
+    }
+
+    entry->node = node;
+}
+
+extern JumpTable *jumpNew(PhfwdAllocator const *alloc, Node const *root,
+                          size_t depth) {
+    size_t size = jumpSize(depth);
+    JumpTable *table = memAlloc(alloc, sizeof(JumpTable)
+                                       + size * sizeof(JumpEntry));
+    if (table == NULL) {
+        return NULL;
+    }
+
+    table->depth = depth;
+    for (size_t i = 0; i < size; ++i) {
+        jumpCompute(table, root, i);
+    }
+
+    return table;
+}
+
+extern void jumpDelete(PhfwdAllocator const *alloc, JumpTable *table) {
+    memFree(alloc, table);
+}
+
+/*
+ * Pozycje prefiksów zaczynających się od num tworzą spójny przedział
+ * tablicy; dla dłuższych num jest to jedna pozycja.
+ */
+extern void jumpRefresh(JumpTable *table, Node const *root, char const *num,
+                        size_t length) {
+    size_t prefix = min(length, table->depth);
+    size_t first = 0;
+
+    for (size_t i = 0; i < prefix; ++i) {
+        first = first * 12 + toInt(num[i]);
+    }
+
+    size_t count = jumpSize(table->depth - prefix);
+    first *= count;
+
+    for (size_t i = first; i < first + count; ++i) {
+        jumpCompute(table, root, i);
+    }
+}
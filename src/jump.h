@@ -0,0 +1,114 @@
+/** @file jump.h
+ * Interfejs tablicy skoków przyspieszającej przejście przez górne poziomy
+ * drzewa TRIE.
+ *
+ * Tablica ma @f$12^k@f$ pozycji, po jednej dla każdego możliwego prefiksu
+ * długości @p k. Pozycja prefiksu przechowuje wierzchołek tego prefiksu
+ * oraz stan wyszukiwania ostatniego przekierowania po przejściu wierzchołków
+ * jego krótszych prefiksów, dzięki czemu phfwdGet może zacząć przechodzenie
+ * drzewa od głębokości @p k.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __JUMP_H__
+#define __JUMP_H__
+
+#include <stddef.h>
+
+#include "phone_forward.h"
+#include "allocator.h"
+#include "epoch.h"
+#include "utils.h"
+
+/**
+ * Najmniejsza obsługiwana długość prefiksu tablicy skoków.
+ */
+#define JUMP_MIN_DEPTH 2
+
+/**
+ * Największa obsługiwana długość prefiksu tablicy skoków.
+ */
+#define JUMP_MAX_DEPTH 4
+
+/**
+ * @brief Pozycja tablicy skoków.
+ */
+typedef struct JumpEntry {
+    /// Wierzchołek prefiksu (NULL, jeśli nie istnieje).
+    Node *node;
+    /// Ostatni wierzchołek z aktualnym przekierowaniem na trasie od korzenia
+    /// do prefiksu, z wyłączeniem samego prefiksu (lub NULL).
+    Node *lastFwd;
+    /// Największy czas wyczyszczenia na tej trasie.
+    Epoch maxTime;
+} JumpEntry;
+
+/**
+ * @brief Tablica skoków.
+ */
+typedef struct JumpTable {
+    /// Długość prefiksów.
+    size_t depth;
+    /// Pozycje tablicy indeksowane prefiksami zapisanymi w systemie
+    /// dwunastkowym.
+    JumpEntry entries[];
+} JumpTable;
+
+/**
+ * @brief Tworzy tablicę skoków dla drzewa.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in] root - korzeń drzewa;
+ * @param[in] depth - długość prefiksów
+ *                    (od @ref JUMP_MIN_DEPTH do @ref JUMP_MAX_DEPTH).
+ * @return Wskaźnik na tablicę lub NULL, gdy nie udało się alokować pamięci.
+ */
+JumpTable *jumpNew(PhfwdAllocator const *alloc, Node const *root,
+                   size_t depth);
+
+/**
+ * @brief Usuwa tablicę skoków.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in] table - usuwana tablica (lub NULL).
+ */
+void jumpDelete(PhfwdAllocator const *alloc, JumpTable *table);
+
+/**
+ * @brief Aktualizuje tablicę po modyfikacji wierzchołka.
+ *
+ * Wywoływana po utworzeniu wierzchołka numeru @p num lub zmianie jego
+ * przekierowania albo czasu wyczyszczenia. Dla numerów krótszych od
+ * długości prefiksów aktualizowane są wszystkie pozycje, których prefiksy
+ * zaczynają się od @p num.
+ *
+ * @param[in, out] table - tablica skoków;
+ * @param[in] root - korzeń drzewa;
+ * @param[in] num - numer zmodyfikowanego wierzchołka;
+ * @param[in] length - długość numeru.
+ */
+void jumpRefresh(JumpTable *table, Node const *root, char const *num,
+                 size_t length);
+
+/**
+ * @brief Zwraca pozycję tablicy dla początku numeru.
+ *
+ * @param[in] table - tablica skoków;
+ * @param[in] num - numer nie krótszy od długości prefiksów tablicy.
+ * @return Pozycja prefiksu numeru.
+ */
+static inline JumpEntry const *jumpLookup(JumpTable const *table,
+                                          char const *num) {
+    size_t index = 0;
+
+    for (size_t i = 0; i < table->depth; ++i) {
+        index = index * 12 + toInt(num[i]);
+    }
+
+    return &table->entries[index];
+}
+
+#endif /* __JUMP_H__ */
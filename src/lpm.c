@@ -0,0 +1,485 @@
+/** @file lpm.c
+ * Implementacja indeksu haszującego do wyszukiwania najdłuższego prefiksu.
+ *
+ * Długości prefiksów tworzą ustalone drzewo wyszukiwania binarnego
+ * nad przedziałem [1, @ref LPM_MAX_DIGITS]. Prefiks długości @p l
+ * zostawia znacznik w każdej tablicy długości @p m < @p l na ścieżce
+ * do @p l w tym drzewie; znaczniki są zliczane, więc mogą być współdzielone
+ * przez wiele prefiksów. Znaczniki nie przechowują najlepszego krótszego
+ * dopasowania (jego utrzymywanie wymagałoby przy dodaniu krótkiego prefiksu
+ * poprawienia wszystkich znaczników pod nim), dlatego po nieudanym
+ * wyszukiwaniu za znacznikiem szukamy jeszcze wśród krótszych długości.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "lpm.h"
+#include "node.h"
+#include "utils.h"
+
+/**
+ * Początkowa pojemność tablicy haszującej.
+ */
+#define LPM_INITIAL_CAPACITY 16
+
+/**
+ * @brief Pozycja tablicy haszującej.
+ *
+ * Pozycja jest wolna, jeśli nie ma ani przekierowania, ani znaczników.
+ */
+typedef struct LpmSlot {
+    /// Spakowany prefiks.
+    uint64_t key;
+    /// Wierzchołek przekierowania z prefiksu (NULL, jeśli to tylko znacznik).
+    Node *node;
+    /// Liczba dłuższych prefiksów, których ścieżka przechodzi przez tę
+    /// pozycję.
+    size_t markers;
+} LpmSlot;
+
+/**
+ * @brief Tablica haszująca prefiksów jednej długości
+ * (adresowanie otwarte, liniowe próbkowanie).
+ */
+typedef struct LpmTable {
+    /// Pozycje tablicy (NULL dla pustej tablicy).
+    LpmSlot *slots;
+    /// Liczba pozycji (potęga dwójki).
+    size_t capacity;
+    /// Liczba zajętych pozycji.
+    size_t count;
+} LpmTable;
+
+/**
+ * Indeks haszujący przekierowań.
+ */
+struct LpmIndex {
+    /// Alokator indeksu.
+    PhfwdAllocator const *alloc;
+    /// Tablice indeksowane długością prefiksu.
+    LpmTable tables[LPM_MAX_DIGITS + 1];
+};
+
+/**
+ * @brief Pakuje numer po cztery bity na cyfrę.
+ *
+ * @param[in] num - numer;
+ * @param[in] length - liczba pakowanych cyfr (co najwyżej
+ *                     @ref LPM_MAX_DIGITS).
+ * @return Spakowany numer; cyfra @p i zajmuje bity od @p 4i do @p 4i+3.
+ */
+static uint64_t lpmPack(char const *num, size_t length) {
+    uint64_t packed = 0;
+
+    for (size_t i = 0; i < length; ++i) {
+        packed |= (uint64_t) toInt(num[i]) << (4 * i);
+    }
+
+    return packed;
+}
+
+/**
+ * @brief Obcina spakowany numer do prefiksu.
+ *
+ * @param[in] packed - spakowany numer;
+ * @param[in] length - długość prefiksu.
+ * @return Spakowany prefiks.
+ */
+static uint64_t lpmPrefix(uint64_t packed, size_t length) {
+    if (length >= LPM_MAX_DIGITS) {
+        return packed;
+    }
+
+    return packed & (((uint64_t) 1 << (4 * length)) - 1);
+}
+
+/**
+ * @brief Funkcja haszująca spakowanego prefiksu.
+ *
+ * @param[in] key - spakowany prefiks;
+ * @param[in] mask - maska rozmiaru tablicy.
+ * @return Indeks pozycji w tablicy.
+ */
+static size_t lpmHash(uint64_t key, size_t mask) {
+    key ^= key >> 31;
+    key *= 0x9e3779b97f4a7c15ull;
+    key ^= key >> 29;
+
+    return (size_t) key & mask;
+}
+
+/**
+ * @brief Sprawdza, czy pozycja jest wolna.
+ *
+ * @param[in] slot - pozycja.
+ * @return Wartość @p true jeśli pozycja jest wolna,
+ *         wartość @p false w przeciwnym wypadku.
+ */
+static bool lpmSlotEmpty(LpmSlot const *slot) {
+    return slot->node == NULL && slot->markers == 0;
+}
+
+/**
+ * @brief Wyszukuje pozycję prefiksu w tablicy.
+ *
+ * @param[in] table - tablica (o niezerowej pojemności);
+ * @param[in] key - spakowany prefiks.
+ * @return Indeks pozycji z prefiksem lub wolnej pozycji, na której powinien
+ *         się znaleźć.
+ */
+static size_t lpmProbe(LpmTable const *table, uint64_t key) {
+    size_t mask = table->capacity - 1;
+    size_t position = lpmHash(key, mask);
+
+    while (!lpmSlotEmpty(&table->slots[position])
+           && table->slots[position].key != key) {
+        position = (position + 1) & mask;
+    }
+
+    return position;
+}
+
+/**
+ * @brief Zapewnia w tablicy miejsce na jedną nową pozycję.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in, out] table - tablica.
+ * @return Wartość @p true jeśli operacja się powiodła,
+ *         wartość @p false jeśli nie udało się alokować pamięci
+ *         (tablica pozostaje wtedy bez zmian).
+ */
+static bool lpmReserve(PhfwdAllocator const *alloc, LpmTable *table) {
+    if (2 * (table->count + 1) <= table->capacity) {
+        return true;
+    }
+
+    size_t capacity = (table->capacity == 0 ?
+                       LPM_INITIAL_CAPACITY : 2 * table->capacity);
+    LpmSlot *slots = memCalloc(alloc, capacity, sizeof(LpmSlot));
+    if (slots == NULL) {
+        return false;
+    }
+
+    LpmTable grown = {slots, capacity, table->count};
+    for (size_t i = 0; i < table->capacity; ++i) {
+        if (!lpmSlotEmpty(&table->slots[i])) {
+            slots[lpmProbe(&grown, table->slots[i].key)] = table->slots[i];
+        }
+    }
+
+    memFree(alloc, table->slots);
+    *table = grown;
+
+    return true;
+}
+
+/**
+ * @brief Zwalnia pozycję, jeśli nie przechowuje już niczego.
+ *
+ * Kolejne pozycje tego samego ciągu próbkowania są przesuwane wstecz,
+ * dzięki czemu tablica nie potrzebuje znaczników usuniętych pozycji.
+ *
+ * @param[in, out] table - tablica;
+ * @param[in] position - indeks pozycji.
+ */
+static void lpmRelease(LpmTable *table, size_t position) {
+    if (!lpmSlotEmpty(&table->slots[position])) {
+        return;
+    }
+
+    size_t mask = table->capacity - 1;
+    size_t hole = position;
+    size_t next = (hole + 1) & mask;
+
+    table->count--;
+    while (!lpmSlotEmpty(&table->slots[next])) {
+        size_t home = lpmHash(table->slots[next].key, mask);
+
+        // Pozycję można przenieść, jeśli dziura leży na jej ciągu próbkowania.
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            table->slots[hole] = table->slots[next];
+            table->slots[next].node = NULL;
+            table->slots[next].markers = 0;
+            hole = next;
+        }
+
+        next = (next + 1) & mask;
+    }
+}
+
+extern LpmIndex *lpmNew(PhfwdAllocator const *alloc) {
+    LpmIndex *index = memCalloc(alloc, 1, sizeof(LpmIndex));
+    if (index == NULL) {
+        return NULL;
+    }
+
+    index->alloc = alloc;
+
+    return index;
+}
+
+/*
+ * Tablice kopiowane są w całości, a wierzchołki przekierowań zastępowane
+ * ich obrazami.
+ */
+extern LpmIndex *lpmClone(LpmIndex const *index, NodeMap const *map) {
+    LpmIndex *copy = lpmNew(index->alloc);
+    if (copy == NULL) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i <= LPM_MAX_DIGITS; ++i) {
+        LpmTable const *table = &index->tables[i];
+        if (table->capacity == 0) {
+            continue;
+        }
+
+        LpmSlot *slots = memAlloc(index->alloc,
+                                  table->capacity * sizeof(LpmSlot));
+        if (slots == NULL) {
+            lpmDelete(copy);
+            return NULL;
+        }
+
+        memcpy(slots, table->slots, table->capacity * sizeof(LpmSlot));
+        for (size_t j = 0; j < table->capacity; ++j) {
+            slots[j].node = nodeMapFind(map, slots[j].node);
+        }
+
+        copy->tables[i] = (LpmTable) {slots, table->capacity, table->count};
+    }
+
+    return copy;
+}
+
+extern void lpmDelete(LpmIndex *index) {
+    if (index == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i <= LPM_MAX_DIGITS; ++i) {
+        memFree(index->alloc, index->tables[i].slots);
+    }
+
+    memFree(index->alloc, index);
+}
+
+/**
+ * @brief Wyznacza kolejną długość na ścieżce wyszukiwania binarnego.
+ *
+ * @param[in, out] low - dolny koniec bieżącego przedziału długości;
+ * @param[in, out] high - górny koniec bieżącego przedziału długości;
+ * @param[in] length - długość, do której prowadzi ścieżka.
+ * @return Długość, w której tablicy ścieżka zostawia znacznik, lub 0,
+ *         jeśli ścieżka dotarła do @p length.
+ */
+static size_t lpmNextMarker(size_t *low, size_t *high, size_t length) {
+    while (*low <= *high) {
+        size_t middle = (*low + *high) / 2;
+
+        if (middle == length) {
+            return 0;
+        }
+
+        if (middle < length) {
+            *low = middle + 1;
+            return middle;
+        }
+
+        *high = middle - 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Najpierw rezerwujemy miejsce we wszystkich tablicach na ścieżce,
+ * a dopiero potem je modyfikujemy, więc przy niepowodzeniu indeks
+ * pozostaje bez zmian.
+ */
+extern bool lpmInsert(LpmIndex *index, char const *num, size_t length,
+                      Node *node, bool *created) {
+    uint64_t packed = lpmPack(num, length);
+    LpmTable *own = &index->tables[length];
+
+    *created = false;
+    if (own->capacity > 0) {
+        LpmSlot *slot = &own->slots[lpmProbe(own, packed)];
+
+        if (slot->node != NULL) {
+            slot->node = node;
+            return true;
+        }
+    }
+
+    size_t low = 1;
+    size_t high = LPM_MAX_DIGITS;
+    size_t marker;
+
+    if (!lpmReserve(index->alloc, own)) {
+        return false;
+    }
+
+    while ((marker = lpmNextMarker(&low, &high, length)) != 0) {
+        if (!lpmReserve(index->alloc, &index->tables[marker])) {
+            return false;
+        }
+    }
+
+    low = 1;
+    high = LPM_MAX_DIGITS;
+    while ((marker = lpmNextMarker(&low, &high, length)) != 0) {
+        LpmTable *table = &index->tables[marker];
+        uint64_t key = lpmPrefix(packed, marker);
+        LpmSlot *slot = &table->slots[lpmProbe(table, key)];
+
+        if (lpmSlotEmpty(slot)) {
+            slot->key = key;
+            table->count++;
+        }
+
+        slot->markers++;
+    }
+
+    LpmSlot *slot = &own->slots[lpmProbe(own, packed)];
+    if (lpmSlotEmpty(slot)) {
+        slot->key = packed;
+        own->count++;
+    }
+
+    slot->node = node;
+    *created = true;
+
+    return true;
+}
+
+extern void lpmErase(LpmIndex *index, char const *num, size_t length) {
+    uint64_t packed = lpmPack(num, length);
+    LpmTable *own = &index->tables[length];
+
+    if (own->capacity == 0) {
+        return;
+    }
+
+    size_t position = lpmProbe(own, packed);
+    if (own->slots[position].node == NULL) {
+        return;
+    }
+
+    own->slots[position].node = NULL;
+    lpmRelease(own, position);
+
+    size_t low = 1;
+    size_t high = LPM_MAX_DIGITS;
+    size_t marker;
+
+    while ((marker = lpmNextMarker(&low, &high, length)) != 0) {
+        LpmTable *table = &index->tables[marker];
+
+        position = lpmProbe(table, lpmPrefix(packed, marker));
+        table->slots[position].markers--;
+        lpmRelease(table, position);
+    }
+}
+
+/**
+ * @brief Wyznacza kolejny wierzchołek poddrzewa, w którym może być
+ * aktualne przekierowanie.
+ *
+ * @param[in] node - bieżący wierzchołek;
+ * @param[in] root - korzeń przeglądanego poddrzewa.
+ * @return Kolejny wierzchołek w porządku preorder lub NULL.
+ */
+static Node const *lpmNextNode(Node const *node, Node const *root) {
+    int first = 0;
+
+    for (;;) {
+        for (int digit = first;
+             digit < 12 && node->depth < LPM_MAX_DIGITS; ++digit) {
+            Node const *child = node->children[digit];
+
+            if (child != NULL && child->fwdDepthBelow >= child->depth) {
+                return child;
+            }
+        }
+
+        if (node == root) {
+            return NULL;
+        }
+
+        first = toInt(node->digit) + 1;
+        node = node->father;
+    }
+}
+
+extern void lpmEraseSubtree(LpmIndex *index, Node const *root) {
+    char buffer[LPM_MAX_DIGITS];
+
+    if (root->depth > LPM_MAX_DIGITS) {
+        return;
+    }
+
+    for (Node const *node = root; node != NULL;
+         node = lpmNextNode(node, root)) {
+        if (node->fwd != NULL) {
+            lpmErase(index, buffer, nodeWrite(node, buffer));
+        }
+    }
+}
+
+/**
+ * @brief Wyszukiwanie binarne po długościach prefiksów.
+ *
+ * @param[in] index - indeks;
+ * @param[in] packed - spakowany numer;
+ * @param[in] length - długość numeru (dłuższych prefiksów nie ma);
+ * @param[in] low - dolny koniec przedziału długości;
+ * @param[in] high - górny koniec przedziału długości.
+ * @return Wierzchołek najdłuższego prefiksu z przedziału, z którego jest
+ *         przekierowanie, lub NULL.
+ */
+static Node *lpmSearch(LpmIndex const *index, uint64_t packed, size_t length,
+                       size_t low, size_t high) {
+    while (low <= high) {
+        size_t middle = (low + high) / 2;
+        LpmTable const *table = &index->tables[middle];
+        LpmSlot const *slot = NULL;
+
+        if (middle <= length && table->count > 0) {
+            slot = &table->slots[lpmProbe(table,
+                                          lpmPrefix(packed, middle))];
+        }
+
+        if (slot == NULL || lpmSlotEmpty(slot)) {
+            high = middle - 1;
+            continue;
+        }
+
+        // Dłuższe prefiksy mogą być jedynie za trafioną pozycją.
+        Node *longer = (slot->markers > 0 ?
+                        lpmSearch(index, packed, length, middle + 1, high) :
+                        NULL);
+        if (longer != NULL) {
+            return longer;
+        }
+
+        if (slot->node != NULL) {
+            return slot->node;
+        }
+
+        high = middle - 1;
+    }
+
+    return NULL;
+}
+
+extern Node *lpmFind(LpmIndex const *index, char const *num, size_t length) {
+    uint64_t packed = lpmPack(num, min(length, LPM_MAX_DIGITS));
+
+    return lpmSearch(index, packed, length, 1, LPM_MAX_DIGITS);
+}
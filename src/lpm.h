@@ -0,0 +1,116 @@
+/** @file lpm.h
+ * Interfejs indeksu haszującego do wyszukiwania najdłuższego prefiksu
+ * numeru, z którego istnieje przekierowanie.
+ *
+ * Indeks przechowuje wierzchołki aktualnych przekierowań z prefiksów
+ * długości co najwyżej @ref LPM_MAX_DIGITS w osobnych tablicach
+ * haszujących dla każdej długości, z kluczami spakowanymi po cztery bity
+ * na cyfrę. Wyszukiwanie jest wyszukiwaniem binarnym po długościach
+ * prefiksów: trafienie w tablicy długości @p m oznacza, że dłuższego
+ * prefiksu warto szukać dalej, więc każdy prefiks zostawia znaczniki
+ * w tablicach długości odwiedzanych po drodze do jego własnej.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __LPM_H__
+#define __LPM_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "phone_forward.h"
+#include "allocator.h"
+
+/**
+ * Największa długość prefiksu przechowywanego w indeksie.
+ */
+#define LPM_MAX_DIGITS 16
+
+struct LpmIndex;
+/**
+ * Definiuje indeks haszujący przekierowań.
+ */
+typedef struct LpmIndex LpmIndex;
+
+/**
+ * @brief Tworzy pusty indeks.
+ *
+ * @param[in] alloc - alokator.
+ * @return Wskaźnik na indeks lub NULL, gdy nie udało się alokować pamięci.
+ */
+LpmIndex *lpmNew(PhfwdAllocator const *alloc);
+
+struct NodeMap;
+
+/**
+ * @brief Kopiuje indeks dla kopii drzewa.
+ *
+ * @param[in] index - kopiowany indeks;
+ * @param[in] map - odwzorowanie wierzchołków drzewa na wierzchołki kopii.
+ * @return Wskaźnik na kopię lub NULL, gdy nie udało się alokować pamięci.
+ */
+LpmIndex *lpmClone(LpmIndex const *index, struct NodeMap const *map);
+
+/**
+ * @brief Usuwa indeks.
+ *
+ * @param[in] index - usuwany indeks (lub NULL).
+ */
+void lpmDelete(LpmIndex *index);
+
+/**
+ * @brief Dodaje do indeksu aktualne przekierowanie z prefiksu.
+ *
+ * Jeśli prefiks jest już w indeksie, jego wierzchołek jest zastępowany.
+ * Przy niepowodzeniu indeks pozostaje bez zmian.
+ *
+ * @param[in, out] index - indeks;
+ * @param[in] num - prefiks (co najwyżej @ref LPM_MAX_DIGITS cyfr);
+ * @param[in] length - długość prefiksu;
+ * @param[in] node - wierzchołek prefiksu;
+ * @param[out] created - czy prefiksu nie było wcześniej w indeksie.
+ * @return Wartość @p true jeśli operacja się powiodła,
+ *         wartość @p false jeśli nie udało się alokować pamięci.
+ */
+bool lpmInsert(LpmIndex *index, char const *num, size_t length, Node *node,
+               bool *created);
+
+/**
+ * @brief Usuwa prefiks z indeksu.
+ *
+ * Nie alokuje pamięci. Nic nie robi, jeśli prefiksu nie ma w indeksie.
+ *
+ * @param[in, out] index - indeks;
+ * @param[in] num - prefiks;
+ * @param[in] length - długość prefiksu.
+ */
+void lpmErase(LpmIndex *index, char const *num, size_t length);
+
+/**
+ * @brief Usuwa z indeksu wszystkie przekierowania z poddrzewa.
+ *
+ * Przegląda jedynie te poddrzewa, w których według ograniczeń
+ * @p fwdDepthBelow mogą być aktualne przekierowania.
+ *
+ * @param[in, out] index - indeks;
+ * @param[in] root - korzeń poddrzewa.
+ */
+void lpmEraseSubtree(LpmIndex *index, Node const *root);
+
+/**
+ * @brief Wyszukuje najdłuższy prefiks numeru, z którego jest przekierowanie.
+ *
+ * Brane są pod uwagę jedynie prefiksy długości co najwyżej
+ * @ref LPM_MAX_DIGITS.
+ *
+ * @param[in] index - indeks;
+ * @param[in] num - numer;
+ * @param[in] length - długość numeru.
+ * @return Wierzchołek znalezionego prefiksu lub NULL, jeśli go nie ma.
+ */
+Node *lpmFind(LpmIndex const *index, char const *num, size_t length);
+
+#endif /* __LPM_H__ */
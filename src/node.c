@@ -0,0 +1,581 @@
+/** @file node.c
+ * Implementacja operacji na wierzchołkach drzewa TRIE
+ * i zbiorach przekierowań wstecz.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "node.h"
+#include "utils.h"
+
+/**
+ * Początkowa pojemność bloku przekierowań wstecz.
+ */
+#define BWD_BLOCK_INITIAL_CAPACITY 2
+
+/**
+ * Największa liczba elementów bloku przekierowań wstecz.
+ */
+#define BWD_BLOCK_MAX 128
+
+/*
+ * Wyrównujemy głębokości obu wierzchołków idąc w górę drzewa.
+ * Jeśli trafimy w ten sam wierzchołek, jeden numer jest prefiksem drugiego;
+ * w przeciwnym wypadku idziemy dalej aż do synów wspólnego przodka
+ * i porównujemy ich cyfry.
+ */
+extern int nodeCompare(Node const *node1, Node const *node2) {
+    Node const *first = node1;
+    Node const *second = node2;
+
+    while (first->depth > second->depth) {
+        first = first->father;
+    }
+
+    while (second->depth > first->depth) {
+        second = second->father;
+    }
+
+    if (first == second) {
+        return (node1->depth > node2->depth) - (node1->depth < node2->depth);
+    }
+
+    while (first->father != second->father) {
+        first = first->father;
+        second = second->father;
+    }
+
+    return toInt(first->digit) - toInt(second->digit);
+}
+
+extern size_t nodeWrite(Node const *node, char *buffer) {
+    size_t depth = node->depth;
+
+    for (size_t i = 0; i < depth; ++i) {
+        buffer[depth - i - 1] = node->digit;
+        node = node->father;
+    }
+
+    return depth;
+}
+
+/*
+ * Sprawdzamy wszystkie wierzchołki na trasie od wierzchołka,
+ * z którego wyszło przekierowanie, do korzenia.
+ */
+extern bool isBackwardLive(Backward const *bwd) {
+    if (bwd == NULL || bwd->fwdTime < bwd->fwdFrom->fwdTime) {
+        return false;
+    }
+
+    Node const *currentNode = bwd->fwdFrom;
+
+    while (currentNode != NULL) {
+        if (currentNode->deleteTime > bwd->fwdTime) {
+            return false;
+        }
+
+        currentNode = currentNode->father;
+    }
+
+    return true;
+}
+
+/*
+ * Po ostatnim synu wracamy do ojca i szukamy jego kolejnego syna.
+ */
+extern Node *nodeNextPreorder(Node const *node) {
+    int first = 0;
+
+    while (node != NULL) {
+        for (int digit = first; digit < 12; ++digit) {
+            if (node->children[digit] != NULL) {
+                return node->children[digit];
+            }
+        }
+
+        if (node->father == NULL) {
+            return NULL;
+        }
+
+        first = toInt(node->digit) + 1;
+        node = node->father;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Funkcja haszująca wskaźnika na wierzchołek.
+ *
+ * @param[in] node - wierzchołek;
+ * @param[in] mask - maska rozmiaru tablicy.
+ * @return Indeks w tablicy haszującej.
+ */
+static size_t nodeMapHash(Node const *node, size_t mask) {
+    uint64_t hash = (uint64_t) (uintptr_t) node;
+
+    hash ^= hash >> 17;
+    hash *= 0x9e3779b97f4a7c15ull;
+
+    return (size_t) (hash >> 32) & mask;
+}
+
+/*
+ * Tablica ma co najmniej dwa razy więcej pozycji niż wierzchołków.
+ */
+extern bool nodeMapInit(PhfwdAllocator const *alloc, NodeMap *map,
+                        size_t count) {
+    size_t capacity = 2;
+    while (capacity < 2 * count) {
+        capacity *= 2;
+    }
+
+    map->alloc = alloc;
+    map->entries = memCalloc(alloc, capacity, sizeof(NodeMapEntry));
+    map->mask = capacity - 1;
+
+    return map->entries != NULL;
+}
+
+extern void nodeMapClear(NodeMap *map) {
+    memFree(map->alloc, map->entries);
+    map->entries = NULL;
+}
+
+extern void nodeMapInsert(NodeMap *map, Node const *from, Node *to) {
+    size_t position = nodeMapHash(from, map->mask);
+
+    while (map->entries[position].from != NULL) {
+        position = (position + 1) & map->mask;
+    }
+
+    map->entries[position].from = from;
+    map->entries[position].to = to;
+}
+
+extern Node *nodeMapFind(NodeMap const *map, Node const *from) {
+    if (from == NULL) {
+        return NULL;
+    }
+
+    size_t position = nodeMapHash(from, map->mask);
+
+    while (map->entries[position].from != NULL) {
+        if (map->entries[position].from == from) {
+            return map->entries[position].to;
+        }
+
+        position = (position + 1) & map->mask;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Wyszukuje blok, w którym powinien znajdować się wierzchołek.
+ *
+ * @param[in] set - niepusty zbiór przekierowań wstecz;
+ * @param[in] fwdFrom - szukany wierzchołek.
+ * @return Indeks pierwszego bloku, którego ostatni element nie jest mniejszy
+ *         od @p fwdFrom, lub indeks ostatniego bloku, jeśli takiego nie ma.
+ */
+static size_t bwdSetFindBlock(BackwardSet const *set, Node const *fwdFrom) {
+    size_t low = 0;
+    size_t high = set->blockCount - 1;
+
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        BackwardBlock const *block = set->blocks[middle];
+
+        if (nodeCompare(block->items[block->count - 1].fwdFrom, fwdFrom) < 0) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+/**
+ * @brief Wyszukuje pozycję wierzchołka w bloku.
+ *
+ * @param[in] block - blok;
+ * @param[in] fwdFrom - szukany wierzchołek;
+ * @param[out] found - czy wierzchołek występuje w bloku.
+ * @return Indeks elementu z wierzchołkiem @p fwdFrom lub, jeśli go nie ma,
+ *         indeks pierwszego elementu większego od niego.
+ */
+static size_t bwdBlockLowerBound(BackwardBlock const *block,
+                                 Node const *fwdFrom, bool *found) {
+    size_t low = 0;
+    size_t high = block->count;
+
+    *found = false;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        int cmp = nodeCompare(block->items[middle].fwdFrom, fwdFrom);
+
+        if (cmp == 0) {
+            *found = true;
+            return middle;
+        }
+
+        if (cmp < 0) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+extern BwdSetPosition bwdSetLowerBound(BackwardSet const *set,
+                                       Node const *fwdFrom, bool *found) {
+    BwdSetPosition position = {0, 0};
+
+    *found = false;
+    if (set == NULL) {
+        return position;
+    }
+
+    position.block = bwdSetFindBlock(set, fwdFrom);
+    position.index = bwdBlockLowerBound(set->blocks[position.block],
+                                        fwdFrom, found);
+
+    // Wszystkie elementy ostatniego bloku są mniejsze od szukanego.
+    if (position.index == set->blocks[position.block]->count) {
+        position.block++;
+        position.index = 0;
+    }
+
+    return position;
+}
+
+/**
+ * @brief Porównuje numer wierzchołka z napisem.
+ *
+ * @param[in] node - wierzchołek;
+ * @param[in] num - numer;
+ * @param[in] length - długość numeru;
+ * @param[out] buffer - bufor roboczy na numer wierzchołka.
+ * @return Wartość ujemna, zero lub dodatnia, jeśli numer wierzchołka jest
+ *         odpowiednio mniejszy, równy lub większy od @p num.
+ */
+static int nodeCompareNumber(Node const *node, char const *num,
+                             size_t length, char *buffer) {
+    size_t nodeLength = nodeWrite(node, buffer);
+
+    return compareNumbers(buffer, nodeLength, num, length);
+}
+
+extern BwdSetPosition bwdSetSeek(BackwardSet const *set, char const *num,
+                                 size_t length, char *buffer) {
+    BwdSetPosition position = {0, 0};
+    if (set == NULL) {
+        return position;
+    }
+
+    size_t low = 0;
+    size_t high = set->blockCount;
+
+    // Szukamy pierwszego bloku, którego ostatni element nie jest mniejszy.
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        BackwardBlock const *block = set->blocks[middle];
+
+        if (nodeCompareNumber(block->items[block->count - 1].fwdFrom,
+                              num, length, buffer) < 0) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    position.block = low;
+    if (position.block == set->blockCount) {
+        return position;
+    }
+
+    // Ostatni element bloku nie jest mniejszy, więc szukany leży w bloku.
+    BackwardBlock const *block = set->blocks[position.block];
+    low = 0;
+    high = block->count - 1;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+
+        if (nodeCompareNumber(block->items[middle].fwdFrom,
+                              num, length, buffer) < 0) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    position.index = low;
+
+    return position;
+}
+
+/**
+ * @brief Alokuje pusty blok.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in] capacity - pojemność bloku.
+ * @return Wskaźnik na blok lub NULL, gdy nie udało się alokować pamięci.
+ */
+static BackwardBlock *bwdBlockNew(PhfwdAllocator const *alloc,
+                                  size_t capacity) {
+    BackwardBlock *block = memAlloc(alloc, sizeof(BackwardBlock)
+                                           + capacity * sizeof(Backward));
+    if (block == NULL) {
+        return NULL;
+    }
+
+    block->count = 0;
+    block->capacity = capacity;
+
+    return block;
+}
+
+/**
+ * @brief Wyznacza pojemność tablicy bloków zbioru.
+ *
+ * @param[in] blockCount - liczba bloków.
+ * @return Najmniejsza potęga dwójki nie mniejsza niż @p blockCount (i niż 1).
+ */
+static size_t bwdSetCapacity(size_t blockCount) {
+    size_t capacity = 1;
+
+    while (capacity < blockCount) {
+        capacity *= 2;
+    }
+
+    return capacity;
+}
+
+/**
+ * @brief Wstawia blok do tablicy bloków zbioru.
+ *
+ * Tablica jest powiększana, gdy liczba bloków osiągnie potęgę dwójki
+ * (zob. @ref bwdSetCapacity); usunięcie bloków jej nie zmniejsza, więc
+ * rzeczywista pojemność może być większa.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in, out] set - wskaźnik na zbiór przekierowań wstecz (zbiór
+ *                       może zostać przeniesiony lub utworzony);
+ * @param[in] index - indeks, pod którym ma się znaleźć blok;
+ * @param[in] block - wstawiany blok.
+ * @return Wartość @p true jeśli operacja się powiodła,
+ *         wartość @p false jeśli nie udało się alokować pamięci.
+ */
+static bool bwdSetInsertBlock(PhfwdAllocator const *alloc, BackwardSet **set,
+                              size_t index, BackwardBlock *block) {
+    BackwardSet *current = *set;
+    size_t blockCount = (current == NULL ? 0 : current->blockCount);
+
+    if ((blockCount & (blockCount - 1)) == 0) {
+        size_t capacity = (blockCount == 0 ? 1 : 2 * blockCount);
+        BackwardSet *grown = memRealloc(alloc, current, sizeof(BackwardSet)
+                                        + capacity * sizeof(BackwardBlock *));
+        if (grown == NULL) {
+            return false;
+        }
+
+        if (current == NULL) {
+            grown->blockCount = 0;
+            grown->count = 0;
+            grown->oldestTime = 0;
+        }
+
+        *set = current = grown;
+    }
+
+    memmove(current->blocks + index + 1, current->blocks + index,
+            (blockCount - index) * sizeof(BackwardBlock *));
+    current->blocks[index] = block;
+    current->blockCount++;
+
+    return true;
+}
+
+/*
+ * Nowy element trafia do bloku wskazanego przez wyszukiwanie binarne.
+ * Blok rośnie dwukrotnie aż do BWD_BLOCK_MAX elementów, a pełny blok
+ * jest dzielony na dwie połowy.
+ */
+extern bool bwdSetInsert(PhfwdAllocator const *alloc, BackwardSet **set,
+                         Node *fwdFrom, Epoch fwdTime) {
+    if (*set == NULL) {
+        BackwardBlock *block = bwdBlockNew(alloc, BWD_BLOCK_INITIAL_CAPACITY);
+        if (block == NULL) {
+            return false;
+        }
+
+        if (!bwdSetInsertBlock(alloc, set, 0, block)) {
+            memFree(alloc, block);
+            return false;
+        }
+    }
+
+    size_t blockIndex = bwdSetFindBlock(*set, fwdFrom);
+    BackwardBlock *block = (*set)->blocks[blockIndex];
+    bool found;
+    size_t index = bwdBlockLowerBound(block, fwdFrom, &found);
+
+    if (found) {
+        block->items[index].fwdTime = fwdTime;
+        return true;
+    }
+
+    if (block->count == BWD_BLOCK_MAX) {
+        BackwardBlock *upper = bwdBlockNew(alloc, BWD_BLOCK_MAX);
+        if (upper == NULL) {
+            return false;
+        }
+
+        if (!bwdSetInsertBlock(alloc, set, blockIndex + 1, upper)) {
+            memFree(alloc, upper);
+            return false;
+        }
+
+        size_t half = BWD_BLOCK_MAX / 2;
+        memcpy(upper->items, block->items + half,
+               (BWD_BLOCK_MAX - half) * sizeof(Backward));
+        upper->count = BWD_BLOCK_MAX - half;
+        block->count = half;
+
+        if (index > half) {
+            block = upper;
+            index -= half;
+        }
+    }
+    else if (block->count == block->capacity) {
+        size_t capacity = min(block->capacity * 2, BWD_BLOCK_MAX);
+        BackwardBlock *grown = memRealloc(alloc, block, sizeof(BackwardBlock)
+                                          + capacity * sizeof(Backward));
+        if (grown == NULL) {
+            return false;
+        }
+
+        grown->capacity = capacity;
+        (*set)->blocks[blockIndex] = block = grown;
+    }
+
+    memmove(block->items + index + 1, block->items + index,
+            (block->count - index) * sizeof(Backward));
+    block->items[index].fwdFrom = fwdFrom;
+    block->items[index].fwdTime = fwdTime;
+    block->count++;
+
+    BackwardSet *current = *set;
+    current->oldestTime = (current->count == 0 ?
+                           fwdTime : (Epoch) min(current->oldestTime,
+                                                 fwdTime));
+    current->count++;
+
+    return true;
+}
+
+extern void bwdSetErase(PhfwdAllocator const *alloc, BackwardSet **set,
+                        Node const *fwdFrom) {
+    BackwardSet *current = *set;
+    bool found;
+    BwdSetPosition position = bwdSetLowerBound(current, fwdFrom, &found);
+
+    if (!found) {
+        return;
+    }
+
+    BackwardBlock *block = current->blocks[position.block];
+    memmove(block->items + position.index, block->items + position.index + 1,
+            (block->count - position.index - 1) * sizeof(Backward));
+    block->count--;
+    current->count--;
+
+    // Puste bloki (i pusty zbiór) są od razu zwalniane.
+    if (block->count == 0) {
+        memFree(alloc, block);
+        memmove(current->blocks + position.block,
+                current->blocks + position.block + 1,
+                (current->blockCount - position.block - 1)
+                * sizeof(BackwardBlock *));
+        current->blockCount--;
+    }
+
+    if (current->count == 0) {
+        memFree(alloc, current);
+        *set = NULL;
+    }
+}
+
+/*
+ * Kopie bloków mają pojemność równą liczbie elementów; rosną przy
+ * pierwszym wstawieniu jak zwykłe bloki.
+ */
+extern bool bwdSetCopy(PhfwdAllocator const *alloc, BackwardSet **copy,
+                       BackwardSet const *set, NodeMap const *map) {
+    if (set == NULL) {
+        return true;
+    }
+
+    BackwardSet *result = memAlloc(alloc, sizeof(BackwardSet)
+                                   + bwdSetCapacity(set->blockCount)
+                                     * sizeof(BackwardBlock *));
+    if (result == NULL) {
+        return false;
+    }
+
+    result->blockCount = 0;
+    result->count = set->count;
+    result->oldestTime = set->oldestTime;
+
+    for (size_t i = 0; i < set->blockCount; ++i) {
+        BackwardBlock const *block = set->blocks[i];
+        BackwardBlock *blockCopy = bwdBlockNew(alloc, block->count);
+        if (blockCopy == NULL) {
+            bwdSetClear(alloc, &result);
+            return false;
+        }
+
+        memcpy(blockCopy->items, block->items,
+               block->count * sizeof(Backward));
+        blockCopy->count = block->count;
+
+        for (size_t j = 0; j < block->count; ++j) {
+            blockCopy->items[j].fwdFrom = nodeMapFind(map,
+                                                      block->items[j].fwdFrom);
+        }
+
+        result->blocks[result->blockCount++] = blockCopy;
+    }
+
+    *copy = result;
+
+    return true;
+}
+
+extern void bwdSetClear(PhfwdAllocator const *alloc, BackwardSet **set) {
+    BackwardSet *current = *set;
+    if (current == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < current->blockCount; ++i) {
+        memFree(alloc, current->blocks[i]);
+    }
+
+    memFree(alloc, current);
+    *set = NULL;
+}
@@ -0,0 +1,448 @@
+/** @file node.h
+ * Wewnętrzna reprezentacja struktury przechowującej przekierowania:
+ * wierzchołki drzewa TRIE, zbiory przekierowań wstecz
+ * oraz sama struktura PhoneForward.
+ *
+ * Nagłówek przeznaczony jest wyłącznie dla modułów biblioteki.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __NODE_H__
+#define __NODE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "phone_forward.h"
+#include "allocator.h"
+#include "cache.h"
+#include "jump.h"
+#include "lpm.h"
+#include "resolve.h"
+#include "changelog.h"
+#include "history.h"
+#include "expiry.h"
+#include "diff.h"
+#include "epoch.h"
+#include "compact.h"
+
+/**
+ * Największa głębokość wierzchołka (długość numeru).
+ */
+#define NODE_MAX_DEPTH UINT32_MAX
+
+/**
+ * Wartość licznika terminów wierzchołka, od której licznik już się nie
+ * zmienia.
+ */
+#define NODE_MAX_PINS UINT16_MAX
+
+/**
+ * @brief Struktura przechowująca informacje na temat przekierowań wstecz.
+ */
+struct Backward {
+    /// Wierzchołek, z którego nastąpiło przekierowanie.
+    Node *fwdFrom;
+
+    /// Czas, w którym nastąpiło przekierowanie.
+    Epoch fwdTime;
+};
+
+/**
+ * @brief Blok posortowanych przekierowań wstecz.
+ */
+typedef struct BackwardBlock {
+    /// Liczba elementów bloku.
+    size_t count;
+    /// Pojemność bloku.
+    size_t capacity;
+    /// Elementy bloku.
+    Backward items[];
+} BackwardBlock;
+
+/**
+ * @brief Zbiór przekierowań wstecz jednego wierzchołka.
+ *
+ * Elementy są posortowane leksykograficznie według numerów
+ * reprezentowanych przez wierzchołki @p fwdFrom, a każdy wierzchołek
+ * występuje w zbiorze co najwyżej raz. Elementy są podzielone na bloki
+ * ograniczonego rozmiaru, dzięki czemu wstawienie i usunięcie elementu
+ * przesuwa w pamięci co najwyżej jeden blok.
+ *
+ * Nagłówek zbioru zajmuje jedną alokację z tablicą bloków, której
+ * pojemność to najmniejsza potęga dwójki nie mniejsza niż liczba bloków.
+ * Pusty zbiór nie zajmuje pamięci (wierzchołek przechowuje NULL).
+ */
+typedef struct BackwardSet {
+    /// Liczba bloków.
+    uint32_t blockCount;
+    /// Łączna liczba elementów zbioru.
+    uint32_t count;
+    /// Dolne ograniczenie czasów przekierowań zbioru.
+    Epoch oldestTime;
+    /// Kolejne bloki zbioru.
+    BackwardBlock *blocks[];
+} BackwardSet;
+
+/**
+ * @brief Pozycja elementu w zbiorze przekierowań wstecz.
+ */
+typedef struct BwdSetPosition {
+    /// Indeks bloku.
+    size_t block;
+    /// Indeks elementu w bloku.
+    size_t index;
+} BwdSetPosition;
+
+/**
+ * @brief Zwraca element zbioru na danej pozycji.
+ *
+ * @param[in] set - zbiór przekierowań wstecz (NULL dla pustego zbioru);
+ * @param[in] position - pozycja elementu.
+ * @return Wskaźnik na element lub NULL, jeśli pozycja wskazuje koniec zbioru.
+ */
+static inline Backward *bwdSetGet(BackwardSet const *set,
+                                  BwdSetPosition position) {
+    if (set == NULL || position.block >= set->blockCount) {
+        return NULL;
+    }
+
+    return &set->blocks[position.block]->items[position.index];
+}
+
+/**
+ * @brief Przesuwa pozycję na kolejny element zbioru.
+ *
+ * @param[in] set - zbiór przekierowań wstecz;
+ * @param[in, out] position - pozycja (różna od końca zbioru).
+ */
+static inline void bwdSetNext(BackwardSet const *set,
+                              BwdSetPosition *position) {
+    if (++position->index == set->blocks[position->block]->count) {
+        position->block++;
+        position->index = 0;
+    }
+}
+
+/**
+ * @brief Pojedynczy wierzchołek drzewa TRIE.
+ * Właściwa struktura przechowująca informację dotyczące numerów i przekierowań.
+ *
+ * Pola uporządkowane są według malejącego rozmiaru, więc struktura nie
+ * zawiera wypełnień poza końcowym.
+ */
+struct Node {
+    /// 12-elementowa tablica - reprezentuje kolejne cyfry numeru.
+    struct Node **children;
+    /// Poprzednia cyfra numeru.
+    struct Node *father;
+    /// Przekierowanie z wierzchołka
+    /// (prefiksu reprezentowanego przez trasę od korzenia do wierzchołka).
+    struct Node *fwd;
+
+    /// Zbiór wierzchołków, z których istnieje przekierowanie
+    /// do danego wierzchołka (NULL, jeśli jest pusty).
+    BackwardSet *backwards;
+
+    /// Historia wierzchołka (NULL, jeśli nie ma w niej niczego).
+    NodeHistory *history;
+
+    /// Suma skrótów aktualnych przekierowań z poddrzewa (zob. diff.h);
+    /// nieaktualna, jeśli @p hashTime jest mniejszy niż czas wyczyszczenia
+    /// któregoś z przodków (wtedy poddrzewo nie ma aktualnych przekierowań).
+    uint64_t contentHash;
+
+    /// Głębokość, na której znajduje się wierzchołek (równoważne pozycji,
+    /// na której w numerze występuje dana cyfra).
+    uint32_t depth;
+    /// Ograniczenie górne głębokości wierzchołków poddrzewa (łącznie z nim
+    /// samym), z których wychodzą aktualne przekierowania (0, jeśli takich
+    /// wierzchołków nie ma).
+    uint32_t fwdDepthBelow;
+
+    /// Czas, kiedy dodane zostało aktualne przekierowanie.
+    Epoch fwdTime;
+    /// Czas, kiedy przekierowania w poddrzewie zostały wyczyszczone.
+    Epoch deleteTime;
+    /// Czas ostatniej zmiany @p contentHash.
+    Epoch hashTime;
+
+    /// Cyfra, którą reprezentuje dany wierzchołek drzewa.
+    char digit;
+    /// Czy wierzchołek leży w bloku wierzchołków (zob. compact.h)
+    /// i nie może być zwalniany osobno.
+    bool packed;
+    /// Liczba oczekujących terminów wygaśnięcia odwołujących się do
+    /// wierzchołka (zob. expiry.h); po osiągnięciu @ref NODE_MAX_PINS
+    /// przestaje maleć, a wierzchołek na zawsze pozostaje na miejscu.
+    uint16_t expiryPins;
+};
+
+/**
+ * Struktura przechowująca przekierowania numerów telefonów.
+ *
+ * Struktura składa się z wierzchołka nadrzędnego,
+ * który zawiera przekierowanie do właściwego korzenia TRIE (już typu Node)
+ * i czasu struktury
+ * (potrzebny do określania kolejności dodawania przekierowań i ich usuwania).
+ */
+struct PhoneForward {
+    /// Korzeń TRIE.
+    Node *rootNode;
+
+    /// Alokator, przez który przechodzą wszystkie alokacje struktury
+    /// (w tym zwracanych wyników).
+    PhfwdAllocator const *alloc;
+
+    /// Czas.
+    size_t time;
+
+    /// Epoka odpowiadająca czasowi @p time (zob. epoch.h).
+    Epoch epoch;
+
+    /// Pierwsza epoka, która nie została przenumerowana.
+    Epoch epochBase;
+
+    /// Czasy odpowiadające przenumerowanym epokom, od 0 do @p epochBase
+    /// (NULL przed pierwszym przenumerowaniem).
+    size_t *epochTimes;
+
+    /// Największa głębokość wierzchołka, z którego kiedykolwiek
+    /// dodano przekierowanie (ogranicza długość wyników phfwdReverse).
+    size_t maxFwdDepth;
+
+    /// Czas ostatniego usunięcia przekierowań (0, jeśli nie było żadnego).
+    Epoch lastRemoveTime;
+
+    /// Pamięć podręczna wyników phfwdGet (NULL, jeśli wyłączona).
+    PhfwdCache *cache;
+
+    /// Tablica skoków górnych poziomów drzewa (NULL, jeśli wyłączona).
+    JumpTable *jump;
+
+    /// Indeks haszujący przekierowań (NULL dla przejścia drzewa).
+    LpmIndex *lpm;
+
+    /// Pamięć domknięć przekierowań phfwdResolve (NULL przed pierwszym
+    /// wywołaniem).
+    ResolveMemo *resolve;
+
+    /// Dziennik modyfikacji (NULL, jeśli wyłączony).
+    ChangeLog *changeLog;
+
+    /// Historia przekierowań (NULL, jeśli wyłączona).
+    History *history;
+
+    /// Terminy wygaśnięcia przekierowań (NULL przed pierwszym użyciem).
+    ExpiryWheel *expiry;
+
+    /// Stan kompaktowania (NULL przed pierwszym wywołaniem phfwdCompact).
+    Compactor *compact;
+};
+
+/**
+ * @brief Porównuje leksykograficznie numery reprezentowane przez wierzchołki.
+ *
+ * Oba wierzchołki muszą należeć do tego samego drzewa.
+ *
+ * @param[in] node1 - pierwszy wierzchołek;
+ * @param[in] node2 - drugi wierzchołek.
+ * @return Wartość ujemna, zero lub dodatnia, jeśli numer @p node1 jest
+ *         odpowiednio mniejszy, równy lub większy od numeru @p node2.
+ */
+int nodeCompare(Node const *node1, Node const *node2);
+
+/**
+ * @brief Zapisuje numer reprezentowany przez wierzchołek do bufora.
+ *
+ * Bufor musi mieścić co najmniej @p node->depth znaków;
+ * napis nie jest zakończony znakiem '\0'.
+ *
+ * @param[in] node - wierzchołek;
+ * @param[out] buffer - bufor wynikowy.
+ * @return Długość zapisanego numeru.
+ */
+size_t nodeWrite(Node const *node, char *buffer);
+
+/**
+ * @brief Znalezienie ostatniego przekierowania od korzenia do wierzchołka.
+ *
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania;
+ * @param[in] num - poprawne znaki numeru (niekoniecznie zakończone '\0');
+ * @param[in] depth - liczba znaków numeru.
+ * @return Wierzchołek reprezentujący najdłuższy prefiks numeru (łącznie
+ *         z nim samym), z którego istnieje aktualne przekierowanie, lub NULL,
+ *         jeśli takiego prefiksu nie ma.
+ */
+Node *findLastFwdPrefix(PhoneForward const *pf, char const *num,
+                        size_t depth);
+
+/**
+ * @brief Wyznacza kolejny wierzchołek drzewa w porządku preorder.
+ *
+ * Synowie odwiedzani są w kolejności cyfr, więc wierzchołki odwiedzane są
+ * w porządku leksykograficznym reprezentowanych numerów.
+ *
+ * @param[in] node - bieżący wierzchołek.
+ * @return Kolejny wierzchołek lub NULL, jeśli @p node był ostatni.
+ */
+Node *nodeNextPreorder(Node const *node);
+
+/**
+ * @brief Pozycja odwzorowania wierzchołków.
+ */
+typedef struct NodeMapEntry {
+    /// Wierzchołek (NULL dla wolnej pozycji).
+    Node const *from;
+    /// Obraz wierzchołka.
+    Node *to;
+} NodeMapEntry;
+
+/**
+ * @brief Odwzorowanie wierzchołków jednego drzewa na wierzchołki innego
+ * (adresowanie otwarte, liniowe próbkowanie).
+ *
+ * Rozmiar tablicy ustalany jest przy tworzeniu na podstawie liczby
+ * wierzchołków, więc wstawianie nie alokuje pamięci.
+ */
+typedef struct NodeMap {
+    /// Alokator odwzorowania.
+    PhfwdAllocator const *alloc;
+    /// Pozycje tablicy.
+    NodeMapEntry *entries;
+    /// Maska rozmiaru tablicy.
+    size_t mask;
+} NodeMap;
+
+/**
+ * @brief Tworzy puste odwzorowanie.
+ *
+ * @param[in] alloc - alokator;
+ * @param[out] map - tworzone odwzorowanie;
+ * @param[in] count - największa liczba wierzchołków odwzorowania.
+ * @return Wartość @p true jeśli operacja się powiodła,
+ *         wartość @p false jeśli nie udało się alokować pamięci.
+ */
+bool nodeMapInit(PhfwdAllocator const *alloc, NodeMap *map, size_t count);
+
+/**
+ * @brief Zwalnia pamięć odwzorowania.
+ *
+ * @param[in, out] map - odwzorowanie.
+ */
+void nodeMapClear(NodeMap *map);
+
+/**
+ * @brief Dodaje wierzchołek do odwzorowania.
+ *
+ * @param[in, out] map - odwzorowanie (niepełne);
+ * @param[in] from - wierzchołek (niewystępujący w odwzorowaniu);
+ * @param[in] to - obraz wierzchołka.
+ */
+void nodeMapInsert(NodeMap *map, Node const *from, Node *to);
+
+/**
+ * @brief Wyznacza obraz wierzchołka.
+ *
+ * @param[in] map - odwzorowanie;
+ * @param[in] from - wierzchołek (lub NULL).
+ * @return Obraz wierzchołka lub NULL, jeśli go nie ma w odwzorowaniu.
+ */
+Node *nodeMapFind(NodeMap const *map, Node const *from);
+
+/**
+ * @brief Sprawdza, czy przekierowanie wstecz jest aktualne.
+ *
+ * Przekierowanie jest aktualne, jeśli nie zostało od tamtej pory zastąpione
+ * ani usunięte (żaden przodek wierzchołka źródłowego, łącznie z nim samym,
+ * nie był czyszczony po jego dodaniu).
+ *
+ * @param[in] bwd - przekierowanie wstecz.
+ * @return Wartość @p true jeśli przekierowanie jest aktualne,
+ *         wartość @p false w przeciwnym wypadku.
+ */
+bool isBackwardLive(Backward const *bwd);
+
+/**
+ * @brief Wyszukuje w zbiorze pozycję wierzchołka źródłowego.
+ *
+ * @param[in] set - zbiór przekierowań wstecz (NULL dla pustego zbioru);
+ * @param[in] fwdFrom - szukany wierzchołek;
+ * @param[out] found - czy wierzchołek występuje w zbiorze.
+ * @return Pozycja elementu z wierzchołkiem @p fwdFrom lub, jeśli go nie ma,
+ *         pozycja pierwszego elementu większego od niego.
+ */
+BwdSetPosition bwdSetLowerBound(BackwardSet const *set, Node const *fwdFrom,
+                                bool *found);
+
+/**
+ * @brief Wyszukuje w zbiorze pierwszy element nie mniejszy od numeru.
+ *
+ * @param[in] set - zbiór przekierowań wstecz (NULL dla pustego zbioru);
+ * @param[in] num - numer;
+ * @param[in] length - długość numeru;
+ * @param[out] buffer - bufor roboczy mieszczący numer dowolnego wierzchołka
+ *                      źródłowego zbioru.
+ * @return Pozycja pierwszego elementu, którego numer nie jest mniejszy
+ *         od @p num (lub koniec zbioru).
+ */
+BwdSetPosition bwdSetSeek(BackwardSet const *set, char const *num,
+                          size_t length, char *buffer);
+
+/**
+ * @brief Dodaje przekierowanie wstecz lub odświeża jego czas.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in, out] set - wskaźnik na zbiór przekierowań wstecz;
+ * @param[in] fwdFrom - wierzchołek, z którego nastąpiło przekierowanie;
+ * @param[in] fwdTime - czas przekierowania.
+ * @return Wartość @p true jeśli operacja się powiodła,
+ *         wartość @p false jeśli nie udało się alokować pamięci
+ *         (zbiór pozostaje wtedy nienaruszony).
+ */
+bool bwdSetInsert(PhfwdAllocator const *alloc, BackwardSet **set,
+                  Node *fwdFrom, Epoch fwdTime);
+
+/**
+ * @brief Usuwa ze zbioru przekierowanie z danego wierzchołka.
+ *
+ * Nic nie robi, jeśli takiego przekierowania nie ma. Zbiór, który stał
+ * się pusty, jest zwalniany.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in, out] set - wskaźnik na zbiór przekierowań wstecz;
+ * @param[in] fwdFrom - wierzchołek, z którego nastąpiło przekierowanie.
+ */
+void bwdSetErase(PhfwdAllocator const *alloc, BackwardSet **set,
+                 Node const *fwdFrom);
+
+/**
+ * @brief Kopiuje zbiór przekierowań wstecz do innego drzewa.
+ *
+ * Bloki kopiowane są w całości, a wierzchołki źródłowe elementów
+ * zastępowane są ich obrazami.
+ *
+ * @param[in] alloc - alokator;
+ * @param[out] copy - wskaźnik na kopię (pustą);
+ * @param[in] set - kopiowany zbiór (NULL dla pustego zbioru);
+ * @param[in] map - odwzorowanie wierzchołków źródłowych zbioru.
+ * @return Wartość @p true jeśli operacja się powiodła,
+ *         wartość @p false jeśli nie udało się alokować pamięci
+ *         (kopia pozostaje wtedy pusta).
+ */
+bool bwdSetCopy(PhfwdAllocator const *alloc, BackwardSet **copy,
+                BackwardSet const *set, NodeMap const *map);
+
+/**
+ * @brief Zwalnia pamięć zbioru.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in, out] set - wskaźnik na zwalniany zbiór (pozostaje pusty).
+ */
+void bwdSetClear(PhfwdAllocator const *alloc, BackwardSet **set);
+
+#endif /* __NODE_H__ */
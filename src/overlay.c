@@ -0,0 +1,339 @@
+/** @file overlay.c
+ * Implementacja nakładki: struktury przekierowań złożonej ze wspólnej,
+ * niemodyfikowanej struktury bazowej i własnych modyfikacji nakładki.
+ *
+ * Własne przekierowania i usunięcia nakładki przechowywane są w osobnej
+ * strukturze, której wierzchołki z niezerowym czasem wyczyszczenia
+ * zasłaniają wszystkie przekierowania bazy z poddrzewa (modyfikacje
+ * nakładki są późniejsze niż cała zawartość bazy). Przekierowanie bazy
+ * z numeru, dla którego nakładka ma własne aktualne przekierowanie, jest
+ * przez nie zastąpione. Pozostałe przekierowania bazy obowiązują bez zmian.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "phone_forward.h"
+#include "phone_forward_overlay.h"
+#include "node.h"
+#include "phnum.h"
+#include "utils.h"
+
+/**
+ * @brief Nakładka na strukturę bazową.
+ */
+struct PhfwdOverlay {
+    /// Struktura bazowa (niemodyfikowana przez nakładkę).
+    PhoneForward const *base;
+    /// Własne przekierowania i usunięcia nakładki.
+    PhoneForward *own;
+};
+
+/*
+ * Własna struktura nakładki korzysta z alokatora bazy.
+ */
+extern PhfwdOverlay *phfwdOverlayNew(PhoneForward const *base) {
+    if (base == NULL) {
+        return NULL;
+    }
+
+    PhfwdOverlay *overlay = memAlloc(base->alloc, sizeof(PhfwdOverlay));
+    if (overlay == NULL) {
+        return NULL;
+    }
+
+    overlay->base = base;
+    overlay->own = phfwdNewWithAllocator(base->alloc);
+
+    if (overlay->own == NULL) {
+        memFree(base->alloc, overlay);
+        return NULL;
+    }
+
+    return overlay;
+}
+
+/*
+ * Struktura bazowa pozostaje nienaruszona.
+ */
+extern void phfwdOverlayDelete(PhfwdOverlay *overlay) {
+    if (overlay == NULL) {
+        return;
+    }
+
+    phfwdDelete(overlay->own);
+    memFree(overlay->base->alloc, overlay);
+}
+
+/*
+ * Przekierowanie trafia wyłącznie do własnej struktury nakładki.
+ */
+extern bool phfwdOverlayAdd(PhfwdOverlay *overlay, char const *num1,
+                            char const *num2) {
+    if (overlay == NULL) {
+        return false;
+    }
+
+    return phfwdAdd(overlay->own, num1, num2);
+}
+
+/*
+ * Usunięcie tworzy we własnej strukturze wierzchołek num (nawet jeśli
+ * nakładka nie ma przekierowań z jego poddrzewa), którego czas
+ * wyczyszczenia zasłania przekierowania bazy.
+ */
+extern void phfwdOverlayRemove(PhfwdOverlay *overlay, char const *num) {
+    if (overlay == NULL) {
+        return;
+    }
+
+    phfwdRemove(overlay->own, num);
+}
+
+/**
+ * @brief Tworzy numer powstały z zamiany prefiksu.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in] prefix - wierzchołek nowego prefiksu;
+ * @param[in] rest - reszta numeru (za zamienianym prefiksem).
+ * @return Nowy numer lub NULL, gdy nie udało się alokować pamięci.
+ */
+static char *replacedNumber(PhfwdAllocator const *alloc, Node const *prefix,
+                            char const *rest) {
+    size_t restLength = stringLength(rest);
+    char *number = memAlloc(alloc, prefix->depth + restLength + 1);
+    if (number == NULL) {
+        return NULL;
+    }
+
+    nodeWrite(prefix, number);
+    memcpy(number + prefix->depth, rest, restLength + 1);
+
+    return number;
+}
+
+/**
+ * @brief Wyznacza przekierowany numer w nakładce.
+ *
+ * Przechodzi ścieżkę numeru we własnej strukturze nakładki, zapamiętując
+ * ostatnie aktualne własne przekierowanie i najpłytszy wyczyszczony
+ * wierzchołek; przekierowanie bazy jest brane pod uwagę jedynie powyżej
+ * tego wierzchołka i tylko wtedy, gdy jest głębiej niż własne.
+ *
+ * @param[in] overlay - nakładka;
+ * @param[in] num - poprawny numer.
+ * @return Przekierowany numer lub NULL, gdy nie udało się alokować pamięci.
+ */
+static char *overlayGetString(PhfwdOverlay const *overlay, char const *num) {
+    PhfwdAllocator const *alloc = overlay->base->alloc;
+    size_t length = stringLength(num);
+    size_t visibleDepth = length;
+    size_t maxDelete = 0;
+    Node const *ownLast = NULL;
+    Node const *node = overlay->own->rootNode;
+
+    for (size_t i = 0; i < length; ++i) {
+        node = node->children[toInt(num[i])];
+        if (node == NULL) {
+            break;
+        }
+
+        if (node->deleteTime > maxDelete) {
+            visibleDepth = min(visibleDepth, i);
+            maxDelete = node->deleteTime;
+        }
+
+        if (node->fwd != NULL && node->fwdTime > maxDelete) {
+            ownLast = node;
+        }
+    }
+
+    Node const *baseLast = (visibleDepth == 0 ? NULL :
+                            findLastFwdPrefix(overlay->base, num,
+                                              visibleDepth));
+
+    // Przy równej głębokości przekierowanie nakładki zastępuje
+    // przekierowanie bazy.
+    Node const *last = ownLast;
+    if (baseLast != NULL
+        && (ownLast == NULL || baseLast->depth > ownLast->depth)) {
+        last = baseLast;
+    }
+
+    if (last == NULL) {
+        return copyString(alloc, num);
+    }
+
+    return replacedNumber(alloc, last->fwd, num + last->depth);
+}
+
+/*
+ * Wynik odpowiada phfwdGet dla struktury powstałej z kopii bazy
+ * przez wykonanie modyfikacji nakładki.
+ */
+extern PhoneNumbers *phfwdOverlayGet(PhfwdOverlay const *overlay,
+                                     char const *num) {
+    if (overlay == NULL) {
+        return NULL;
+    }
+
+    PhfwdAllocator const *alloc = overlay->base->alloc;
+
+    if (!ifNumOk(num)) {
+        return phnumNew(alloc);
+    }
+
+    char *resultString = overlayGetString(overlay, num);
+    PhoneNumbers *result = phnumNew(alloc);
+
+    if (resultString == NULL || result == NULL
+        || !phnumAdd(result, resultString)) {
+        memFree(alloc, resultString);
+        phnumDelete(result);
+        return NULL;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Sprawdza, czy przekierowanie bazy obowiązuje w nakładce.
+ *
+ * @param[in] overlay - nakładka;
+ * @param[in] source - wierzchołek bazy z aktualnym przekierowaniem;
+ * @param[out] buffer - bufor na numer wierzchołka @p source.
+ * @return Wartość @p true, jeśli nakładka nie wyczyściła żadnego prefiksu
+ *         numeru @p source i nie ma własnego przekierowania z tego numeru,
+ *         wartość @p false w przeciwnym wypadku.
+ */
+static bool isBaseFwdVisible(PhfwdOverlay const *overlay, Node const *source,
+                             char *buffer) {
+    size_t length = nodeWrite(source, buffer);
+    Node const *node = overlay->own->rootNode;
+
+    for (size_t i = 0; i < length; ++i) {
+        node = node->children[toInt(buffer[i])];
+        if (node == NULL) {
+            return true;
+        }
+
+        if (node->deleteTime != 0) {
+            return false;
+        }
+    }
+
+    // Bez wyczyszczeń na ścieżce każde własne przekierowanie jest aktualne.
+    return node->fwd == NULL;
+}
+
+/*
+ * Wynik phfwdReverse własnej struktury (zawierający sam numer) uzupełniamy
+ * o aktualne przekierowania bazy na prefiksy numeru, które nie zostały
+ * zasłonięte przez nakładkę.
+ */
+extern PhoneNumbers *phfwdOverlayReverse(PhfwdOverlay const *overlay,
+                                         char const *num) {
+    if (overlay == NULL) {
+        return NULL;
+    }
+
+    PhoneForward const *base = overlay->base;
+
+    if (!ifNumOk(num)) {
+        return phnumNew(base->alloc);
+    }
+
+    PhoneNumbers *result = phfwdReverse(overlay->own, num);
+    char *buffer = memAlloc(base->alloc, base->maxFwdDepth + 1);
+
+    bool ok = (result != NULL && buffer != NULL);
+    Node const *node = base->rootNode;
+
+    for (size_t i = 0; num[i] != '\0' && ok; ++i) {
+        node = node->children[toInt(num[i])];
+        if (node == NULL) {
+            break;
+        }
+
+        BackwardSet const *set = node->backwards;
+        BwdSetPosition position = {0, 0};
+        Backward const *bwd;
+
+        for (; ok && (bwd = bwdSetGet(set, position)) != NULL;
+             bwdSetNext(set, &position)) {
+            if (!isBackwardLive(bwd)
+                || !isBaseFwdVisible(overlay, bwd->fwdFrom, buffer)) {
+                continue;
+            }
+
+            char *number = replacedNumber(base->alloc, bwd->fwdFrom,
+                                          num + i + 1);
+            ok = (number != NULL && phnumAdd(result, number));
+            if (!ok) {
+                memFree(base->alloc, number);
+            }
+        }
+    }
+
+    memFree(base->alloc, buffer);
+
+    if (!ok) {
+        phnumDelete(result);
+        return NULL;
+    }
+
+    phnumSort(result);
+
+    return phnumRemoveDuplicates(result);
+}
+
+/*
+ * Kandydatami są numery z wyniku phfwdOverlayReverse; pozostawiamy te,
+ * które nakładka przekierowuje na num.
+ */
+extern PhoneNumbers *phfwdOverlayGetReverse(PhfwdOverlay const *overlay,
+                                            char const *num) {
+    if (overlay == NULL) {
+        return NULL;
+    }
+
+    PhfwdAllocator const *alloc = overlay->base->alloc;
+
+    if (!ifNumOk(num)) {
+        return phnumNew(alloc);
+    }
+
+    PhoneNumbers *candidates = phfwdOverlayReverse(overlay, num);
+    PhoneNumbers *result = phnumNew(alloc);
+    bool ok = (candidates != NULL && result != NULL);
+
+    char const *candidate;
+    for (size_t i = 0;
+         ok && (candidate = phnumGet(candidates, i)) != NULL; ++i) {
+        char *afterGet = overlayGetString(overlay, candidate);
+        ok = (afterGet != NULL);
+
+        if (ok && areStringsEqual(afterGet, num)) {
+            char *copy = copyString(alloc, candidate);
+            ok = (copy != NULL && phnumAdd(result, copy));
+            if (!ok) {
+                memFree(alloc, copy);
+            }
+        }
+
+        memFree(alloc, afterGet);
+    }
+
+    phnumDelete(candidates);
+
+    if (!ok) {
+        phnumDelete(result);
+        return NULL;
+    }
+
+    return result;
+}
@@ -10,6 +10,7 @@
 #include <stdlib.h>
 
 #include "phone_forward.h"
+#include "allocator.h"
 #include "utils.h"
 
 /**
@@ -24,20 +25,23 @@ struct PhoneNumbers {
     size_t count;
     /// Elementy na strukturze.
     char **numbers;
+    /// Alokator struktury i przechowywanych napisów.
+    PhfwdAllocator const *alloc;
 };
 
-extern PhoneNumbers *phnumNew(void) {
-    PhoneNumbers *pnum = malloc(sizeof(PhoneNumbers));
+extern PhoneNumbers *phnumNew(PhfwdAllocator const *alloc) {
+    PhoneNumbers *pnum = memAlloc(alloc, sizeof(PhoneNumbers));
     if (pnum == NULL) {
         return NULL;
     }
 
     pnum->size = 8;
     pnum->count = 0;
+    pnum->alloc = alloc;
 
-    pnum->numbers = malloc(8 * sizeof(char*));
+    pnum->numbers = memAlloc(alloc, 8 * sizeof(char*));
     if (pnum->numbers == NULL) {
-        free(pnum);
+        memFree(alloc, pnum);
         return NULL;
     }
     
@@ -55,20 +59,16 @@ extern bool phnumAdd(PhoneNumbers *pnum, char *num) {
 
     // Dynamiczna alokacja pamięci na kolejne elementy tablicy.
     if (pnum->size == pnum->count) {
-        pnum->size *= 2;
-
-        char **backup = pnum->numbers;
-        size_t count = pnum->count;
-        pnum->numbers = realloc(pnum->numbers, sizeof(char*) * pnum->size);
-
-        if (pnum->numbers == NULL) {
-            for (size_t i = 0; i < count; ++i) {
-                free(backup[i]);
-            }
-
-            free(backup);
+        // Przy niepowodzeniu struktura pozostaje nienaruszona
+        // (wywołujący nadal może ją usunąć za pomocą phnumDelete).
+        char **numbers = memRealloc(pnum->alloc, pnum->numbers,
+                                    sizeof(char*) * pnum->size * 2);
+        if (numbers == NULL) {
             return false;
         }
+
+        pnum->numbers = numbers;
+        pnum->size *= 2;
     }
 
     pnum->numbers[(pnum->count)++] = num;
@@ -87,11 +87,11 @@ extern char const *phnumGet(PhoneNumbers const *pnum, size_t idx) {
 extern void phnumDelete(PhoneNumbers *pnum) {
     if (pnum != NULL) {
         for (size_t i = 0; i < pnum->count; ++i) {
-            free(pnum->numbers[i]);
+            memFree(pnum->alloc, pnum->numbers[i]);
         }
 
-        free(pnum->numbers);
-        free(pnum);
+        memFree(pnum->alloc, pnum->numbers);
+        memFree(pnum->alloc, pnum);
     }
 }
 
@@ -175,7 +175,7 @@ extern PhoneNumbers *phnumRemoveDuplicates(PhoneNumbers *pnum) {
         return NULL;
     }
 
-    PhoneNumbers *phnumNoDuplicates = phnumNew();
+    PhoneNumbers *phnumNoDuplicates = phnumNew(pnum->alloc);
     if (phnumNoDuplicates == NULL) {
         phnumDelete(pnum);
         return NULL;
@@ -194,9 +194,9 @@ extern PhoneNumbers *phnumRemoveDuplicates(PhoneNumbers *pnum) {
         // Jeśli numer jest pierwszym dodawanym numerem lub napisy są różne,
         // dodajemy napis na wynikową strukturę.
         if (phnumNoDuplicates->count == 0 || strcmp(str1, str2) != 0) {
-            char *copy = copyString(pnum->numbers[i]);
+            char *copy = copyString(pnum->alloc, pnum->numbers[i]);
             if (!phnumAdd(phnumNoDuplicates, copy)) {
-                free(copy);
+                memFree(pnum->alloc, copy);
                 phnumDelete(phnumNoDuplicates);
                 phnumDelete(pnum);
                 
@@ -17,9 +17,11 @@ struct PhoneNumbers;
 /**
  * @brief Utworzenie nowej struktury przechowywującej ciąg numerów telefonów.
  * 
+ * @param[in] alloc - alokator, przez który przechodzą wszystkie alokacje
+ *                    struktury (łącznie z przechowywanymi napisami).
  * @return Wskaźnik na nową strukturę lub NULL jeśli alokacja pamięci się nie powiodła.
  */
-PhoneNumbers *phnumNew(void);
+PhoneNumbers *phnumNew(PhfwdAllocator const *alloc);
 
 size_t getCount(PhoneNumbers *pnum);
 
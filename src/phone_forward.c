@@ -11,164 +11,98 @@
 #include <stdint.h>
 
 #include "phone_forward.h"
+#include "phone_forward_query.h"
+#include "phone_forward_reverse.h"
+#include "phone_forward_tuning.h"
+#include "node.h"
+#include "allocator.h"
 #include "phnum.h"
 #include "utils.h"
-#include "queue.h"
-
-/**
- * @brief Struktura przechowująca informacje na temat przekierowań wstecz.
- */
-typedef struct Backward {
-    /// Wierzchołek, z którego nastąpiło przekierowanie.
-    Node *fwdFrom;
-
-    /// Czas, w którym nastąpiło przekierowanie.
-    size_t fwdTime;
-} Backward;
-
-extern Backward *makeCopyBackward(Backward *bwd) {
-    if (bwd == NULL) {
-        return NULL;
-    }
-
-    Backward *bwdCopy = malloc(sizeof(Backward));
-    if (bwdCopy == NULL) {
-        return NULL;
-    }
-
-    bwdCopy->fwdFrom = bwd->fwdFrom;
-    bwdCopy->fwdTime = bwd->fwdTime;
-
-    return bwdCopy;
-}
-
-/**
- * @brief Tworzy nową strukturę typu Backward (przekierowanie wstecz).
- * 
- * @param[in] fwdFrom - wskaźnik do wierzchołka,
- *                      z którego nastąpiło przekierowanie;
- * @param[in] fwdTime - czas kiedy nastąpiło przekierowanie.
- * @return Nowa struktura typu Backward.
- */
-static Backward* backwardNew(Node *fwdFrom, size_t fwdTime) {
-    Backward *backward = malloc(sizeof(Backward));
-    if (backward ==  NULL) {
-        return NULL;
-    }
-
-    if (fwdFrom == NULL) {
-        return NULL;
-    }
-    
-    backward->fwdFrom = fwdFrom;
-    backward->fwdTime = fwdTime;
-
-    return backward;
-}
-
-/**
- * @brief Pojedynczy wierzchołek drzewa TRIE.
- * Właściwa struktura przechowująca informację dotyczące numerów i przekierowań.
- */
-typedef struct Node {
-    /// 12-elementowa tablica - reprezentuje kolejne cyfry numeru.
-    struct Node **children;
-    /// Poprzednia cyfra numeru.
-    struct Node *father;
-    /// Przekierowanie z wierzchołka
-    /// (prefiksu reprezentowanego przez trasę od korzenia do wierzchołka).
-    struct Node *fwd;
-
-    /// Cyfra, którą reprezentuje dany wierzchołek drzewa.
-    char digit;
-    /// Głębokość, na której znajduje się wierzchołek (równoważne pozycji,
-    /// na której w numerze występuje dana cyfra).
-    size_t depth;
-
-    /// Czas, kiedy dodane zostało aktualne przekierowanie.
-    size_t fwdTime;
-    /// Czas, kiedy przekierowania w poddrzewie zostały wyczyszczone.
-    size_t deleteTime;
-
-    /// Liczba usuniętych poddrzew. 
-    uint8_t sonsDeleted;
-
-    /// Kolejka wierzchołków, z których istnieje przekierowanie
-    /// do danego wierzchołka.
-    Queue* backwards;
-
-} Node;
-
-/**
- * Struktura przechowująca przekierowania numerów telefonów.
- *
- * Struktura składa się z wierzchołka nadrzędnego,
- * który zawiera przekierowanie do właściwego korzenia TRIE (już typu Node)
- * i czasu struktury
- * (potrzebny do określania kolejności dodawania przekierowań i ich usuwania).
- */
-struct PhoneForward {
-    /// Korzeń TRIE.
-    Node *rootNode;
-
-    /// Czas.
-    size_t time;
-};
+#include "trace.h"
+#include "cache.h"
+#include "jump.h"
+#include "lpm.h"
+#include "resolve.h"
+#include "changelog.h"
+#include "history.h"
+#include "expiry.h"
 
 /**
  * @brief Utworzenie nowego wierzchołka drzewa i inicjalizacja paramterów.
  * 
+ * @param[in] alloc - alokator;
  * @param[in] digit - cyfra, którą ma reprezentować inicjaliowany wierzchołek;
  * @param[in] father - ojciec inicjalizowanego wierzchołka.
  * @return Zainicjalizowany wierzchołek.
  */
-static Node *phfwdNewNode(char digit, Node *father) {
-    Node *pf = malloc(sizeof(Node));
+static Node *phfwdNewNode(PhfwdAllocator const *alloc,
+                          char digit, Node *father) {
+    Node *pf = memAlloc(alloc, sizeof(Node));
     if (pf == NULL) {
         return NULL;
     }
 
-    pf->children = calloc(12, sizeof(Node*));
+    pf->children = memCalloc(alloc, 12, sizeof(Node*));
     if (pf->children == NULL) {
-        free(pf);
+        memFree(alloc, pf);
         return NULL;
     }
 
     pf->father = father;
     pf->fwd = NULL;
 
+    pf->backwards = NULL;
+    pf->history = NULL;
+
+    pf->contentHash = 0;
+
     pf->digit = digit;
+    pf->packed = false;
+    pf->expiryPins = 0;
     pf->depth = (father == NULL ? 0 : father->depth + 1);
+    pf->fwdDepthBelow = 0;
 
     pf->fwdTime = 0;
     pf->deleteTime = 0;
+    pf->hashTime = 0;
 
-    pf->sonsDeleted = 0;
-    
-    pf->backwards = queueNew();
+    return pf;
+}
 
-    if (pf->backwards == NULL) {
-        free(pf->children);
-        free(pf);
+extern PhoneForward *phfwdNew(void) {
+    return phfwdNewWithAllocator(&phfwdSystemAllocator);
+}
 
+extern PhoneForward *phfwdNewWithAllocator(PhfwdAllocator const *alloc) {
+    if (alloc == NULL) {
         return NULL;
     }
 
-    return pf;
-}
-
-extern PhoneForward *phfwdNew(void) {
-    PhoneForward *pf = malloc(sizeof(PhoneForward));
+    PhoneForward *pf = memAlloc(alloc, sizeof(PhoneForward));
     if (pf == NULL) {
         return NULL;
     }
 
     pf->time = 0;
+    pf->epoch = 0;
+    pf->epochBase = 0;
+    pf->epochTimes = NULL;
+    pf->maxFwdDepth = 0;
+    pf->lastRemoveTime = 0;
+    pf->cache = NULL;
+    pf->jump = NULL;
+    pf->lpm = NULL;
+    pf->resolve = NULL;
+    pf->changeLog = NULL;
+    pf->history = NULL;
+    pf->expiry = NULL;
+    pf->compact = NULL;
+    pf->alloc = alloc;
 
     // Ustawienie w korzeniu znaku niebędącego cyfrą (atrapa).
-    Node *rootNode = phfwdNewNode('a', NULL);
+    Node *rootNode = phfwdNewNode(alloc, 'a', NULL);
     if (rootNode == NULL) {
-        free(pf);
+        memFree(alloc, pf);
         return NULL;
     }
 
@@ -177,25 +111,45 @@ extern PhoneForward *phfwdNew(void) {
     return pf;
 }
 
+extern PhoneForward *phfwdNewWithEngine(PhfwdEngine engine) {
+    if (engine != PHFWD_ENGINE_TRIE && engine != PHFWD_ENGINE_HASH) {
+        return NULL;
+    }
+
+    PhoneForward *pf = phfwdNew();
+    if (pf == NULL || engine == PHFWD_ENGINE_TRIE) {
+        return pf;
+    }
+
+    pf->lpm = lpmNew(pf->alloc);
+    if (pf->lpm == NULL) {
+        phfwdDelete(pf);
+        return NULL;
+    }
+
+    return pf;
+}
+
 /**
  * @brief Usunięcie utworzonych wierzchołków przy błędzie alokacji pamięci.
  * 
  * Jeżeli podczas dodawania nowego wierzchołka wystąpi błąd alokacji pamięci,
  * to usuwamy nowoutworzoną ścieżkę.
  * 
+ * @param[in] alloc - alokator;
  * @param[in] currentNode - wierzchołek,
  *                          który udało nam się zaalokować jako ostatni;
  * @param[in] addDepth - głębokość, na której kończymy usuwanie;
  *                       (dotarliśmy do początku nowoutworzonej ścieżki).
  */
-static void deleteUpPath(Node *currentNode, size_t addDepth) {
+static void deleteUpPath(PhfwdAllocator const *alloc,
+                         Node *currentNode, size_t addDepth) {
     while (currentNode->depth > addDepth) {
         Node *father = currentNode->father;
 
         father->children[toInt(currentNode->digit)] = NULL;
-        free(currentNode->children);
-        queueDelete(currentNode->backwards);
-        free(currentNode);
+        memFree(alloc, currentNode->children);
+        memFree(alloc, currentNode);
 
         currentNode = father;
     }
@@ -210,14 +164,16 @@ static void deleteUpPath(Node *currentNode, size_t addDepth) {
  * W razie niepowodzenia (błąd alokacji pamięci)
  * dotychczas utworzona ścieżka zostaje usunięta.
  * 
+ * @param[in] alloc - alokator;
  * @param[in, out] pf - wskaźnik do struktury przechowującej przekierowania
  *                numerów telefonów;
  * @param[in] num - numer telefonu, który mamy znaleźć;
  * @param[in] length - długość numeru.
  * @return Szukany wierzchołek.
  */
-static Node *phfwdFind(Node *pf, char const *num, size_t length) {
-    if (pf == NULL || !ifNumOk(num)) {
+static Node *phfwdFind(PhfwdAllocator const *alloc,
+                       Node *pf, char const *num, size_t length) {
+    if (pf == NULL || !ifNumOk(num) || length > NODE_MAX_DEPTH) {
         return NULL;
     }
 
@@ -230,10 +186,10 @@ static Node *phfwdFind(Node *pf, char const *num, size_t length) {
             // aby w razie czego wiedzieć dokąd usunąć ścieżkę.
             addDepth = min(addDepth, pf->depth + 1);
 
-            Node *node = phfwdNewNode(toChar(digit), pf);
+            Node *node = phfwdNewNode(alloc, toChar(digit), pf);
             // Usunięcie ścieżki w razie niepowodzenia alokacji pamięci.
             if (node == NULL) {
-                deleteUpPath(pf, addDepth);
+                deleteUpPath(alloc, pf, addDepth);
                 return NULL;
             }
 
@@ -246,53 +202,183 @@ static Node *phfwdFind(Node *pf, char const *num, size_t length) {
     return pf;    
 }
 
-/*
- * Dodanie przekierowania wiąże się z odnalezieniem w strukturze
- * wierzchołków reprezentujących num1 oraz num2
- * i ustawieniem pola fwd w pierwszym wierzchołku
- * jako wskaźnik na drugi wierzchołek.
+/**
+ * @brief Aktualizuje ograniczenia głębokości przekierowań po dodaniu
+ * przekierowania.
+ *
+ * Ograniczenia wierzchołków wyczyszczonych poddrzew mogą być zawyżone,
+ * więc przechodzimy zawsze aż do korzenia.
+ *
+ * @param[in, out] node - wierzchołek, z którego dodano przekierowanie.
  */
-extern bool phfwdAdd(PhoneForward *pf, char const *num1, char const *num2) {
+static void raiseFwdDepth(Node *node) {
+    size_t depth = node->depth;
+
+    for (; node != NULL; node = node->father) {
+        node->fwdDepthBelow = max(node->fwdDepthBelow, depth);
+    }
+}
+
+/**
+ * @brief Aktualizuje ograniczenia głębokości przekierowań po wyczyszczeniu
+ * poddrzewa.
+ *
+ * Wszystkie przekierowania z poddrzewa przestają być aktualne, a ograniczenia
+ * przodków wyznaczane są od nowa na podstawie ich synów (ograniczenia
+ * wierzchołków wewnątrz poddrzewa pozostają zawyżone, co jest bezpieczne).
+ *
+ * @param[in, out] node - korzeń wyczyszczonego poddrzewa.
+ */
+static void lowerFwdDepth(Node *node) {
+    node->fwdDepthBelow = 0;
+
+    for (node = node->father; node != NULL; node = node->father) {
+        size_t below = (node->fwd != NULL ? node->depth : 0);
+
+        for (size_t i = 0; i < 12; ++i) {
+            if (node->children[i] != NULL) {
+                below = max(below, node->children[i]->fwdDepthBelow);
+            }
+        }
+
+        node->fwdDepthBelow = below;
+    }
+}
+
+/**
+ * @brief Dodaje przekierowanie (zob. @ref phfwdAdd).
+ *
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania;
+ * @param[in] num1 - wskaźnik na napis reprezentujący prefiks numerów
+ *                   przekierowywanych;
+ * @param[in] num2 - wskaźnik na napis reprezentujący prefiks numerów,
+ *                   na które jest wykonywane przekierowanie.
+ * @return Wartość @p true, jeśli przekierowanie zostało dodane.
+ *         Wartość @p false, jeśli wystąpił błąd.
+ */
+static bool addForward(PhoneForward *pf, char const *num1,
+                       char const *num2) {
     if (!ifNumOk(num1) || !ifNumOk(num2) || pf == NULL 
                        || num1 == num2   || strcmp(num1, num2) == 0) {
         return false;
     }
 
-    Node *num1Node = phfwdFind(pf->rootNode, num1, stringLength(num1));
-    Node *num2Node = phfwdFind(pf->rootNode, num2, stringLength(num2));
+    // Wierzchołki nie przechowują czasów większych niż EPOCH_LIMIT.
+    if (!epochReserve(pf, 1)) {
+        return false;
+    }
+
+    Node *num1Node = phfwdFind(pf->alloc, pf->rootNode,
+                               num1, stringLength(num1));
+    Node *num2Node = phfwdFind(pf->alloc, pf->rootNode,
+                               num2, stringLength(num2));
     if (num1Node == NULL || num2Node == NULL) {
         return false;
     }
 
-    pf->time++;
+    // Wierzchołek num2 mógł zostać właśnie utworzony.
+    if (pf->jump != NULL) {
+        jumpRefresh(pf->jump, pf->rootNode, num2, num2Node->depth);
+    }
+
+    // Indeks nie zawiera jeszcze num1, jeśli jego przekierowanie nie jest
+    // aktualne; wtedy przy niepowodzeniu trzeba je z indeksu wycofać.
+    bool lpmCreated = false;
+    if (pf->lpm != NULL && num1Node->depth <= LPM_MAX_DIGITS
+        && !lpmInsert(pf->lpm, num1, num1Node->depth, num1Node, &lpmCreated)) {
+        return false;
+    }
+
+    if (!bwdSetInsert(pf->alloc, &num2Node->backwards,
+                      num1Node, pf->epoch + 1)) {
+        if (lpmCreated) {
+            lpmErase(pf->lpm, num1, num1Node->depth);
+        }
 
-    num1Node->fwd = num2Node;
-    num1Node->fwdTime = pf->time;
-    
-    Backward *tmp = backwardNew(num1Node, pf->time);
-    if (!queueAdd(tmp, num2Node->backwards)) {
-        free(tmp);
         return false;
     }
 
+    // Skrót zastępowanego przekierowania odejmujemy, jeśli jest aktualne.
+    Backward current = {num1Node, num1Node->fwdTime};
+    uint64_t hashDelta = diffFwdHash(num1, num1Node->depth, num2Node);
+    if (num1Node->fwd != NULL && isBackwardLive(&current)) {
+        hashDelta -= diffFwdHash(num1, num1Node->depth, num1Node->fwd);
+    }
+
+    if (num1Node->fwd != NULL && num1Node->fwd != num2Node) {
+        bwdSetErase(pf->alloc, &num1Node->fwd->backwards, num1Node);
+    }
+
+    Epoch epoch = epochTick(pf);
+    pf->maxFwdDepth = max(pf->maxFwdDepth, num1Node->depth);
+
+    // Zastępowane przekierowanie (również do tego samego celu) trafia
+    // do historii.
+    if (pf->history != NULL && num1Node->fwd != NULL) {
+        historyRecordVersion(pf->history, num1Node, num1Node->fwd,
+                             num1Node->fwdTime, epoch);
+    }
+
+    num1Node->fwd = num2Node;
+    num1Node->fwdTime = epoch;
+    raiseFwdDepth(num1Node);
+    diffUpdatePath(pf->rootNode, num1, num1Node->depth, hashDelta, epoch);
+
+    if (pf->cache != NULL) {
+        cacheInvalidate(pf->cache, num1, num1Node->depth);
+    }
+
+    if (pf->resolve != NULL) {
+        resolveInvalidate(pf->resolve, num1, num1Node->depth);
+    }
+
+    if (pf->changeLog != NULL) {
+        changeLogAppend(pf->changeLog, pf->time, num1, num1Node->depth,
+                        num2, num2Node->depth);
+    }
+
+    if (pf->jump != NULL) {
+        jumpRefresh(pf->jump, pf->rootNode, num1, num1Node->depth);
+    }
+
     return true;
 }
 
+/*
+ * Dodanie przekierowania wiąże się z odnalezieniem w strukturze
+ * wierzchołków reprezentujących num1 oraz num2
+ * i ustawieniem pola fwd w pierwszym wierzchołku
+ * jako wskaźnik na drugi wierzchołek.
+ *
+ * Zastępowane przekierowanie jest od razu usuwane ze zbioru przekierowań
+ * wstecz poprzedniego celu, dzięki czemu każdy wierzchołek występuje
+ * w co najwyżej jednym zbiorze.
+ */
+extern bool phfwdAdd(PhoneForward *pf, char const *num1, char const *num2) {
+    // Mierzymy również wywołania odrzucone i nieudane.
+    TRACE_BEGIN(traceAdd);
+    bool added = addForward(pf, num1, num2);
+    TRACE_END(traceAdd, PHFWD_TRACE_ADD);
+
+    return added;
+}
+
 /**
  * @brief Zwrócenie numeru reprezentowanego przez dany wierzchołek.
  * Algorytm polega na przejściu od @p node do korzenia na podstawie @p father.
  * Dzięki parametrowi @p depth znamy końcową długość napisu
  * i możemy od razu uzupełniać wynikową tablicę.
+ * @param[in] alloc - alokator;
  * @param[in] node - wierzchołek, do którego mamy znaleźć odpowiadający numer.
  * @return Znaleziony numer.
  */
-static char *phfwdRead(Node *node) {
+static char *phfwdRead(PhfwdAllocator const *alloc, Node *node) {
     if (node == NULL) {
         return NULL;
     }
 
     size_t depth = node->depth;
-    char *result = malloc(sizeof(char) * (depth + 1));
+    char *result = memAlloc(alloc, sizeof(char) * (depth + 1));
     if (result == NULL) {
         return NULL;
     }
@@ -307,35 +393,60 @@ static char *phfwdRead(Node *node) {
     return result;
 }
 
-/**
- * @brief Znalezienie ostatniego przekierowania od korzenia do wierzchołka.
+/*
  * Algorytm wyszukania tego wierzchołka polega na przejściu ścieżki
  * od korzenia do wierzchołka reprezentującego @p num i
  * znalezieniu dzięki temu ostatniego wierzchołka zawierającego przekierowanie.
- * @param[in] node - wierzchołek początkowy;
- * @param[in] num - zadany numer
- * @return Wierzchołek reprezentujący najdłuższy możliwy prefiks numeru,
- *         z którego istnieje przekierowanie.
+ * Jeśli włączona jest tablica skoków, przejście zaczyna się od jej pozycji
+ * dla początku numeru, z zapamiętanym stanem wyszukiwania. Przejście kończy
+ * się wcześniej, jeśli poniżej bieżącego wierzchołka nie ma już aktualnych
+ * przekierowań (zob. @p fwdDepthBelow).
  */
-static Node *phfwdFindLastFwd(Node *node, char const *num) {
-    if (node == NULL || !ifNumOk(num)) {
-        return NULL;
+extern Node *findLastFwdPrefix(PhoneForward const *pf, char const *num,
+                               size_t depth) {
+    // Indeks nie zna przekierowań z prefiksów dłuższych niż LPM_MAX_DIGITS.
+    if (pf->lpm != NULL
+        && (depth <= LPM_MAX_DIGITS || pf->maxFwdDepth <= LPM_MAX_DIGITS)) {
+        return lpmFind(pf->lpm, num, depth);
     }
 
+    Node *node = pf->rootNode;
     Node *result = NULL;
-    size_t depth = stringLength(num);
     size_t maxTime = 0;
+    size_t i = 0;
 
-    for (size_t i = 0; i < depth && node != NULL; ++i) {
+    if (pf->jump != NULL && depth >= pf->jump->depth) {
+        JumpEntry const *entry = jumpLookup(pf->jump, num);
+
+        node = entry->node;
+        result = entry->lastFwd;
+        maxTime = entry->maxTime;
+        i = pf->jump->depth;
+    }
+
+    // Liczba odwiedzonych wierzchołków to liczba wykonanych kroków pętli
+    // (zob. PHFWD_TRACE_WALK_STEPS).
+    TRACE_MARK(walkStart, i);
+    TRACE_COUNT(PHFWD_TRACE_WALKS, 1);
+
+    for (; i < depth && node != NULL; ++i) {
         maxTime = max(maxTime, node->deleteTime);
 
         if (node->fwd != NULL && node->fwdTime > maxTime) {
             result = node;
         }
 
+        // Głębiej nie ma już żadnego aktualnego przekierowania.
+        if (node->fwdDepthBelow <= node->depth) {
+            TRACE_COUNT(PHFWD_TRACE_WALK_STEPS, i - walkStart + 1);
+            return result;
+        }
+
         node = node->children[toInt(num[i])];
     }
 
+    TRACE_COUNT(PHFWD_TRACE_WALK_STEPS, i - walkStart + (node != NULL));
+
     // Sprawdzenie ostatniego wierzchołka
     // (na głębokości równej długości napisu)
     if (node != NULL) {
@@ -349,23 +460,42 @@ static Node *phfwdFindLastFwd(Node *node, char const *num) {
     return result;
 }
 
+/**
+ * @brief Znalezienie ostatniego przekierowania od korzenia do wierzchołka
+ * reprezentującego napis @p num (zob. @ref findLastFwdPrefix).
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania;
+ * @param[in] num - zadany numer
+ * @return Wierzchołek reprezentujący najdłuższy możliwy prefiks numeru,
+ *         z którego istnieje przekierowanie, lub NULL, jeśli go nie ma
+ *         lub napis nie reprezentuje numeru.
+ */
+static Node *phfwdFindLastFwd(PhoneForward const *pf, char const *num) {
+    if (pf == NULL || !ifNumOk(num)) {
+        return NULL;
+    }
+
+    return findLastFwdPrefix(pf, num, stringLength(num));
+}
+
 /**
  * @brief Konstrukcja wyniku funkcji phfwdGet.
  * Konstrukcja składa się z określenia na co przekierowujemy zadany numer
  * (prefix wyniku) oraz uzupełnienia wyniku resztą oryginalnego numeru.
+ * @param[in] alloc - alokator;
  * @param[in] num - numer, z którego wykonujemy przekierowanie;
  * @param[in] NumLastFwd - wierzchołek zawierający ostatnie przekierowanie
  *                     na trasie od korzenia do wierzchołka
  *                     reprezentującego @p num.
  * @return Przekierowany napis.
  */
-static char *constructResultString(char const *num, Node *NumLastFwd) {
+static char *constructResultString(PhfwdAllocator const *alloc,
+                                   char const *num, Node *NumLastFwd) {
     if (num == NULL || NumLastFwd == NULL) {
         return NULL;
     }
 
     // Początkowa wartość wyniku - ostatnie możliwe przekierowanie numeru.
-    char *resultString = phfwdRead(NumLastFwd->fwd);
+    char *resultString = phfwdRead(alloc, NumLastFwd->fwd);
 
     if (resultString == NULL) {
         return NULL;
@@ -378,10 +508,10 @@ static char *constructResultString(char const *num, Node *NumLastFwd) {
     char *backup = resultString;
     // Zaalokowanie pamięci potrzebnej na wynik
     // (możemy określić jego długość na podstawie znanych parametrów).
-    resultString = realloc(resultString, sizeof(char) *
-                          (fwdLength - lastFwdLength + numLength + 1));
+    resultString = memRealloc(alloc, resultString, sizeof(char) *
+                              (fwdLength - lastFwdLength + numLength + 1));
     if (resultString == NULL) {
-        free(backup);
+        memFree(alloc, backup);
         return NULL;
     }
 
@@ -408,231 +538,433 @@ extern PhoneNumbers *phfwdGet(PhoneForward const *pf, char const *num) {
     }
 
     if (!ifNumOk(num)) {
-        return phnumNew();
+        return phnumNew(pf->alloc);
     }
 
-    Node *NumLastFwd = phfwdFindLastFwd(pf->rootNode, num);
+    TRACE_BEGIN(traceGet);
+    TRACE_MARK(tracePhase, traceGet);
 
-    if (NumLastFwd == NULL) {
-        PhoneNumbers *result = phnumNew();
-        if (result == NULL) {
-            return NULL;
+    char *resultString;
+    char cached[CACHE_MAX_DIGITS + 1];
+    size_t length = stringLength(num);
+
+    if (pf->cache != NULL && cacheLookup(pf->cache, num, length, cached)) {
+        resultString = copyString(pf->alloc, cached);
+        TRACE_LAP(tracePhase, PHFWD_TRACE_CACHE_HIT);
+    }
+    else {
+        Node *NumLastFwd = phfwdFindLastFwd(pf, num);
+        TRACE_LAP(tracePhase, PHFWD_TRACE_FIND_LAST_FWD);
+
+        // Jeśli numer nie jest przekierowany, wynikiem jest on sam.
+        resultString = (NumLastFwd == NULL ?
+                        copyString(pf->alloc, num) :
+                        constructResultString(pf->alloc, num, NumLastFwd));
+        TRACE_LAP(tracePhase, PHFWD_TRACE_CONSTRUCT_RESULT);
+
+        if (pf->cache != NULL && resultString != NULL) {
+            cacheStore(pf->cache, num, length,
+                       resultString, stringLength(resultString));
         }
+    }
 
-        char *copy = copyString(num);
-        if (!phnumAdd(result, copy)) {
-            free(copy);
-            free(result);
-            return NULL;
+    PhoneNumbers *result = phnumNew(pf->alloc);
+    if (result == NULL || !phnumAdd(result, resultString)) {
+        memFree(pf->alloc, resultString);
+        phnumDelete(result);
+        result = NULL;
+    }
+
+    // Czas całego wywołania obejmuje też trafienia w pamięć podręczną
+    // i nieudane alokacje wyniku.
+    TRACE_END(traceGet, PHFWD_TRACE_GET);
+
+    return result;
+}
+
+/*
+ * Wynik składa się z przekierowania ostatniego przekierowanego prefiksu
+ * (odczytanego od końca, idąc w górę drzewa) oraz reszty numeru. Znaki,
+ * które nie mieszczą się w buforze, są pomijane.
+ */
+extern size_t phfwdGetInto(PhoneForward const *pf, char const *num,
+                           size_t length, char *buffer, size_t size) {
+    if (pf == NULL || num == NULL || length == 0) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < length; ++i) {
+        if (toInt(num[i]) < 0) {
+            return 0;
         }
+    }
 
-        return result;
+    Node const *lastFwd = findLastFwdPrefix(pf, num, length);
+    Node const *fwd = (lastFwd == NULL ? NULL : lastFwd->fwd);
+    size_t prefixLength = (lastFwd == NULL ? 0 : lastFwd->depth);
+    size_t fwdLength = (fwd == NULL ? 0 : fwd->depth);
+    size_t resultLength = fwdLength + length - prefixLength;
+
+    if (size == 0) {
+        return resultLength;
     }
 
-    char *resultString = constructResultString(num, NumLastFwd);
-    PhoneNumbers *result = phnumNew();
-    if (result == NULL) {
-        free(resultString);
-        return NULL;
+    size_t limit = min(resultLength, size - 1);
+
+    for (size_t i = fwdLength; i > 0; --i, fwd = fwd->father) {
+        if (i <= limit) {
+            buffer[i - 1] = fwd->digit;
+        }
     }
 
-    if (!phnumAdd(result, resultString)) {
-        free(resultString);
-        phnumDelete(result);
-        return NULL;
+    if (limit > fwdLength) {
+        memcpy(buffer + fwdLength, num + prefixLength, limit - fwdLength);
     }
 
-    return result;
+    buffer[limit] = '\0';
+
+    return resultLength;
 }
 
 /**
- * @brief Sprawdza, czy przekierowanie jest aktualne.
- * 
- * Sprawdzamy wszystkie wierzchołki na trasie od wierzchołka,
- * z którego wyszło przekierowanie do korzenia
- * i sprawdzamy czy poddrzewo, w którym się znajdujemy był czyszczony.
- * 
- * @param[in] bwd - struktura Backward (określa badane przekierowane).
- * @return Wartość @p true jeśli przekierowanie jest aktualne,
- *         wartość @p false w przeciwnym wypadku.
+ * @brief Sprawdza, czy w poddrzewie numeru może być aktualne przekierowanie
+ * z numeru dłuższego niż @p num.
+ *
+ * @param[in] root - korzeń drzewa;
+ * @param[in] num - numer;
+ * @param[in] length - długość numeru.
+ * @return Wartość @p false, jeśli takiego przekierowania na pewno nie ma,
+ *         wartość @p true w przeciwnym wypadku.
+ */
+static bool mayHaveFwdBelow(Node const *root, char const *num,
+                            size_t length) {
+    Node const *node = root;
+
+    for (size_t i = 0; i < length && node != NULL; ++i) {
+        node = node->children[toInt(num[i])];
+    }
+
+    return node != NULL && node->fwdDepthBelow > node->depth;
+}
+
+/**
+ * @brief Wyznacza domknięcie przekierowania z prefiksu.
+ *
+ * Wykonuje kolejne przekierowania z numeru docelowego prefiksu @p source,
+ * dopóki nie zależą one od dalszych cyfr numeru, czyli dopóki w poddrzewie
+ * otrzymanego numeru nie ma aktualnych przekierowań.
+ *
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania;
+ * @param[in] source - wierzchołek z aktualnym przekierowaniem;
+ * @param[out] closure - wyznaczone domknięcie.
+ * @return Wartość @p true jeśli wyznaczono domknięcie,
+ *         wartość @p false jeśli numery są zbyt długie, by je zapamiętać.
  */
-static bool isNotClearedBefore(Backward *bwd) {
-    if (bwd == NULL || bwd->fwdTime < bwd->fwdFrom->fwdTime) {
+static bool buildClosure(PhoneForward const *pf, Node const *source,
+                         ResolveClosure *closure) {
+    char chain[RESOLVE_MAX_CHAIN][RESOLVE_MAX_DIGITS + 1];
+    char sourceNum[RESOLVE_MAX_DIGITS];
+
+    if (source->depth > RESOLVE_MAX_DIGITS
+        || source->fwd->depth > RESOLVE_MAX_DIGITS) {
         return false;
     }
 
-    Node *currentNode = bwd->fwdFrom;
+    closure->source = source;
+    closure->status = RESOLVE_PARTIAL;
+    closure->depCount = 0;
+    resolveDepend(closure, sourceNum, nodeWrite(source, sourceNum));
 
-    while (currentNode != NULL) {
-        if (currentNode->deleteTime > bwd->fwdTime) {
-            return false;
+    size_t length = nodeWrite(source->fwd, chain[0]);
+    size_t hops = 1;
+    chain[0][length] = '\0';
+
+    while (closure->status == RESOLVE_PARTIAL) {
+        char const *current = chain[hops - 1];
+
+        resolveDepend(closure, current, length);
+        if (mayHaveFwdBelow(pf->rootNode, current, length)) {
+            break;
         }
 
-        currentNode = currentNode->father;
+        Node const *next = phfwdFindLastFwd(pf, current);
+        if (next == NULL) {
+            closure->status = RESOLVE_TERMINAL;
+            break;
+        }
+
+        size_t nextLength = next->fwd->depth + length - next->depth;
+        if (hops == RESOLVE_MAX_CHAIN || nextLength > RESOLVE_MAX_DIGITS) {
+            break;
+        }
+
+        char *following = chain[hops++];
+        nodeWrite(next->fwd, following);
+        memcpy(following + next->fwd->depth, current + next->depth,
+               length - next->depth);
+        following[nextLength] = '\0';
+        length = nextLength;
+
+        // Powrót do numeru z łańcucha powtarza się dla każdego sufiksu.
+        for (size_t i = 0; i + 1 < hops; ++i) {
+            if (strcmp(chain[i], following) == 0) {
+                closure->status = RESOLVE_CYCLE;
+            }
+        }
     }
-    
+
+    closure->hops = hops;
+    closure->length = length;
+    memcpy(closure->prefix, chain[hops - 1], length + 1);
+
     return true;
 }
 
 /**
- * @brief Skonstruuje końcowy napis funkcji phfwdReverse.
- * 
- * @param[in] num - sufiks oryginalnego napisu;
- * @param[in] fwdFrom - wierzchołek reprezentujący numer,
- * na który przekierowany został prefiks oryginalnego numeru.
- * @return Połącznie dwóch napisów (num i tego reprezentowanego przez fwdFrom),
- *         wartość @p NULL jeśli dodanie się nie udało.
+ * @brief Zastępuje prefiks numeru innym prefiksem.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in] num - numer;
+ * @param[in] dropped - długość zastępowanego prefiksu;
+ * @param[in] prefix - nowy prefiks;
+ * @param[in] length - długość nowego prefiksu.
+ * @return Nowy numer lub NULL, gdy nie udało się alokować pamięci.
  */
-static char *constructResultStringRev(char const *num, Node *fwdFrom) {
-    if (num == NULL || fwdFrom == NULL) {
+static char *replacePrefix(PhfwdAllocator const *alloc, char const *num,
+                           size_t dropped, char const *prefix, size_t length) {
+    size_t rest = stringLength(num) - dropped;
+    char *result = memAlloc(alloc, sizeof(char) * (length + rest + 1));
+    if (result == NULL) {
         return NULL;
     }
 
-    // Początkowa wartość wyniku - oryginalne przekierowanie.
-    char *resultString = phfwdRead(fwdFrom);
+    memcpy(result, prefix, length);
+    memcpy(result + length, num + dropped, rest + 1);
 
-    if (resultString == NULL) {
+    return result;
+}
+
+/**
+ * @brief Wyznacza domknięcie przekierowania z prefiksu, korzystając
+ * z pamięci domknięć.
+ *
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania;
+ * @param[in] source - wierzchołek z aktualnym przekierowaniem.
+ * @return Domknięcie lub NULL, jeśli pamięć domknięć jest wyłączona lub
+ *         numery są zbyt długie, by je zapamiętać.
+ */
+static ResolveClosure const *findClosure(PhoneForward *pf,
+                                         Node const *source) {
+    if (pf->resolve == NULL) {
         return NULL;
     }
 
-    size_t fwdLength = fwdFrom->depth;
-    size_t numLength = stringLength(num) - 1;
+    ResolveClosure const *closure = resolveLookup(pf->resolve, source);
+    if (closure == NULL) {
+        ResolveClosure built;
 
-    char *backup = resultString;
-    // Zaalokowanie pamięci potrzebnej na wynik
-    // (możemy określić jego długość na podstawie znanych parametrów).
-    resultString = realloc(resultString, sizeof(char) *
-                          (fwdLength + numLength + 1));
-    if (resultString == NULL) {
-        free(backup);
-        return NULL;
-    }
+        if (!buildClosure(pf, source, &built)) {
+            return NULL;
+        }
 
-    // Przepisanie reszty numeru do ostatecznego wyniku.
-    for (long long i = 0; i <= (long long) numLength - 1; ++i) {
-        resultString[fwdLength + i] = num[i + 1];
+        resolveStore(pf->resolve, &built);
+        closure = resolveLookup(pf->resolve, source);
     }
 
-    resultString[fwdLength + numLength] = '\0';
-
-    return resultString;
+    return closure;
 }
 
 /**
- * @brief Rozpatrzenie przekierowań na jeden prefiks oryginalnego numeru.
- * 
- * @param[in, out] pnumResult - wskaźnik do wynikowej struktury
- * (na nią wrzucamy znalezione numery)
- * @param[in] currentNode - wierzchołek reprezentujący dany prefiks
- * @param[in] num - sufiks oryginalnego numeru
- * @return Wartość @p true jeśli nie wystąpił błąd alokacji pamięci,
- *         wartość @p false w przeciwnym wypadku.
+ * @brief Sprawdza, czy łańcuch przekierowań rośnie w nieskończoność.
+ *
+ * Krok łańcucha zależy tylko od pierwszych @p bound cyfr numeru (dłuższych
+ * przekierowanych prefiksów nie ma) i zmienia tylko te cyfry. Jeśli
+ * od zapamiętanego numeru żaden numer łańcucha nie był krótszy niż
+ * @p minLength, ostatnie @p minLength - @p bound cyfr zapamiętanego numeru
+ * pozostało nietknięte, a kroki zależały tylko od jego początku x. Jeśli
+ * bieżący numer zaczyna się od x c dla niepustego c, te same kroki
+ * powtórzą się z x c w miejscu x, potem z x c c itd., więc łańcuch się
+ * nie kończy.
+ *
+ * @param[in] anchor - zapamiętany numer łańcucha;
+ * @param[in] anchorLength - długość zapamiętanego numeru;
+ * @param[in] current - bieżący numer łańcucha;
+ * @param[in] length - długość bieżącego numeru;
+ * @param[in] minLength - najmniejsza długość numeru łańcucha od zapamiętanego
+ *                        do bieżącego;
+ * @param[in] bound - ograniczenie górne długości przekierowanych prefiksów.
+ * @return Wartość @p true, jeśli łańcuch rośnie w nieskończoność.
  */
-static bool lookBackwards(PhoneNumbers *pnumResult,
-                          Node *currentNode, char const *num) {
-    if (pnumResult == NULL || currentNode == NULL || num == NULL)  {
+static bool isGrowingChain(char const *anchor, size_t anchorLength,
+                           char const *current, size_t length,
+                           size_t minLength, size_t bound) {
+    if (minLength < bound || length <= anchorLength) {
         return false;
     }
 
-    Queue *q = currentNode->backwards;
-    // Nowa kolejka - w trakcie przeglądania przekierowań wstecz
-    // będziemy przepisywać przekierowania wstecz z oryginalnej kolejki
-    // pomijając te, które nie są już aktualne.
-    Queue *newQ = queueNew();
-    // Kopia oryginalnej kolejki - pozwala zachować oryginalne wartości
-    // kolejki w wypadku błędu alokacji pamięci
-    // (nie wykonujemy operacji, które mogą się nie powieść,
-    // na oryginalnej kolejce).
-    Queue *copyQ = queueCopy(q);
-
-    if (newQ == NULL || copyQ == NULL) {
-        queueDelete(newQ);
-        queueDelete(copyQ);
-        return false;
+    size_t front = anchorLength - (minLength - bound);
+
+    return strncmp(anchor, current, front) == 0;
+}
+
+/*
+ * Łańcuch wykonujemy krokami: krok z numeru o najdłuższym przekierowanym
+ * prefiksie s to domknięcie s (lub, bez domknięcia, jedno przekierowanie).
+ * Kolejne numery po krokach są więc wyznaczone przez poprzednie, a cykl
+ * wykrywamy algorytmem Brenta: numer porównujemy z zapamiętanym numerem,
+ * który zmieniamy na bieżący po 1, 2, 4, ... krokach. Z tym samym
+ * zapamiętanym numerem porównujemy łańcuchy rosnące w nieskończoność
+ * (zob. isGrowingChain), np. dla przekierowania 1 -> 12, które inaczej
+ * budowałyby coraz dłuższe numery aż do wyczerpania pamięci.
+ *
+ * Brak pamięci na pamięć domknięć nie jest błędem - łańcuch wykonywany jest
+ * wtedy po jednym przekierowaniu.
+ */
+extern PhoneNumbers *phfwdResolve(PhoneForward *pf, char const *num,
+                                  size_t maxHops) {
+    if (pf == NULL) {
+        return NULL;
     }
 
-    while (!queueIsEmpty(copyQ)) {
-        Backward *bwd = queueGet(copyQ);
-        
-        if (isNotClearedBefore(bwd)) {
-            char *resultString = constructResultStringRev(num, bwd->fwdFrom);
-            // Zwalnianie pamięci przy niepowodzeniach poszczególnych operacji.
-            if (!phnumAdd(pnumResult, resultString)) {
-                free(bwd);
-                queueDelete(newQ);
-                queueDelete(copyQ);
-                free(resultString);
+    PhoneNumbers *result = phnumNew(pf->alloc);
+    if (result == NULL || !ifNumOk(num)) {
+        return result;
+    }
 
-                return false;
-            }
+    if (pf->resolve == NULL) {
+        pf->resolve = resolveNew(pf->alloc);
+    }
 
-            if (!queueAdd(bwd, newQ)) {
-                free(bwd);
-                queueDelete(newQ);
-                queueDelete(copyQ);
+    char *current = copyString(pf->alloc, num);
+    char *tortoise = copyString(pf->alloc, num);
+    size_t tortoiseLength = stringLength(num);
+    size_t minLength = tortoiseLength;
+    size_t bound = pf->rootNode->fwdDepthBelow;
+    size_t hops = 0;
+    size_t power = 1;
+    size_t lambda = 0;
+    bool finished = false;
+
+    while (current != NULL && tortoise != NULL) {
+        Node *source = phfwdFindLastFwd(pf, current);
+        if (source == NULL) {
+            finished = true;
+            break;
+        }
 
-                return false;
-            }
+        ResolveClosure const *closure = findClosure(pf, source);
+        size_t stepHops = (closure == NULL ? 1 : closure->hops);
+        if (stepHops > maxHops - hops
+            || (closure != NULL && closure->status == RESOLVE_CYCLE)) {
+            break;
+        }
+
+        char *next = (closure == NULL ?
+                      constructResultString(pf->alloc, current, source) :
+                      replacePrefix(pf->alloc, current, source->depth,
+                                    closure->prefix, closure->length));
+        memFree(pf->alloc, current);
+        current = next;
+        hops += stepHops;
+
+        if (current == NULL) {
+            break;
+        }
+
+        if (closure != NULL && closure->status == RESOLVE_TERMINAL) {
+            finished = true;
+            break;
+        }
+
+        size_t length = stringLength(current);
+        minLength = min(minLength, length);
+        if (strcmp(current, tortoise) == 0
+            || isGrowingChain(tortoise, tortoiseLength, current, length,
+                              minLength, bound)) {
+            break;
         }
-        else {
-            free(bwd);
+
+        if (++lambda == power) {
+            memFree(pf->alloc, tortoise);
+            tortoise = copyString(pf->alloc, current);
+            tortoiseLength = length;
+            minLength = length;
+            power *= 2;
+            lambda = 0;
         }
     }
 
-    currentNode->backwards = newQ;
-    queueDelete(copyQ);
-    queueDelete(q);
+    bool failed = (current == NULL || tortoise == NULL);
+    memFree(pf->alloc, tortoise);
 
-    return true;
-}
+    if (failed || !finished) {
+        memFree(pf->alloc, current);
 
-/**
- * @brief Usuwa struktury zadanych w razie wystąpienia błędu alokacji pamięci.
- * 
- * @param[in] possibleResults - wskaźnik do struktury z potencjalnymi wynikami
- * (wynik funkcji phfwdReverse);
- * @param[in] result - wskaźnik do struktury z numerami,
- * które zostały uznane za faktyczne wyniki;
- * @param[in] pnumIthAfterGet - wskaźnik do wyniku funkcji @ref phfwdGet
- * na i-tym numerze @p possibleResults.
- */
-static void handleMemoryError(PhoneNumbers *possibleResults,
-    PhoneNumbers *result, PhoneNumbers *pnumIthAfterGet) {
-    phnumDelete(possibleResults);
-    phnumDelete(result);
-    phnumDelete(pnumIthAfterGet);
+        if (failed) {
+            phnumDelete(result);
+            return NULL;
+        }
+
+        return result;
+    }
+
+    if (!phnumAdd(result, current)) {
+        memFree(pf->alloc, current);
+        phnumDelete(result);
+        return NULL;
+    }
+
+    return result;
 }
 
 /**
- * @brief Sytuacja, w której potencjalny wynik okazuje się faktycznym wynikiem.
- * 
- * Wskaźniki do wszystkich struktur podane są w parametrach funkcji,
- * aby w razie potrzeby można było wyczyścić zaalokowaną na nie pamięć.
- * @param[in] ith - i-ty numer struktury @p possibleResults
- * (numer, który okazuje się jednym z faktycznych wyników);
- * @param possibleResults - wskaźnik do struktury z potencjalnymi wynikami
- * (wynik funkcji phfwdReverse)
- * @param result - wskaźnik do struktury z numerami,
- * które zostały uznane za faktyczne wyniki;
- * @param pnumIthAfterGet wskaźnik do wyniku funkcji @ref phfwdGet
- * na i-tym numerze @p possibleResults.
- * @return Zmodyfikowana struktura @p result (powiększona o jeden numer),
- *         NULL jeśli dodanie na strukturę wynikową się nie powiodło.
+ * @brief Wyznacza wynik phfwdGetReverse dla poprawnego numeru.
+ *
+ * Kandydatów z kursora phfwdReverse sprawdzamy na bieżąco,
+ * bez materializowania całego wyniku phfwdReverse.
+ *
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania;
+ * @param[in] num - poprawny numer.
+ * @return Wskaźnik na strukturę z wynikiem lub NULL, gdy nie udało się
+ *         alokować pamięci.
  */
-static PhoneNumbers *handleEqualStrings(
-    char const *ith, PhoneNumbers *possibleResults, PhoneNumbers *result,
-    PhoneNumbers *pnumIthAfterGet) {
-    char *oneOfTheResults = copyString(ith);
-    if (oneOfTheResults == NULL) {
-        handleMemoryError(possibleResults, result, pnumIthAfterGet);
+static PhoneNumbers *getReverse(PhoneForward const *pf, char const *num) {
+    PhfwdReverseCursor *cursor = phfwdReverseOpen(pf, num);
+    PhoneNumbers *result = phnumNew(pf->alloc);
+
+    if (cursor == NULL || result == NULL) {
+        phfwdReverseClose(cursor);
+        phnumDelete(result);
         return NULL;
     }
 
-    if (!phnumAdd(result, oneOfTheResults)) {
-        handleMemoryError(possibleResults, result, pnumIthAfterGet);
-        return NULL;
+    char const *candidate;
+    while ((candidate = phfwdReverseNext(cursor)) != NULL) {
+        PhoneNumbers *candidateAfterGet = phfwdGet(pf, candidate);
+        char const *afterGet = phnumGet(candidateAfterGet, 0);
+        if (afterGet == NULL) {
+            phnumDelete(candidateAfterGet);
+            phfwdReverseClose(cursor);
+            phnumDelete(result);
+            return NULL;
+        }
+
+        if (areStringsEqual(afterGet, num)) {
+            char *copy = copyString(pf->alloc, candidate);
+            if (!phnumAdd(result, copy)) {
+                memFree(pf->alloc, copy);
+                phnumDelete(candidateAfterGet);
+                phfwdReverseClose(cursor);
+                phnumDelete(result);
+                return NULL;
+            }
+        }
+
+        phnumDelete(candidateAfterGet);
     }
 
+    phfwdReverseClose(cursor);
+
     return result;
 }
 
@@ -641,112 +973,117 @@ extern PhoneNumbers *phfwdGetReverse(PhoneForward const *pf, char const *num) {
         return NULL;
 
     if (!ifNumOk(num))
-        return phnumNew();
+        return phnumNew(pf->alloc);
 
-    PhoneNumbers *possibleResults = phfwdReverse(pf, num);
-    PhoneNumbers *result = phnumNew();
+    // Mierzymy również wywołania nieudane.
+    TRACE_BEGIN(traceGetReverse);
+    PhoneNumbers *result = getReverse(pf, num);
+    TRACE_END(traceGetReverse, PHFWD_TRACE_GET_REVERSE);
 
-    if (possibleResults == NULL || result == NULL) {
-        handleMemoryError(possibleResults, result, NULL);
-        return NULL;
-    }
+    return result;
+}
 
-    size_t count = getCount(possibleResults);
-    for (size_t i = 0; i < count; ++i) {
-        char const *ith = phnumGet(possibleResults, i);
-        if (ith == NULL) {
-            handleMemoryError(possibleResults, result, NULL);
-            return NULL;
-        }
+/**
+ * @brief Zbiera numery zwracane przez kursor.
+ *
+ * Kursor zostaje zamknięty niezależnie od wyniku.
+ *
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania;
+ * @param[in] cursor - kursor (NULL oznacza błąd jego otwarcia);
+ * @param[in] limit - największa liczba zbieranych numerów.
+ * @return Wskaźnik na strukturę z zebranymi numerami lub NULL,
+ *         gdy nie udało się alokować pamięci.
+ */
+static PhoneNumbers *collectReverse(PhoneForward const *pf,
+                                    PhfwdReverseCursor *cursor,
+                                    size_t limit) {
+    PhoneNumbers *result = phnumNew(pf->alloc);
 
-        PhoneNumbers *pnumIthAfterGet = phfwdGet(pf, ith);
-        if (pnumIthAfterGet == NULL) {
-            handleMemoryError(possibleResults, result, NULL);
-            return NULL;
-        }
+    if (cursor == NULL || result == NULL) {
+        phfwdReverseClose(cursor);
+        phnumDelete(result);
+        return NULL;
+    }
 
-        char const *ithAfterGet = phnumGet(pnumIthAfterGet, 0);
-        if (ithAfterGet == NULL) {
-            handleMemoryError(possibleResults, result, pnumIthAfterGet);
+    char const *next;
+    while (getCount(result) < limit
+           && (next = phfwdReverseNext(cursor)) != NULL) {
+        char *copy = copyString(pf->alloc, next);
+        if (!phnumAdd(result, copy)) {
+            memFree(pf->alloc, copy);
+            phfwdReverseClose(cursor);
+            phnumDelete(result);
             return NULL;
         }
-
-        if (areStringsEqual(ithAfterGet, num)) {
-            result = handleEqualStrings(ith, possibleResults,
-                                        result, pnumIthAfterGet);
-            if (result == NULL)
-                return NULL;
-        }
-
-        phnumDelete(pnumIthAfterGet);
     }
 
-    phnumDelete(possibleResults);
+    phfwdReverseClose(cursor);
 
     return result;
 }
 
+/*
+ * Wynik jest zbierany z kursora, który zwraca numery już posortowane
+ * i bez powtórzeń.
+ */
 extern PhoneNumbers *phfwdReverse(PhoneForward const *pf, char const *num) {
     if (pf == NULL) {
         return NULL;
     }
 
     if (!ifNumOk(num)) {
-        return phnumNew();
+        return phnumNew(pf->alloc);
     }
 
-    Node *currentNode = pf->rootNode->children[toInt(*num)];
-    
-    PhoneNumbers *pnumResult = phnumNew();
-    if (pnumResult == NULL) {
-        return NULL;
-    }
+    TRACE_BEGIN(traceReverse);
+    TRACE_MARK(tracePhase, traceReverse);
+
+    PhfwdReverseCursor *cursor = phfwdReverseOpen(pf, num);
+    TRACE_LAP(tracePhase, PHFWD_TRACE_REVERSE_OPEN);
+
+    PhoneNumbers *result = collectReverse(pf, cursor, SIZE_MAX);
+    TRACE_LAP(tracePhase, PHFWD_TRACE_REVERSE_MERGE);
+
+    TRACE_SINCE(traceReverse, tracePhase, PHFWD_TRACE_REVERSE);
 
-    if (!phnumAdd(pnumResult, copyString(num))) {
-        phnumDelete(pnumResult);
+    return result;
+}
+
+/*
+ * Kursor zaczyna od pierwszego numeru większego od after,
+ * więc nie przegląda numerów z wcześniejszych stron.
+ */
+extern PhoneNumbers *phfwdReverseRange(PhoneForward const *pf, char const *num,
+                                       char const *after, size_t limit) {
+    if (pf == NULL) {
         return NULL;
     }
 
-    // Przeglądanie prefiksów dopóki ciąg znaków się nie skończy.
-    while (currentNode != NULL && *num != '\0') {
-        // Sprawdzenie danego prefiksu.
-        if (!lookBackwards(pnumResult, currentNode, num)) {
-            phnumDelete(pnumResult);
-            return NULL;
-        }
-        
-        // Skrócenie napisu.
-        num += sizeof(char);
-        
-        // Sprawdzenie, czy ciąg znaków nie skończył się podczas przesunięcia.
-        if (*num != '\0') {
-            // Sprawdzenie, czy istnieje wierzchołek,
-            // do którego chcemy przejść istnieje.
-            if (currentNode->children[toInt(*num)] != NULL) {
-                currentNode = currentNode->children[toInt(*num)];
-            }
-            else {
-                break;
-            }
-        }
+    if (!ifNumOk(num) || (after != NULL && !ifNumOk(after))) {
+        return phnumNew(pf->alloc);
     }
-    
-    phnumSort(pnumResult); 
 
-    return phnumRemoveDuplicates(pnumResult);
+    return collectReverse(pf, phfwdReverseOpenAfter(pf, num, after), limit);
 }
 
-/*
- * Usunięcie poddrzewa nie polega na fizycznym usunięciu poddrzewa
- * (ani przekierowań z niego wychodzących),
- * lecz na ustawieniu w wierzchołku czasu jego wyczyszczenia.
+/**
+ * @brief Usuwa przekierowania z numerów o danym prefiksie
+ * (zob. @ref phfwdRemove).
+ *
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania;
+ * @param[in] num - wskaźnik na napis reprezentujący prefiks numerów.
  */
-extern void phfwdRemove(PhoneForward *pf, char const *num) {
+static void removeForwards(PhoneForward *pf, char const *num) {
     if (!ifNumOk(num) || pf == NULL) {
         return;
     }
 
-    Node *removeNode = phfwdFind(pf->rootNode, num, stringLength(num));
+    if (!epochReserve(pf, 1)) {
+        return;
+    }
+
+    Node *removeNode = phfwdFind(pf->alloc, pf->rootNode,
+                                 num, stringLength(num));
     if (removeNode == NULL) {
         return;
     }
@@ -756,8 +1093,52 @@ extern void phfwdRemove(PhoneForward *pf, char const *num) {
     // z największym czasem wyczyszczenia wśród przodków.
     //
     // Dodatkowo następuje zwiększenie czasu struktury.
-    pf->time++;
-    removeNode->deleteTime = pf->time;
+    if (pf->lpm != NULL) {
+        lpmEraseSubtree(pf->lpm, removeNode);
+    }
+
+    Epoch epoch = epochTick(pf);
+    diffUpdatePath(pf->rootNode, num, removeNode->depth,
+                   -diffSubtreeHash(pf->rootNode, num, removeNode->depth),
+                   epoch);
+
+    if (pf->history != NULL && removeNode->deleteTime != 0) {
+        historyRecordRemoval(pf->history, removeNode, removeNode->deleteTime,
+                             epoch);
+    }
+
+    removeNode->deleteTime = epoch;
+    pf->lastRemoveTime = epoch;
+    lowerFwdDepth(removeNode);
+
+    if (pf->cache != NULL) {
+        cacheInvalidate(pf->cache, num, removeNode->depth);
+    }
+
+    if (pf->resolve != NULL) {
+        resolveInvalidate(pf->resolve, num, removeNode->depth);
+    }
+
+    if (pf->changeLog != NULL) {
+        changeLogAppend(pf->changeLog, pf->time, num, removeNode->depth,
+                        NULL, 0);
+    }
+
+    if (pf->jump != NULL) {
+        jumpRefresh(pf->jump, pf->rootNode, num, removeNode->depth);
+    }
+}
+
+/*
+ * Usunięcie poddrzewa nie polega na fizycznym usunięciu poddrzewa
+ * (ani przekierowań z niego wychodzących),
+ * lecz na ustawieniu w wierzchołku czasu jego wyczyszczenia.
+ */
+extern void phfwdRemove(PhoneForward *pf, char const *num) {
+    // Mierzymy również wywołania odrzucone i nieudane.
+    TRACE_BEGIN(traceRemove);
+    removeForwards(pf, num);
+    TRACE_END(traceRemove, PHFWD_TRACE_REMOVE);
 }
 
 /*
@@ -768,35 +1149,103 @@ extern void phfwdDelete(PhoneForward *pf) {
         return;
     }
 
+    // Historia odwołuje się do wierzchołków, więc usuwamy ją przed nimi.
+    historyDelete(pf->history);
+
+    // Synów odwiedzamy w kolejności cyfr, a wierzchołek zwalniamy po
+    // zwolnieniu wszystkich jego poddrzew; po powrocie do ojca szukamy
+    // kolejnego syna za cyfrą zwolnionego.
     Node *node = pf->rootNode;
-    // Sprawdzenie czy wszystkie poddrzewa struktury zostały usunięte.
-    while (pf->rootNode->sonsDeleted < 12) {
-
-        // Sprawdzenie czy wszystkie poddrzewa wierzchołka
-        // zostały usunięte.
-        if (node->sonsDeleted == 12) {
-
-            // Zwolnienie pamięci, powrót do ojca
-            // oraz zwiększenie liczby usuniętych poddrzew.
-            free(node->children);
-            queueDelete(node->backwards);
-            Node *backup = node->father;
-            free(node);
-            node = backup;
-            node->sonsDeleted++;
+    int first = 0;
+
+    while (node != NULL) {
+        while (first < 12 && node->children[first] == NULL) {
+            first++;
         }
-        // Przejście do syna w celu jego usunięcia.
-        else if (node->children[node->sonsDeleted] != NULL) {
-            node = node->children[node->sonsDeleted];
+
+        if (first < 12) {
+            node = node->children[first];
+            first = 0;
+            continue;
         }
-        // Zwiększenie liczby usuniętych poddrzew.
-        else {
-            node->sonsDeleted++;
+
+        Node *father = node->father;
+        first = (father == NULL ? 0 : toInt(node->digit) + 1);
+
+        bwdSetClear(pf->alloc, &node->backwards);
+
+        // Wierzchołki z bloków zwalniamy razem z blokami.
+        if (!node->packed) {
+            memFree(pf->alloc, node->children);
+            memFree(pf->alloc, node);
         }
+
+        node = father;
+    }
+
+    compactDelete(pf->compact);
+
+    cacheDelete(pf->cache);
+    jumpDelete(pf->alloc, pf->jump);
+    lpmDelete(pf->lpm);
+    resolveDelete(pf->resolve);
+    changeLogDelete(pf->changeLog);
+    expiryDelete(pf->expiry);
+    memFree(pf->alloc, pf->epochTimes);
+    memFree(pf->alloc, pf);
+}
+
+/*
+ * Nowa pamięć podręczna zastępuje poprzednią dopiero po udanej alokacji.
+ */
+extern bool phfwdEnableCache(PhoneForward *pf, size_t capacity) {
+    if (pf == NULL) {
+        return false;
     }
 
-    free(pf->rootNode->children);
-    queueDelete(pf->rootNode->backwards);
-    free(pf->rootNode);
-    free(pf);
+    PhfwdCache *cache = NULL;
+    if (capacity > 0) {
+        cache = cacheNew(pf->alloc, capacity);
+        if (cache == NULL) {
+            return false;
+        }
+    }
+
+    cacheDelete(pf->cache);
+    pf->cache = cache;
+
+    return true;
+}
+
+extern bool phfwdCacheStats(PhoneForward const *pf, PhfwdCacheStats *stats) {
+    if (pf == NULL || pf->cache == NULL || stats == NULL) {
+        return false;
+    }
+
+    cacheStats(pf->cache, stats);
+
+    return true;
+}
+
+/*
+ * Nowa tablica skoków zastępuje poprzednią dopiero po udanej alokacji.
+ */
+extern bool phfwdEnableJumpTable(PhoneForward *pf, size_t depth) {
+    if (pf == NULL || (depth != 0 && (depth < JUMP_MIN_DEPTH
+                                      || depth > JUMP_MAX_DEPTH))) {
+        return false;
+    }
+
+    JumpTable *jump = NULL;
+    if (depth > 0) {
+        jump = jumpNew(pf->alloc, pf->rootNode, depth);
+        if (jump == NULL) {
+            return false;
+        }
+    }
+
+    jumpDelete(pf->alloc, pf->jump);
+    pf->jump = jump;
+
+    return true;
 }
\ No newline at end of file
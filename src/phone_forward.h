@@ -1,6 +1,13 @@
 /** @file
  * Interfejs klasy przechowującej przekierowania numerów telefonicznych.
  *
+ * Interfejsy opcjonalnych części biblioteki znajdują się w osobnych
+ * nagłówkach: phone_forward_query.h, phone_forward_reverse.h,
+ * phone_forward_tuning.h, phone_forward_bulk.h, phone_forward_changelog.h,
+ * phone_forward_history.h, phone_forward_expiry.h, phone_forward_overlay.h,
+ * phone_forward_store.h, phone_forward_sharded.h, phone_forward_frozen.h,
+ * allocator.h i trace.h.
+ *
  * @author Marcin Peczarski <marpe@mimuw.edu.pl>
  * @author Jagoda Bobińska <jb438249@students.mimuw.edu.pl>
  * @copyright Uniwersytet Warszawski
@@ -31,18 +38,6 @@ struct Backward;
  */
 typedef struct Backward Backward;
 
-/**
- * @brief Utworzenie kopii zadanej struktury Backward.
- * 
- * Funkcja przydatna jest podczas kopiowania kolejki
- * (nie mamy wtedy dostępu do poszczególnych argumentów Backward,
- * więc jesteśmy zmuszeni kopiować strukturę jako całość).
- * 
- * @param[in] bwd - wskaźnik do kopiowanej struktury.
- * @return Wskaźnik do skopiowanej struktury.
- */
-Backward *makeCopyBackward(Backward *bwd);
-
 struct Node;
 /**
  * Definiuje strukturę Node (wierzchołek).
@@ -0,0 +1,546 @@
+/** @file phone_forward_batch.c
+ * Wsadowe wykonywanie pliku poleceń na strukturze przechowującej
+ * przekierowania.
+ *
+ * Plik poleceń składa się z poleceń rozdzielonych białymi znakami:
+ * - `NUM > NUM` – dodaje przekierowanie;
+ * - `NUM ?` – wypisuje przekierowanie numeru;
+ * - `? NUM` – wypisuje w kolejnych wierszach przeciwobraz numeru;
+ * - `DEL NUM` – usuwa przekierowania z prefiksu.
+ *
+ * Operatory nie muszą być oddzielone od numerów. Plik jest mapowany do
+ * pamięci, numery rozpoznawane są po osiem znaków naraz, a wyniki zbierane
+ * są w dużym buforze wypisywanym bezpośrednio wywołaniem write. Przy
+ * pierwszym błędnym poleceniu program wypisuje na standardowe wyjście
+ * diagnostyczne `ERROR n`, gdzie n to numer (od 1) pierwszego znaku
+ * błędnego polecenia, i kończy się kodem 1.
+ *
+ * Użycie:
+ * - phone_forward_batch [-s] PLIK – wykonuje polecenia z pliku (`-` oznacza
+ *   standardowe wejście), z opcją `-s` wypisuje też przepustowość;
+ * - phone_forward_batch -g LICZBA – wypisuje losowy plik z zadaną liczbą
+ *   poleceń do pomiaru przepustowości.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "phone_forward.h"
+
+/// Rozmiar bufora wyjścia.
+#define BATCH_OUTPUT_SIZE (1 << 20)
+
+/// Słowo z jedynką w każdym bajcie.
+#define BYTE_ONES 0x0101010101010101ULL
+
+/// Słowo z ustawionym najstarszym bitem każdego bajtu.
+#define BYTE_HIGHS 0x8080808080808080ULL
+
+/**
+ * @brief Bufor wyjścia.
+ */
+typedef struct Output {
+    /// Deskryptor, do którego wypisujemy.
+    int fd;
+    /// Liczba zapisanych bajtów.
+    size_t size;
+    /// Czy wystąpił błąd zapisu.
+    bool failed;
+    /// Dane.
+    char data[BATCH_OUTPUT_SIZE];
+} Output;
+
+/**
+ * @brief Bufor na numer zakończony znakiem '\0'.
+ */
+typedef struct Scratch {
+    /// Numer.
+    char *data;
+    /// Rozmiar zaalokowanej pamięci.
+    size_t capacity;
+} Scratch;
+
+/**
+ * @brief Wypisuje zawartość bufora wyjścia.
+ *
+ * @param[in, out] out - bufor wyjścia.
+ */
+static void flushOutput(Output *out) {
+    size_t offset = 0;
+
+    while (!out->failed && offset < out->size) {
+        ssize_t written = write(out->fd, out->data + offset,
+                                out->size - offset);
+        if (written < 0) {
+            out->failed = (errno != EINTR);
+        }
+        else {
+            offset += (size_t) written;
+        }
+    }
+
+    out->size = 0;
+}
+
+/**
+ * @brief Dopisuje do bufora wyjścia wiersz.
+ *
+ * @param[in, out] out - bufor wyjścia;
+ * @param[in] line - wiersz (bez znaku końca wiersza);
+ * @param[in] length - długość wiersza.
+ */
+static void writeLine(Output *out, char const *line, size_t length) {
+    if (out->size + length + 1 > BATCH_OUTPUT_SIZE) {
+        flushOutput(out);
+    }
+
+    // Wiersz dłuższy niż bufor wypisujemy we fragmentach.
+    while (length + 1 > BATCH_OUTPUT_SIZE) {
+        memcpy(out->data, line, BATCH_OUTPUT_SIZE);
+        out->size = BATCH_OUTPUT_SIZE;
+        flushOutput(out);
+        line += BATCH_OUTPUT_SIZE;
+        length -= BATCH_OUTPUT_SIZE;
+    }
+
+    memcpy(out->data + out->size, line, length);
+    out->size += length;
+    out->data[out->size++] = '\n';
+}
+
+/**
+ * @brief Oznacza bajty słowa równe zero.
+ *
+ * @param[in] word - słowo.
+ * @return Słowo z ustawionym najstarszym bitem dokładnie tych bajtów,
+ *         które w @p word są równe zero.
+ */
+static inline uint64_t zeroBytes(uint64_t word) {
+    uint64_t low = (word & ~BYTE_HIGHS) + ~BYTE_HIGHS;
+
+    return ~(low | word) & BYTE_HIGHS;
+}
+
+/**
+ * @brief Oznacza bajty słowa będące cyframi dziesiętnymi.
+ *
+ * Żadne odejmowanie ani dodawanie nie przenosi się między bajtami, więc
+ * wynik jest dokładny dla każdego bajtu.
+ *
+ * @param[in] word - słowo.
+ * @return Słowo z ustawionym najstarszym bitem dokładnie tych bajtów,
+ *         które w @p word są cyframi od '0' do '9'.
+ */
+static inline uint64_t decimalBytes(uint64_t word) {
+    uint64_t low = word & ~BYTE_HIGHS;
+    uint64_t notAbove = BYTE_ONES * (127 + '9' + 1) - low;
+    uint64_t notBelow = low + BYTE_ONES * (127 - ('0' - 1));
+
+    return notAbove & notBelow & ~word & BYTE_HIGHS;
+}
+
+/**
+ * @brief Sprawdza, czy znak należy do alfabetu numerów.
+ *
+ * @param[in] c - znak.
+ * @return Wartość @p true jeśli znak jest cyfrą, '*' lub '#',
+ *         wartość @p false w przeciwnym wypadku.
+ */
+static inline bool isNumberChar(char c) {
+    return (c >= '0' && c <= '9') || c == '*' || c == '#';
+}
+
+/**
+ * @brief Wyznacza długość numeru zaczynającego się w danym miejscu.
+ *
+ * Na maszynach little-endian sprawdza osiem znaków naraz.
+ *
+ * @param[in] begin - początek numeru;
+ * @param[in] end - koniec danych.
+ * @return Liczba kolejnych znaków z alfabetu numerów.
+ */
+static size_t numberLength(char const *begin, char const *end) {
+    char const *p = begin;
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    while (end - p >= 8) {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+
+        uint64_t inAlphabet = decimalBytes(word)
+                              | zeroBytes(word ^ (BYTE_ONES * '*'))
+                              | zeroBytes(word ^ (BYTE_ONES * '#'));
+        uint64_t outside = ~inAlphabet & BYTE_HIGHS;
+
+        if (outside != 0) {
+            p += __builtin_ctzll(outside) / 8;
+            return (size_t) (p - begin);
+        }
+
+        p += 8;
+    }
+#endif
+
+    while (p < end && isNumberChar(*p)) {
+        p++;
+    }
+
+    return (size_t) (p - begin);
+}
+
+/**
+ * @brief Sprawdza, czy znak jest białym znakiem.
+ *
+ * @param[in] c - znak.
+ * @return Wartość @p true jeśli znak jest białym znakiem,
+ *         wartość @p false w przeciwnym wypadku.
+ */
+static inline bool isBlank(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v'
+           || c == '\f';
+}
+
+/**
+ * @brief Pomija białe znaki.
+ *
+ * @param[in] p - bieżąca pozycja;
+ * @param[in] end - koniec danych.
+ * @return Pozycja pierwszego znaku, który nie jest biały.
+ */
+static char const *skipBlanks(char const *p, char const *end) {
+    while (p < end && isBlank(*p)) {
+        p++;
+    }
+
+    return p;
+}
+
+/**
+ * @brief Wczytuje numer do bufora.
+ *
+ * @param[in, out] p - bieżąca pozycja, po wczytaniu za numerem;
+ * @param[in] end - koniec danych;
+ * @param[in, out] scratch - bufor.
+ * @return Numer zakończony znakiem '\0' lub NULL, jeśli w bieżącej pozycji
+ *         (po pominięciu białych znaków) nie ma numeru lub nie udało się
+ *         alokować pamięci.
+ */
+static char const *readNumber(char const **p, char const *end,
+                              Scratch *scratch) {
+    char const *begin = skipBlanks(*p, end);
+    size_t length = numberLength(begin, end);
+
+    if (length == 0) {
+        return NULL;
+    }
+
+    if (length + 1 > scratch->capacity) {
+        size_t capacity = 2 * (length + 1);
+        char *data = realloc(scratch->data, capacity);
+        if (data == NULL) {
+            return NULL;
+        }
+
+        scratch->data = data;
+        scratch->capacity = capacity;
+    }
+
+    memcpy(scratch->data, begin, length);
+    scratch->data[length] = '\0';
+    *p = begin + length;
+
+    return scratch->data;
+}
+
+/**
+ * @brief Wykonuje polecenia.
+ *
+ * @param[in, out] pf - struktura przechowująca przekierowania;
+ * @param[in] data - polecenia;
+ * @param[in] size - rozmiar poleceń;
+ * @param[in, out] out - bufor wyjścia;
+ * @param[out] commands - liczba wykonanych poleceń.
+ * @return Zero, jeśli wszystkie polecenia były poprawne, lub numer (od 1)
+ *         pierwszego znaku pierwszego błędnego polecenia.
+ */
+static size_t execute(PhoneForward *pf, char const *data, size_t size,
+                      Output *out, size_t *commands) {
+    char const *end = data + size;
+    char const *p = skipBlanks(data, end);
+    Scratch first = {NULL, 0}, second = {NULL, 0};
+    size_t error = 0;
+
+    *commands = 0;
+
+    while (p < end && error == 0) {
+        char const *command = p;
+        char const *num1;
+
+        if (*p == '?') {
+            p++;
+            num1 = readNumber(&p, end, &first);
+            PhoneNumbers *result = (num1 == NULL ? NULL
+                                                 : phfwdReverse(pf, num1));
+            char const *num;
+
+            for (size_t i = 0; (num = phnumGet(result, i)) != NULL; ++i) {
+                writeLine(out, num, strlen(num));
+            }
+
+            error = (result == NULL);
+            phnumDelete(result);
+        }
+        else if (end - p >= 3 && memcmp(p, "DEL", 3) == 0) {
+            p += 3;
+            num1 = readNumber(&p, end, &first);
+            if (num1 != NULL) {
+                phfwdRemove(pf, num1);
+            }
+
+            error = (num1 == NULL);
+        }
+        else if ((num1 = readNumber(&p, end, &first)) != NULL) {
+            p = skipBlanks(p, end);
+
+            if (p < end && *p == '?') {
+                p++;
+                PhoneNumbers *result = phfwdGet(pf, num1);
+                char const *num = phnumGet(result, 0);
+
+                if (num != NULL) {
+                    writeLine(out, num, strlen(num));
+                }
+
+                error = (num == NULL);
+                phnumDelete(result);
+            }
+            else if (p < end && *p == '>') {
+                p++;
+                char const *num2 = readNumber(&p, end, &second);
+
+                error = (num2 == NULL || !phfwdAdd(pf, num1, num2));
+            }
+            else {
+                error = 1;
+            }
+        }
+        else {
+            error = 1;
+        }
+
+        if (error != 0) {
+            error = (size_t) (command - data) + 1;
+        }
+        else {
+            (*commands)++;
+            p = skipBlanks(p, end);
+        }
+    }
+
+    free(first.data);
+    free(second.data);
+
+    return error;
+}
+
+/**
+ * @brief Wypisuje losowy plik poleceń.
+ *
+ * Co dziesiąte polecenie dodaje przekierowanie, co pięćdziesiąte usuwa
+ * przekierowania z prefiksu, co dziesiąte pyta o przeciwobraz, a pozostałe
+ * pytają o przekierowanie. Numery zaczynają się jednym z kilkuset
+ * prefiksów.
+ *
+ * @param[in] count - liczba poleceń;
+ * @param[in, out] out - bufor wyjścia.
+ */
+static void generate(size_t count, Output *out) {
+    unsigned seed = 1;
+    char line[64];
+
+    for (size_t i = 0; i < count; ++i) {
+        char num1[16], num2[16];
+        unsigned roll = (unsigned) rand_r(&seed) % 50;
+
+        snprintf(num1, sizeof(num1), "%u%u", 100 + rand_r(&seed) % 400,
+                 (unsigned) rand_r(&seed) % 1000000);
+        snprintf(num2, sizeof(num2), "%u%u", 100 + rand_r(&seed) % 400,
+                 (unsigned) rand_r(&seed) % 1000);
+
+        int length;
+        if (roll < 5) {
+            length = snprintf(line, sizeof(line), "%.*s > %s",
+                              4 + rand_r(&seed) % 4, num1, num2);
+        }
+        else if (roll < 6) {
+            length = snprintf(line, sizeof(line), "DEL %.*s",
+                              4 + rand_r(&seed) % 4, num1);
+        }
+        else if (roll < 11) {
+            length = snprintf(line, sizeof(line), "? %s", num2);
+        }
+        else {
+            length = snprintf(line, sizeof(line), "%s ?", num1);
+        }
+
+        writeLine(out, line, (size_t) length);
+    }
+}
+
+/**
+ * @brief Wczytuje całe dane z deskryptora, który nie może być zmapowany.
+ *
+ * @param[in] fd - deskryptor;
+ * @param[out] size - rozmiar danych.
+ * @return Dane lub NULL w przypadku błędu.
+ */
+static char *readAll(int fd, size_t *size) {
+    size_t capacity = 1 << 20;
+    char *data = malloc(capacity);
+
+    *size = 0;
+    while (data != NULL) {
+        if (*size == capacity) {
+            capacity *= 2;
+            char *grown = realloc(data, capacity);
+            if (grown == NULL) {
+                break;
+            }
+            data = grown;
+        }
+
+        ssize_t received = read(fd, data + *size, capacity - *size);
+        if (received == 0) {
+            return data;
+        }
+
+        if (received > 0) {
+            *size += (size_t) received;
+        }
+        else if (errno != EINTR) {
+            break;
+        }
+    }
+
+    free(data);
+
+    return NULL;
+}
+
+/**
+ * @brief Zwraca bieżący czas.
+ *
+ * @return Czas w sekundach.
+ */
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Uruchamia program.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty.
+ * @return Kod wyjścia.
+ */
+int main(int argc, char *argv[]) {
+    static Output out;
+    out.fd = STDOUT_FILENO;
+
+    if (argc == 3 && strcmp(argv[1], "-g") == 0) {
+        generate(strtoul(argv[2], NULL, 10), &out);
+        flushOutput(&out);
+        return out.failed;
+    }
+
+    bool stats = (argc == 3 && strcmp(argv[1], "-s") == 0);
+    if (argc != 2 && !stats) {
+        fprintf(stderr, "usage: %s [-s] FILE | -g COUNT\n", argv[0]);
+        return 1;
+    }
+
+    char const *path = argv[argc - 1];
+    int fd = (strcmp(path, "-") == 0 ? STDIN_FILENO : open(path, O_RDONLY));
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) < 0) {
+        perror(path);
+        return 1;
+    }
+
+    size_t size = 0;
+    char *data = NULL;
+    bool mapped = false;
+
+    if (S_ISREG(info.st_mode) && info.st_size > 0) {
+        size = (size_t) info.st_size;
+        data = mmap(NULL, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        mapped = (data != MAP_FAILED);
+        if (mapped) {
+            madvise(data, size, MADV_SEQUENTIAL);
+        }
+        else {
+            data = NULL;
+        }
+    }
+
+    if (!mapped && (!S_ISREG(info.st_mode) || info.st_size > 0)) {
+        data = readAll(fd, &size);
+        if (data == NULL) {
+            perror(path);
+            return 1;
+        }
+    }
+
+    PhoneForward *pf = phfwdNew();
+    if (pf == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    double start = now();
+    size_t commands;
+    size_t error = execute(pf, data, size, &out, &commands);
+    flushOutput(&out);
+    double seconds = now() - start;
+
+    if (error != 0) {
+        fprintf(stderr, "ERROR %zu\n", error);
+    }
+
+    if (stats) {
+        fprintf(stderr, "%zu bytes, %zu commands, %.3f s, %.1f MB/s, "
+                        "%.0f commands/s\n", size, commands, seconds,
+                (double) size / seconds / 1e6, (double) commands / seconds);
+    }
+
+    phfwdDelete(pf);
+    if (mapped) {
+        munmap(data, size);
+    }
+    else {
+        free(data);
+    }
+    if (fd != STDIN_FILENO) {
+        close(fd);
+    }
+
+    return (error != 0 || out.failed);
+}
@@ -0,0 +1,118 @@
+/** @file phone_forward_bulk.h
+ * Interfejs operacji na całej strukturze przechowującej przekierowania:
+ * kopiowania, przeglądania, porównywania i kompaktowania.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __PHONE_FORWARD_BULK_H__
+#define __PHONE_FORWARD_BULK_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "phone_forward.h"
+
+/** @brief Tworzy kopię struktury.
+ * Tworzy niezależną strukturę z tymi samymi przekierowaniami, czasem
+ * i zegarem (wraz z terminami wygaśnięcia przekierowań), korzystającą
+ * z tego samego alokatora i sposobu wyszukiwania, z pustą pamięcią
+ * podręczną tej samej pojemności i tablicą skoków tej samej długości.
+ * Kopia nie ma dziennika modyfikacji ani historii przekierowań. Koszt
+ * kopiowania jest liniowy względem rozmiaru struktury: wierzchołki drzewa
+ * kopiowane są jednym przejściem, a zbiory przekierowań wstecz całymi
+ * blokami.
+ * @param[in] pf – wskaźnik na kopiowaną strukturę.
+ * @return Wskaźnik na kopię lub NULL, gdy nie udało się alokować pamięci
+ *         lub @p pf ma wartość NULL.
+ */
+PhoneForward * phfwdClone(PhoneForward const *pf);
+
+/**
+ * @brief Funkcja otrzymująca kolejne przekierowania od @ref phfwdForEach.
+ * Otrzymuje kontekst przekazany do @ref phfwdForEach, numer, z którego
+ * wychodzi przekierowanie, i numer, do którego ono prowadzi (oba napisy
+ * są ważne jedynie w czasie wywołania). Zwraca wartość @p false, aby
+ * przerwać przekazywanie przekierowań.
+ */
+typedef bool (*PhfwdForwardCallback)(void *context, char const *num1,
+                                     char const *num2);
+
+/** @brief Przekazuje wszystkie aktualne przekierowania o podanym prefiksie.
+ * Wywołuje @p callback dla każdego aktualnego przekierowania z numeru
+ * zaczynającego się od @p prefix, w porządku leksykograficznym numerów
+ * (cyfry przed '*', a '*' przed '#'). Nie alokuje pamięci, o ile numery
+ * przekierowań mają co najwyżej 64 cyfry. Struktura nie może być
+ * modyfikowana w czasie przekazywania przekierowań.
+ * @param[in] pf       – wskaźnik na strukturę przechowującą przekierowania
+ *                       numerów;
+ * @param[in] prefix   – wskaźnik na napis reprezentujący prefiks numerów
+ *                       lub pusty napis (wszystkie przekierowania);
+ * @param[in] callback – funkcja otrzymująca przekierowania;
+ * @param[in] context  – kontekst przekazywany do @p callback.
+ * @return Wartość @p true, jeśli przekazano wszystkie przekierowania.
+ *         Wartość @p false, jeśli któryś ze wskaźników ma wartość NULL,
+ *         @p prefix nie reprezentuje numeru, nie udało się alokować pamięci
+ *         lub @p callback przerwał przekazywanie.
+ */
+bool phfwdForEach(PhoneForward const *pf, char const *prefix,
+                  PhfwdForwardCallback callback, void *context);
+
+/**
+ * @brief Funkcja otrzymująca kolejne różnice od @ref phfwdDiff.
+ * Otrzymuje kontekst przekazany do @ref phfwdDiff, numer, z którego
+ * wychodzi przekierowanie, oraz numer docelowy w pierwszej i w drugiej
+ * strukturze (NULL, jeśli w danej strukturze nie ma aktualnego
+ * przekierowania z tego numeru). Napisy są ważne jedynie w czasie
+ * wywołania. Zwraca wartość @p false, aby przerwać przekazywanie różnic.
+ */
+typedef bool (*PhfwdDiffCallback)(void *context, char const *num,
+                                  char const *before, char const *after);
+
+/** @brief Przekazuje różnice między dwiema strukturami.
+ * Wywołuje @p callback dla każdego numeru, z którego przekierowanie jest
+ * aktualne tylko w jednej ze struktur lub prowadzi w nich do różnych
+ * numerów, w porządku leksykograficznym numerów (jak @ref phfwdForEach).
+ * Struktury porównywane są za pomocą skrótów zawartości poddrzew,
+ * utrzymywanych przy każdej modyfikacji, więc identyczne poddrzewa są
+ * pomijane, a koszt zależy od liczby różnic, a nie od rozmiaru struktur.
+ * Różnice mogą zostać pominięte z prawdopodobieństwem rzędu
+ * @f$2^{-64}@f$. Struktury nie mogą być modyfikowane w czasie porównania.
+ * @param[in] first    – wskaźnik na pierwszą strukturę (jej alokator
+ *                       przydziela pamięć porównania);
+ * @param[in] second   – wskaźnik na drugą strukturę;
+ * @param[in] callback – funkcja otrzymująca różnice;
+ * @param[in] context  – kontekst przekazywany do @p callback.
+ * @return Wartość @p true, jeśli przekazano wszystkie różnice.
+ *         Wartość @p false, jeśli któryś ze wskaźników ma wartość NULL,
+ *         nie udało się alokować pamięci lub @p callback przerwał
+ *         przekazywanie.
+ */
+bool phfwdDiff(PhoneForward const *first, PhoneForward const *second,
+               PhfwdDiffCallback callback, void *context);
+
+/** @brief Kompaktuje strukturę przyrostowo.
+ * Przechodzi kolejny fragment drzewa w porządku leksykograficznym numerów,
+ * zaczynając tam, gdzie skończyło poprzednie wywołanie, i odwiedza co
+ * najwyżej @p budget wierzchołków. Usuwa przekierowania, które przestały być
+ * aktualne (wraz z ich przekierowaniami wstecz), zwalnia wierzchołki, które
+ * nie są już potrzebne, a pozostałe przenosi do dużych bloków pamięci tak,
+ * by wierzchołki numerów o wspólnych prefiksach leżały obok siebie.
+ * Nie zmienia wyników zapytań ani czasu struktury; przy włączonej historii
+ * usuwa jedynie przekierowania nieaktualne już w chwili horyzontu.
+ * Wierzchołki z historią lub z oczekującymi terminami wygaśnięcia pozostają
+ * na miejscu. Dla kursorów, nakładek i @ref phfwdForEach wywołanie jest
+ * modyfikacją struktury. Koszt wywołania jest proporcjonalny do @p budget.
+ * @param[in,out] pf – wskaźnik na strukturę przechowującą przekierowania
+ *                     numerów;
+ * @param[in] budget – największa liczba odwiedzanych wierzchołków.
+ * @return Wartość @p true, jeśli wywołanie zakończyło przejście całego drzewa
+ *         (kolejne zacznie nowe przejście). Wartość @p false, jeśli zostały
+ *         wierzchołki do odwiedzenia, @p pf ma wartość NULL lub nie udało się
+ *         alokować pamięci.
+ */
+bool phfwdCompact(PhoneForward *pf, size_t budget);
+
+#endif /* __PHONE_FORWARD_BULK_H__ */
@@ -0,0 +1,648 @@
+/** @file phone_forward_cdr.c
+ * Równoległe przepisywanie rekordów połączeń (CDR) przekierowaniami.
+ *
+ * Program wczytuje przekierowania z pliku wierszy `NUM > NUM`, a następnie
+ * w każdym wierszu pliku rekordów zastępuje wskazane pole wynikiem
+ * @ref phfwdGetInto. Pola, które nie są numerami, pozostają bez zmian.
+ * Zmapowany plik rekordów dzielony jest na fragmenty kończące się na
+ * granicy wierszy. Fragmenty przetwarzane są przez pulę wątków z kolejkami
+ * z podkradaniem zadań, a wyniki wypisywane są w kolejności fragmentów.
+ * W obróbce jest naraz co najwyżej ustalona liczba fragmentów, a bufory ich
+ * wyników są używane wielokrotnie, więc przepisanie rekordu nie alokuje
+ * pamięci.
+ *
+ * Użycie: phone_forward_cdr PRZEKIEROWANIA REKORDY [-t wątki] [-f pole]
+ *         [-d separator] [-h] [-s]
+ *
+ * Pola numerowane są od zera. Opcja `-h` wybiera haszujący indeks
+ * prefiksów (@ref PHFWD_ENGINE_HASH). Z opcją `-s` program wypisuje na
+ * standardowe wyjście diagnostyczne przepustowość. Skalowanie z liczbą
+ * wątków mierzy cel bench_cdr (skrypt bench/cdr_scaling.sh).
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "phone_forward.h"
+#include "phone_forward_query.h"
+#include "phone_forward_tuning.h"
+
+/// Docelowy rozmiar fragmentu pliku rekordów.
+#define CDR_CHUNK_SIZE (1 << 20)
+
+/// Liczba fragmentów w obróbce na jeden wątek.
+#define CDR_WINDOW_PER_THREAD 4
+
+/**
+ * @brief Fragment pliku rekordów wraz z buforem wyniku.
+ */
+typedef struct Chunk {
+    /// Początek fragmentu.
+    char const *begin;
+    /// Koniec fragmentu.
+    char const *end;
+    /// Wynik.
+    char *out;
+    /// Długość wyniku.
+    size_t size;
+    /// Rozmiar bufora wyniku.
+    size_t capacity;
+    /// Czy nie udało się alokować pamięci na wynik.
+    bool failed;
+    /// Czy fragment jest przetworzony.
+    atomic_bool done;
+} Chunk;
+
+/**
+ * @brief Kolejka zadań wątku.
+ *
+ * Właściciel pobiera zadania z początku (najstarsze, których wyniki będą
+ * najszybciej potrzebne), a pozostałe wątki podkradają je z końca.
+ */
+typedef struct Deque {
+    /// Muteks kolejki.
+    pthread_mutex_t lock;
+    /// Numery fragmentów.
+    size_t *items;
+    /// Pozycja początku kolejki.
+    size_t head;
+    /// Liczba zadań w kolejce.
+    size_t count;
+    /// Rozmiar tablicy @p items.
+    size_t capacity;
+} Deque;
+
+/**
+ * @brief Pula wątków przepisujących rekordy.
+ */
+typedef struct Pool {
+    /// Struktura przechowująca przekierowania (tylko do odczytu).
+    PhoneForward const *pf;
+    /// Numer przepisywanego pola.
+    size_t field;
+    /// Separator pól.
+    char delimiter;
+    /// Liczba wątków.
+    unsigned threads;
+    /// Kolejki zadań wątków.
+    Deque *deques;
+    /// Fragmenty w obróbce, indeksowane numerem fragmentu modulo
+    /// @p window.
+    Chunk *chunks;
+    /// Liczba fragmentów w obróbce.
+    size_t window;
+    /// Liczba zadań w kolejkach.
+    atomic_size_t pending;
+    /// Muteks usypiania wątków.
+    pthread_mutex_t lock;
+    /// Zmienna warunkowa: pojawiło się zadanie.
+    pthread_cond_t work;
+    /// Zmienna warunkowa: przetworzono fragment.
+    pthread_cond_t finished;
+    /// Czy nie będzie już nowych zadań.
+    bool closing;
+    /// Liczba podkradzionych zadań.
+    atomic_size_t steals;
+} Pool;
+
+/**
+ * @brief Zapewnia w buforze wyniku fragmentu miejsce na kolejne znaki.
+ *
+ * @param[in, out] chunk - fragment;
+ * @param[in] length - liczba znaków.
+ * @return Wartość @p true jeśli operacja się powiodła,
+ *         wartość @p false jeśli nie udało się alokować pamięci.
+ */
+static bool reserve(Chunk *chunk, size_t length) {
+    if (chunk->size + length <= chunk->capacity) {
+        return true;
+    }
+
+    size_t capacity = 2 * (chunk->size + length);
+    char *out = realloc(chunk->out, capacity);
+    if (out == NULL) {
+        return false;
+    }
+
+    chunk->out = out;
+    chunk->capacity = capacity;
+
+    return true;
+}
+
+/**
+ * @brief Dopisuje do wyniku fragmentu znaki.
+ *
+ * @param[in, out] chunk - fragment;
+ * @param[in] data - znaki;
+ * @param[in] length - liczba znaków.
+ * @return Wartość @p true jeśli operacja się powiodła,
+ *         wartość @p false jeśli nie udało się alokować pamięci.
+ */
+static bool append(Chunk *chunk, char const *data, size_t length) {
+    if (!reserve(chunk, length)) {
+        return false;
+    }
+
+    memcpy(chunk->out + chunk->size, data, length);
+    chunk->size += length;
+
+    return true;
+}
+
+/**
+ * @brief Przepisuje rekordy fragmentu.
+ *
+ * @param[in] pool - pula wątków;
+ * @param[in, out] chunk - fragment.
+ */
+static void rewriteChunk(Pool const *pool, Chunk *chunk) {
+    char const *p = chunk->begin;
+
+    chunk->size = 0;
+    chunk->failed = !reserve(chunk, (size_t) (chunk->end - chunk->begin));
+
+    while (p < chunk->end && !chunk->failed) {
+        char const *lineEnd = memchr(p, '\n', (size_t) (chunk->end - p));
+        lineEnd = (lineEnd == NULL ? chunk->end : lineEnd + 1);
+
+        // Wyszukanie przepisywanego pola.
+        char const *field = p;
+        for (size_t i = 0; i < pool->field && field != NULL; ++i) {
+            field = memchr(field, pool->delimiter,
+                           (size_t) (lineEnd - field));
+            field = (field == NULL ? NULL : field + 1);
+        }
+
+        if (field == NULL) {
+            chunk->failed = !append(chunk, p, (size_t) (lineEnd - p));
+            p = lineEnd;
+            continue;
+        }
+
+        char const *fieldEnd = field;
+        while (fieldEnd < lineEnd && *fieldEnd != pool->delimiter
+               && *fieldEnd != '\n' && *fieldEnd != '\r') {
+            fieldEnd++;
+        }
+
+        chunk->failed = !append(chunk, p, (size_t) (field - p));
+        if (chunk->failed) {
+            break;
+        }
+
+        size_t length = (size_t) (fieldEnd - field);
+        size_t space = chunk->capacity - chunk->size;
+        size_t written = phfwdGetInto(pool->pf, field, length,
+                                      chunk->out + chunk->size, space);
+
+        if (written >= space) {
+            // Wynik nie zmieścił się w buforze i nie może zostać dopisany.
+            chunk->failed = !reserve(chunk, written + 1);
+            if (chunk->failed) {
+                break;
+            }
+
+            phfwdGetInto(pool->pf, field, length, chunk->out + chunk->size,
+                         written + 1);
+        }
+
+        if (written == 0) {
+            // Pole nie jest numerem.
+            chunk->failed = !append(chunk, field, length);
+        }
+        else {
+            chunk->size += written;
+        }
+
+        chunk->failed = chunk->failed
+                        || !append(chunk, fieldEnd,
+                                   (size_t) (lineEnd - fieldEnd));
+        p = lineEnd;
+    }
+}
+
+/**
+ * @brief Pobiera zadanie z kolejki.
+ *
+ * @param[in, out] deque - kolejka;
+ * @param[in] fromBack - czy pobrać zadanie z końca kolejki;
+ * @param[out] item - numer fragmentu.
+ * @return Wartość @p true jeśli kolejka nie była pusta,
+ *         wartość @p false w przeciwnym wypadku.
+ */
+static bool takeItem(Deque *deque, bool fromBack, size_t *item) {
+    bool taken = false;
+
+    pthread_mutex_lock(&deque->lock);
+    if (deque->count > 0) {
+        size_t position = deque->head;
+
+        if (fromBack) {
+            position = (deque->head + deque->count - 1) % deque->capacity;
+        }
+        else {
+            deque->head = (deque->head + 1) % deque->capacity;
+        }
+
+        *item = deque->items[position];
+        deque->count--;
+        taken = true;
+    }
+    pthread_mutex_unlock(&deque->lock);
+
+    return taken;
+}
+
+/**
+ * @brief Dodaje zadanie na koniec kolejki.
+ *
+ * Kolejka ma miejsce na wszystkie fragmenty w obróbce.
+ *
+ * @param[in, out] deque - kolejka;
+ * @param[in] item - numer fragmentu.
+ */
+static void putItem(Deque *deque, size_t item) {
+    pthread_mutex_lock(&deque->lock);
+    deque->items[(deque->head + deque->count) % deque->capacity] = item;
+    deque->count++;
+    pthread_mutex_unlock(&deque->lock);
+}
+
+/**
+ * @brief Pobiera zadanie dla wątku: z własnej kolejki lub podkradając je.
+ *
+ * @param[in, out] pool - pula wątków;
+ * @param[in] self - numer wątku;
+ * @param[out] item - numer fragmentu.
+ * @return Wartość @p true jeśli udało się pobrać zadanie,
+ *         wartość @p false w przeciwnym wypadku.
+ */
+static bool findWork(Pool *pool, unsigned self, size_t *item) {
+    if (takeItem(&pool->deques[self], false, item)) {
+        return true;
+    }
+
+    for (unsigned i = 1; i < pool->threads; ++i) {
+        if (takeItem(&pool->deques[(self + i) % pool->threads], true, item)) {
+            atomic_fetch_add(&pool->steals, 1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Argument wątku puli.
+ */
+typedef struct WorkerArg {
+    /// Pula wątków.
+    Pool *pool;
+    /// Numer wątku.
+    unsigned self;
+} WorkerArg;
+
+/**
+ * @brief Wątek puli: przepisuje fragmenty, dopóki są zadania.
+ *
+ * @param[in] arg - argument wątku.
+ * @return NULL.
+ */
+static void *workerMain(void *arg) {
+    Pool *pool = ((WorkerArg *) arg)->pool;
+    unsigned self = ((WorkerArg *) arg)->self;
+    size_t item;
+
+    for (;;) {
+        if (findWork(pool, self, &item)) {
+            atomic_fetch_sub(&pool->pending, 1);
+
+            Chunk *chunk = &pool->chunks[item % pool->window];
+            rewriteChunk(pool, chunk);
+            atomic_store(&chunk->done, true);
+
+            pthread_mutex_lock(&pool->lock);
+            pthread_cond_signal(&pool->finished);
+            pthread_mutex_unlock(&pool->lock);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        while (atomic_load(&pool->pending) == 0 && !pool->closing) {
+            pthread_cond_wait(&pool->work, &pool->lock);
+        }
+        bool stop = (atomic_load(&pool->pending) == 0 && pool->closing);
+        pthread_mutex_unlock(&pool->lock);
+
+        if (stop) {
+            return NULL;
+        }
+    }
+}
+
+/**
+ * @brief Wypisuje cały bufor.
+ *
+ * @param[in] data - dane;
+ * @param[in] size - rozmiar danych.
+ * @return Wartość @p true jeśli operacja się powiodła,
+ *         wartość @p false w przeciwnym wypadku.
+ */
+static bool writeAll(char const *data, size_t size) {
+    while (size > 0) {
+        ssize_t written = write(STDOUT_FILENO, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        data += written;
+        size -= (size_t) written;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Przepisuje rekordy i wypisuje je w kolejności.
+ *
+ * Wątek główny wyznacza kolejne fragmenty, rozdziela je po kolei między
+ * kolejki wątków i wypisuje wyniki najstarszego fragmentu, gdy tylko jest
+ * gotowy.
+ *
+ * @param[in, out] pool - pula wątków;
+ * @param[in] data - rekordy;
+ * @param[in] size - rozmiar rekordów.
+ * @return Wartość @p true jeśli operacja się powiodła,
+ *         wartość @p false w przeciwnym wypadku.
+ */
+static bool runPipeline(Pool *pool, char const *data, size_t size) {
+    char const *end = data + size;
+    char const *next = data;
+    size_t issued = 0, written = 0;
+    bool ok = true;
+
+    while (written < issued || next < end) {
+        // Wydanie nowych fragmentów, jeśli jest na nie miejsce.
+        while (next < end && issued - written < pool->window) {
+            Chunk *chunk = &pool->chunks[issued % pool->window];
+            char const *chunkEnd = end;
+
+            if ((size_t) (end - next) > CDR_CHUNK_SIZE) {
+                chunkEnd = memchr(next + CDR_CHUNK_SIZE, '\n',
+                                  (size_t) (end - next - CDR_CHUNK_SIZE));
+                chunkEnd = (chunkEnd == NULL ? end : chunkEnd + 1);
+            }
+
+            chunk->begin = next;
+            chunk->end = chunkEnd;
+            atomic_store(&chunk->done, false);
+            next = chunkEnd;
+
+            putItem(&pool->deques[issued % pool->threads], issued);
+            issued++;
+
+            pthread_mutex_lock(&pool->lock);
+            atomic_fetch_add(&pool->pending, 1);
+            pthread_cond_signal(&pool->work);
+            pthread_mutex_unlock(&pool->lock);
+        }
+
+        Chunk *chunk = &pool->chunks[written % pool->window];
+
+        pthread_mutex_lock(&pool->lock);
+        while (!atomic_load(&chunk->done)) {
+            pthread_cond_wait(&pool->finished, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+
+        ok = ok && !chunk->failed && writeAll(chunk->out, chunk->size);
+        written++;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->closing = true;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+
+    return ok;
+}
+
+/**
+ * @brief Wczytuje przekierowania z pliku wierszy `NUM > NUM`.
+ *
+ * @param[in] path - ścieżka pliku;
+ * @param[in] engine - sposób wyszukiwania najdłuższego prefiksu.
+ * @return Struktura z przekierowaniami lub NULL w przypadku błędu.
+ */
+static PhoneForward *loadForwards(char const *path, PhfwdEngine engine) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return NULL;
+    }
+
+    PhoneForward *pf = phfwdNewWithEngine(engine);
+    char *line = NULL;
+    size_t capacity = 0;
+    size_t number = 0;
+    bool ok = (pf != NULL);
+
+    while (ok && getline(&line, &capacity, file) >= 0) {
+        number++;
+
+        char *save;
+        char *num1 = strtok_r(line, " \t\r\n", &save);
+        char *arrow = (num1 == NULL ? NULL : strtok_r(NULL, " \t\r\n", &save));
+        char *num2 = (arrow == NULL ? NULL : strtok_r(NULL, " \t\r\n", &save));
+
+        if (num1 == NULL) {
+            continue;
+        }
+
+        ok = (num2 != NULL && strcmp(arrow, ">") == 0
+              && phfwdAdd(pf, num1, num2));
+        if (!ok) {
+            fprintf(stderr, "%s:%zu: invalid forward\n", path, number);
+        }
+    }
+
+    free(line);
+    fclose(file);
+
+    if (!ok) {
+        phfwdDelete(pf);
+        return NULL;
+    }
+
+    return pf;
+}
+
+/**
+ * @brief Zwraca bieżący czas.
+ *
+ * @return Czas w sekundach.
+ */
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Uruchamia program.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty.
+ * @return Kod wyjścia.
+ */
+int main(int argc, char *argv[]) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned threads = (cores > 0 ? (unsigned) cores : 1);
+    size_t field = 0;
+    char delimiter = ',';
+    PhfwdEngine engine = PHFWD_ENGINE_TRIE;
+    bool stats = false;
+    bool ok = (argc >= 3);
+
+    for (int i = 3; ok && i < argc; ++i) {
+        if (strcmp(argv[i], "-s") == 0) {
+            stats = true;
+        }
+        else if (strcmp(argv[i], "-h") == 0) {
+            engine = PHFWD_ENGINE_HASH;
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "-t") == 0) {
+            threads = (unsigned) strtoul(argv[++i], NULL, 10);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "-f") == 0) {
+            field = strtoul(argv[++i], NULL, 10);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "-d") == 0
+                 && strlen(argv[i + 1]) == 1) {
+            delimiter = argv[++i][0];
+        }
+        else {
+            ok = false;
+        }
+    }
+
+    if (!ok || threads == 0) {
+        fprintf(stderr, "usage: %s FORWARDS RECORDS [-t threads] [-f field] "
+                        "[-d delimiter] [-h] [-s]\n", argv[0]);
+        return 1;
+    }
+
+    PhoneForward *pf = loadForwards(argv[1], engine);
+    if (pf == NULL) {
+        return 1;
+    }
+
+    int fd = open(argv[2], O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) < 0) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    size_t size = (size_t) info.st_size;
+    char const *data = NULL;
+    if (size > 0) {
+        data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            perror(argv[2]);
+            return 1;
+        }
+        madvise((void *) data, size, MADV_SEQUENTIAL);
+    }
+
+    Pool pool = {
+        .pf = pf, .field = field, .delimiter = delimiter, .threads = threads,
+        .window = (size_t) threads * CDR_WINDOW_PER_THREAD
+    };
+    pool.deques = calloc(threads, sizeof(Deque));
+    pool.chunks = calloc(pool.window, sizeof(Chunk));
+    pthread_t *workers = calloc(threads, sizeof(pthread_t));
+    WorkerArg *args = calloc(threads, sizeof(WorkerArg));
+    if (pool.deques == NULL || pool.chunks == NULL || workers == NULL
+        || args == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.work, NULL);
+    pthread_cond_init(&pool.finished, NULL);
+    for (unsigned i = 0; i < threads; ++i) {
+        pthread_mutex_init(&pool.deques[i].lock, NULL);
+        pool.deques[i].capacity = pool.window;
+        pool.deques[i].items = malloc(pool.window * sizeof(size_t));
+        if (pool.deques[i].items == NULL) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+    }
+
+    double start = now();
+    for (unsigned i = 0; i < threads; ++i) {
+        args[i] = (WorkerArg) {&pool, i};
+        pthread_create(&workers[i], NULL, workerMain, &args[i]);
+    }
+
+    ok = runPipeline(&pool, data, size);
+
+    for (unsigned i = 0; i < threads; ++i) {
+        pthread_join(workers[i], NULL);
+    }
+    double seconds = now() - start;
+
+    if (!ok) {
+        fprintf(stderr, "failed to write records\n");
+    }
+
+    if (stats) {
+        fprintf(stderr, "%zu bytes, %u threads, %.3f s, %.1f MB/s, "
+                        "%zu steals\n", size, threads, seconds,
+                (double) size / seconds / 1e6,
+                (size_t) atomic_load(&pool.steals));
+    }
+
+    for (unsigned i = 0; i < threads; ++i) {
+        pthread_mutex_destroy(&pool.deques[i].lock);
+        free(pool.deques[i].items);
+    }
+    for (size_t i = 0; i < pool.window; ++i) {
+        free(pool.chunks[i].out);
+    }
+    free(pool.deques);
+    free(pool.chunks);
+    free(workers);
+    free(args);
+    if (size > 0) {
+        munmap((void *) data, size);
+    }
+    close(fd);
+    phfwdDelete(pf);
+
+    return !ok;
+}
@@ -0,0 +1,96 @@
+/** @file phone_forward_changelog.h
+ * Interfejs dziennika modyfikacji struktury przechowującej
+ * przekierowania.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __PHONE_FORWARD_CHANGELOG_H__
+#define __PHONE_FORWARD_CHANGELOG_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "phone_forward.h"
+
+/**
+ * @brief Funkcja otrzymująca kolejne rekordy modyfikacji od
+ * @ref phfwdChangesSince.
+ * Otrzymuje kontekst przekazany do @ref phfwdChangesSince oraz rekord
+ * (ważny jedynie w czasie wywołania) i jego rozmiar w bajtach. Zwraca
+ * wartość @p false, aby przerwać przekazywanie rekordów.
+ */
+typedef bool (*PhfwdChangeCallback)(void *context, void const *data,
+                                    size_t size);
+
+/** @brief Włącza dziennik modyfikacji struktury.
+ * Dziennik zapamiętuje kolejne dodania przekierowań i wywołania
+ * @ref phfwdRemove w buforze rozmiaru @p capacity bajtów, usuwając
+ * najstarsze wpisy, gdy brakuje miejsca. Ponowne wywołanie zastępuje
+ * dziennik nowym, pustym; wartość 0 go wyłącza.
+ * @param[in,out] pf    – wskaźnik na strukturę przechowującą przekierowania
+ *                        numerów;
+ * @param[in] capacity  – rozmiar dziennika w bajtach (najwyżej
+ *                        @f$2^{32}-1@f$).
+ * @return Wartość @p true, jeśli operacja się powiodła. Wartość @p false,
+ *         jeśli @p pf ma wartość NULL, @p capacity jest zbyt duże lub nie
+ *         udało się alokować pamięci (dotychczasowy dziennik pozostaje wtedy
+ *         bez zmian).
+ */
+bool phfwdChangeLogEnable(PhoneForward *pf, size_t capacity);
+
+/** @brief Zwraca czas logiczny struktury.
+ * Czas zwiększa się przy każdej modyfikacji struktury. Modyfikacje
+ * wykonane po odczytaniu czasu @p t przekazuje
+ * @ref phfwdChangesSince( @p pf, @p t, ...).
+ * @param[in] pf – wskaźnik na strukturę przechowującą przekierowania numerów.
+ * @return Czas struktury lub 0, jeśli @p pf ma wartość NULL.
+ */
+size_t phfwdTime(PhoneForward const *pf);
+
+/** @brief Przekazuje modyfikacje wykonane po zadanym czasie.
+ * Wywołuje @p callback kolejno dla każdej modyfikacji zapamiętanej
+ * w dzienniku, wykonanej po czasie @p time. Rekord zaczyna się bajtem
+ * rodzaju (1 – dodanie przekierowania, 2 – wywołanie @ref phfwdRemove,
+ * 3 – wygaśnięcie przekierowania, zob. @ref phfwdAdvanceClock), po którym
+ * następuje czas struktury po modyfikacji, a następnie numer @p num1 (i dla
+ * dodania @p num2). Liczby zapisane są po siedem bitów na
+ * bajt, od najmłodszych, z najstarszym bitem oznaczającym kolejny bajt.
+ * Numer to jego długość, a po niej cyfry po dwie na bajt (pierwsza na
+ * młodszych czterech bitach, '*' i '#' jako 10 i 11). Koszt zależy od liczby
+ * przekazanych modyfikacji, a nie od rozmiaru struktury.
+ * @param[in] pf       – wskaźnik na strukturę przechowującą przekierowania
+ *                       numerów;
+ * @param[in] time     – czas, od którego przekazywane są modyfikacje;
+ * @param[in] callback – funkcja otrzymująca rekordy;
+ * @param[in] context  – kontekst przekazywany do @p callback.
+ * @return Wartość @p true, jeśli przekazano wszystkie modyfikacje po czasie
+ *         @p time. Wartość @p false, jeśli któryś ze wskaźników ma wartość
+ *         NULL, dziennik jest wyłączony, nie zawiera już wszystkich tych
+ *         modyfikacji (niczego wtedy nie przekazuje) lub @p callback
+ *         przerwał przekazywanie.
+ */
+bool phfwdChangesSince(PhoneForward const *pf, size_t time,
+                       PhfwdChangeCallback callback, void *context);
+
+/** @brief Odtwarza modyfikacje przekazane przez @ref phfwdChangesSince.
+ * Wykonuje kolejno modyfikacje zapisane w sklejonych rekordach, pomijając
+ * rekordy o czasie nie większym niż @p *lastTime, dzięki czemu ponowne
+ * przekazanie tych samych rekordów niczego nie zmienia.
+ * @param[in,out] pf       – wskaźnik na strukturę przechowującą
+ *                           przekierowania numerów;
+ * @param[in] data         – rekordy;
+ * @param[in] size         – łączny rozmiar rekordów w bajtach;
+ * @param[in,out] lastTime – czas ostatniego odtworzonego rekordu
+ *                           (aktualizowany po każdym rekordzie).
+ * @return Wartość @p true, jeśli odtworzono wszystkie rekordy. Wartość
+ *         @p false, jeśli któryś ze wskaźników ma wartość NULL, rekordy są
+ *         niepoprawne lub nie udało się alokować pamięci; wcześniejsze
+ *         rekordy pozostają wtedy odtworzone.
+ */
+bool phfwdApplyChanges(PhoneForward *pf, void const *data, size_t size,
+                       size_t *lastTime);
+
+#endif /* __PHONE_FORWARD_CHANGELOG_H__ */
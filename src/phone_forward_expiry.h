@@ -0,0 +1,64 @@
+/** @file phone_forward_expiry.h
+ * Interfejs przekierowań z terminem wygaśnięcia.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __PHONE_FORWARD_EXPIRY_H__
+#define __PHONE_FORWARD_EXPIRY_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "phone_forward.h"
+
+/** @brief Dodaje przekierowanie z terminem wygaśnięcia.
+ * Działa jak @ref phfwdAdd, a dodatkowo, gdy zegar przekierowań
+ * (zob. @ref phfwdAdvanceClock) osiągnie @p deadline, przekierowanie
+ * z @p num1 zostanie wycofane – o ile do tego czasu nie zostało zastąpione
+ * (również kolejnym wywołaniem tej funkcji) ani usunięte. Wycofanie dotyczy
+ * jedynie przekierowania z @p num1, a nie przekierowań z numerów, których
+ * @p num1 jest prefiksem. Zegar przekierowań jest niezależny od czasu
+ * logicznego struktury (zob. @ref phfwdTime), a jego jednostki określa
+ * użytkownik.
+ * @param[in,out] pf   – wskaźnik na strukturę przechowującą przekierowania
+ *                       numerów;
+ * @param[in] num1     – wskaźnik na napis reprezentujący prefiks numerów
+ *                       przekierowywanych;
+ * @param[in] num2     – wskaźnik na napis reprezentujący prefiks numerów,
+ *                       na które jest wykonywane przekierowanie;
+ * @param[in] deadline – termin wygaśnięcia.
+ * @return Wartość @p true, jeśli przekierowanie zostało dodane.
+ *         Wartość @p false, jeśli wystąpił błąd jak w @ref phfwdAdd,
+ *         termin nie jest późniejszy niż bieżący zegar przekierowań lub
+ *         nie udało się alokować pamięci.
+ */
+bool phfwdAddWithExpiry(PhoneForward *pf, char const *num1, char const *num2,
+                        size_t deadline);
+
+/** @brief Przesuwa zegar przekierowań.
+ * Wycofuje wszystkie przekierowania dodane przez @ref phfwdAddWithExpiry
+ * z terminem nie późniejszym niż @p now. Każde wycofanie zwiększa czas
+ * logiczny struktury i trafia do dziennika modyfikacji oraz historii
+ * przekierowań, jeśli są włączone. Koszt zależy od liczby terminów, które
+ * minęły lub zostały przeniesione w kole czasowym, a nie od rozmiaru
+ * struktury. Zegar jest początkowo równy 0.
+ * @param[in,out] pf – wskaźnik na strukturę przechowującą przekierowania
+ *                     numerów;
+ * @param[in] now    – nowy zegar przekierowań.
+ * @return Wartość @p true, jeśli operacja się powiodła. Wartość @p false,
+ *         jeśli @p pf ma wartość NULL, @p now jest wcześniejszy niż bieżący
+ *         zegar lub nie udało się alokować pamięci (zegar i przekierowania
+ *         pozostają wtedy bez zmian).
+ */
+bool phfwdAdvanceClock(PhoneForward *pf, size_t now);
+
+/** @brief Zwraca zegar przekierowań.
+ * @param[in] pf – wskaźnik na strukturę przechowującą przekierowania numerów.
+ * @return Zegar ustawiony ostatnio przez @ref phfwdAdvanceClock lub 0.
+ */
+size_t phfwdClock(PhoneForward const *pf);
+
+#endif /* __PHONE_FORWARD_EXPIRY_H__ */
@@ -0,0 +1,78 @@
+/** @file phone_forward_frozen.h
+ * Interfejs zamrożonej, niemodyfikowalnej postaci struktury
+ * przechowującej przekierowania.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __PHONE_FORWARD_FROZEN_H__
+#define __PHONE_FORWARD_FROZEN_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "phone_forward.h"
+
+struct PhfwdFrozen;
+/**
+ * Definiuje zamrożoną postać struktury PhoneForward (zob. @ref phfwdFreeze).
+ */
+typedef struct PhfwdFrozen PhfwdFrozen;
+
+/** @brief Tworzy zamrożoną postać struktury.
+ * Kompiluje aktualne przekierowania struktury (z pominięciem zastąpionych
+ * i usuniętych) do zwartej, niemodyfikowalnej postaci, z której korzystają
+ * funkcje @ref phfwdFrozenGet, @ref phfwdFrozenReverse
+ * i @ref phfwdFrozenGetReverse. Wynik nie zależy od dalszych modyfikacji
+ * ani od usunięcia struktury @p pf, ale korzysta z jej alokatora.
+ * @param[in] pf – wskaźnik na strukturę przechowującą przekierowania numerów.
+ * @return Wskaźnik na zamrożoną strukturę lub NULL, gdy nie udało się
+ *         alokować pamięci lub @p pf ma wartość NULL.
+ */
+PhfwdFrozen * phfwdFreeze(PhoneForward const *pf);
+
+/** @brief Wyznacza przekierowanie numeru w zamrożonej strukturze.
+ * Działa jak @ref phfwdGet dla struktury, z której powstała @p frozen.
+ * @param[in] frozen – wskaźnik na zamrożoną strukturę;
+ * @param[in] num    – wskaźnik na napis reprezentujący numer.
+ * @return Wskaźnik na strukturę przechowującą ciąg numerów lub NULL, gdy nie
+ *         udało się alokować pamięci lub @p frozen ma wartość NULL.
+ */
+PhoneNumbers * phfwdFrozenGet(PhfwdFrozen const *frozen, char const *num);
+
+/** @brief Wyznacza przekierowania na dany numer w zamrożonej strukturze.
+ * Działa jak @ref phfwdReverse dla struktury, z której powstała @p frozen.
+ * @param[in] frozen – wskaźnik na zamrożoną strukturę;
+ * @param[in] num    – wskaźnik na napis reprezentujący numer.
+ * @return Wskaźnik na strukturę przechowującą ciąg numerów lub NULL, gdy nie
+ *         udało się alokować pamięci lub @p frozen ma wartość NULL.
+ */
+PhoneNumbers * phfwdFrozenReverse(PhfwdFrozen const *frozen, char const *num);
+
+/** @brief Wyznacza przeciwobraz numeru w zamrożonej strukturze.
+ * Działa jak @ref phfwdGetReverse dla struktury, z której powstała
+ * @p frozen.
+ * @param[in] frozen – wskaźnik na zamrożoną strukturę;
+ * @param[in] num    – wskaźnik na napis reprezentujący numer.
+ * @return Wskaźnik na strukturę przechowującą ciąg numerów lub NULL, gdy nie
+ *         udało się alokować pamięci lub @p frozen ma wartość NULL.
+ */
+PhoneNumbers * phfwdFrozenGetReverse(PhfwdFrozen const *frozen,
+                                     char const *num);
+
+/** @brief Zwraca rozmiar zamrożonej struktury.
+ * @param[in] frozen – wskaźnik na zamrożoną strukturę.
+ * @return Liczba bajtów zajmowanych przez @p frozen
+ *         (0, jeśli @p frozen ma wartość NULL).
+ */
+size_t phfwdFrozenSize(PhfwdFrozen const *frozen);
+
+/** @brief Usuwa zamrożoną strukturę.
+ * Nic nie robi, jeśli wskaźnik ma wartość NULL.
+ * @param[in] frozen – wskaźnik na usuwaną strukturę.
+ */
+void phfwdFrozenDelete(PhfwdFrozen *frozen);
+
+#endif /* __PHONE_FORWARD_FROZEN_H__ */
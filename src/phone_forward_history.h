@@ -0,0 +1,86 @@
+/** @file phone_forward_history.h
+ * Interfejs historii przekierowań i zapytań o minione chwile.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __PHONE_FORWARD_HISTORY_H__
+#define __PHONE_FORWARD_HISTORY_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "phone_forward.h"
+
+/** @brief Włącza historię przekierowań.
+ * Od tej chwili struktura zapamiętuje zastępowane przekierowania i czasy
+ * wcześniejszych wywołań @ref phfwdRemove, dzięki czemu
+ * @ref phfwdGetAt i @ref phfwdReverseAt odpowiadają na pytania o dowolną
+ * chwilę nie wcześniejszą niż horyzont historii (początkowo bieżący czas
+ * struktury, zob. @ref phfwdTime). Zużycie pamięci rośnie z liczbą
+ * zastąpionych przekierowań i ponownych wyczyszczeń, a nie z liczbą
+ * chwil, o które można pytać. Ponowne wywołanie zachowuje dotychczasową
+ * historię.
+ * @param[in,out] pf – wskaźnik na strukturę przechowującą przekierowania
+ *                     numerów.
+ * @return Wartość @p true, jeśli historia jest włączona. Wartość @p false,
+ *         jeśli @p pf ma wartość NULL lub nie udało się alokować pamięci.
+ */
+bool phfwdHistoryEnable(PhoneForward *pf);
+
+/** @brief Zwraca horyzont historii przekierowań.
+ * Jeśli podczas zapamiętywania historii zabraknie pamięci, modyfikacja
+ * struktury i tak się wykonuje, a horyzont przesuwa się do jej czasu.
+ * @param[in] pf – wskaźnik na strukturę przechowującą przekierowania numerów.
+ * @return Najwcześniejsza chwila, o którą można pytać funkcje
+ *         @ref phfwdGetAt i @ref phfwdReverseAt (bieżący czas struktury,
+ *         jeśli historia jest wyłączona), lub 0, jeśli @p pf ma wartość NULL.
+ */
+size_t phfwdHistoryHorizon(PhoneForward const *pf);
+
+/** @brief Wyznacza przekierowanie numeru w minionej chwili.
+ * Działa jak @ref phfwdGet dla stanu struktury po wszystkich modyfikacjach
+ * o czasie (zob. @ref phfwdTime) nie większym niż @p time. Koszt zależy od
+ * długości numeru i logarytmicznie od liczby zmian przekierowań na jego
+ * ścieżce.
+ * @param[in] pf   – wskaźnik na strukturę przechowującą przekierowania
+ *                   numerów;
+ * @param[in] num  – wskaźnik na napis reprezentujący numer;
+ * @param[in] time – chwila.
+ * @return Wskaźnik na strukturę przechowującą ciąg numerów. Ciąg jest pusty,
+ *         jeśli @p num nie reprezentuje numeru lub @p time jest wcześniejszy
+ *         niż horyzont historii (zob. @ref phfwdHistoryHorizon). Wartość NULL,
+ *         jeśli @p pf ma wartość NULL lub nie udało się alokować pamięci.
+ */
+PhoneNumbers * phfwdGetAt(PhoneForward const *pf, char const *num,
+                          size_t time);
+
+/** @brief Wyznacza przekierowania na numer w minionej chwili.
+ * Działa jak @ref phfwdReverse dla stanu struktury po wszystkich
+ * modyfikacjach o czasie nie większym niż @p time.
+ * @param[in] pf   – wskaźnik na strukturę przechowującą przekierowania
+ *                   numerów;
+ * @param[in] num  – wskaźnik na napis reprezentujący numer;
+ * @param[in] time – chwila.
+ * @return Wskaźnik na strukturę przechowującą posortowany ciąg numerów bez
+ *         powtórzeń. Ciąg jest pusty, jeśli @p num nie reprezentuje numeru
+ *         lub @p time jest wcześniejszy niż horyzont historii. Wartość NULL,
+ *         jeśli @p pf ma wartość NULL lub nie udało się alokować pamięci.
+ */
+PhoneNumbers * phfwdReverseAt(PhoneForward const *pf, char const *num,
+                              size_t time);
+
+/** @brief Usuwa historię sprzed zadanej chwili.
+ * Przesuwa horyzont historii do @p horizon (najwyżej do bieżącego czasu
+ * struktury; horyzont nigdy się nie cofa) i zwalnia pamięć potrzebną
+ * jedynie do odpowiadania na pytania o wcześniejsze chwile. Nic nie robi,
+ * jeśli @p pf ma wartość NULL lub historia jest wyłączona.
+ * @param[in,out] pf  – wskaźnik na strukturę przechowującą przekierowania
+ *                      numerów;
+ * @param[in] horizon – nowy horyzont historii.
+ */
+void phfwdPruneHistory(PhoneForward *pf, size_t horizon);
+
+#endif /* __PHONE_FORWARD_HISTORY_H__ */
@@ -0,0 +1,441 @@
+/** @file phone_forward_loadgen.c
+ * Generator obciążenia serwera przekierowań (phone_forward_server).
+ *
+ * Najpierw jednym połączeniem dodaje zadaną liczbę przekierowań, a potem
+ * każdy z wątków otwiera własne połączenie i wysyła zadaną liczbę żądań,
+ * utrzymując zadaną liczbę żądań bez odpowiedzi. Na koniec wypisuje
+ * przepustowość i rozkład opóźnień żądań.
+ *
+ * Użycie: phone_forward_loadgen ŚCIEŻKA_GNIAZDA [-c połączenia]
+ *         [-n żądania_na_połączenie] [-d głębokość_potoku]
+ *         [-w procent_modyfikacji] [-p przekierowania_początkowe]
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "server_protocol.h"
+
+/// Największa długość generowanego numeru.
+#define LOADGEN_MAX_NUMBER 16
+
+/**
+ * @brief Parametry obciążenia.
+ */
+typedef struct LoadConfig {
+    /// Ścieżka gniazda serwera.
+    char const *path;
+    /// Liczba połączeń (wątków).
+    unsigned connections;
+    /// Liczba żądań na połączenie.
+    unsigned requests;
+    /// Największa liczba żądań bez odpowiedzi na połączenie.
+    unsigned depth;
+    /// Procent żądań będących modyfikacjami.
+    unsigned writePercent;
+    /// Liczba przekierowań dodawanych przed pomiarem.
+    unsigned prefill;
+} LoadConfig;
+
+/**
+ * @brief Stan wątku generatora.
+ */
+typedef struct LoadWorker {
+    /// Parametry obciążenia.
+    LoadConfig const *config;
+    /// Ziarno generatora liczb losowych.
+    unsigned seed;
+    /// Liczba żądań do wysłania.
+    unsigned requests;
+    /// Największa liczba żądań bez odpowiedzi.
+    unsigned depth;
+    /// Czy żądania są dodaniami przekierowań początkowych.
+    bool prefill;
+    /// Opóźnienia kolejnych żądań w nanosekundach.
+    uint64_t *latencies;
+    /// Liczba odpowiedzi z błędem.
+    unsigned long errors;
+    /// Czy wątek zakończył się powodzeniem.
+    bool ok;
+} LoadWorker;
+
+/**
+ * @brief Zwraca bieżący czas.
+ *
+ * @return Czas w nanosekundach.
+ */
+static uint64_t now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+/**
+ * @brief Generuje numer.
+ *
+ * Numery zaczynają się jednym z kilkuset prefiksów, tak jak numery
+ * z planu numeracji, więc część z nich trafia w przekierowania.
+ *
+ * @param[in, out] seed - ziarno generatora;
+ * @param[out] num - bufor na numer;
+ * @param[in] minLength - najmniejsza długość numeru.
+ * @return Długość numeru.
+ */
+static size_t randomNumber(unsigned *seed, char *num, size_t minLength) {
+    unsigned prefix = (unsigned) rand_r(seed) % 400;
+    size_t length = minLength
+                    + (size_t) rand_r(seed) % (LOADGEN_MAX_NUMBER
+                                               - minLength + 1);
+
+    num[0] = (char) ('1' + prefix % 9);
+    num[1] = (char) ('0' + prefix / 9 % 10);
+    num[2] = (char) ('0' + prefix / 90);
+    for (size_t i = 3; i < length; ++i) {
+        num[i] = (char) ('0' + rand_r(seed) % 10);
+    }
+
+    return length;
+}
+
+/**
+ * @brief Zapisuje numer do żądania.
+ *
+ * @param[out] out - bufor;
+ * @param[in] num - numer;
+ * @param[in] length - długość numeru.
+ * @return Liczba zapisanych bajtów.
+ */
+static size_t putNumber(uint8_t *out, char const *num, size_t length) {
+    protoPut16(out, (uint16_t) length);
+    memcpy(out + 2, num, length);
+
+    return 2 + length;
+}
+
+/**
+ * @brief Zapisuje do bufora losowe żądanie.
+ *
+ * @param[in, out] worker - stan wątku;
+ * @param[in, out] out - bufor;
+ * @param[in] id - identyfikator żądania.
+ * @return Wartość @p true jeśli operacja się powiodła,
+ *         wartość @p false jeśli nie udało się alokować pamięci.
+ */
+static bool putRequest(LoadWorker *worker, ProtoBuffer *out, uint32_t id) {
+    uint8_t *frame = protoReserve(out, 4 + PROTO_REQUEST_HEADER
+                                       + 2 * (2 + LOADGEN_MAX_NUMBER));
+    if (frame == NULL) {
+        return false;
+    }
+
+    char num1[LOADGEN_MAX_NUMBER], num2[LOADGEN_MAX_NUMBER];
+    unsigned roll = (unsigned) rand_r(&worker->seed) % 100;
+    uint8_t op;
+    size_t size = PROTO_REQUEST_HEADER;
+
+    if (worker->prefill || roll < worker->config->writePercent) {
+        bool remove = !worker->prefill && rand_r(&worker->seed) % 8 == 0;
+
+        op = (remove ? PROTO_DEL : PROTO_ADD);
+        size += putNumber(frame + 4 + size, num1,
+                          randomNumber(&worker->seed, num1, 4));
+        if (!remove) {
+            size += putNumber(frame + 4 + size, num2,
+                              randomNumber(&worker->seed, num2, 4));
+        }
+    }
+    else {
+        op = (roll % 10 == 0 ? PROTO_REVERSE : PROTO_GET);
+        size += putNumber(frame + 4 + size, num1,
+                          randomNumber(&worker->seed, num1, 9));
+    }
+
+    protoPut32(frame, (uint32_t) size);
+    frame[4] = op;
+    protoPut32(frame + 5, id);
+    out->size += 4 + size;
+
+    return true;
+}
+
+/**
+ * @brief Łączy się z serwerem.
+ *
+ * @param[in] path - ścieżka gniazda.
+ * @return Deskryptor gniazda lub -1 w przypadku błędu.
+ */
+static int connectTo(char const *path) {
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        return -1;
+    }
+
+    strcpy(address.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, (struct sockaddr *) &address,
+                           sizeof(address)) < 0) {
+        close(fd);
+        fd = -1;
+    }
+
+    return fd;
+}
+
+/**
+ * @brief Wysyła cały bufor.
+ *
+ * @param[in] fd - gniazdo;
+ * @param[in, out] out - bufor.
+ * @return Wartość @p true jeśli operacja się powiodła,
+ *         wartość @p false w przeciwnym wypadku.
+ */
+static bool sendAll(int fd, ProtoBuffer *out) {
+    while (out->offset < out->size) {
+        ssize_t written = send(fd, out->data + out->offset,
+                               out->size - out->offset, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        out->offset += (size_t) written;
+    }
+
+    out->offset = out->size = 0;
+
+    return true;
+}
+
+/**
+ * @brief Wątek generatora: wysyła żądania i mierzy ich opóźnienia.
+ *
+ * @param[in, out] arg - stan wątku.
+ * @return NULL.
+ */
+static void *workerMain(void *arg) {
+    LoadWorker *worker = arg;
+    int fd = connectTo(worker->config->path);
+    ProtoBuffer in = {0}, out = {0};
+    uint64_t *sent = malloc(worker->requests * sizeof(uint64_t));
+    unsigned next = 0, answered = 0;
+
+    if (fd < 0 || sent == NULL) {
+        goto cleanup;
+    }
+
+    while (answered < worker->requests) {
+        uint64_t time = now();
+
+        while (next < worker->requests && next - answered < worker->depth) {
+            if (!putRequest(worker, &out, next)) {
+                goto cleanup;
+            }
+            sent[next++] = time;
+        }
+
+        if (!sendAll(fd, &out)) {
+            goto cleanup;
+        }
+
+        uint8_t *space = protoReserve(&in, 65536);
+        ssize_t received = (space == NULL ? -1 : recv(fd, space, 65536, 0));
+        if (received <= 0) {
+            if (received < 0 && errno == EINTR) {
+                continue;
+            }
+            goto cleanup;
+        }
+
+        in.size += (size_t) received;
+        time = now();
+
+        while (in.size - in.offset >= 4) {
+            uint32_t size = protoGet32(in.data + in.offset);
+            if (in.size - in.offset < 4 + (size_t) size) {
+                break;
+            }
+
+            uint8_t const *frame = in.data + in.offset + 4;
+            uint32_t id = protoGet32(frame);
+            if (size < PROTO_RESPONSE_HEADER || id != answered) {
+                fprintf(stderr, "unexpected response %u\n", id);
+                goto cleanup;
+            }
+
+            worker->errors += (frame[4] != PROTO_OK);
+            worker->latencies[answered++] = time - sent[id];
+            in.offset += 4 + size;
+        }
+    }
+
+    worker->ok = true;
+
+cleanup:
+    if (fd >= 0) {
+        close(fd);
+    }
+    free(sent);
+    protoFree(&in);
+    protoFree(&out);
+
+    return NULL;
+}
+
+/**
+ * @brief Porównuje dwie liczby do sortowania.
+ *
+ * @param[in] a - wskaźnik na pierwszą liczbę;
+ * @param[in] b - wskaźnik na drugą liczbę.
+ * @return Wynik porównania.
+ */
+static int compareLatencies(void const *a, void const *b) {
+    uint64_t x = *(uint64_t const *) a, y = *(uint64_t const *) b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Wczytuje liczbę z argumentu opcji.
+ *
+ * @param[in] text - argument;
+ * @param[out] value - liczba.
+ * @return Wartość @p true jeśli argument jest liczbą dodatnią,
+ *         wartość @p false w przeciwnym wypadku.
+ */
+static bool parseCount(char const *text, unsigned *value) {
+    char *end;
+    unsigned long parsed = strtoul(text, &end, 10);
+
+    if (*text == '\0' || *end != '\0' || parsed > 100000000) {
+        return false;
+    }
+
+    *value = (unsigned) parsed;
+
+    return true;
+}
+
+/**
+ * @brief Uruchamia generator obciążenia.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty.
+ * @return Kod wyjścia.
+ */
+int main(int argc, char *argv[]) {
+    LoadConfig config = {
+        .connections = 4, .requests = 100000, .depth = 32,
+        .writePercent = 5, .prefill = 100000
+    };
+    bool ok = (argc >= 2 && argc % 2 == 0);
+
+    for (int i = 2; ok && i < argc; i += 2) {
+        unsigned *option = NULL;
+
+        if (!strcmp(argv[i], "-c")) {
+            option = &config.connections;
+        }
+        else if (!strcmp(argv[i], "-n")) {
+            option = &config.requests;
+        }
+        else if (!strcmp(argv[i], "-d")) {
+            option = &config.depth;
+        }
+        else if (!strcmp(argv[i], "-w")) {
+            option = &config.writePercent;
+        }
+        else if (!strcmp(argv[i], "-p")) {
+            option = &config.prefill;
+        }
+
+        ok = (option != NULL && parseCount(argv[i + 1], option));
+    }
+
+    if (!ok || config.connections == 0 || config.depth == 0
+        || config.writePercent > 100) {
+        fprintf(stderr, "usage: %s SOCKET_PATH [-c connections] "
+                        "[-n requests] [-d depth] [-w write%%] "
+                        "[-p prefill]\n", argv[0]);
+        return 1;
+    }
+    config.path = argv[1];
+
+    LoadWorker prefill = {
+        .config = &config, .seed = 1, .requests = config.prefill,
+        .depth = 256, .prefill = true,
+        .latencies = malloc((config.prefill + 1) * sizeof(uint64_t))
+    };
+    workerMain(&prefill);
+    free(prefill.latencies);
+    if (!prefill.ok) {
+        fprintf(stderr, "prefill failed\n");
+        return 1;
+    }
+
+    size_t total = (size_t) config.connections * config.requests;
+    LoadWorker *workers = calloc(config.connections, sizeof(LoadWorker));
+    pthread_t *threads = calloc(config.connections, sizeof(pthread_t));
+    uint64_t *latencies = malloc((total + 1) * sizeof(uint64_t));
+    if (workers == NULL || threads == NULL || latencies == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    uint64_t start = now();
+    for (unsigned i = 0; i < config.connections; ++i) {
+        workers[i] = (LoadWorker) {
+            .config = &config, .seed = 2 + i, .requests = config.requests,
+            .depth = config.depth,
+            .latencies = latencies + (size_t) i * config.requests
+        };
+        pthread_create(&threads[i], NULL, workerMain, &workers[i]);
+    }
+
+    unsigned long errors = 0;
+    for (unsigned i = 0; i < config.connections; ++i) {
+        pthread_join(threads[i], NULL);
+        ok = ok && workers[i].ok;
+        errors += workers[i].errors;
+    }
+    double seconds = (double) (now() - start) / 1e9;
+
+    if (!ok) {
+        fprintf(stderr, "connection failed\n");
+        return 1;
+    }
+
+    qsort(latencies, total, sizeof(uint64_t), compareLatencies);
+
+    printf("requests %zu, errors %lu, time %.3f s, throughput %.0f req/s\n",
+           total, errors, seconds, (double) total / seconds);
+
+    double const quantiles[] = {0.5, 0.9, 0.99, 0.999, 1.0};
+    char const *names[] = {"p50", "p90", "p99", "p99.9", "max"};
+    for (size_t i = 0; total > 0 && i < 5; ++i) {
+        size_t index = (size_t) (quantiles[i] * (double) (total - 1));
+        printf("%s %.1f us%s", names[i], (double) latencies[index] / 1e3,
+               (i == 4 ? "\n" : ", "));
+    }
+
+    free(workers);
+    free(threads);
+    free(latencies);
+
+    return 0;
+}
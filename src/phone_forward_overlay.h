@@ -0,0 +1,99 @@
+/** @file phone_forward_overlay.h
+ * Interfejs nakładek na wspólną strukturę bazową.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __PHONE_FORWARD_OVERLAY_H__
+#define __PHONE_FORWARD_OVERLAY_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "phone_forward.h"
+
+struct PhfwdOverlay;
+/**
+ * Definiuje nakładkę: strukturę przekierowań złożoną ze wspólnej struktury
+ * bazowej i własnych modyfikacji (zob. @ref phfwdOverlayNew).
+ */
+typedef struct PhfwdOverlay PhfwdOverlay;
+
+/** @brief Tworzy nową nakładkę na strukturę.
+ * Tworzy nakładkę bez własnych modyfikacji, odwołującą się do struktury
+ * @p base zamiast ją kopiować. Nakładka przechowuje jedynie własne
+ * przekierowania i usunięcia, a jej funkcje zwracają te same wyniki co
+ * odpowiednie funkcje dla kopii @p base, na której wykonano kolejno
+ * modyfikacje nakładki. Wiele nakładek może korzystać z tej samej
+ * struktury bazowej; nie może ona być modyfikowana ani usunięta, dopóki
+ * istnieją jej nakładki. Nakładka korzysta z alokatora struktury bazowej.
+ * @param[in] base – wskaźnik na strukturę bazową.
+ * @return Wskaźnik na utworzoną nakładkę lub NULL, gdy nie udało się
+ *         alokować pamięci lub @p base ma wartość NULL.
+ */
+PhfwdOverlay * phfwdOverlayNew(PhoneForward const *base);
+
+/** @brief Usuwa nakładkę.
+ * Usuwa własne modyfikacje nakładki, nie zmieniając struktury bazowej.
+ * Nic nie robi, jeśli wskaźnik ma wartość NULL.
+ * @param[in] overlay – wskaźnik na usuwaną nakładkę.
+ */
+void phfwdOverlayDelete(PhfwdOverlay *overlay);
+
+/** @brief Dodaje przekierowanie do nakładki.
+ * Działa jak @ref phfwdAdd; przekierowanie zastępuje w nakładce
+ * przekierowanie z @p num1 struktury bazowej.
+ * @param[in,out] overlay – wskaźnik na nakładkę;
+ * @param[in] num1        – wskaźnik na napis reprezentujący prefiks numerów
+ *                          przekierowywanych;
+ * @param[in] num2        – wskaźnik na napis reprezentujący prefiks numerów,
+ *                          na które jest wykonywane przekierowanie.
+ * @return Wartość @p true, jeśli przekierowanie zostało dodane.
+ *         Wartość @p false, jeśli wystąpił błąd, np. podany napis nie
+ *         reprezentuje numeru, oba podane numery są identyczne lub nie
+ *         udało się alokować pamięci.
+ */
+bool phfwdOverlayAdd(PhfwdOverlay *overlay, char const *num1,
+                     char const *num2);
+
+/** @brief Usuwa przekierowania w nakładce.
+ * Działa jak @ref phfwdRemove; usuwa w nakładce również przekierowania
+ * struktury bazowej.
+ * @param[in,out] overlay – wskaźnik na nakładkę;
+ * @param[in] num         – wskaźnik na napis reprezentujący prefiks numerów.
+ */
+void phfwdOverlayRemove(PhfwdOverlay *overlay, char const *num);
+
+/** @brief Wyznacza przekierowanie numeru w nakładce.
+ * Działa jak @ref phfwdGet. Poza wyszukaniem w strukturze bazowej
+ * przechodzi jedną ścieżkę w drzewie własnych modyfikacji nakładki.
+ * @param[in] overlay – wskaźnik na nakładkę;
+ * @param[in] num     – wskaźnik na napis reprezentujący numer.
+ * @return Wskaźnik na strukturę przechowującą ciąg numerów lub NULL, gdy
+ *         @p overlay ma wartość NULL lub nie udało się alokować pamięci.
+ */
+PhoneNumbers * phfwdOverlayGet(PhfwdOverlay const *overlay, char const *num);
+
+/** @brief Wyznacza przekierowania na numer w nakładce.
+ * Działa jak @ref phfwdReverse.
+ * @param[in] overlay – wskaźnik na nakładkę;
+ * @param[in] num     – wskaźnik na napis reprezentujący numer.
+ * @return Wskaźnik na strukturę przechowującą ciąg numerów lub NULL, gdy
+ *         @p overlay ma wartość NULL lub nie udało się alokować pamięci.
+ */
+PhoneNumbers * phfwdOverlayReverse(PhfwdOverlay const *overlay,
+                                   char const *num);
+
+/** @brief Wyznacza numery przekierowywane na numer w nakładce.
+ * Działa jak @ref phfwdGetReverse.
+ * @param[in] overlay – wskaźnik na nakładkę;
+ * @param[in] num     – wskaźnik na napis reprezentujący numer.
+ * @return Wskaźnik na strukturę przechowującą ciąg numerów lub NULL, gdy
+ *         @p overlay ma wartość NULL lub nie udało się alokować pamięci.
+ */
+PhoneNumbers * phfwdOverlayGetReverse(PhfwdOverlay const *overlay,
+                                      char const *num);
+
+#endif /* __PHONE_FORWARD_OVERLAY_H__ */
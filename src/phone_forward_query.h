@@ -0,0 +1,62 @@
+/** @file phone_forward_query.h
+ * Interfejs dodatkowych zapytań o przekierowania numerów: wyznaczania
+ * przekierowania bez alokacji pamięci i wykonywania łańcuchów przekierowań.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __PHONE_FORWARD_QUERY_H__
+#define __PHONE_FORWARD_QUERY_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "phone_forward.h"
+
+/** @brief Wyznacza przekierowanie numeru do podanego bufora.
+ * Działa jak @ref phfwdGet, ale nie alokuje pamięci. Numer nie musi być
+ * zakończony znakiem '\0'. Do bufora zapisywane jest co najwyżej
+ * @p size - 1 znaków wyniku oraz kończący znak '\0' (jeśli @p size > 0).
+ * Nie korzysta z pamięci podręcznej wyników (zob. @ref phfwdEnableCache).
+ * Funkcje @ref phfwdGet i @ref phfwdGetInto mogą być wywoływane
+ * współbieżnie z wielu wątków, o ile w tym czasie struktura nie jest
+ * modyfikowana, a jej alokator jest bezpieczny wątkowo (domyślny jest).
+ * @param[in] pf     – wskaźnik na strukturę przechowującą przekierowania
+ *                     numerów;
+ * @param[in] num    – wskaźnik na znaki numeru;
+ * @param[in] length – liczba znaków numeru;
+ * @param[out] buffer – bufor na wynik;
+ * @param[in] size   – rozmiar bufora.
+ * @return Długość wyniku (bez znaku '\0'), także gdy nie zmieścił się
+ *         w buforze, lub zero, jeśli @p pf ma wartość NULL lub znaki nie
+ *         reprezentują numeru.
+ */
+size_t phfwdGetInto(PhoneForward const *pf, char const *num, size_t length,
+                    char *buffer, size_t size);
+
+/** @brief Wyznacza numer, na który ostatecznie przekierowany jest numer.
+ * Stosuje do numeru @p num kolejno przekierowania tak jak @ref phfwdGet,
+ * dopóki do otrzymanego numeru stosuje się jakieś przekierowanie, i zwraca
+ * ostatni numer łańcucha (sam @p num, jeśli nie jest przekierowany). Łańcuch
+ * nie może mieć więcej niż @p maxHops przekierowań. Cykle oraz łańcuchy
+ * rosnące w nieskończoność (np. dla przekierowania 1 -> 12) są wykrywane
+ * bez wykonywania wszystkich @p maxHops przekierowań, więc @p maxHops może
+ * być dowolnie duże, np. SIZE_MAX. Fragmenty łańcuchów
+ * niezależne od dalszych cyfr numeru są zapamiętywane, a @ref phfwdAdd
+ * i @ref phfwdRemove unieważniają jedynie fragmenty zależne od
+ * modyfikowanych przekierowań.
+ * @param[in,out] pf   – wskaźnik na strukturę przechowującą przekierowania
+ *                       numerów;
+ * @param[in] num      – wskaźnik na napis reprezentujący numer;
+ * @param[in] maxHops  – największa liczba przekierowań w łańcuchu.
+ * @return Wskaźnik na strukturę przechowującą ciąg numerów. Ciąg jest pusty,
+ *         jeśli napis nie reprezentuje numeru, łańcuch jest cykliczny,
+ *         rośnie w nieskończoność lub jest dłuższy niż @p maxHops
+ *         przekierowań. Wartość NULL, jeśli @p pf ma
+ *         wartość NULL lub nie udało się alokować pamięci.
+ */
+PhoneNumbers * phfwdResolve(PhoneForward *pf, char const *num, size_t maxHops);
+
+#endif /* __PHONE_FORWARD_QUERY_H__ */
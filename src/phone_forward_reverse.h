@@ -0,0 +1,112 @@
+/** @file phone_forward_reverse.h
+ * Interfejs leniwego przeglądania, stronicowania i zliczania wyników
+ * funkcji @ref phfwdReverse.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __PHONE_FORWARD_REVERSE_H__
+#define __PHONE_FORWARD_REVERSE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "phone_forward.h"
+
+struct PhfwdReverseCursor;
+/**
+ * Definiuje kursor przeglądający wynik funkcji @ref phfwdReverse.
+ */
+typedef struct PhfwdReverseCursor PhfwdReverseCursor;
+
+/** @brief Otwiera kursor przeglądający przekierowania na dany numer.
+ * Kursor zwraca kolejno te same numery, co @ref phfwdReverse, w tej samej
+ * kolejności, ale wyznacza je leniwie: pamięć kursora zależy jedynie od
+ * długości numerów, a nie od liczby przekierowań na dany numer. Kursor jest
+ * ważny, dopóki struktura @p pf nie zostanie zmodyfikowana lub usunięta.
+ * Jeśli podany napis nie reprezentuje numeru, kursor nie zwraca żadnego
+ * numeru. Kursor musi zostać zamknięty za pomocą funkcji
+ * @ref phfwdReverseClose.
+ * @param[in] pf  – wskaźnik na strukturę przechowującą przekierowania numerów;
+ * @param[in] num – wskaźnik na napis reprezentujący numer.
+ * @return Wskaźnik na kursor lub NULL, gdy nie udało się alokować pamięci
+ *         lub @p pf ma wartość NULL.
+ */
+PhfwdReverseCursor * phfwdReverseOpen(PhoneForward const *pf,
+                                      char const *num);
+
+/** @brief Otwiera kursor zaczynający od numerów większych od zadanego.
+ * Działa jak @ref phfwdReverseOpen, ale kursor zwraca jedynie numery
+ * leksykograficznie większe od @p after. Koszt otwarcia zależy jedynie
+ * od długości numerów i logarytmicznie od liczby przekierowań.
+ * Jeśli @p after ma wartość NULL, kursor zwraca cały wynik; jeśli @p after
+ * nie reprezentuje numeru, kursor nie zwraca żadnego numeru.
+ * @param[in] pf    – wskaźnik na strukturę przechowującą przekierowania
+ *                    numerów;
+ * @param[in] num   – wskaźnik na napis reprezentujący numer;
+ * @param[in] after – wskaźnik na napis reprezentujący numer, po którym
+ *                    zaczyna się wynik, lub NULL.
+ * @return Wskaźnik na kursor lub NULL, gdy nie udało się alokować pamięci
+ *         lub @p pf ma wartość NULL.
+ */
+PhfwdReverseCursor * phfwdReverseOpenAfter(PhoneForward const *pf,
+                                           char const *num,
+                                           char const *after);
+
+/** @brief Zwraca kolejny numer kursora.
+ * Nie alokuje pamięci. Zwrócony napis jest ważny do kolejnego wywołania
+ * funkcji na tym samym kursorze lub do jego zamknięcia.
+ * @param[in,out] cursor – wskaźnik na kursor.
+ * @return Wskaźnik na napis reprezentujący kolejny numer lub NULL, jeśli
+ *         numery się skończyły lub @p cursor ma wartość NULL.
+ */
+char const * phfwdReverseNext(PhfwdReverseCursor *cursor);
+
+/** @brief Zamyka kursor.
+ * Zwalnia pamięć kursora. Nic nie robi, jeśli wskaźnik ma wartość NULL.
+ * @param[in] cursor – wskaźnik na zamykany kursor.
+ */
+void phfwdReverseClose(PhfwdReverseCursor *cursor);
+
+/** @brief Wyznacza stronę wyniku funkcji @ref phfwdReverse.
+ * Wyznacza co najwyżej @p limit kolejnych numerów wyniku funkcji
+ * @ref phfwdReverse, leksykograficznie większych od @p after. Koszt jest
+ * proporcjonalny do @p limit (z dokładnością do czynników logarytmicznych
+ * i długości numerów), a nie do liczby wszystkich przekierowań na numer.
+ * Jeśli @p after ma wartość NULL, wynik zaczyna się od początku.
+ * Jeśli @p num lub @p after nie reprezentuje numeru, wynikiem jest pusty
+ * ciąg. Alokuje strukturę @p PhoneNumbers, która musi być zwolniona
+ * za pomocą funkcji @ref phnumDelete.
+ * @param[in] pf    – wskaźnik na strukturę przechowującą przekierowania
+ *                    numerów;
+ * @param[in] num   – wskaźnik na napis reprezentujący numer;
+ * @param[in] after – wskaźnik na napis reprezentujący ostatni numer
+ *                    poprzedniej strony lub NULL;
+ * @param[in] limit – największa liczba zwracanych numerów.
+ * @return Wskaźnik na strukturę przechowującą ciąg numerów lub NULL, gdy nie
+ *         udało się alokować pamięci.
+ */
+PhoneNumbers * phfwdReverseRange(PhoneForward const *pf, char const *num,
+                                 char const *after, size_t limit);
+
+/** @brief Wyznacza liczność wyniku funkcji @ref phfwdReverse.
+ * Nie buduje wyniku ani nie alokuje pamięci.
+ * @param[in] pf  – wskaźnik na strukturę przechowującą przekierowania numerów;
+ * @param[in] num – wskaźnik na napis reprezentujący numer.
+ * @return Liczba numerów, które zwróciłaby funkcja @ref phfwdReverse;
+ *         0, jeśli @p pf ma wartość NULL lub @p num nie reprezentuje numeru.
+ */
+size_t phfwdReverseCount(PhoneForward const *pf, char const *num);
+
+/** @brief Wyznacza liczność wyniku funkcji @ref phfwdGetReverse.
+ * Nie buduje wyniku ani nie alokuje pamięci.
+ * @param[in] pf  – wskaźnik na strukturę przechowującą przekierowania numerów;
+ * @param[in] num – wskaźnik na napis reprezentujący numer.
+ * @return Liczba numerów, które zwróciłaby funkcja @ref phfwdGetReverse;
+ *         0, jeśli @p pf ma wartość NULL lub @p num nie reprezentuje numeru.
+ */
+size_t phfwdGetReverseCount(PhoneForward const *pf, char const *num);
+
+#endif /* __PHONE_FORWARD_REVERSE_H__ */
@@ -0,0 +1,814 @@
+/** @file phone_forward_server.c
+ * Serwer udostępniający jedną strukturę przechowującą przekierowania przez
+ * gniazdo domeny uniksowej.
+ *
+ * Wątek główny obsługuje wszystkie połączenia pętlą zdarzeń epoll. Po każdym
+ * przebudzeniu wykonuje wszystkie kompletne żądania odczytu ze wszystkich
+ * gotowych połączeń w jednej sekcji krytycznej czytelnika. Modyfikacje
+ * przekazywane są jedynemu wątkowi piszącemu, który wykonuje wszystkie
+ * oczekujące modyfikacje w jednej sekcji krytycznej pisarza i zgłasza ich
+ * zakończenie przez eventfd. Połączenie czekające na modyfikację nie jest
+ * w tym czasie dalej przetwarzane, więc żądania jednego połączenia
+ * wykonywane są w kolejności wysłania.
+ *
+ * Użycie: phone_forward_server ŚCIEŻKA_GNIAZDA [--hash]
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "phone_forward.h"
+#include "phone_forward_tuning.h"
+#include "server_protocol.h"
+
+/// Największa liczba zdarzeń odbieranych jednym wywołaniem epoll_wait.
+#define SERVER_EVENTS 256
+
+/// Rozmiar niewysłanych odpowiedzi, powyżej którego wstrzymujemy
+/// przetwarzanie żądań połączenia.
+#define SERVER_OUTPUT_LIMIT (4 << 20)
+
+/// Rozmiar jednorazowego odczytu z gniazda.
+#define SERVER_READ_CHUNK 65536
+
+/**
+ * @brief Połączenie z klientem.
+ */
+typedef struct Connection {
+    /// Deskryptor gniazda.
+    int fd;
+    /// Odebrane, jeszcze nieprzetworzone żądania.
+    ProtoBuffer in;
+    /// Niewysłane odpowiedzi.
+    ProtoBuffer out;
+    /// Czy połączenie czeka na wykonanie modyfikacji.
+    bool waiting;
+    /// Czy klient zakończył wysyłanie żądań.
+    bool eof;
+    /// Czy wystąpił błąd (połączenie jest do zamknięcia).
+    bool broken;
+    /// Czy czekamy na możliwość zapisu do gniazda.
+    bool polling;
+    /// Czy połączenie jest na liście gotowych.
+    bool ready;
+    /// Następne połączenie na liście gotowych.
+    struct Connection *nextReady;
+} Connection;
+
+/**
+ * @brief Modyfikacja przekazywana wątkowi piszącemu.
+ */
+typedef struct WriteRequest {
+    /// Połączenie, które wysłało żądanie.
+    Connection *conn;
+    /// Operacja (@ref PROTO_ADD lub @ref PROTO_DEL).
+    uint8_t op;
+    /// Identyfikator żądania.
+    uint32_t id;
+    /// Pierwszy numer.
+    char *num1;
+    /// Drugi numer (NULL dla @ref PROTO_DEL).
+    char *num2;
+    /// Status wykonania.
+    uint8_t status;
+    /// Następna modyfikacja w kolejce.
+    struct WriteRequest *next;
+} WriteRequest;
+
+/**
+ * @brief Stan serwera.
+ */
+typedef struct Server {
+    /// Obsługiwana struktura.
+    PhoneForward *pf;
+    /// Blokada czytelników i pisarza struktury.
+    pthread_rwlock_t lock;
+
+    /// Deskryptor epoll.
+    int epoll;
+    /// Gniazdo nasłuchujące.
+    int listener;
+    /// Deskryptor eventfd budzący pętlę zdarzeń po modyfikacjach.
+    int wakeup;
+    /// Deskryptor sygnałów kończących pracę.
+    int signals;
+
+    /// Muteks kolejek modyfikacji.
+    pthread_mutex_t queueLock;
+    /// Zmienna warunkowa wątku piszącego.
+    pthread_cond_t queueCond;
+    /// Modyfikacje do wykonania.
+    WriteRequest *queue;
+    /// Ostatnia modyfikacja do wykonania.
+    WriteRequest *queueTail;
+    /// Wykonane modyfikacje.
+    WriteRequest *done;
+    /// Ostatnia wykonana modyfikacja.
+    WriteRequest *doneTail;
+    /// Czy serwer kończy pracę.
+    bool stopping;
+
+    /// Lista połączeń z żądaniami do przetworzenia.
+    Connection *ready;
+
+    /// Liczba wykonanych żądań.
+    unsigned long long requests;
+    /// Liczba sekcji krytycznych czytelnika.
+    unsigned long long readBatches;
+    /// Liczba sekcji krytycznych pisarza.
+    unsigned long long writeBatches;
+} Server;
+
+/**
+ * @brief Dopisuje modyfikację na koniec listy.
+ *
+ * @param[in, out] head - początek listy;
+ * @param[in, out] tail - koniec listy;
+ * @param[in] request - modyfikacja.
+ */
+static void appendWrite(WriteRequest **head, WriteRequest **tail,
+                        WriteRequest *request) {
+    request->next = NULL;
+
+    if (*head == NULL) {
+        *head = request;
+    }
+    else {
+        (*tail)->next = request;
+    }
+
+    *tail = request;
+}
+
+/**
+ * @brief Wątek piszący: wykonuje oczekujące modyfikacje partiami.
+ *
+ * @param[in, out] arg - stan serwera.
+ * @return NULL.
+ */
+static void *writerMain(void *arg) {
+    Server *server = arg;
+
+    for (;;) {
+        pthread_mutex_lock(&server->queueLock);
+        while (server->queue == NULL && !server->stopping) {
+            pthread_cond_wait(&server->queueCond, &server->queueLock);
+        }
+
+        WriteRequest *batch = server->queue;
+        server->queue = server->queueTail = NULL;
+        bool stopping = server->stopping;
+        pthread_mutex_unlock(&server->queueLock);
+
+        if (batch == NULL && stopping) {
+            return NULL;
+        }
+
+        pthread_rwlock_wrlock(&server->lock);
+        for (WriteRequest *request = batch; request != NULL;
+             request = request->next) {
+            if (request->op == PROTO_ADD) {
+                request->status = (phfwdAdd(server->pf, request->num1,
+                                            request->num2) ?
+                                   PROTO_OK : PROTO_ERROR);
+            }
+            else {
+                phfwdRemove(server->pf, request->num1);
+                request->status = PROTO_OK;
+            }
+        }
+        server->writeBatches++;
+        pthread_rwlock_unlock(&server->lock);
+
+        pthread_mutex_lock(&server->queueLock);
+        while (batch != NULL) {
+            WriteRequest *next = batch->next;
+            appendWrite(&server->done, &server->doneTail, batch);
+            batch = next;
+        }
+        pthread_mutex_unlock(&server->queueLock);
+
+        uint64_t one = 1;
+        if (write(server->wakeup, &one, sizeof(one)) < 0) {
+            perror("write(eventfd)");
+        }
+    }
+}
+
+/**
+ * @brief Dodaje połączenie do listy gotowych.
+ *
+ * @param[in, out] server - stan serwera;
+ * @param[in, out] conn - połączenie.
+ */
+static void markReady(Server *server, Connection *conn) {
+    if (!conn->ready) {
+        conn->ready = true;
+        conn->nextReady = server->ready;
+        server->ready = conn;
+    }
+}
+
+/**
+ * @brief Dopisuje odpowiedź do bufora połączenia.
+ *
+ * Jeśli któryś numer wyniku nie mieści się w polu długości (u16),
+ * dopisuje zamiast niej odpowiedź ze statusem @ref PROTO_ERROR.
+ *
+ * @param[in, out] conn - połączenie;
+ * @param[in] id - identyfikator żądania;
+ * @param[in] status - status;
+ * @param[in] numbers - numery wyniku (lub NULL).
+ */
+static void respond(Connection *conn, uint32_t id, uint8_t status,
+                    PhoneNumbers const *numbers) {
+    size_t size = PROTO_RESPONSE_HEADER;
+    uint32_t count = 0;
+    char const *num;
+
+    while (numbers != NULL && (num = phnumGet(numbers, count)) != NULL) {
+        size_t length = strlen(num);
+
+        // Wynik phfwdGet może mieć niemal dwa razy więcej cyfr, niż mieści
+        // pole długości numeru (cel przekierowania i reszta numeru).
+        if (length > UINT16_MAX) {
+            respond(conn, id, PROTO_ERROR, NULL);
+            return;
+        }
+
+        size += 2 + length;
+        count++;
+    }
+
+    uint8_t *out = protoReserve(&conn->out, 4 + size);
+    if (out == NULL) {
+        conn->broken = true;
+        return;
+    }
+
+    protoPut32(out, (uint32_t) size);
+    protoPut32(out + 4, id);
+    out[8] = status;
+    protoPut32(out + 9, count);
+    out += 4 + PROTO_RESPONSE_HEADER;
+
+    for (uint32_t i = 0; i < count; ++i) {
+        num = phnumGet(numbers, i);
+        size_t length = strlen(num);
+
+        protoPut16(out, (uint16_t) length);
+        memcpy(out + 2, num, length);
+        out += 2 + length;
+    }
+
+    conn->out.size += 4 + size;
+}
+
+/**
+ * @brief Odczytuje numer z argumentów żądania.
+ *
+ * @param[in] args - argumenty;
+ * @param[in] size - rozmiar argumentów;
+ * @param[in, out] position - pozycja odczytu.
+ * @return Numer zakończony znakiem '\0' lub NULL, jeśli argumenty są
+ *         niepoprawne lub nie udało się alokować pamięci.
+ */
+static char *readNumber(uint8_t const *args, size_t size, size_t *position) {
+    if (size - *position < 2) {
+        return NULL;
+    }
+
+    size_t length = protoGet16(args + *position);
+    if (size - *position - 2 < length) {
+        return NULL;
+    }
+
+    char *num = malloc(length + 1);
+    if (num != NULL) {
+        memcpy(num, args + *position + 2, length);
+        num[length] = '\0';
+    }
+
+    *position += 2 + length;
+
+    return num;
+}
+
+/**
+ * @brief Wykonuje żądanie lub przekazuje je wątkowi piszącemu.
+ *
+ * Wywoływana w sekcji krytycznej czytelnika.
+ *
+ * @param[in, out] server - stan serwera;
+ * @param[in, out] conn - połączenie;
+ * @param[in] op - operacja;
+ * @param[in] id - identyfikator żądania;
+ * @param[in] args - argumenty;
+ * @param[in] size - rozmiar argumentów.
+ */
+static void handleRequest(Server *server, Connection *conn, uint8_t op,
+                          uint32_t id, uint8_t const *args, size_t size) {
+    size_t position = 0;
+    char *num1 = readNumber(args, size, &position);
+    char *num2 = (op == PROTO_ADD && num1 != NULL ?
+                  readNumber(args, size, &position) : NULL);
+
+    server->requests++;
+
+    if (num1 == NULL || (op == PROTO_ADD && num2 == NULL)
+        || position != size || op < PROTO_GET || op > PROTO_DEL) {
+        free(num1);
+        free(num2);
+        respond(conn, id, PROTO_ERROR, NULL);
+        return;
+    }
+
+    if (op == PROTO_ADD || op == PROTO_DEL) {
+        WriteRequest *request = malloc(sizeof(WriteRequest));
+        if (request == NULL) {
+            free(num1);
+            free(num2);
+            respond(conn, id, PROTO_ERROR, NULL);
+            return;
+        }
+
+        request->conn = conn;
+        request->op = op;
+        request->id = id;
+        request->num1 = num1;
+        request->num2 = num2;
+        conn->waiting = true;
+
+        pthread_mutex_lock(&server->queueLock);
+        appendWrite(&server->queue, &server->queueTail, request);
+        pthread_cond_signal(&server->queueCond);
+        pthread_mutex_unlock(&server->queueLock);
+        return;
+    }
+
+    PhoneNumbers *result;
+    if (op == PROTO_GET) {
+        result = phfwdGet(server->pf, num1);
+    }
+    else if (op == PROTO_REVERSE) {
+        result = phfwdReverse(server->pf, num1);
+    }
+    else {
+        result = phfwdGetReverse(server->pf, num1);
+    }
+
+    respond(conn, id, (result == NULL ? PROTO_ERROR : PROTO_OK), result);
+    phnumDelete(result);
+    free(num1);
+}
+
+/**
+ * @brief Sprawdza, czy połączenie może przetworzyć kolejne żądanie.
+ *
+ * @param[in] conn - połączenie.
+ * @return Wartość @p true jeśli połączenie nie czeka na modyfikację, nie
+ *         przekroczyło limitu niewysłanych odpowiedzi i ma kompletne
+ *         żądanie, wartość @p false w przeciwnym wypadku.
+ */
+static bool hasRequest(Connection const *conn) {
+    ProtoBuffer const *in = &conn->in;
+
+    if (conn->waiting || conn->broken || in->size - in->offset < 4
+        || conn->out.size - conn->out.offset >= SERVER_OUTPUT_LIMIT) {
+        return false;
+    }
+
+    return in->size - in->offset >= 4 + (size_t) protoGet32(in->data
+                                                            + in->offset);
+}
+
+/**
+ * @brief Przetwarza kompletne żądania połączenia.
+ *
+ * Wywoływana w sekcji krytycznej czytelnika. Zatrzymuje się na pierwszej
+ * modyfikacji, niekompletnym żądaniu lub zbyt wielu niewysłanych
+ * odpowiedziach.
+ *
+ * @param[in, out] server - stan serwera;
+ * @param[in, out] conn - połączenie.
+ */
+static void processRequests(Server *server, Connection *conn) {
+    ProtoBuffer *in = &conn->in;
+
+    while (!conn->waiting && !conn->broken && in->size - in->offset >= 4
+           && conn->out.size - conn->out.offset < SERVER_OUTPUT_LIMIT) {
+        uint32_t size = protoGet32(in->data + in->offset);
+
+        if (size < PROTO_REQUEST_HEADER || size > PROTO_MAX_REQUEST) {
+            conn->broken = true;
+            return;
+        }
+
+        if (in->size - in->offset < 4 + (size_t) size) {
+            return;
+        }
+
+        uint8_t const *frame = in->data + in->offset + 4;
+        in->offset += 4 + size;
+        handleRequest(server, conn, frame[0], protoGet32(frame + 1),
+                      frame + PROTO_REQUEST_HEADER,
+                      size - PROTO_REQUEST_HEADER);
+    }
+}
+
+/**
+ * @brief Ustawia zdarzenia, na które czeka połączenie.
+ *
+ * @param[in] server - stan serwera;
+ * @param[in, out] conn - połączenie;
+ * @param[in] polling - czy czekać na możliwość zapisu.
+ */
+static void setPolling(Server const *server, Connection *conn,
+                       bool polling) {
+    if (conn->polling == polling) {
+        return;
+    }
+
+    struct epoll_event event = {
+        .events = (conn->eof ? 0 : EPOLLIN) | (polling ? EPOLLOUT : 0),
+        .data.ptr = conn
+    };
+
+    epoll_ctl(server->epoll, EPOLL_CTL_MOD, conn->fd, &event);
+    conn->polling = polling;
+}
+
+/**
+ * @brief Zamyka połączenie, jeśli nie jest już potrzebne.
+ *
+ * Połączenie czekające na modyfikację zwalniane jest dopiero po jej
+ * wykonaniu.
+ *
+ * @param[in] server - stan serwera;
+ * @param[in, out] conn - połączenie.
+ * @return Wartość @p true jeśli połączenie zostało zamknięte,
+ *         wartość @p false w przeciwnym wypadku.
+ */
+static bool closeIfDone(Server const *server, Connection *conn) {
+    bool flushed = (conn->out.offset == conn->out.size);
+
+    if (conn->waiting || conn->ready
+        || !(conn->broken || (conn->eof && flushed))) {
+        return false;
+    }
+
+    epoll_ctl(server->epoll, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    protoFree(&conn->in);
+    protoFree(&conn->out);
+    free(conn);
+
+    return true;
+}
+
+/**
+ * @brief Wysyła odpowiedzi połączenia.
+ *
+ * @param[in] server - stan serwera;
+ * @param[in, out] conn - połączenie.
+ */
+static void flushOutput(Server *server, Connection *conn) {
+    ProtoBuffer *out = &conn->out;
+
+    while (!conn->broken && out->offset < out->size) {
+        ssize_t written = send(conn->fd, out->data + out->offset,
+                               out->size - out->offset, MSG_NOSIGNAL);
+
+        if (written < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+
+            if (errno != EINTR) {
+                conn->broken = true;
+            }
+        }
+        else {
+            out->offset += (size_t) written;
+        }
+    }
+
+    if (out->offset == out->size) {
+        out->offset = out->size = 0;
+    }
+
+    if (!conn->broken) {
+        setPolling(server, conn, out->offset < out->size);
+    }
+}
+
+/**
+ * @brief Odbiera dostępne dane połączenia.
+ *
+ * @param[in, out] server - stan serwera;
+ * @param[in, out] conn - połączenie.
+ */
+static void readInput(Server *server, Connection *conn) {
+    for (;;) {
+        uint8_t *space = protoReserve(&conn->in, SERVER_READ_CHUNK);
+        if (space == NULL) {
+            conn->broken = true;
+            break;
+        }
+
+        ssize_t received = recv(conn->fd, space, SERVER_READ_CHUNK, 0);
+        if (received > 0) {
+            conn->in.size += (size_t) received;
+            continue;
+        }
+
+        if (received == 0) {
+            conn->eof = true;
+            struct epoll_event event = {
+                .events = (conn->polling ? EPOLLOUT : 0),
+                .data.ptr = conn
+            };
+            epoll_ctl(server->epoll, EPOLL_CTL_MOD, conn->fd, &event);
+        }
+        else if (errno == EINTR) {
+            continue;
+        }
+        else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            conn->broken = true;
+        }
+
+        break;
+    }
+
+    markReady(server, conn);
+}
+
+/**
+ * @brief Przyjmuje oczekujące połączenia.
+ *
+ * @param[in, out] server - stan serwera.
+ */
+static void acceptConnections(Server *server) {
+    for (;;) {
+        int fd = accept4(server->listener, NULL, NULL, SOCK_NONBLOCK);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                perror("accept4");
+            }
+            return;
+        }
+
+        Connection *conn = calloc(1, sizeof(Connection));
+        struct epoll_event event = {.events = EPOLLIN, .data.ptr = conn};
+
+        if (conn == NULL
+            || epoll_ctl(server->epoll, EPOLL_CTL_ADD, fd, &event) < 0) {
+            free(conn);
+            close(fd);
+            continue;
+        }
+
+        conn->fd = fd;
+    }
+}
+
+/**
+ * @brief Zapisuje odpowiedzi na wykonane modyfikacje.
+ *
+ * @param[in, out] server - stan serwera.
+ */
+static void collectWrites(Server *server) {
+    uint64_t count;
+    if (read(server->wakeup, &count, sizeof(count)) < 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&server->queueLock);
+    WriteRequest *done = server->done;
+    server->done = server->doneTail = NULL;
+    pthread_mutex_unlock(&server->queueLock);
+
+    while (done != NULL) {
+        WriteRequest *next = done->next;
+        Connection *conn = done->conn;
+
+        respond(conn, done->id, done->status, NULL);
+        conn->waiting = false;
+        markReady(server, conn);
+
+        free(done->num1);
+        free(done->num2);
+        free(done);
+        done = next;
+    }
+}
+
+/**
+ * @brief Przetwarza żądania gotowych połączeń i wysyła odpowiedzi.
+ *
+ * Wszystkie żądania odczytu wykonywane są w jednej sekcji krytycznej
+ * czytelnika.
+ *
+ * @param[in, out] server - stan serwera.
+ */
+static void processReady(Server *server) {
+    Connection *ready = server->ready;
+    server->ready = NULL;
+
+    if (ready == NULL) {
+        return;
+    }
+
+    pthread_rwlock_rdlock(&server->lock);
+    for (Connection *conn = ready; conn != NULL; conn = conn->nextReady) {
+        processRequests(server, conn);
+    }
+    server->readBatches++;
+    pthread_rwlock_unlock(&server->lock);
+
+    while (ready != NULL) {
+        Connection *conn = ready;
+        ready = conn->nextReady;
+        conn->ready = false;
+
+        flushOutput(server, conn);
+        if (!closeIfDone(server, conn) && hasRequest(conn)) {
+            markReady(server, conn);
+        }
+    }
+}
+
+/**
+ * @brief Tworzy gniazdo nasłuchujące.
+ *
+ * @param[in] path - ścieżka gniazda.
+ * @return Deskryptor gniazda lub -1 w przypadku błędu.
+ */
+static int listenOn(char const *path) {
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "socket path too long\n");
+        return -1;
+    }
+
+    strcpy(address.sun_path, path);
+    unlink(path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (fd < 0 || bind(fd, (struct sockaddr *) &address,
+                       sizeof(address)) < 0 || listen(fd, SOMAXCONN) < 0) {
+        perror(path);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ * @brief Dodaje deskryptor do zbioru epoll.
+ *
+ * @param[in] server - stan serwera;
+ * @param[in] fd - pole stanu serwera z deskryptorem;
+ * @return Wartość @p true jeśli operacja się powiodła,
+ *         wartość @p false w przeciwnym wypadku.
+ */
+static bool watch(Server *server, int *fd) {
+    struct epoll_event event = {.events = EPOLLIN, .data.ptr = fd};
+
+    return epoll_ctl(server->epoll, EPOLL_CTL_ADD, *fd, &event) == 0;
+}
+
+/**
+ * @brief Pętla zdarzeń serwera.
+ *
+ * @param[in, out] server - stan serwera.
+ */
+static void serve(Server *server) {
+    struct epoll_event events[SERVER_EVENTS];
+
+    while (!server->stopping) {
+        int count = epoll_wait(server->epoll, events, SERVER_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait");
+            return;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            // Deskryptory serwera rejestrowane są ze wskaźnikiem na pole
+            // struktury serwera, a połączenia ze wskaźnikiem na połączenie.
+            void *tag = events[i].data.ptr;
+
+            if (tag == &server->listener) {
+                acceptConnections(server);
+            }
+            else if (tag == &server->wakeup) {
+                collectWrites(server);
+            }
+            else if (tag == &server->signals) {
+                server->stopping = true;
+            }
+            else {
+                Connection *conn = tag;
+
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    readInput(server, conn);
+                }
+
+                if (events[i].events & EPOLLOUT) {
+                    markReady(server, conn);
+                }
+            }
+        }
+
+        // Połączenia wstrzymane limitem niewysłanych odpowiedzi, które
+        // zdążyły wysłać odpowiedzi, wracają na listę gotowych.
+        while (server->ready != NULL) {
+            processReady(server);
+        }
+    }
+}
+
+/**
+ * @brief Uruchamia serwer.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty.
+ * @return Kod wyjścia.
+ */
+int main(int argc, char *argv[]) {
+    if (argc < 2 || argc > 3 || (argc == 3 && strcmp(argv[2], "--hash"))) {
+        fprintf(stderr, "usage: %s SOCKET_PATH [--hash]\n", argv[0]);
+        return 1;
+    }
+
+    Server server;
+    memset(&server, 0, sizeof(server));
+    server.pf = phfwdNewWithEngine(argc == 3 ? PHFWD_ENGINE_HASH
+                                             : PHFWD_ENGINE_TRIE);
+    pthread_rwlock_init(&server.lock, NULL);
+    pthread_mutex_init(&server.queueLock, NULL);
+    pthread_cond_init(&server.queueCond, NULL);
+
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &mask, NULL);
+
+    server.epoll = epoll_create1(0);
+    server.listener = listenOn(argv[1]);
+    server.wakeup = eventfd(0, EFD_NONBLOCK);
+    server.signals = signalfd(-1, &mask, SFD_NONBLOCK);
+
+    if (server.pf == NULL || server.epoll < 0 || server.listener < 0
+        || server.wakeup < 0 || server.signals < 0
+        || !watch(&server, &server.listener) || !watch(&server, &server.wakeup)
+        || !watch(&server, &server.signals)) {
+        fprintf(stderr, "failed to start server\n");
+        return 1;
+    }
+
+    // Wątek piszący dziedziczy zablokowane sygnały.
+    pthread_t writer;
+    if (pthread_create(&writer, NULL, writerMain, &server) != 0) {
+        fprintf(stderr, "failed to start writer thread\n");
+        return 1;
+    }
+
+    serve(&server);
+
+    pthread_mutex_lock(&server.queueLock);
+    server.stopping = true;
+    pthread_cond_signal(&server.queueCond);
+    pthread_mutex_unlock(&server.queueLock);
+    pthread_join(writer, NULL);
+
+    fprintf(stderr, "requests %llu, read batches %llu, write batches %llu\n",
+            server.requests, server.readBatches, server.writeBatches);
+
+    unlink(argv[1]);
+    phfwdDelete(server.pf);
+
+    return 0;
+}
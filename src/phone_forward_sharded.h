@@ -0,0 +1,106 @@
+/** @file phone_forward_sharded.h
+ * Interfejs struktury podzielonej na części, modyfikowanej równolegle
+ * przez wiele wątków.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __PHONE_FORWARD_SHARDED_H__
+#define __PHONE_FORWARD_SHARDED_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "phone_forward.h"
+
+struct PhfwdSharded;
+/**
+ * Definiuje strukturę przekierowań podzieloną na części według pierwszej
+ * cyfry numeru, z których każda może być modyfikowana współbieżnie
+ * (zob. @ref phfwdShardedNew).
+ */
+typedef struct PhfwdSharded PhfwdSharded;
+
+/** @brief Tworzy nową strukturę podzieloną na części.
+ * Tworzy strukturę niezawierającą żadnych przekierowań, złożoną z dwunastu
+ * niezależnych struktur @p PhoneForward – po jednej dla każdej możliwej
+ * pierwszej cyfry numeru – chronionych osobnymi blokadami czytelników
+ * i pisarzy. Przekierowanie z @p num1 przechowywane jest wyłącznie
+ * w części pierwszej cyfry @p num1 (razem ze swoim wpisem przekierowania
+ * wstecz), a każda część ma własny czas, więc modyfikacje numerów
+ * o różnych pierwszych cyfrach wykonują się równolegle. Wszystkie funkcje
+ * struktury mogą być wywoływane współbieżnie z wielu wątków.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
+ *         alokować pamięci.
+ */
+PhfwdSharded * phfwdShardedNew(void);
+
+/** @brief Usuwa strukturę podzieloną na części.
+ * Nic nie robi, jeśli wskaźnik ma wartość NULL. Nie może być wywołana
+ * współbieżnie z innymi funkcjami struktury.
+ * @param[in] sharded – wskaźnik na usuwaną strukturę.
+ */
+void phfwdShardedDelete(PhfwdSharded *sharded);
+
+/** @brief Dodaje przekierowanie do struktury podzielonej na części.
+ * Działa jak @ref phfwdAdd, blokując jedynie część pierwszej cyfry
+ * @p num1.
+ * @param[in,out] sharded – wskaźnik na strukturę;
+ * @param[in] num1        – wskaźnik na napis reprezentujący prefiks numerów
+ *                          przekierowywanych;
+ * @param[in] num2        – wskaźnik na napis reprezentujący prefiks numerów,
+ *                          na które jest wykonywane przekierowanie.
+ * @return Wartość @p true, jeśli przekierowanie zostało dodane.
+ *         Wartość @p false, jeśli wystąpił błąd, np. podany napis nie
+ *         reprezentuje numeru, oba podane numery są identyczne lub nie
+ *         udało się alokować pamięci.
+ */
+bool phfwdShardedAdd(PhfwdSharded *sharded, char const *num1,
+                     char const *num2);
+
+/** @brief Usuwa przekierowania ze struktury podzielonej na części.
+ * Działa jak @ref phfwdRemove, blokując jedynie część pierwszej cyfry
+ * @p num.
+ * @param[in,out] sharded – wskaźnik na strukturę;
+ * @param[in] num         – wskaźnik na napis reprezentujący prefiks numerów.
+ */
+void phfwdShardedRemove(PhfwdSharded *sharded, char const *num);
+
+/** @brief Wyznacza przekierowanie numeru w strukturze podzielonej na części.
+ * Działa jak @ref phfwdGet, blokując do odczytu jedynie część pierwszej
+ * cyfry @p num.
+ * @param[in] sharded – wskaźnik na strukturę;
+ * @param[in] num     – wskaźnik na napis reprezentujący numer.
+ * @return Wskaźnik na strukturę przechowującą ciąg numerów lub NULL, gdy
+ *         @p sharded ma wartość NULL lub nie udało się alokować pamięci.
+ */
+PhoneNumbers * phfwdShardedGet(PhfwdSharded *sharded, char const *num);
+
+/** @brief Wyznacza przekierowania na numer w strukturze podzielonej
+ * na części.
+ * Działa jak @ref phfwdReverse. Części odczytywane są kolejno, każda pod
+ * własną blokadą, więc wynik odpowiada w każdej części pewnemu jej stanowi
+ * z czasu wywołania, ale nie musi odpowiadać jednemu stanowi całej
+ * struktury, jeśli współbieżnie wykonywane są modyfikacje.
+ * @param[in] sharded – wskaźnik na strukturę;
+ * @param[in] num     – wskaźnik na napis reprezentujący numer.
+ * @return Wskaźnik na strukturę przechowującą ciąg numerów lub NULL, gdy
+ *         @p sharded ma wartość NULL lub nie udało się alokować pamięci.
+ */
+PhoneNumbers * phfwdShardedReverse(PhfwdSharded *sharded, char const *num);
+
+/** @brief Wyznacza numery przekierowywane na numer w strukturze podzielonej
+ * na części.
+ * Działa jak @ref phfwdGetReverse, z tymi samymi zastrzeżeniami co
+ * @ref phfwdShardedReverse.
+ * @param[in] sharded – wskaźnik na strukturę;
+ * @param[in] num     – wskaźnik na napis reprezentujący numer.
+ * @return Wskaźnik na strukturę przechowującą ciąg numerów lub NULL, gdy
+ *         @p sharded ma wartość NULL lub nie udało się alokować pamięci.
+ */
+PhoneNumbers * phfwdShardedGetReverse(PhfwdSharded *sharded,
+                                      char const *num);
+
+#endif /* __PHONE_FORWARD_SHARDED_H__ */
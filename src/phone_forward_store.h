@@ -0,0 +1,142 @@
+/** @file phone_forward_store.h
+ * Interfejs magazynu niemodyfikowalnych tabel przekierowań ze wspólnymi
+ * poddrzewami.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __PHONE_FORWARD_STORE_H__
+#define __PHONE_FORWARD_STORE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "phone_forward.h"
+
+struct PhfwdStore;
+/**
+ * Definiuje magazyn tabel przekierowań ze współdzielonymi poddrzewami
+ * (zob. @ref phfwdStoreNew).
+ */
+typedef struct PhfwdStore PhfwdStore;
+
+struct PhfwdStoreTable;
+/**
+ * Definiuje tabelę przekierowań przechowywaną w magazynie.
+ */
+typedef struct PhfwdStoreTable PhfwdStoreTable;
+
+/**
+ * @brief Statystyki pamięci magazynu tabel.
+ */
+typedef struct PhfwdStoreStats {
+    /// Liczba tabel.
+    size_t tables;
+    /// Liczba wierzchołków (każde współdzielone poddrzewo liczone raz).
+    size_t nodes;
+    /// Liczba bajtów zajmowanych przez magazyn.
+    size_t bytes;
+    /// Liczba bajtów, które zajmowałyby tabele bez współdzielenia poddrzew;
+    /// różnica z @p bytes to pamięć zaoszczędzona przez współdzielenie.
+    size_t unsharedBytes;
+} PhfwdStoreStats;
+
+/** @brief Tworzy nowy magazyn tabel.
+ * Magazyn przechowuje niemodyfikowalne drzewa aktualnych przekierowań
+ * wielu tabel, w których identyczne poddrzewa (o tych samych numerach
+ * względem korzenia poddrzewa i tych samych celach) są przechowywane raz,
+ * niezależnie od tego, z której tabeli i spod którego prefiksu pochodzą.
+ * Modyfikacja tabeli tworzy nową ścieżkę od korzenia do modyfikowanego
+ * prefiksu, nie zmieniając poddrzew współdzielonych z innymi tabelami.
+ * Funkcje magazynu i jego tabel nie mogą być wywoływane współbieżnie.
+ * @return Wskaźnik na utworzony magazyn lub NULL, gdy nie udało się
+ *         alokować pamięci.
+ */
+PhfwdStore * phfwdStoreNew(void);
+
+/** @brief Usuwa magazyn wraz ze wszystkimi jego tabelami.
+ * Nic nie robi, jeśli wskaźnik ma wartość NULL.
+ * @param[in] store – wskaźnik na usuwany magazyn.
+ */
+void phfwdStoreDelete(PhfwdStore *store);
+
+/** @brief Dodaje do magazynu tabelę z aktualnymi przekierowaniami struktury.
+ * Dalsze modyfikacje struktury @p pf nie zmieniają tabeli.
+ * @param[in,out] store – wskaźnik na magazyn;
+ * @param[in] pf        – wskaźnik na strukturę przechowującą przekierowania
+ *                        numerów.
+ * @return Wskaźnik na utworzoną tabelę lub NULL, gdy któryś ze wskaźników
+ *         ma wartość NULL lub nie udało się alokować pamięci.
+ */
+PhfwdStoreTable * phfwdStoreImport(PhfwdStore *store, PhoneForward const *pf);
+
+/** @brief Tworzy kopię tabeli.
+ * Kopia współdzieli z tabelą wszystkie wierzchołki, więc jej utworzenie
+ * nie zależy od liczby przekierowań; późniejsze modyfikacje kopii i tabeli
+ * są od siebie niezależne.
+ * @param[in] table – wskaźnik na kopiowaną tabelę.
+ * @return Wskaźnik na kopię lub NULL, gdy @p table ma wartość NULL lub nie
+ *         udało się alokować pamięci.
+ */
+PhfwdStoreTable * phfwdStoreCopy(PhfwdStoreTable const *table);
+
+/** @brief Usuwa tabelę z magazynu.
+ * Zwalnia wierzchołki, których nie używa już żadna tabela. Nic nie robi,
+ * jeśli wskaźnik ma wartość NULL.
+ * @param[in] table – wskaźnik na usuwaną tabelę.
+ */
+void phfwdStoreRelease(PhfwdStoreTable *table);
+
+/** @brief Dodaje przekierowanie do tabeli.
+ * Działa jak @ref phfwdAdd.
+ * @param[in,out] table – wskaźnik na tabelę;
+ * @param[in] num1      – wskaźnik na napis reprezentujący prefiks numerów
+ *                        przekierowywanych;
+ * @param[in] num2      – wskaźnik na napis reprezentujący prefiks numerów,
+ *                        na które jest wykonywane przekierowanie.
+ * @return Wartość @p true, jeśli przekierowanie zostało dodane.
+ *         Wartość @p false, jeśli wystąpił błąd, np. podany napis nie
+ *         reprezentuje numeru, oba podane numery są identyczne lub nie
+ *         udało się alokować pamięci (tabela pozostaje wtedy bez zmian).
+ */
+bool phfwdStoreAdd(PhfwdStoreTable *table, char const *num1,
+                   char const *num2);
+
+/** @brief Usuwa przekierowania z tabeli.
+ * Działa jak @ref phfwdRemove. Jeśli nie udało się alokować pamięci, tabela
+ * pozostaje bez zmian.
+ * @param[in,out] table – wskaźnik na tabelę;
+ * @param[in] num       – wskaźnik na napis reprezentujący prefiks numerów.
+ */
+void phfwdStoreRemove(PhfwdStoreTable *table, char const *num);
+
+/** @brief Wyznacza przekierowanie numeru w tabeli.
+ * Działa jak @ref phfwdGet.
+ * @param[in] table – wskaźnik na tabelę;
+ * @param[in] num   – wskaźnik na napis reprezentujący numer.
+ * @return Wskaźnik na strukturę przechowującą ciąg numerów lub NULL, gdy
+ *         @p table ma wartość NULL lub nie udało się alokować pamięci.
+ */
+PhoneNumbers * phfwdStoreGet(PhfwdStoreTable const *table, char const *num);
+
+/** @brief Tworzy strukturę z przekierowaniami tabeli.
+ * Tabele nie przechowują przekierowań wstecz; do wyznaczania wyników
+ * funkcji @ref phfwdReverse i @ref phfwdGetReverse służy utworzona
+ * struktura.
+ * @param[in] table – wskaźnik na tabelę.
+ * @return Wskaźnik na nową strukturę lub NULL, gdy @p table ma wartość
+ *         NULL lub nie udało się alokować pamięci.
+ */
+PhoneForward * phfwdStoreExport(PhfwdStoreTable const *table);
+
+/** @brief Udostępnia statystyki pamięci magazynu.
+ * @param[in] store  – wskaźnik na magazyn;
+ * @param[out] stats – wskaźnik na wynikowe statystyki.
+ * @return Wartość @p true, jeśli statystyki zostały wypełnione. Wartość
+ *         @p false, jeśli któryś ze wskaźników ma wartość NULL.
+ */
+bool phfwdStoreStats(PhfwdStore const *store, PhfwdStoreStats *stats);
+
+#endif /* __PHONE_FORWARD_STORE_H__ */
@@ -0,0 +1,105 @@
+/** @file phone_forward_tuning.h
+ * Interfejs opcjonalnych przyspieszeń wyszukiwania: wyboru sposobu
+ * wyszukiwania najdłuższego prefiksu, pamięci podręcznej wyników
+ * i tablicy skoków.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __PHONE_FORWARD_TUNING_H__
+#define __PHONE_FORWARD_TUNING_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "phone_forward.h"
+
+/**
+ * @brief Sposób wyszukiwania najdłuższego przekierowanego prefiksu numeru
+ * w funkcji @ref phfwdGet.
+ */
+typedef enum PhfwdEngine {
+    /// Przejście drzewa TRIE cyfra po cyfrze.
+    PHFWD_ENGINE_TRIE,
+    /// Wyszukiwanie binarne po długościach prefiksów w tablicach
+    /// haszujących.
+    PHFWD_ENGINE_HASH
+} PhfwdEngine;
+
+/** @brief Tworzy nową strukturę korzystającą z podanego sposobu wyszukiwania.
+ * Tworzy nową strukturę niezawierającą żadnych przekierowań. Dla
+ * @ref PHFWD_ENGINE_HASH przekierowania z prefiksów długości co najwyżej 16
+ * są dodatkowo przechowywane w tablicach haszujących (po jednej dla każdej
+ * długości) i funkcja @ref phfwdGet wykonuje dla nich wyszukiwanie binarne
+ * po długościach prefiksów zamiast przechodzenia drzewa. Funkcje
+ * @ref phfwdAdd i @ref phfwdRemove zachowują się tak samo, choć
+ * @ref phfwdRemove przegląda wtedy przekierowania z usuwanego poddrzewa.
+ * @param[in] engine – sposób wyszukiwania.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
+ *         alokować pamięci lub @p engine jest niepoprawny.
+ */
+PhoneForward * phfwdNewWithEngine(PhfwdEngine engine);
+
+/**
+ * @brief Statystyki pamięci podręcznej wyników funkcji @ref phfwdGet.
+ */
+typedef struct PhfwdCacheStats {
+    /// Liczba wywołań obsłużonych z pamięci podręcznej.
+    unsigned long long hits;
+    /// Liczba wywołań, dla których nie znaleziono aktualnego wyniku.
+    unsigned long long misses;
+    /// Liczba chybień spowodowanych unieważnionym wpisem.
+    unsigned long long stale;
+    /// Liczba wpisów usuniętych z braku miejsca.
+    unsigned long long evictions;
+    /// Liczba zajętych wpisów.
+    size_t entries;
+    /// Największa liczba wpisów.
+    size_t capacity;
+} PhfwdCacheStats;
+
+/** @brief Włącza pamięć podręczną wyników funkcji @ref phfwdGet.
+ * Zapamiętuje co najwyżej około @p capacity ostatnio używanych wyników
+ * (wyniki numerów dłuższych niż 16 cyfr nie są zapamiętywane). Modyfikacje
+ * struktury unieważniają jedynie wyniki numerów o tym samym prefiksie
+ * (długości co najwyżej 3) i nie przeglądają pamięci podręcznej. Funkcja
+ * @ref phfwdGet może być wtedy wywoływana równocześnie z wielu wątków,
+ * o ile w tym czasie struktura nie jest modyfikowana. Ponowne wywołanie
+ * zastępuje pamięć podręczną nową, pustą; wartość 0 ją wyłącza.
+ * @param[in,out] pf    – wskaźnik na strukturę przechowującą przekierowania
+ *                        numerów;
+ * @param[in] capacity  – największa liczba zapamiętanych wyników.
+ * @return Wartość @p true, jeśli operacja się powiodła. Wartość @p false,
+ *         jeśli @p pf ma wartość NULL lub nie udało się alokować pamięci
+ *         (dotychczasowa pamięć podręczna pozostaje wtedy bez zmian).
+ */
+bool phfwdEnableCache(PhoneForward *pf, size_t capacity);
+
+/** @brief Udostępnia statystyki pamięci podręcznej.
+ * @param[in] pf     – wskaźnik na strukturę przechowującą przekierowania
+ *                     numerów;
+ * @param[out] stats – wskaźnik na wynikowe statystyki.
+ * @return Wartość @p true, jeśli statystyki zostały wypełnione. Wartość
+ *         @p false, jeśli pamięć podręczna jest wyłączona lub któryś
+ *         ze wskaźników ma wartość NULL.
+ */
+bool phfwdCacheStats(PhoneForward const *pf, PhfwdCacheStats *stats);
+
+/** @brief Włącza tablicę skoków dla pierwszych cyfr numerów.
+ * Tablica ma @f$12^{depth}@f$ pozycji i pozwala funkcji @ref phfwdGet
+ * pominąć przechodzenie pierwszych @p depth poziomów drzewa. Jest
+ * aktualizowana przez @ref phfwdAdd i @ref phfwdRemove. Ponowne wywołanie
+ * zastępuje tablicę nową; wartość 0 ją wyłącza.
+ * @param[in,out] pf – wskaźnik na strukturę przechowującą przekierowania
+ *                     numerów;
+ * @param[in] depth  – liczba cyfr indeksujących tablicę (od 2 do 4) lub 0.
+ * @return Wartość @p true, jeśli operacja się powiodła. Wartość @p false,
+ *         jeśli @p pf ma wartość NULL, @p depth jest spoza zakresu lub nie
+ *         udało się alokować pamięci (dotychczasowa tablica pozostaje wtedy
+ *         bez zmian).
+ */
+bool phfwdEnableJumpTable(PhoneForward *pf, size_t depth);
+
+#endif /* __PHONE_FORWARD_TUNING_H__ */
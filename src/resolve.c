@@ -0,0 +1,238 @@
+/** @file resolve.c
+ * Implementacja pamięci domknięć przekierowań.
+ *
+ * Pozycja domknięcia wybierana jest funkcją haszującą wskaźnika wierzchołka
+ * prefiksu źródłowego, a nowe domknięcie zastępuje poprzednie z tej samej
+ * pozycji. Gdy zastąpionych zostanie więcej ważnych domknięć, niż jest
+ * pozycji, liczba pozycji jest podwajana (do @ref RESOLVE_MAX_SLOTS).
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <string.h>
+
+#include "resolve.h"
+#include "utils.h"
+
+/// Początkowa liczba pozycji pamięci domknięć (potęga dwójki).
+#define RESOLVE_MIN_SLOTS 1024
+
+/// Największa liczba pozycji pamięci domknięć.
+#define RESOLVE_MAX_SLOTS 65536
+
+/// Liczba poziomów liczników prefiksów (długości 1, 2 i 3).
+#define RESOLVE_GEN_LEVELS 3
+
+/// Indeks pierwszego licznika poddrzewa (12 + 12^2 + 12^3).
+#define RESOLVE_SUBTREE_GENS (12 + 144 + 1728)
+
+/// Łączna liczba liczników (z licznikami poddrzew długości 1 i 2).
+#define RESOLVE_GENS (RESOLVE_SUBTREE_GENS + 12 + 144)
+
+/**
+ * Pamięć domknięć przekierowań.
+ */
+struct ResolveMemo {
+    /// Alokator pamięci domknięć.
+    PhfwdAllocator const *alloc;
+    /// Liczniki generacji prefiksów długości 1, 2 i 3, a następnie
+    /// poddrzew prefiksów długości 1 i 2.
+    uint32_t gens[RESOLVE_GENS];
+    /// Pozycje pamięci.
+    ResolveClosure *slots;
+    /// Maska wyznaczająca pozycję z wartości funkcji haszującej.
+    size_t mask;
+    /// Liczba ważnych domknięć zastąpionych od ostatniego powiększenia.
+    size_t evictions;
+};
+
+/**
+ * Indeksy pierwszych liczników prefiksów kolejnych długości.
+ */
+static size_t const resolvePrefixOffsets[RESOLVE_GEN_LEVELS] =
+    {0, 12, 12 + 144};
+
+/**
+ * Indeksy pierwszych liczników poddrzew prefiksów długości 1 i 2.
+ */
+static size_t const resolveSubtreeOffsets[RESOLVE_GEN_LEVELS - 1] =
+    {RESOLVE_SUBTREE_GENS, RESOLVE_SUBTREE_GENS + 12};
+
+/**
+ * @brief Wyznacza pozycję domknięcia prefiksu.
+ *
+ * @param[in] source - wierzchołek prefiksu źródłowego;
+ * @param[in] mask - maska liczby pozycji.
+ * @return Indeks pozycji.
+ */
+static size_t resolveSlot(Node const *source, size_t mask) {
+    uint64_t key = (uint64_t) (uintptr_t) source;
+
+    key ^= key >> 31;
+    key *= 0x9e3779b97f4a7c15ull;
+    key ^= key >> 29;
+
+    return (size_t) key & mask;
+}
+
+/**
+ * @brief Wyznacza sumę liczników, od których zależy domknięcie.
+ *
+ * Liczniki tylko rosną, więc każda modyfikacja zmienia sumę.
+ *
+ * @param[in] memo - pamięć domknięć;
+ * @param[in] closure - domknięcie.
+ * @return Suma liczników.
+ */
+static uint32_t resolveStamp(ResolveMemo const *memo,
+                             ResolveClosure const *closure) {
+    uint32_t stamp = 0;
+
+    for (size_t i = 0; i < closure->depCount; ++i) {
+        stamp += memo->gens[closure->deps[i]];
+    }
+
+    return stamp;
+}
+
+extern ResolveMemo *resolveNew(PhfwdAllocator const *alloc) {
+    ResolveMemo *memo = memCalloc(alloc, 1, sizeof(ResolveMemo));
+    if (memo == NULL) {
+        return NULL;
+    }
+
+    memo->slots = memCalloc(alloc, RESOLVE_MIN_SLOTS, sizeof(ResolveClosure));
+    if (memo->slots == NULL) {
+        memFree(alloc, memo);
+        return NULL;
+    }
+
+    memo->alloc = alloc;
+    memo->mask = RESOLVE_MIN_SLOTS - 1;
+
+    return memo;
+}
+
+extern void resolveDelete(ResolveMemo *memo) {
+    if (memo == NULL) {
+        return;
+    }
+
+    memFree(memo->alloc, memo->slots);
+    memFree(memo->alloc, memo);
+}
+
+/*
+ * Modyfikacje prefiksów num są widoczne w licznikach jego prefiksów
+ * długości co najwyżej 3, a modyfikacje dłuższych numerów - w liczniku
+ * trzycyfrowego prefiksu num lub, dla krótszych num, w liczniku poddrzewa.
+ */
+extern bool resolveDepend(ResolveClosure *closure, char const *num,
+                          size_t length) {
+    size_t levels = min(length, RESOLVE_GEN_LEVELS);
+    size_t needed = levels + (length < RESOLVE_GEN_LEVELS ? 1 : 0);
+    size_t index = 0;
+
+    if (closure->depCount + needed > RESOLVE_MAX_DEPS) {
+        return false;
+    }
+
+    for (size_t level = 0; level < levels; ++level) {
+        index = index * 12 + toInt(num[level]);
+        closure->deps[closure->depCount++] =
+            (uint16_t) (resolvePrefixOffsets[level] + index);
+    }
+
+    if (length < RESOLVE_GEN_LEVELS) {
+        closure->deps[closure->depCount++] =
+            (uint16_t) (resolveSubtreeOffsets[length - 1] + index);
+    }
+
+    return true;
+}
+
+extern ResolveClosure const *resolveLookup(ResolveMemo const *memo,
+                                           Node const *source) {
+    ResolveClosure const *closure = &memo->slots[resolveSlot(source,
+                                                             memo->mask)];
+
+    if (closure->source != source
+        || closure->stamp != resolveStamp(memo, closure)) {
+        return NULL;
+    }
+
+    return closure;
+}
+
+/**
+ * @brief Podwaja liczbę pozycji pamięci, przenosząc ważne domknięcia.
+ *
+ * Przy niepowodzeniu alokacji pamięć pozostaje bez zmian.
+ *
+ * @param[in, out] memo - pamięć domknięć.
+ */
+static void resolveGrow(ResolveMemo *memo) {
+    size_t count = 2 * (memo->mask + 1);
+    ResolveClosure *slots = memCalloc(memo->alloc, count,
+                                      sizeof(ResolveClosure));
+    if (slots == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i <= memo->mask; ++i) {
+        ResolveClosure const *closure = &memo->slots[i];
+
+        if (closure->source != NULL
+            && closure->stamp == resolveStamp(memo, closure)) {
+            slots[resolveSlot(closure->source, count - 1)] = *closure;
+        }
+    }
+
+    memFree(memo->alloc, memo->slots);
+    memo->slots = slots;
+    memo->mask = count - 1;
+    memo->evictions = 0;
+}
+
+extern void resolveStore(ResolveMemo *memo, ResolveClosure const *closure) {
+    ResolveClosure *slot = &memo->slots[resolveSlot(closure->source,
+                                                    memo->mask)];
+
+    if (slot->source != NULL && slot->source != closure->source
+        && slot->stamp == resolveStamp(memo, slot)
+        && ++memo->evictions > memo->mask
+        && memo->mask + 1 < RESOLVE_MAX_SLOTS) {
+        resolveGrow(memo);
+        slot = &memo->slots[resolveSlot(closure->source, memo->mask)];
+    }
+
+    memcpy(slot, closure, sizeof(ResolveClosure));
+    slot->stamp = resolveStamp(memo, slot);
+}
+
+/*
+ * Licznik prefiksu długości co najwyżej 3 odpowiada dokładnie
+ * modyfikowanemu prefiksowi, a liczniki poddrzew - jego krótszym
+ * prefiksom.
+ */
+extern void resolveInvalidate(ResolveMemo *memo, char const *num,
+                              size_t length) {
+    size_t levels = min(length, RESOLVE_GEN_LEVELS);
+    size_t index = 0;
+
+    if (levels == 0) {
+        return;
+    }
+
+    for (size_t level = 0; level < levels; ++level) {
+        index = index * 12 + toInt(num[level]);
+
+        if (level + 1 < length && level + 1 < RESOLVE_GEN_LEVELS) {
+            memo->gens[resolveSubtreeOffsets[level] + index]++;
+        }
+    }
+
+    memo->gens[resolvePrefixOffsets[levels - 1] + index]++;
+}
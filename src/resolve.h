@@ -0,0 +1,146 @@
+/** @file resolve.h
+ * Interfejs pamięci domknięć przekierowań używanej przez phfwdResolve.
+ *
+ * Domknięcie prefiksu @p s, z którego jest przekierowanie, opisuje ciąg
+ * kolejnych przekierowań numerów zaczynających się od @p s, dopóki żaden
+ * z nich nie zależy od dalszych cyfr numeru. Pozwala to wykonać wiele
+ * przekierowań łańcucha jednym krokiem: numer @p s w zostaje zastąpiony
+ * numerem @p p w, gdzie @p p jest prefiksem zapamiętanym w domknięciu.
+ *
+ * Domknięcia unieważniane są licznikami generacji tak jak wyniki w pamięci
+ * podręcznej phfwdGet: modyfikacja przekierowań z prefiksu @p a zwiększa
+ * licznik jego (najwyżej trzycyfrowego) prefiksu oraz liczniki poddrzew jego
+ * krótszych prefiksów. Domknięcie pamięta liczniki numerów, od których
+ * zależało, i jest ważne, dopóki ich suma się nie zmieniła.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __RESOLVE_H__
+#define __RESOLVE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "phone_forward.h"
+#include "allocator.h"
+
+/**
+ * Największa liczba przekierowań składających się na jedno domknięcie.
+ */
+#define RESOLVE_MAX_CHAIN 8
+
+/**
+ * Największa długość prefiksu zapamiętanego w domknięciu.
+ */
+#define RESOLVE_MAX_DIGITS 31
+
+/**
+ * Największa liczba liczników, od których zależy domknięcie
+ * (po cztery dla prefiksu źródłowego i każdego numeru łańcucha).
+ */
+#define RESOLVE_MAX_DEPS (4 * (RESOLVE_MAX_CHAIN + 1))
+
+/**
+ * @brief Stan łańcucha po wykonaniu przekierowań domknięcia.
+ */
+typedef enum ResolveStatus {
+    /// Do otrzymanego numeru nie stosuje się już żadne przekierowanie.
+    RESOLVE_TERMINAL,
+    /// Dalsze przekierowania zależą od pozostałych cyfr numeru.
+    RESOLVE_PARTIAL,
+    /// Łańcuch wraca do odwiedzonego już numeru i nigdy się nie kończy.
+    RESOLVE_CYCLE
+} ResolveStatus;
+
+/**
+ * @brief Domknięcie przekierowania z prefiksu.
+ */
+typedef struct ResolveClosure {
+    /// Wierzchołek prefiksu źródłowego (NULL dla wolnej pozycji).
+    Node const *source;
+    /// Liczba przekierowań składających się na domknięcie.
+    size_t hops;
+    /// Stan łańcucha po tych przekierowaniach.
+    ResolveStatus status;
+    /// Długość prefiksu zastępującego prefiks źródłowy.
+    size_t length;
+    /// Prefiks zastępujący prefiks źródłowy (zakończony znakiem '\0').
+    char prefix[RESOLVE_MAX_DIGITS + 1];
+    /// Suma liczników generacji z chwili zapamiętania.
+    uint32_t stamp;
+    /// Liczba liczników, od których zależy domknięcie.
+    size_t depCount;
+    /// Indeksy tych liczników.
+    uint16_t deps[RESOLVE_MAX_DEPS];
+} ResolveClosure;
+
+struct ResolveMemo;
+/**
+ * Definiuje pamięć domknięć przekierowań.
+ */
+typedef struct ResolveMemo ResolveMemo;
+
+/**
+ * @brief Tworzy pustą pamięć domknięć.
+ *
+ * @param[in] alloc - alokator.
+ * @return Wskaźnik na pamięć domknięć lub NULL, gdy nie udało się
+ *         alokować pamięci.
+ */
+ResolveMemo *resolveNew(PhfwdAllocator const *alloc);
+
+/**
+ * @brief Usuwa pamięć domknięć.
+ *
+ * @param[in] memo - usuwana pamięć domknięć (lub NULL).
+ */
+void resolveDelete(ResolveMemo *memo);
+
+/**
+ * @brief Dodaje do domknięcia zależność od przekierowań numeru.
+ *
+ * Domknięcie przestaje być ważne po modyfikacji przekierowań z dowolnego
+ * prefiksu numeru lub z dowolnego numeru, którego prefiksem jest @p num.
+ *
+ * @param[in, out] closure - budowane domknięcie;
+ * @param[in] num - numer;
+ * @param[in] length - długość numeru (niezerowa).
+ * @return Wartość @p true jeśli operacja się powiodła,
+ *         wartość @p false jeśli domknięcie ma już zbyt wiele zależności.
+ */
+bool resolveDepend(ResolveClosure *closure, char const *num, size_t length);
+
+/**
+ * @brief Wyszukuje ważne domknięcie prefiksu.
+ *
+ * @param[in] memo - pamięć domknięć;
+ * @param[in] source - wierzchołek prefiksu źródłowego.
+ * @return Wskaźnik na domknięcie lub NULL, jeśli nie ma ważnego domknięcia.
+ */
+ResolveClosure const *resolveLookup(ResolveMemo const *memo,
+                                    Node const *source);
+
+/**
+ * @brief Zapamiętuje domknięcie, zastępując domknięcie z tej samej pozycji.
+ *
+ * @param[in, out] memo - pamięć domknięć;
+ * @param[in] closure - domknięcie z ustalonymi zależnościami.
+ */
+void resolveStore(ResolveMemo *memo, ResolveClosure const *closure);
+
+/**
+ * @brief Unieważnia domknięcia zależne od przekierowań z prefiksu.
+ *
+ * Wywoływana przy każdej modyfikacji przekierowań z prefiksu @p num.
+ *
+ * @param[in, out] memo - pamięć domknięć;
+ * @param[in] num - prefiks, którego przekierowania się zmieniły;
+ * @param[in] length - długość prefiksu.
+ */
+void resolveInvalidate(ResolveMemo *memo, char const *num, size_t length);
+
+#endif /* __RESOLVE_H__ */
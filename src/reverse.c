@@ -0,0 +1,652 @@
+/** @file reverse.c
+ * Implementacja kursora przeglądającego wynik funkcji phfwdReverse.
+ *
+ * Każdy prefiks zadanego numeru, na który istnieją przekierowania,
+ * wyznacza jeden strumień kandydatów: numery źródłowe z posortowanego zbioru
+ * przekierowań wstecz z dopisanym pozostałym sufiksem. Kandydaci jednego
+ * strumienia są generowani rosnąco, a kursor scala strumienie wszystkich
+ * prefiksów, pomijając powtórzenia. Cała pamięć kursora jest alokowana
+ * przy jego otwarciu i zależy jedynie od długości numerów, a nie od liczby
+ * przekierowań na dany numer.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <string.h>
+
+#include "phone_forward.h"
+#include "phone_forward_reverse.h"
+#include "node.h"
+#include "utils.h"
+
+/**
+ * @brief Strumień kandydatów wyznaczonych przez jeden prefiks numeru.
+ *
+ * Kandydat wierzchołka źródłowego @p x to numer @p x z dopisanym sufiksem
+ * zadanego numeru. Jeśli @p x jest prefiksem kolejnego elementu zbioru,
+ * jego kandydat może być od tego elementu większy, więc @p x czeka na liście
+ * oczekujących, dopóki nie stanie się najmniejszym możliwym kandydatem.
+ * Oczekujące wierzchołki zawsze tworzą łańcuch prefiksów, stąd ich liczba
+ * jest ograniczona przez największą głębokość wierzchołka źródłowego.
+ */
+typedef struct ReverseStream {
+    /// Wierzchołek prefiksu numeru
+    /// (NULL dla strumienia zawierającego tylko sam numer).
+    Node const *target;
+    /// Długość prefiksu.
+    size_t prefixLength;
+    /// Pozycja kolejnego nieprzejrzanego elementu zbioru przekierowań wstecz.
+    BwdSetPosition next;
+    /// Oczekujące wierzchołki źródłowe (każdy jest prefiksem następnego).
+    Node const **pending;
+    /// Liczba oczekujących wierzchołków.
+    size_t pendingCount;
+    /// Najmniejszy niewypisany kandydat strumienia.
+    char *head;
+    /// Długość kandydata @p head.
+    size_t headLength;
+    /// Czy strumień ma jeszcze kandydata.
+    bool hasHead;
+} ReverseStream;
+
+/**
+ * Kursor przeglądający wynik funkcji phfwdReverse.
+ */
+struct PhfwdReverseCursor {
+    /// Alokator, którym zaalokowano kursor.
+    PhfwdAllocator const *alloc;
+    /// Kopia zadanego numeru.
+    char *num;
+    /// Długość zadanego numeru.
+    size_t length;
+    /// Strumienie kolejnych prefiksów.
+    ReverseStream *streams;
+    /// Liczba strumieni.
+    size_t streamCount;
+    /// Dwa bufory robocze do porównywania kandydatów.
+    char *scratch[2];
+    /// Ostatnio zwrócony numer.
+    char *out;
+    /// Długość ostatnio zwróconego numeru.
+    size_t outLength;
+    /// Czy kursor zwrócił już jakiś numer.
+    bool hasOut;
+};
+
+/**
+ * @brief Zapisuje do bufora kandydata wierzchołka źródłowego.
+ *
+ * @param[in] cursor - kursor;
+ * @param[in] stream - strumień, do którego należy wierzchołek;
+ * @param[in] fwdFrom - wierzchołek źródłowy;
+ * @param[out] buffer - bufor wynikowy.
+ * @return Długość kandydata.
+ */
+static size_t buildCandidate(PhfwdReverseCursor const *cursor,
+                             ReverseStream const *stream,
+                             Node const *fwdFrom, char *buffer) {
+    size_t fwdLength = nodeWrite(fwdFrom, buffer);
+    size_t suffixLength = cursor->length - stream->prefixLength;
+
+    memcpy(buffer + fwdLength, cursor->num + stream->prefixLength,
+           suffixLength);
+
+    return fwdLength + suffixLength;
+}
+
+/**
+ * @brief Wyznacza najmniejszego kandydata wśród oczekujących wierzchołków.
+ *
+ * Kandydat zostaje zapisany w buforze @p cursor->scratch[0].
+ *
+ * @param[in, out] cursor - kursor;
+ * @param[in] stream - strumień z niepustą listą oczekujących;
+ * @param[out] length - długość kandydata.
+ * @return Indeks wierzchołka z najmniejszym kandydatem.
+ */
+static size_t pendingMin(PhfwdReverseCursor *cursor,
+                         ReverseStream const *stream, size_t *length) {
+    size_t best = 0;
+    size_t bestLength = buildCandidate(cursor, stream, stream->pending[0],
+                                       cursor->scratch[0]);
+
+    for (size_t i = 1; i < stream->pendingCount; ++i) {
+        size_t candidateLength = buildCandidate(cursor, stream,
+                                                stream->pending[i],
+                                                cursor->scratch[1]);
+
+        if (compareNumbers(cursor->scratch[1], candidateLength,
+                           cursor->scratch[0], bestLength) < 0) {
+            char *swap = cursor->scratch[0];
+            cursor->scratch[0] = cursor->scratch[1];
+            cursor->scratch[1] = swap;
+
+            best = i;
+            bestLength = candidateLength;
+        }
+    }
+
+    *length = bestLength;
+
+    return best;
+}
+
+/**
+ * @brief Przesuwa strumień do kolejnego kandydata.
+ *
+ * Najmniejszego oczekującego kandydata można wypisać, gdy jest mniejszy
+ * od numeru kolejnego wierzchołka zbioru: wszystkie dalsze elementy zbioru
+ * (i ich kandydaci) są wtedy od niego większe. W przeciwnym wypadku kolejny
+ * wierzchołek dołącza do oczekujących.
+ *
+ * @param[in, out] cursor - kursor;
+ * @param[in, out] stream - przesuwany strumień.
+ */
+static void streamAdvance(PhfwdReverseCursor *cursor, ReverseStream *stream) {
+    // Strumień samego numeru zawiera dokładnie jednego kandydata.
+    if (stream->target == NULL) {
+        stream->hasHead = (stream->next.index == 0);
+        if (stream->hasHead) {
+            memcpy(stream->head, cursor->num, cursor->length);
+            stream->headLength = cursor->length;
+            stream->next.index = 1;
+        }
+
+        return;
+    }
+
+    BackwardSet const *set = stream->target->backwards;
+
+    for (;;) {
+        // Pomijamy nieaktualne przekierowania.
+        Backward const *bwd = bwdSetGet(set, stream->next);
+        while (bwd != NULL && !isBackwardLive(bwd)) {
+            bwdSetNext(set, &stream->next);
+            bwd = bwdSetGet(set, stream->next);
+        }
+
+        Node const *candidate = (bwd != NULL ? bwd->fwdFrom : NULL);
+
+        if (stream->pendingCount > 0) {
+            size_t minLength;
+            size_t minIndex = pendingMin(cursor, stream, &minLength);
+
+            bool emit = (candidate == NULL);
+            if (!emit) {
+                size_t candidateLength = nodeWrite(candidate,
+                                                   cursor->scratch[1]);
+                emit = compareNumbers(cursor->scratch[0], minLength,
+                                      cursor->scratch[1],
+                                      candidateLength) < 0;
+            }
+
+            if (emit) {
+                memcpy(stream->head, cursor->scratch[0], minLength);
+                stream->headLength = minLength;
+                stream->hasHead = true;
+
+                memmove(stream->pending + minIndex,
+                        stream->pending + minIndex + 1,
+                        (stream->pendingCount - minIndex - 1)
+                        * sizeof(Node const *));
+                stream->pendingCount--;
+
+                return;
+            }
+        }
+
+        if (candidate == NULL) {
+            stream->hasHead = false;
+            return;
+        }
+
+        stream->pending[stream->pendingCount++] = candidate;
+        bwdSetNext(set, &stream->next);
+    }
+}
+
+/**
+ * @brief Ustawia strumień tak, by zwracał jedynie kandydatów większych
+ * od zadanego numeru.
+ *
+ * Elementy zbioru nie mniejsze od @p after mają kandydatów nie mniejszych
+ * od @p after, więc strumień zaczyna od pierwszego z nich. Spośród elementów
+ * mniejszych kandydata większego od @p after mogą mieć jedynie właściwe
+ * prefiksy @p after; te trafiają od razu na listę oczekujących.
+ *
+ * @param[in, out] cursor - kursor;
+ * @param[in, out] stream - ustawiany strumień;
+ * @param[in] root - korzeń drzewa;
+ * @param[in] after - numer, po którym zaczyna się wynik;
+ * @param[in] afterLength - długość numeru @p after.
+ */
+static void streamSeek(PhfwdReverseCursor *cursor, ReverseStream *stream,
+                       Node const *root, char const *after,
+                       size_t afterLength) {
+    if (stream->target == NULL) {
+        if (compareNumbers(cursor->num, cursor->length,
+                           after, afterLength) <= 0) {
+            stream->next.index = 1;
+        }
+
+        return;
+    }
+
+    stream->next = bwdSetSeek(stream->target->backwards, after, afterLength,
+                              cursor->scratch[0]);
+
+    Node const *node = root;
+    for (size_t i = 0; i + 1 < afterLength; ++i) {
+        node = node->children[toInt(after[i])];
+        if (node == NULL) {
+            break;
+        }
+
+        Backward bwd = {(Node *) node, node->fwdTime};
+        if (node->fwd != stream->target || !isBackwardLive(&bwd)) {
+            continue;
+        }
+
+        size_t candidateLength = buildCandidate(cursor, stream, node,
+                                                cursor->scratch[0]);
+        if (compareNumbers(cursor->scratch[0], candidateLength,
+                           after, afterLength) > 0) {
+            stream->pending[stream->pendingCount++] = node;
+        }
+    }
+}
+
+/**
+ * @brief Otwiera kursor zwracający numery większe od zadanego.
+ *
+ * Kursor wraz ze wszystkimi buforami zajmuje jeden blok pamięci:
+ * struktura kursora, tablica strumieni, listy oczekujących wierzchołków,
+ * a na końcu bufory napisów (kopia numeru, dwa bufory robocze,
+ * ostatni wynik i najmniejsi kandydaci kolejnych strumieni).
+ * Ostatni wynik jest początkowo równy @p after, dzięki czemu pomijanie
+ * powtórzeń pomija również sam numer @p after.
+ *
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania;
+ * @param[in] num - numer;
+ * @param[in] after - numer, po którym zaczyna się wynik
+ *                    (NULL oznacza początek wyniku).
+ * @return Wskaźnik na kursor lub NULL, gdy nie udało się alokować pamięci
+ *         lub @p pf ma wartość NULL.
+ */
+static PhfwdReverseCursor *reverseOpen(PhoneForward const *pf,
+                                       char const *num, char const *after) {
+    if (pf == NULL) {
+        return NULL;
+    }
+
+    size_t length = (ifNumOk(num) ? stringLength(num) : 0);
+    size_t afterLength = 0;
+    if (after != NULL) {
+        if (ifNumOk(after)) {
+            afterLength = stringLength(after);
+        }
+        else {
+            length = 0;
+        }
+    }
+
+    // Strumień samego numeru i strumienie prefiksów,
+    // na które istnieją przekierowania.
+    size_t streamCount = (length > 0 ? 1 : 0);
+    Node const *node = pf->rootNode;
+    for (size_t i = 0; i < length; ++i) {
+        node = node->children[toInt(num[i])];
+        if (node == NULL) {
+            break;
+        }
+
+        if (node->backwards != NULL) {
+            streamCount++;
+        }
+    }
+
+    size_t bufferSize = max(pf->maxFwdDepth + length, afterLength) + 1;
+    size_t pendingSize = pf->maxFwdDepth + 1;
+    size_t size = sizeof(PhfwdReverseCursor)
+                  + streamCount * (sizeof(ReverseStream)
+                                   + pendingSize * sizeof(Node const *)
+                                   + bufferSize)
+                  + 4 * bufferSize;
+
+    char *block = memAlloc(pf->alloc, size);
+    if (block == NULL) {
+        return NULL;
+    }
+
+    PhfwdReverseCursor *cursor = (PhfwdReverseCursor *) block;
+    ReverseStream *streams = (ReverseStream *) (cursor + 1);
+    Node const **pending = (Node const **) (streams + streamCount);
+    char *buffers = (char *) (pending + streamCount * pendingSize);
+
+    cursor->alloc = pf->alloc;
+    cursor->length = length;
+    cursor->streams = streams;
+    cursor->streamCount = streamCount;
+    cursor->outLength = afterLength;
+    cursor->hasOut = (afterLength > 0);
+
+    cursor->num = buffers;
+    cursor->scratch[0] = buffers + bufferSize;
+    cursor->scratch[1] = buffers + 2 * bufferSize;
+    cursor->out = buffers + 3 * bufferSize;
+    buffers += 4 * bufferSize;
+
+    if (length > 0) {
+        memcpy(cursor->num, num, length);
+    }
+
+    if (afterLength > 0) {
+        memcpy(cursor->out, after, afterLength);
+    }
+
+    node = pf->rootNode;
+    for (size_t i = 0; i < streamCount; ++i) {
+        ReverseStream *stream = &streams[i];
+
+        // Pierwszy strumień zawiera sam numer,
+        // kolejne odpowiadają coraz dłuższym prefiksom.
+        if (i == 0) {
+            stream->target = NULL;
+            stream->prefixLength = length;
+        }
+        else {
+            do {
+                node = node->children[toInt(num[node->depth])];
+            } while (node->backwards == NULL);
+
+            stream->target = node;
+            stream->prefixLength = node->depth;
+        }
+
+        stream->next.block = 0;
+        stream->next.index = 0;
+        stream->pending = pending + i * pendingSize;
+        stream->pendingCount = 0;
+        stream->head = buffers + i * bufferSize;
+        stream->headLength = 0;
+
+        if (afterLength > 0) {
+            streamSeek(cursor, stream, pf->rootNode, after, afterLength);
+        }
+
+        streamAdvance(cursor, stream);
+    }
+
+    return cursor;
+}
+
+extern PhfwdReverseCursor *phfwdReverseOpen(PhoneForward const *pf,
+                                            char const *num) {
+    return reverseOpen(pf, num, NULL);
+}
+
+extern PhfwdReverseCursor *phfwdReverseOpenAfter(PhoneForward const *pf,
+                                                 char const *num,
+                                                 char const *after) {
+    return reverseOpen(pf, num, after);
+}
+
+/*
+ * Wybieramy strumień z najmniejszym kandydatem; kandydat równy ostatnio
+ * zwróconemu numerowi jest powtórzeniem i zostaje pominięty.
+ */
+extern char const *phfwdReverseNext(PhfwdReverseCursor *cursor) {
+    if (cursor == NULL) {
+        return NULL;
+    }
+
+    for (;;) {
+        ReverseStream *best = NULL;
+
+        for (size_t i = 0; i < cursor->streamCount; ++i) {
+            ReverseStream *stream = &cursor->streams[i];
+
+            if (stream->hasHead
+                && (best == NULL
+                    || compareNumbers(stream->head, stream->headLength,
+                                      best->head, best->headLength) < 0)) {
+                best = stream;
+            }
+        }
+
+        if (best == NULL) {
+            return NULL;
+        }
+
+        bool duplicate = cursor->hasOut
+                         && compareNumbers(best->head, best->headLength,
+                                           cursor->out,
+                                           cursor->outLength) == 0;
+        if (!duplicate) {
+            memcpy(cursor->out, best->head, best->headLength);
+            cursor->out[best->headLength] = '\0';
+            cursor->outLength = best->headLength;
+            cursor->hasOut = true;
+        }
+
+        streamAdvance(cursor, best);
+
+        if (!duplicate) {
+            return cursor->out;
+        }
+    }
+}
+
+extern void phfwdReverseClose(PhfwdReverseCursor *cursor) {
+    if (cursor != NULL) {
+        memFree(cursor->alloc, cursor);
+    }
+}
+
+/**
+ * @brief Sprawdza, czy wszystkie przekierowania zbioru są na pewno aktualne.
+ *
+ * Tak jest, jeśli najstarsze przekierowanie zbioru zostało dodane
+ * po ostatnim usunięciu przekierowań ze struktury.
+ *
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania;
+ * @param[in] set - zbiór przekierowań wstecz.
+ * @return Wartość @p true jeśli wszystkie przekierowania są aktualne,
+ *         wartość @p false jeśli trzeba je sprawdzić pojedynczo.
+ */
+static bool bwdSetAllLive(PhoneForward const *pf, BackwardSet const *set) {
+    return set->oldestTime > pf->lastRemoveTime;
+}
+
+/**
+ * @brief Sprawdza, czy kandydat źródła pewnego prefiksu powtarza
+ * kandydata krótszego prefiksu.
+ *
+ * Kandydat @p fwdFrom z prefiksu @p target jest równy kandydatowi
+ * wierzchołka @p y z krótszego prefiksu @p p wtedy i tylko wtedy, gdy
+ * @p fwdFrom to @p y z dopisanymi cyframi numeru leżącymi między końcami
+ * obu prefiksów.
+ *
+ * @param[in] root - korzeń drzewa;
+ * @param[in] fwdFrom - aktualne źródło przekierowania na @p target;
+ * @param[in] target - wierzchołek prefiksu numeru;
+ * @param[in] num - numer.
+ * @return Wartość @p true jeśli kandydat już został policzony,
+ *         wartość @p false w przeciwnym wypadku.
+ */
+static bool isCountedBefore(Node const *root, Node const *fwdFrom,
+                            Node const *target, char const *num) {
+    Node const *prefix = root;
+
+    for (size_t i = 0; i + 1 < target->depth; ++i) {
+        prefix = prefix->children[toInt(num[i])];
+        if (prefix->backwards == NULL) {
+            continue;
+        }
+
+        // Odcinamy od źródła cyfry num[prefix->depth .. target->depth).
+        size_t cut = target->depth - prefix->depth;
+        if (fwdFrom->depth <= cut) {
+            continue;
+        }
+
+        Node const *shorter = fwdFrom;
+        size_t j = target->depth;
+        while (j > prefix->depth && shorter->digit == num[j - 1]) {
+            shorter = shorter->father;
+            j--;
+        }
+
+        if (j > prefix->depth) {
+            continue;
+        }
+
+        Backward bwd = {(Node *) shorter, shorter->fwdTime};
+        if (shorter->fwd == prefix && isBackwardLive(&bwd)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Numer zawsze należy do wyniku i nie może powtarzać żadnego kandydata
+ * (wymagałoby to przekierowania prefiksu na samego siebie). Kandydatów
+ * najkrótszego prefiksu liczymy bez sprawdzania powtórzeń, a jeśli żadne
+ * usunięcie nie mogło ich unieważnić, wprost z liczności zbioru.
+ */
+extern size_t phfwdReverseCount(PhoneForward const *pf, char const *num) {
+    if (pf == NULL || !ifNumOk(num)) {
+        return 0;
+    }
+
+    size_t length = stringLength(num);
+    size_t count = 1;
+    bool first = true;
+    Node const *node = pf->rootNode;
+
+    for (size_t i = 0; i < length; ++i) {
+        node = node->children[toInt(num[i])];
+        if (node == NULL) {
+            break;
+        }
+
+        BackwardSet const *set = node->backwards;
+        if (set == NULL) {
+            continue;
+        }
+
+        if (first && bwdSetAllLive(pf, set)) {
+            count += set->count;
+        }
+        else {
+            for (size_t b = 0; b < set->blockCount; ++b) {
+                BackwardBlock const *block = set->blocks[b];
+
+                for (size_t j = 0; j < block->count; ++j) {
+                    Backward const *bwd = &block->items[j];
+
+                    if (isBackwardLive(bwd)
+                        && (first || !isCountedBefore(pf->rootNode,
+                                                      bwd->fwdFrom,
+                                                      node, num))) {
+                        count++;
+                    }
+                }
+            }
+        }
+
+        first = false;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Sprawdza, czy na trasie w dół od wierzchołka istnieje aktualne
+ * przekierowanie.
+ *
+ * @param[in] node - wierzchołek początkowy (jego przekierowanie
+ *                   nie jest sprawdzane);
+ * @param[in] maxDelete - największy czas wyczyszczenia wśród przodków
+ *                        @p node (łącznie z nim samym);
+ * @param[in] suffix - cyfry wyznaczające trasę;
+ * @param[in] length - długość trasy.
+ * @return Wartość @p true jeśli istnieje aktualne przekierowanie z wierzchołka
+ *         na trasie, wartość @p false w przeciwnym wypadku.
+ */
+static bool hasLiveFwdBelow(Node const *node, size_t maxDelete,
+                            char const *suffix, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        if (node->fwdDepthBelow <= node->depth) {
+            return false;
+        }
+
+        node = node->children[toInt(suffix[i])];
+        if (node == NULL) {
+            return false;
+        }
+
+        maxDelete = max(maxDelete, node->deleteTime);
+        if (node->fwd != NULL && node->fwdTime > maxDelete) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Kandydat x z dopisanym sufiksem należy do wyniku phfwdGetReverse wtedy
+ * i tylko wtedy, gdy przekierowanie z x jest aktualne i żaden dłuższy
+ * prefiks kandydata nie ma aktualnego przekierowania. Ten sam napis może
+ * pochodzić z kilku prefiksów, ale warunek spełnia co najwyżej jedno
+ * z jego źródeł, więc powtórzeń nie trzeba wykrywać.
+ */
+extern size_t phfwdGetReverseCount(PhoneForward const *pf, char const *num) {
+    if (pf == NULL || !ifNumOk(num)) {
+        return 0;
+    }
+
+    size_t length = stringLength(num);
+    size_t count = (hasLiveFwdBelow(pf->rootNode, pf->rootNode->deleteTime,
+                                    num, length) ? 0 : 1);
+    Node const *node = pf->rootNode;
+
+    for (size_t i = 0; i < length; ++i) {
+        node = node->children[toInt(num[i])];
+        if (node == NULL) {
+            break;
+        }
+
+        BackwardSet const *set = node->backwards;
+        for (size_t b = 0; set != NULL && b < set->blockCount; ++b) {
+            BackwardBlock const *block = set->blocks[b];
+
+            for (size_t j = 0; j < block->count; ++j) {
+                Backward const *bwd = &block->items[j];
+                if (bwd->fwdTime < bwd->fwdFrom->fwdTime) {
+                    continue;
+                }
+
+                size_t maxDelete = 0;
+                for (Node const *up = bwd->fwdFrom; up != NULL;
+                     up = up->father) {
+                    maxDelete = max(maxDelete, up->deleteTime);
+                }
+
+                if (bwd->fwdTime > maxDelete
+                    && !hasLiveFwdBelow(bwd->fwdFrom, maxDelete,
+                                        num + node->depth,
+                                        length - node->depth)) {
+                    count++;
+                }
+            }
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,162 @@
+/** @file server_protocol.h
+ * Binarny protokół serwera przekierowań (phone_forward_server) oraz
+ * bufory wspólne dla serwera i generatora obciążenia.
+ *
+ * Żądanie to ramka: rozmiar reszty ramki (u32), operacja (u8),
+ * identyfikator żądania (u32) i argumenty operacji - jeden numer, a dla
+ * @ref PROTO_ADD dwa numery. Odpowiedź to ramka: rozmiar reszty ramki (u32),
+ * identyfikator żądania (u32), status (u8), liczba numerów (u32) i numery.
+ * Numer zapisany jest jako długość (u16) i znaki numeru; na żądanie, którego
+ * wynik zawiera dłuższy numer, serwer odpowiada statusem @ref PROTO_ERROR
+ * bez numerów. Liczby zapisane są w kolejności little-endian. Klient może
+ * wysyłać kolejne żądania, nie czekając na odpowiedzi; odpowiedzi na żądania
+ * jednego połączenia przychodzą w kolejności żądań.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __SERVER_PROTOCOL_H__
+#define __SERVER_PROTOCOL_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// Operacja phfwdGet.
+#define PROTO_GET 1
+/// Operacja phfwdReverse.
+#define PROTO_REVERSE 2
+/// Operacja phfwdGetReverse.
+#define PROTO_GETREVERSE 3
+/// Operacja phfwdAdd.
+#define PROTO_ADD 4
+/// Operacja phfwdRemove.
+#define PROTO_DEL 5
+
+/// Status wykonanej operacji.
+#define PROTO_OK 0
+/// Status niepoprawnego żądania lub nieudanej operacji.
+#define PROTO_ERROR 1
+
+/// Rozmiar nagłówka żądania (bez pola rozmiaru).
+#define PROTO_REQUEST_HEADER 5
+/// Rozmiar nagłówka odpowiedzi (bez pola rozmiaru).
+#define PROTO_RESPONSE_HEADER 9
+/// Największy rozmiar żądania (bez pola rozmiaru).
+#define PROTO_MAX_REQUEST (1 << 20)
+
+/**
+ * @brief Zapisuje liczbę 16-bitową.
+ *
+ * @param[out] out - bufor;
+ * @param[in] value - liczba.
+ */
+static inline void protoPut16(uint8_t *out, uint16_t value) {
+    out[0] = (uint8_t) value;
+    out[1] = (uint8_t) (value >> 8);
+}
+
+/**
+ * @brief Zapisuje liczbę 32-bitową.
+ *
+ * @param[out] out - bufor;
+ * @param[in] value - liczba.
+ */
+static inline void protoPut32(uint8_t *out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = (uint8_t) (value >> (8 * i));
+    }
+}
+
+/**
+ * @brief Odczytuje liczbę 16-bitową.
+ *
+ * @param[in] in - bufor.
+ * @return Odczytana liczba.
+ */
+static inline uint16_t protoGet16(uint8_t const *in) {
+    return (uint16_t) (in[0] | (in[1] << 8));
+}
+
+/**
+ * @brief Odczytuje liczbę 32-bitową.
+ *
+ * @param[in] in - bufor.
+ * @return Odczytana liczba.
+ */
+static inline uint32_t protoGet32(uint8_t const *in) {
+    uint32_t value = 0;
+
+    for (int i = 0; i < 4; ++i) {
+        value |= (uint32_t) in[i] << (8 * i);
+    }
+
+    return value;
+}
+
+/**
+ * @brief Bufor bajtów z pozycją odczytu.
+ */
+typedef struct ProtoBuffer {
+    /// Dane.
+    uint8_t *data;
+    /// Liczba zapisanych bajtów.
+    size_t size;
+    /// Rozmiar zaalokowanej pamięci.
+    size_t capacity;
+    /// Liczba bajtów już odczytanych (lub wysłanych).
+    size_t offset;
+} ProtoBuffer;
+
+/**
+ * @brief Zapewnia w buforze miejsce na kolejne bajty.
+ *
+ * Przy braku miejsca odczytane bajty są najpierw usuwane z bufora.
+ *
+ * @param[in, out] buffer - bufor;
+ * @param[in] extra - liczba bajtów.
+ * @return Wskaźnik na miejsce na bajty lub NULL, gdy nie udało się alokować
+ *         pamięci.
+ */
+static inline uint8_t *protoReserve(ProtoBuffer *buffer, size_t extra) {
+    if (buffer->size + extra > buffer->capacity && buffer->offset > 0) {
+        memmove(buffer->data, buffer->data + buffer->offset,
+                buffer->size - buffer->offset);
+        buffer->size -= buffer->offset;
+        buffer->offset = 0;
+    }
+
+    if (buffer->size + extra > buffer->capacity) {
+        size_t capacity = (buffer->capacity == 0 ? 4096 : buffer->capacity);
+
+        while (capacity < buffer->size + extra) {
+            capacity *= 2;
+        }
+
+        uint8_t *data = realloc(buffer->data, capacity);
+        if (data == NULL) {
+            return NULL;
+        }
+
+        buffer->data = data;
+        buffer->capacity = capacity;
+    }
+
+    return buffer->data + buffer->size;
+}
+
+/**
+ * @brief Zwalnia pamięć bufora.
+ *
+ * @param[in, out] buffer - bufor.
+ */
+static inline void protoFree(ProtoBuffer *buffer) {
+    free(buffer->data);
+    memset(buffer, 0, sizeof(ProtoBuffer));
+}
+
+#endif /* __SERVER_PROTOCOL_H__ */
@@ -0,0 +1,245 @@
+/** @file sharded.c
+ * Implementacja struktury przekierowań podzielonej na części według
+ * pierwszej cyfry numeru.
+ *
+ * Wszystkie numery, których dotyczą funkcje phfwdGet i phfwdRemove, oraz
+ * wszystkie przekierowania, które mogą się do nich stosować, mają tę samą
+ * pierwszą cyfrę, więc te funkcje korzystają z jednej części. Przekierowanie
+ * wstecz zapisywane jest w drzewie części numeru przekierowywanego, więc
+ * dodanie przekierowania nigdy nie modyfikuje innej części, a czasy
+ * usunięć porównywane są jedynie w obrębie jednej części. Numery wyniku
+ * phfwdReverse z części danej cyfry zaczynają się tą cyfrą (poza samym
+ * zadanym numerem), więc wyniki kolejnych części wystarczy skleić.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "phone_forward.h"
+#include "phone_forward_sharded.h"
+#include "allocator.h"
+#include "phnum.h"
+#include "utils.h"
+
+/// Liczba części (możliwych pierwszych cyfr numeru).
+#define SHARD_COUNT 12
+
+/**
+ * @brief Część struktury wraz z blokadą.
+ *
+ * Części wyrównane są do rozmiaru linii pamięci podręcznej, żeby blokady
+ * różnych części nie współdzieliły linii.
+ */
+typedef struct Shard {
+    /// Blokada czytelników i pisarzy części.
+    _Alignas(64) pthread_rwlock_t lock;
+    /// Przekierowania z numerów o pierwszej cyfrze części.
+    PhoneForward *pf;
+} Shard;
+
+/**
+ * @brief Struktura przekierowań podzielona na części.
+ */
+struct PhfwdSharded {
+    /// Części indeksowane pierwszą cyfrą numeru.
+    Shard shards[SHARD_COUNT];
+};
+
+/**
+ * @brief Wyznacza część numeru.
+ *
+ * @param[in] sharded - struktura;
+ * @param[in] num - numer.
+ * @return Część pierwszej cyfry numeru; dla napisu niebędącego numerem
+ *         dowolna część (funkcje części obsługują go same).
+ */
+static Shard *shardOf(PhfwdSharded *sharded, char const *num) {
+    if (!ifNumOk(num)) {
+        return &sharded->shards[0];
+    }
+
+    return &sharded->shards[toInt(num[0])];
+}
+
+/*
+ * Części tworzone są z domyślnym alokatorem, który jest bezpieczny wątkowo.
+ */
+extern PhfwdSharded *phfwdShardedNew(void) {
+    PhfwdSharded *sharded = aligned_alloc(_Alignof(PhfwdSharded),
+                                          sizeof(PhfwdSharded));
+    if (sharded == NULL) {
+        return NULL;
+    }
+
+    for (int i = 0; i < SHARD_COUNT; ++i) {
+        sharded->shards[i].pf = phfwdNew();
+
+        if (sharded->shards[i].pf == NULL) {
+            while (i-- > 0) {
+                pthread_rwlock_destroy(&sharded->shards[i].lock);
+                phfwdDelete(sharded->shards[i].pf);
+            }
+            free(sharded);
+            return NULL;
+        }
+
+        pthread_rwlock_init(&sharded->shards[i].lock, NULL);
+    }
+
+    return sharded;
+}
+
+/*
+ * Usuwa wszystkie części wraz z blokadami.
+ */
+extern void phfwdShardedDelete(PhfwdSharded *sharded) {
+    if (sharded == NULL) {
+        return;
+    }
+
+    for (int i = 0; i < SHARD_COUNT; ++i) {
+        pthread_rwlock_destroy(&sharded->shards[i].lock);
+        phfwdDelete(sharded->shards[i].pf);
+    }
+
+    free(sharded);
+}
+
+/*
+ * Przekierowanie wraz z wpisem przekierowania wstecz trafia do części
+ * pierwszej cyfry num1, nawet jeśli num2 zaczyna się inną cyfrą.
+ */
+extern bool phfwdShardedAdd(PhfwdSharded *sharded, char const *num1,
+                            char const *num2) {
+    if (sharded == NULL) {
+        return false;
+    }
+
+    Shard *shard = shardOf(sharded, num1);
+
+    pthread_rwlock_wrlock(&shard->lock);
+    bool result = phfwdAdd(shard->pf, num1, num2);
+    pthread_rwlock_unlock(&shard->lock);
+
+    return result;
+}
+
+/*
+ * Wszystkie usuwane przekierowania zaczynają się pierwszą cyfrą num.
+ */
+extern void phfwdShardedRemove(PhfwdSharded *sharded, char const *num) {
+    if (sharded == NULL) {
+        return;
+    }
+
+    Shard *shard = shardOf(sharded, num);
+
+    pthread_rwlock_wrlock(&shard->lock);
+    phfwdRemove(shard->pf, num);
+    pthread_rwlock_unlock(&shard->lock);
+}
+
+/*
+ * Wszystkie przekierowania, które mogą się stosować do num, są w części
+ * jego pierwszej cyfry.
+ */
+extern PhoneNumbers *phfwdShardedGet(PhfwdSharded *sharded,
+                                     char const *num) {
+    if (sharded == NULL) {
+        return NULL;
+    }
+
+    Shard *shard = shardOf(sharded, num);
+
+    pthread_rwlock_rdlock(&shard->lock);
+    PhoneNumbers *result = phfwdGet(shard->pf, num);
+    pthread_rwlock_unlock(&shard->lock);
+
+    return result;
+}
+
+/**
+ * @brief Skleja wyniki funkcji przekierowań wstecz ze wszystkich części.
+ *
+ * Z wyniku części zachowywane są jedynie numery zaczynające się jej cyfrą:
+ * pozostałe to zadany numer, o którym rozstrzyga część jego pierwszej
+ * cyfry.
+ *
+ * @param[in] sharded - struktura;
+ * @param[in] num - numer;
+ * @param[in] function - funkcja przekierowań wstecz.
+ * @return Posortowany wynik lub NULL, gdy nie udało się alokować pamięci.
+ */
+static PhoneNumbers *collectShards(PhfwdSharded *sharded, char const *num,
+                                   PhoneNumbers *(*function)(
+                                       PhoneForward const *, char const *)) {
+    if (!ifNumOk(num)) {
+        return phnumNew(&phfwdSystemAllocator);
+    }
+
+    PhoneNumbers *result = phnumNew(&phfwdSystemAllocator);
+    bool ok = (result != NULL);
+
+    for (int i = 0; i < SHARD_COUNT && ok; ++i) {
+        Shard *shard = &sharded->shards[i];
+
+        pthread_rwlock_rdlock(&shard->lock);
+        PhoneNumbers *part = function(shard->pf, num);
+        pthread_rwlock_unlock(&shard->lock);
+
+        ok = (part != NULL);
+
+        char const *found;
+        for (size_t j = 0; ok && (found = phnumGet(part, j)) != NULL; ++j) {
+            if (toInt(found[0]) != i) {
+                continue;
+            }
+
+            char *copy = copyString(&phfwdSystemAllocator, found);
+            ok = (copy != NULL && phnumAdd(result, copy));
+            if (!ok) {
+                memFree(&phfwdSystemAllocator, copy);
+            }
+        }
+
+        phnumDelete(part);
+    }
+
+    if (!ok) {
+        phnumDelete(result);
+        return NULL;
+    }
+
+    return result;
+}
+
+/*
+ * Skleja wyniki phfwdReverse kolejnych części (zob. collectShards).
+ */
+extern PhoneNumbers *phfwdShardedReverse(PhfwdSharded *sharded,
+                                         char const *num) {
+    if (sharded == NULL) {
+        return NULL;
+    }
+
+    return collectShards(sharded, num, phfwdReverse);
+}
+
+/*
+ * Numer x z części jego pierwszej cyfry spełnia phfwdGet(x) = num w całej
+ * strukturze wtedy i tylko wtedy, gdy spełnia to w tej części.
+ */
+extern PhoneNumbers *phfwdShardedGetReverse(PhfwdSharded *sharded,
+                                            char const *num) {
+    if (sharded == NULL) {
+        return NULL;
+    }
+
+    return collectShards(sharded, num, phfwdGetReverse);
+}
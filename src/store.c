@@ -0,0 +1,894 @@
+/** @file store.c
+ * Implementacja magazynu tabel przekierowań ze współdzielonymi poddrzewami.
+ *
+ * Tabela magazynu to niemodyfikowalne drzewo TRIE aktualnych przekierowań:
+ * wierzchołek przechowuje jedynie cel przekierowania ze swojego prefiksu
+ * (jeśli jest) i synów, a puste poddrzewa nie są reprezentowane. Każdy
+ * wierzchołek istnieje w magazynie w jednym egzemplarzu: przed utworzeniem
+ * nowego wierzchołka szukamy w tablicy haszującej identycznego (o tym samym
+ * celu i tych samych synach), więc identyczne poddrzewa różnych tabel
+ * (i jednej tabeli) są jednym poddrzewem. Synowie są już kanoniczni,
+ * dlatego porównanie wierzchołków porównuje jedynie wskaźniki na synów.
+ *
+ * Modyfikacja tabeli nie zmienia żadnego wierzchołka: ścieżka od korzenia
+ * do modyfikowanego prefiksu budowana jest od nowa (ponownie wyszukując
+ * wierzchołki w magazynie), a poddrzewa spoza ścieżki pozostają wspólne.
+ * Wierzchołki zliczają odwołania (synów innych wierzchołków i korzeni
+ * tabel) i są zwalniane, gdy przestają być używane.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "phone_forward.h"
+#include "phone_forward_store.h"
+#include "node.h"
+#include "phnum.h"
+#include "utils.h"
+
+/**
+ * Początkowa liczba kubełków tablicy haszującej.
+ */
+#define STORE_INITIAL_BUCKETS 64
+
+/**
+ * @brief Wierzchołek tabeli magazynu.
+ *
+ * Za wskaźnikami na synów (w kolejności cyfr) zapisany jest cel
+ * przekierowania zakończony znakiem '\0'.
+ */
+typedef struct StoreNode {
+    /// Następny wierzchołek tego samego kubełka tablicy haszującej.
+    struct StoreNode *next;
+    /// Skrót wierzchołka.
+    uint64_t hash;
+    /// Liczba odwołań do wierzchołka.
+    size_t refCount;
+    /// Łączny rozmiar poddrzewa bez współdzielenia (ograniczony do
+    /// SIZE_MAX).
+    size_t expandedBytes;
+    /// Wysokość poddrzewa (0 dla liścia).
+    uint32_t height;
+    /// Długość celu przekierowania (0, jeśli nie ma przekierowania).
+    uint32_t targetLength;
+    /// Maska cyfr synów.
+    uint16_t childMask;
+    /// Synowie wierzchołka.
+    struct StoreNode *children[];
+} StoreNode;
+
+/**
+ * Magazyn tabel przekierowań.
+ */
+struct PhfwdStore {
+    /// Alokator magazynu i zwracanych wyników.
+    PhfwdAllocator const *alloc;
+    /// Kubełki tablicy haszującej wierzchołków.
+    StoreNode **buckets;
+    /// Liczba kubełków (potęga dwójki).
+    size_t bucketCount;
+    /// Liczba wierzchołków.
+    size_t nodeCount;
+    /// Łączny rozmiar wierzchołków.
+    size_t nodeBytes;
+    /// Pierwsza tabela magazynu.
+    PhfwdStoreTable *tables;
+    /// Liczba tabel.
+    size_t tableCount;
+};
+
+/**
+ * Tabela magazynu.
+ */
+struct PhfwdStoreTable {
+    /// Magazyn tabeli.
+    PhfwdStore *store;
+    /// Korzeń drzewa tabeli (NULL dla pustej tabeli).
+    StoreNode *root;
+    /// Poprzednia tabela magazynu.
+    PhfwdStoreTable *prev;
+    /// Następna tabela magazynu.
+    PhfwdStoreTable *next;
+};
+
+/**
+ * @brief Liczba synów wierzchołka.
+ *
+ * @param[in] node - wierzchołek.
+ * @return Liczba synów.
+ */
+static int childCount(StoreNode const *node) {
+    return __builtin_popcount(node->childMask);
+}
+
+/**
+ * @brief Zwraca cel przekierowania wierzchołka.
+ *
+ * @param[in] node - wierzchołek.
+ * @return Cel przekierowania zakończony znakiem '\0' (pusty, jeśli
+ *         z wierzchołka nie ma przekierowania).
+ */
+static char const *nodeTarget(StoreNode const *node) {
+    return (char const *) (node->children + childCount(node));
+}
+
+/**
+ * @brief Przechodzi do syna wierzchołka.
+ *
+ * @param[in] node - wierzchołek (lub NULL);
+ * @param[in] digit - cyfra syna (0-11).
+ * @return Syn lub NULL, jeśli go nie ma.
+ */
+static StoreNode *storeChild(StoreNode const *node, int digit) {
+    if (node == NULL || (node->childMask & (1u << digit)) == 0) {
+        return NULL;
+    }
+
+    return node->children[__builtin_popcount(node->childMask
+                                             & ((1u << digit) - 1))];
+}
+
+/**
+ * @brief Dołącza wartość do skrótu.
+ *
+ * @param[in] hash - dotychczasowy skrót;
+ * @param[in] value - dołączana wartość.
+ * @return Nowy skrót.
+ */
+static uint64_t storeMix(uint64_t hash, uint64_t value) {
+    hash ^= value;
+    hash *= 0x9e3779b97f4a7c15ull;
+    hash ^= hash >> 29;
+
+    return hash;
+}
+
+/**
+ * @brief Dodaje rozmiary z ograniczeniem do SIZE_MAX.
+ *
+ * @param[in] a - pierwszy rozmiar;
+ * @param[in] b - drugi rozmiar.
+ * @return Suma rozmiarów lub SIZE_MAX, jeśli jej nie można przedstawić.
+ */
+static size_t addBytes(size_t a, size_t b) {
+    return (a > SIZE_MAX - b ? SIZE_MAX : a + b);
+}
+
+/**
+ * @brief Usuwa wierzchołek z tablicy haszującej.
+ *
+ * @param[in, out] store - magazyn;
+ * @param[in] node - wierzchołek tablicy.
+ */
+static void storeUnlink(PhfwdStore *store, StoreNode const *node) {
+    StoreNode **link = &store->buckets[node->hash & (store->bucketCount - 1)];
+
+    while (*link != node) {
+        link = &(*link)->next;
+    }
+
+    *link = node->next;
+}
+
+/**
+ * @brief Usuwa odwołanie do wierzchołka.
+ *
+ * Wierzchołki, do których nie ma już odwołań, są usuwane z tablicy
+ * haszującej i zwalniane. Usunięte z tablicy wierzchołki łączone są w listę
+ * przez pole @p next, więc zwalnianie poddrzewa nie wymaga rekurencji.
+ *
+ * @param[in, out] store - magazyn;
+ * @param[in, out] node - wierzchołek (lub NULL).
+ */
+static void storeRelease(PhfwdStore *store, StoreNode *node) {
+    if (node == NULL || --node->refCount > 0) {
+        return;
+    }
+
+    storeUnlink(store, node);
+    node->next = NULL;
+
+    while (node != NULL) {
+        StoreNode *pending = node->next;
+
+        for (int i = 0; i < childCount(node); ++i) {
+            StoreNode *child = node->children[i];
+
+            if (--child->refCount == 0) {
+                storeUnlink(store, child);
+                child->next = pending;
+                pending = child;
+            }
+        }
+
+        store->nodeCount--;
+        store->nodeBytes -= sizeof(StoreNode)
+                            + childCount(node) * sizeof(StoreNode *)
+                            + node->targetLength + 1;
+        memFree(store->alloc, node);
+
+        node = pending;
+    }
+}
+
+/**
+ * @brief Zwalnia odwołania z tablicy synów.
+ *
+ * @param[in, out] store - magazyn;
+ * @param[in, out] children - synowie (12 pozycji, NULL dla braku syna).
+ */
+static void releaseChildren(PhfwdStore *store, StoreNode **children) {
+    for (int i = 0; i < 12; ++i) {
+        storeRelease(store, children[i]);
+        children[i] = NULL;
+    }
+}
+
+/**
+ * @brief Dwukrotnie zwiększa tablicę haszującą.
+ *
+ * Przy braku pamięci tablica pozostaje bez zmian (kubełki są wtedy
+ * jedynie dłuższe).
+ *
+ * @param[in, out] store - magazyn.
+ */
+static void storeGrow(PhfwdStore *store) {
+    size_t count = 2 * store->bucketCount;
+    StoreNode **buckets = memCalloc(store->alloc, count, sizeof(StoreNode *));
+    if (buckets == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < store->bucketCount; ++i) {
+        StoreNode *node = store->buckets[i];
+
+        while (node != NULL) {
+            StoreNode *next = node->next;
+            StoreNode **bucket = &buckets[node->hash & (count - 1)];
+
+            node->next = *bucket;
+            *bucket = node;
+            node = next;
+        }
+    }
+
+    memFree(store->alloc, store->buckets);
+    store->buckets = buckets;
+    store->bucketCount = count;
+}
+
+/**
+ * @brief Wyznacza kanoniczny wierzchołek o danym celu i synach.
+ *
+ * Funkcja przejmuje odwołania do synów: jeśli identyczny wierzchołek już
+ * istnieje, są one zwalniane (ten wierzchołek ma własne), a w przeciwnym
+ * wypadku przechodzą na nowy wierzchołek. Również przy niepowodzeniu
+ * odwołania do synów są zwalniane.
+ *
+ * @param[in, out] store - magazyn;
+ * @param[in] target - cyfry celu przekierowania;
+ * @param[in] targetLength - długość celu (0, jeśli nie ma przekierowania);
+ * @param[in, out] children - synowie (12 pozycji, NULL dla braku syna);
+ * @param[out] result - odwołanie do wierzchołka (NULL dla pustego
+ *                      poddrzewa).
+ * @return Wartość @p true, jeśli operacja się powiodła,
+ *         wartość @p false, gdy nie udało się alokować pamięci.
+ */
+static bool storeIntern(PhfwdStore *store, char const *target,
+                        size_t targetLength, StoreNode **children,
+                        StoreNode **result) {
+    uint16_t mask = 0;
+    uint64_t hash = storeMix(0, targetLength);
+
+    for (size_t i = 0; i < targetLength; ++i) {
+        hash = storeMix(hash, (uint64_t) toInt(target[i]));
+    }
+
+    for (int i = 0; i < 12; ++i) {
+        if (children[i] != NULL) {
+            mask |= (uint16_t) (1u << i);
+            hash = storeMix(hash, (uint64_t) (uintptr_t) children[i]);
+        }
+    }
+
+    *result = NULL;
+    if (mask == 0 && targetLength == 0) {
+        return true;
+    }
+
+    hash = storeMix(hash, mask);
+
+    StoreNode *node = store->buckets[hash & (store->bucketCount - 1)];
+    for (; node != NULL; node = node->next) {
+        if (node->hash != hash || node->childMask != mask
+            || node->targetLength != targetLength
+            || memcmp(nodeTarget(node), target, targetLength) != 0) {
+            continue;
+        }
+
+        bool same = true;
+        for (int i = 0, j = 0; i < 12 && same; ++i) {
+            if (children[i] != NULL) {
+                same = (node->children[j++] == children[i]);
+            }
+        }
+
+        if (same) {
+            node->refCount++;
+            releaseChildren(store, children);
+            *result = node;
+            return true;
+        }
+    }
+
+    int count = __builtin_popcount(mask);
+    size_t size = sizeof(StoreNode) + count * sizeof(StoreNode *)
+                  + targetLength + 1;
+
+    if (targetLength > UINT32_MAX
+        || (node = memAlloc(store->alloc, size)) == NULL) {
+        releaseChildren(store, children);
+        return false;
+    }
+
+    node->hash = hash;
+    node->refCount = 1;
+    node->expandedBytes = size;
+    node->height = 0;
+    node->targetLength = (uint32_t) targetLength;
+    node->childMask = mask;
+
+    for (int i = 0, j = 0; i < 12; ++i) {
+        if (children[i] != NULL) {
+            StoreNode *child = children[i];
+
+            node->children[j++] = child;
+            node->expandedBytes = addBytes(node->expandedBytes,
+                                           child->expandedBytes);
+            if (child->height + 1 > node->height) {
+                node->height = child->height + 1;
+            }
+        }
+    }
+
+    char *digits = (char *) (node->children + count);
+    memcpy(digits, target, targetLength);
+    digits[targetLength] = '\0';
+
+    StoreNode **bucket = &store->buckets[hash & (store->bucketCount - 1)];
+    node->next = *bucket;
+    *bucket = node;
+
+    store->nodeCount++;
+    store->nodeBytes += size;
+    if (store->nodeCount > store->bucketCount) {
+        storeGrow(store);
+    }
+
+    *result = node;
+    return true;
+}
+
+/*
+ * Magazyn korzysta z domyślnego alokatora.
+ */
+extern PhfwdStore *phfwdStoreNew(void) {
+    PhfwdAllocator const *alloc = &phfwdSystemAllocator;
+    PhfwdStore *store = memAlloc(alloc, sizeof(PhfwdStore));
+    if (store == NULL) {
+        return NULL;
+    }
+
+    store->alloc = alloc;
+    store->buckets = memCalloc(alloc, STORE_INITIAL_BUCKETS,
+                               sizeof(StoreNode *));
+    store->bucketCount = STORE_INITIAL_BUCKETS;
+    store->nodeCount = 0;
+    store->nodeBytes = 0;
+    store->tables = NULL;
+    store->tableCount = 0;
+
+    if (store->buckets == NULL) {
+        memFree(alloc, store);
+        return NULL;
+    }
+
+    return store;
+}
+
+/*
+ * Zwolnienie wszystkich tabel zwalnia wszystkie wierzchołki.
+ */
+extern void phfwdStoreDelete(PhfwdStore *store) {
+    if (store == NULL) {
+        return;
+    }
+
+    while (store->tables != NULL) {
+        phfwdStoreRelease(store->tables);
+    }
+
+    memFree(store->alloc, store->buckets);
+    memFree(store->alloc, store);
+}
+
+/**
+ * @brief Tworzy tabelę o danym korzeniu.
+ *
+ * @param[in, out] store - magazyn;
+ * @param[in] root - odwołanie do korzenia (przejmowane przez tabelę; przy
+ *                   niepowodzeniu zwalniane).
+ * @return Wskaźnik na tabelę lub NULL, gdy nie udało się alokować pamięci.
+ */
+static PhfwdStoreTable *tableNew(PhfwdStore *store, StoreNode *root) {
+    PhfwdStoreTable *table = memAlloc(store->alloc, sizeof(PhfwdStoreTable));
+    if (table == NULL) {
+        storeRelease(store, root);
+        return NULL;
+    }
+
+    table->store = store;
+    table->root = root;
+    table->prev = NULL;
+    table->next = store->tables;
+
+    if (store->tables != NULL) {
+        store->tables->prev = table;
+    }
+
+    store->tables = table;
+    store->tableCount++;
+
+    return table;
+}
+
+/**
+ * @brief Stan przejścia drzewa struktury w funkcji phfwdStoreImport.
+ */
+typedef struct ImportFrame {
+    /// Wierzchołek struktury.
+    Node const *node;
+    /// Największy czas wyczyszczenia wśród wierzchołka i jego przodków.
+    size_t maxDelete;
+    /// Kolejna cyfra syna do odwiedzenia.
+    int nextDigit;
+    /// Kanoniczne poddrzewa odwiedzonych już synów.
+    StoreNode *children[12];
+} ImportFrame;
+
+/**
+ * @brief Zapisuje cel aktualnego przekierowania wierzchołka.
+ *
+ * @param[in] alloc - alokator;
+ * @param[in] frame - stan przejścia wierzchołka;
+ * @param[in, out] buffer - bufor (powiększany w razie potrzeby);
+ * @param[in, out] capacity - rozmiar bufora.
+ * @return Długość celu (0, jeśli przekierowanie nie jest aktualne)
+ *         lub SIZE_MAX, gdy nie udało się alokować pamięci.
+ */
+static size_t importTarget(PhfwdAllocator const *alloc,
+                           ImportFrame const *frame,
+                           char **buffer, size_t *capacity) {
+    Node const *node = frame->node;
+
+    if (node->fwd == NULL || node->fwdTime <= frame->maxDelete) {
+        return 0;
+    }
+
+    if (node->fwd->depth > *capacity) {
+        char *larger = memRealloc(alloc, *buffer, node->fwd->depth);
+        if (larger == NULL) {
+            return SIZE_MAX;
+        }
+
+        *buffer = larger;
+        *capacity = node->fwd->depth;
+    }
+
+    return nodeWrite(node->fwd, *buffer);
+}
+
+/*
+ * Drzewo struktury przechodzimy w porządku postorder, pomijając poddrzewa
+ * bez aktualnych przekierowań (zob. fwdDepthBelow); wierzchołek tabeli
+ * powstaje po kanonicznych wierzchołkach wszystkich swoich synów.
+ * Wierzchołki z aktualnymi przekierowaniami nie są głębsze niż
+ * maxFwdDepth, więc tyle wynosi największa głębokość stosu.
+ */
+extern PhfwdStoreTable *phfwdStoreImport(PhfwdStore *store,
+                                         PhoneForward const *pf) {
+    if (store == NULL || pf == NULL) {
+        return NULL;
+    }
+
+    PhfwdAllocator const *alloc = store->alloc;
+    ImportFrame *frames = memAlloc(alloc, (pf->maxFwdDepth + 1)
+                                          * sizeof(ImportFrame));
+    if (frames == NULL) {
+        return NULL;
+    }
+
+    char *buffer = NULL;
+    size_t capacity = 0;
+    StoreNode *root = NULL;
+    size_t top = 0;
+    bool ok = true;
+
+    frames[0] = (ImportFrame) {pf->rootNode, pf->rootNode->deleteTime, 0,
+                               {NULL}};
+
+    for (;;) {
+        ImportFrame *frame = &frames[top];
+        Node const *child = NULL;
+
+        while (child == NULL && frame->nextDigit < 12) {
+            child = frame->node->children[frame->nextDigit++];
+            if (child != NULL && child->fwdDepthBelow == 0) {
+                child = NULL;
+            }
+        }
+
+        if (child != NULL) {
+            frames[++top] = (ImportFrame) {
+                child, max(frame->maxDelete, child->deleteTime), 0, {NULL}
+            };
+            continue;
+        }
+
+        StoreNode *result = NULL;
+        size_t length = importTarget(alloc, frame, &buffer, &capacity);
+
+        if (length == SIZE_MAX) {
+            releaseChildren(store, frame->children);
+            ok = false;
+        }
+        else {
+            ok = storeIntern(store, buffer, length, frame->children, &result);
+        }
+
+        if (!ok) {
+            break;
+        }
+
+        if (top == 0) {
+            root = result;
+            break;
+        }
+
+        frames[top - 1].children[toInt(frame->node->digit)] = result;
+        top--;
+    }
+
+    if (!ok) {
+        while (top-- > 0) {
+            releaseChildren(store, frames[top].children);
+        }
+    }
+
+    memFree(alloc, buffer);
+    memFree(alloc, frames);
+
+    return (ok ? tableNew(store, root) : NULL);
+}
+
+/*
+ * Kopia współdzieli z tabelą całe drzewo.
+ */
+extern PhfwdStoreTable *phfwdStoreCopy(PhfwdStoreTable const *table) {
+    if (table == NULL) {
+        return NULL;
+    }
+
+    if (table->root != NULL) {
+        table->root->refCount++;
+    }
+
+    return tableNew(table->store, table->root);
+}
+
+/*
+ * Wierzchołki przestające być używane są zwalniane.
+ */
+extern void phfwdStoreRelease(PhfwdStoreTable *table) {
+    if (table == NULL) {
+        return;
+    }
+
+    PhfwdStore *store = table->store;
+
+    storeRelease(store, table->root);
+
+    if (table->prev != NULL) {
+        table->prev->next = table->next;
+    }
+    else {
+        store->tables = table->next;
+    }
+
+    if (table->next != NULL) {
+        table->next->prev = table->prev;
+    }
+
+    store->tableCount--;
+    memFree(store->alloc, table);
+}
+
+/**
+ * @brief Zastępuje poddrzewo tabeli, budując od nowa ścieżkę od korzenia.
+ *
+ * @param[in, out] table - tabela;
+ * @param[in] path - dotychczasowe wierzchołki ścieżki na głębokościach
+ *                   od 0 do @p length - 1 (NULL, jeśli ich nie ma);
+ * @param[in] num - numer ścieżki;
+ * @param[in] length - długość numeru;
+ * @param[in] bottom - odwołanie do nowego poddrzewa numeru (przejmowane).
+ * @return Wartość @p true, jeśli operacja się powiodła,
+ *         wartość @p false, gdy nie udało się alokować pamięci (tabela
+ *         pozostaje wtedy bez zmian).
+ */
+static bool tableRebuild(PhfwdStoreTable *table, StoreNode **path,
+                         char const *num, size_t length, StoreNode *bottom) {
+    PhfwdStore *store = table->store;
+    StoreNode *current = bottom;
+
+    for (size_t depth = length; depth-- > 0;) {
+        StoreNode const *old = path[depth];
+        StoreNode *children[12] = {NULL};
+        int digit = toInt(num[depth]);
+
+        for (int i = 0; i < 12; ++i) {
+            children[i] = (i == digit ? current : storeChild(old, i));
+            if (i != digit && children[i] != NULL) {
+                children[i]->refCount++;
+            }
+        }
+
+        char const *target = (old == NULL ? "" : nodeTarget(old));
+        size_t targetLength = (old == NULL ? 0 : old->targetLength);
+
+        if (!storeIntern(store, target, targetLength, children, &current)) {
+            return false;
+        }
+    }
+
+    storeRelease(store, table->root);
+    table->root = current;
+
+    return true;
+}
+
+/**
+ * @brief Zapisuje ścieżkę numeru w tabeli.
+ *
+ * @param[in] table - tabela;
+ * @param[in] num - numer;
+ * @param[in] length - długość numeru;
+ * @param[out] path - wierzchołki na głębokościach od 0 do @p length - 1.
+ * @return Wierzchołek numeru lub NULL, jeśli go nie ma.
+ */
+static StoreNode *tablePath(PhfwdStoreTable const *table, char const *num,
+                            size_t length, StoreNode **path) {
+    StoreNode *node = table->root;
+
+    for (size_t i = 0; i < length; ++i) {
+        path[i] = node;
+        node = storeChild(node, toInt(num[i]));
+    }
+
+    return node;
+}
+
+/*
+ * Nowy wierzchołek num1 ma synów dotychczasowego wierzchołka num1,
+ * a wierzchołki ścieżki powyżej niego są tworzone od nowa.
+ */
+extern bool phfwdStoreAdd(PhfwdStoreTable *table, char const *num1,
+                          char const *num2) {
+    if (table == NULL || !ifNumOk(num1) || !ifNumOk(num2)
+        || strcmp(num1, num2) == 0) {
+        return false;
+    }
+
+    PhfwdStore *store = table->store;
+    size_t length = stringLength(num1);
+    StoreNode **path = memAlloc(store->alloc, length * sizeof(StoreNode *));
+    if (path == NULL) {
+        return false;
+    }
+
+    StoreNode const *old = tablePath(table, num1, length, path);
+    StoreNode *children[12] = {NULL};
+
+    for (int i = 0; i < 12; ++i) {
+        children[i] = storeChild(old, i);
+        if (children[i] != NULL) {
+            children[i]->refCount++;
+        }
+    }
+
+    StoreNode *bottom;
+    bool ok = storeIntern(store, num2, stringLength(num2), children, &bottom)
+              && tableRebuild(table, path, num1, length, bottom);
+
+    memFree(store->alloc, path);
+
+    return ok;
+}
+
+/*
+ * Usunięcie zastępuje poddrzewo num pustym poddrzewem.
+ */
+extern void phfwdStoreRemove(PhfwdStoreTable *table, char const *num) {
+    if (table == NULL || !ifNumOk(num)) {
+        return;
+    }
+
+    PhfwdStore *store = table->store;
+    size_t length = stringLength(num);
+    StoreNode **path = memAlloc(store->alloc, length * sizeof(StoreNode *));
+    if (path == NULL) {
+        return;
+    }
+
+    if (tablePath(table, num, length, path) != NULL) {
+        tableRebuild(table, path, num, length, NULL);
+    }
+
+    memFree(store->alloc, path);
+}
+
+/*
+ * Wynik to cel przekierowania z najdłuższego prefiksu z dopisaną resztą
+ * numeru.
+ */
+extern PhoneNumbers *phfwdStoreGet(PhfwdStoreTable const *table,
+                                   char const *num) {
+    if (table == NULL) {
+        return NULL;
+    }
+
+    PhfwdAllocator const *alloc = table->store->alloc;
+    PhoneNumbers *result = phnumNew(alloc);
+    if (result == NULL || !ifNumOk(num)) {
+        return result;
+    }
+
+    size_t length = stringLength(num);
+    size_t fwdLength = 0;
+    StoreNode const *last = NULL;
+    StoreNode const *node = table->root;
+
+    for (size_t i = 0; i < length && node != NULL; ++i) {
+        node = storeChild(node, toInt(num[i]));
+
+        if (node != NULL && node->targetLength > 0) {
+            last = node;
+            fwdLength = i + 1;
+        }
+    }
+
+    char const *prefix = (last == NULL ? num : nodeTarget(last));
+    size_t prefixLength = (last == NULL ? 0 : last->targetLength);
+    size_t resultLength = prefixLength + length - fwdLength;
+    char *resultString = memAlloc(alloc, resultLength + 1);
+    if (resultString == NULL) {
+        phnumDelete(result);
+        return NULL;
+    }
+
+    memcpy(resultString, prefix, prefixLength);
+    memcpy(resultString + prefixLength, num + fwdLength, length - fwdLength);
+    resultString[resultLength] = '\0';
+
+    if (!phnumAdd(result, resultString)) {
+        memFree(alloc, resultString);
+        phnumDelete(result);
+        return NULL;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Stan przejścia drzewa tabeli w funkcji phfwdStoreExport.
+ */
+typedef struct ExportFrame {
+    /// Wierzchołek tabeli.
+    StoreNode const *node;
+    /// Kolejna cyfra syna do odwiedzenia.
+    int nextDigit;
+} ExportFrame;
+
+/*
+ * Przekierowania dodawane są w porządku preorder; stos i bufor numeru
+ * mają rozmiar wynikający z wysokości drzewa.
+ */
+extern PhoneForward *phfwdStoreExport(PhfwdStoreTable const *table) {
+    if (table == NULL) {
+        return NULL;
+    }
+
+    PhfwdAllocator const *alloc = table->store->alloc;
+    PhoneForward *pf = phfwdNew();
+    if (pf == NULL || table->root == NULL) {
+        return pf;
+    }
+
+    size_t height = table->root->height;
+    ExportFrame *frames = memAlloc(alloc, (height + 1) * sizeof(ExportFrame));
+    char *number = memAlloc(alloc, height + 1);
+    bool ok = (frames != NULL && number != NULL);
+    size_t top = 0;
+
+    if (ok) {
+        frames[0] = (ExportFrame) {table->root, 0};
+    }
+
+    while (ok) {
+        ExportFrame *frame = &frames[top];
+        StoreNode const *child = NULL;
+
+        while (child == NULL && frame->nextDigit < 12) {
+            child = storeChild(frame->node, frame->nextDigit++);
+        }
+
+        if (child == NULL) {
+            if (top == 0) {
+                break;
+            }
+
+            top--;
+            continue;
+        }
+
+        number[top] = toChar(frame->nextDigit - 1);
+        frames[++top] = (ExportFrame) {child, 0};
+
+        if (child->targetLength > 0) {
+            number[top] = '\0';
+            ok = phfwdAdd(pf, number, nodeTarget(child));
+        }
+    }
+
+    memFree(alloc, number);
+    memFree(alloc, frames);
+
+    if (!ok) {
+        phfwdDelete(pf);
+        return NULL;
+    }
+
+    return pf;
+}
+
+/*
+ * Rozmiar bez współdzielenia to suma rozmiarów drzew wszystkich tabel,
+ * w których każde wystąpienie poddrzewa liczone jest osobno.
+ */
+extern bool phfwdStoreStats(PhfwdStore const *store, PhfwdStoreStats *stats) {
+    if (store == NULL || stats == NULL) {
+        return false;
+    }
+
+    size_t tableBytes = store->tableCount * sizeof(PhfwdStoreTable);
+    size_t unshared = tableBytes;
+
+    for (PhfwdStoreTable const *table = store->tables; table != NULL;
+         table = table->next) {
+        if (table->root != NULL) {
+            unshared = addBytes(unshared, table->root->expandedBytes);
+        }
+    }
+
+    stats->tables = store->tableCount;
+    stats->nodes = store->nodeCount;
+    stats->bytes = sizeof(PhfwdStore) + tableBytes + store->nodeBytes
+                   + store->bucketCount * sizeof(StoreNode *);
+    stats->unsharedBytes = unshared;
+
+    return true;
+}
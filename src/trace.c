@@ -0,0 +1,449 @@
+/** @file trace.c
+ * Implementacja opcjonalnej instrumentacji czasów wykonania operacji.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "trace.h"
+
+#ifdef PHFWD_TRACE
+
+/**
+ * @brief Histogramy jednego wątku.
+ *
+ * Liczniki zapisuje wyłącznie wątek-właściciel, więc wystarczą zwykłe
+ * odczyty i zapisy atomowe bez prefiksu blokady; atomowość jest potrzebna
+ * tylko po to, by migawki z innych wątków nie były wyścigiem danych.
+ */
+typedef struct ThreadTrace {
+    /// Liczby próbek dla każdego punktu.
+    _Atomic uint64_t count[PHFWD_TRACE_POINTS];
+    /// Sumy czasów dla każdego punktu.
+    _Atomic uint64_t sum[PHFWD_TRACE_POINTS];
+    /// Minima dla każdego punktu.
+    _Atomic uint64_t min[PHFWD_TRACE_POINTS];
+    /// Maksima dla każdego punktu.
+    _Atomic uint64_t max[PHFWD_TRACE_POINTS];
+    /// Kubełki dla każdego punktu.
+    _Atomic uint64_t buckets[PHFWD_TRACE_POINTS][PHFWD_TRACE_BUCKETS];
+    /// Liczniki zdarzeń.
+    _Atomic uint64_t counters[PHFWD_TRACE_COUNTERS];
+    /// Następny zarejestrowany wątek.
+    struct ThreadTrace *next;
+} ThreadTrace;
+
+/// Lista histogramów wszystkich wątków (nigdy nie są zwalniane,
+/// więc próbki zakończonych wątków nadal trafiają do migawek).
+static ThreadTrace *_Atomic traceThreads = NULL;
+
+/// Histogramy bieżącego wątku.
+static _Thread_local ThreadTrace *traceLocal = NULL;
+
+/// Funkcja wywoływana przy każdej próbce.
+static _Atomic PhfwdTraceHook traceHook = NULL;
+
+/// Maska próbkowania: mierzona jest operacja, dla której licznik wątku
+/// ma wyzerowane bity maski.
+static _Atomic uint32_t traceSampleMask = 0;
+
+/// Licznik rozpoczętych pomiarów bieżącego wątku.
+static _Thread_local uint32_t traceTick = 0;
+
+/**
+ * @brief Zwiększa licznik, którego jedynym zapisującym jest bieżący wątek.
+ *
+ * @param[in, out] counter - licznik;
+ * @param[in] value - wartość do dodania.
+ */
+static inline void counterAdd(_Atomic uint64_t *counter, uint64_t value) {
+    uint64_t old = atomic_load_explicit(counter, memory_order_relaxed);
+    atomic_store_explicit(counter, old + value, memory_order_relaxed);
+}
+
+/**
+ * @brief Zeruje histogramy jednego wątku.
+ *
+ * @param[out] local - histogramy do wyzerowania.
+ */
+static void traceClear(ThreadTrace *local) {
+    for (size_t p = 0; p < PHFWD_TRACE_POINTS; ++p) {
+        atomic_store_explicit(&local->count[p], 0, memory_order_relaxed);
+        atomic_store_explicit(&local->sum[p], 0, memory_order_relaxed);
+        atomic_store_explicit(&local->min[p], UINT64_MAX,
+                              memory_order_relaxed);
+        atomic_store_explicit(&local->max[p], 0, memory_order_relaxed);
+
+        for (size_t i = 0; i < PHFWD_TRACE_BUCKETS; ++i) {
+            atomic_store_explicit(&local->buckets[p][i], 0,
+                                  memory_order_relaxed);
+        }
+    }
+
+    for (size_t c = 0; c < PHFWD_TRACE_COUNTERS; ++c) {
+        atomic_store_explicit(&local->counters[c], 0, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Zwraca histogramy bieżącego wątku, rejestrując je przy pierwszym
+ * użyciu.
+ *
+ * @return Wskaźnik na histogramy lub NULL, jeśli nie udało się
+ *         alokować pamięci.
+ */
+static ThreadTrace *traceThread(void) {
+    if (traceLocal != NULL) {
+        return traceLocal;
+    }
+
+    ThreadTrace *local = malloc(sizeof(ThreadTrace));
+    if (local == NULL) {
+        return NULL;
+    }
+
+    traceClear(local);
+
+    local->next = atomic_load(&traceThreads);
+    while (!atomic_compare_exchange_weak(&traceThreads, &local->next, local));
+
+    traceLocal = local;
+
+    return local;
+}
+
+#endif /* PHFWD_TRACE */
+
+/**
+ * @brief Wyznacza kubełek odpowiadający danemu czasowi.
+ *
+ * Wartości mniejsze niż 32 mają własne kubełki, a każda kolejna potęga
+ * dwójki jest dzielona na 16 równych części.
+ *
+ * @param[in] nanos - czas w nanosekundach.
+ * @return Indeks kubełka.
+ */
+static inline size_t bucketIndex(uint64_t nanos) {
+    if (nanos < 32) {
+        return nanos;
+    }
+
+    size_t msb = 63 - __builtin_clzll(nanos);
+    size_t shift = msb - 4;
+
+    return 32 + (shift - 1) * 16 + ((nanos >> shift) - 16);
+}
+
+/**
+ * @brief Zwraca dolną granicę kubełka (funkcja odwrotna do bucketIndex).
+ *
+ * @param[in] idx - indeks kubełka.
+ * @return Najmniejszy czas trafiający do kubełka.
+ */
+static inline uint64_t bucketValue(size_t idx) {
+    if (idx < 32) {
+        return idx;
+    }
+
+    size_t shift = (idx - 32) / 16 + 1;
+    uint64_t mantissa = (idx - 32) % 16 + 16;
+
+    return mantissa << shift;
+}
+
+/**
+ * @brief Odczytuje zegar monotoniczny systemu.
+ * @return Czas w nanosekundach.
+ */
+static uint64_t clockNanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+#if defined(PHFWD_TRACE) && (defined(__x86_64__) || defined(__i386__))
+
+/// Liczba nanosekund na takt licznika TSC pomnożona przez 2^32
+/// (0 - jeszcze nie skalibrowano).
+static _Atomic uint64_t tscScale = 0;
+
+/**
+ * @brief Kalibruje licznik TSC względem zegara monotonicznego.
+ *
+ * Wykonywana raz, przy pierwszym pomiarze; trwa około milisekundy.
+ *
+ * @return Liczba nanosekund na takt pomnożona przez 2^32.
+ */
+static uint64_t tscCalibrate(void) {
+    uint64_t startNanos = clockNanos();
+    uint64_t startTicks = __rdtsc();
+
+    uint64_t nanos;
+    do {
+        nanos = clockNanos();
+    } while (nanos - startNanos < 1000000);
+
+    uint64_t ticks = __rdtsc() - startTicks;
+    uint64_t scale = ((nanos - startNanos) << 32) / (ticks == 0 ? 1 : ticks);
+
+    atomic_store(&tscScale, scale == 0 ? 1 : scale);
+
+    return scale;
+}
+
+extern uint64_t traceNow(void) {
+    // Odczyt TSC jest kilkukrotnie tańszy od clock_gettime, a czas
+    // pomiaru jest liczony tylko z różnic, więc wystarczy przeskalować takty.
+    uint64_t scale = atomic_load_explicit(&tscScale, memory_order_relaxed);
+    if (scale == 0) {
+        scale = tscCalibrate();
+    }
+
+    unsigned __int128 ticks = __rdtsc();
+
+    return (uint64_t) ((ticks * scale) >> 32);
+}
+
+#else
+
+extern uint64_t traceNow(void) {
+    return clockNanos();
+}
+
+#endif
+
+extern uint64_t traceStart(void) {
+#ifdef PHFWD_TRACE
+    uint32_t mask = atomic_load_explicit(&traceSampleMask,
+                                         memory_order_relaxed);
+    if ((traceTick++ & mask) != 0) {
+        return 0;
+    }
+
+    uint64_t now = traceNow();
+
+    return (now == 0 ? 1 : now);
+#else
+    return 0;
+#endif
+}
+
+extern void traceRecord(PhfwdTracePoint point, uint64_t nanos) {
+#ifdef PHFWD_TRACE
+    ThreadTrace *local = traceThread();
+    if (local == NULL || point >= PHFWD_TRACE_POINTS) {
+        return;
+    }
+
+    counterAdd(&local->count[point], 1);
+    counterAdd(&local->sum[point], nanos);
+    counterAdd(&local->buckets[point][bucketIndex(nanos)], 1);
+
+    if (nanos < atomic_load_explicit(&local->min[point],
+                                     memory_order_relaxed)) {
+        atomic_store_explicit(&local->min[point], nanos, memory_order_relaxed);
+    }
+
+    if (nanos > atomic_load_explicit(&local->max[point],
+                                     memory_order_relaxed)) {
+        atomic_store_explicit(&local->max[point], nanos, memory_order_relaxed);
+    }
+
+    PhfwdTraceHook hook = atomic_load_explicit(&traceHook,
+                                               memory_order_relaxed);
+    if (hook != NULL) {
+        hook(point, nanos);
+    }
+#else
+    (void) point;
+    (void) nanos;
+#endif
+}
+
+extern void traceCount(PhfwdTraceCounter counter, uint64_t value) {
+#ifdef PHFWD_TRACE
+    ThreadTrace *local = traceThread();
+    if (local == NULL || counter >= PHFWD_TRACE_COUNTERS) {
+        return;
+    }
+
+    counterAdd(&local->counters[counter], value);
+#else
+    (void) counter;
+    (void) value;
+#endif
+}
+
+extern bool phfwdTraceEnabled(void) {
+#ifdef PHFWD_TRACE
+    return true;
+#else
+    return false;
+#endif
+}
+
+extern bool phfwdTraceSnapshot(PhfwdTracePoint point, PhfwdHistogram *out) {
+    if (out == NULL || point >= PHFWD_TRACE_POINTS) {
+        return false;
+    }
+
+    memset(out, 0, sizeof(PhfwdHistogram));
+
+#ifdef PHFWD_TRACE
+    out->min = UINT64_MAX;
+
+    ThreadTrace *local = atomic_load(&traceThreads);
+    while (local != NULL) {
+        out->count += atomic_load_explicit(&local->count[point],
+                                           memory_order_relaxed);
+        out->sum += atomic_load_explicit(&local->sum[point],
+                                         memory_order_relaxed);
+
+        uint64_t localMin = atomic_load_explicit(&local->min[point],
+                                                 memory_order_relaxed);
+        uint64_t localMax = atomic_load_explicit(&local->max[point],
+                                                 memory_order_relaxed);
+        out->min = (localMin < out->min ? localMin : out->min);
+        out->max = (localMax > out->max ? localMax : out->max);
+
+        for (size_t i = 0; i < PHFWD_TRACE_BUCKETS; ++i) {
+            out->buckets[i] += atomic_load_explicit(&local->buckets[point][i],
+                                                    memory_order_relaxed);
+        }
+
+        local = local->next;
+    }
+
+    if (out->count == 0) {
+        out->min = 0;
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+extern uint64_t phfwdHistogramPercentile(PhfwdHistogram const *hist,
+                                         double percentile) {
+    if (hist == NULL || hist->count == 0) {
+        return 0;
+    }
+
+    // Numer próbki (liczony od jedynki), której szukamy.
+    uint64_t rank = (uint64_t) (percentile / 100.0 * (double) hist->count);
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    if (rank > hist->count) {
+        rank = hist->count;
+    }
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < PHFWD_TRACE_BUCKETS; ++i) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            return bucketValue(i);
+        }
+    }
+
+    return hist->max;
+}
+
+extern uint64_t phfwdTraceCounter(PhfwdTraceCounter counter) {
+    uint64_t sum = 0;
+
+#ifdef PHFWD_TRACE
+    if (counter >= PHFWD_TRACE_COUNTERS) {
+        return 0;
+    }
+
+    ThreadTrace *local = atomic_load(&traceThreads);
+    while (local != NULL) {
+        sum += atomic_load_explicit(&local->counters[counter],
+                                    memory_order_relaxed);
+        local = local->next;
+    }
+#else
+    (void) counter;
+#endif
+
+    return sum;
+}
+
+extern void phfwdTraceReset(void) {
+#ifdef PHFWD_TRACE
+    ThreadTrace *local = atomic_load(&traceThreads);
+    while (local != NULL) {
+        traceClear(local);
+        local = local->next;
+    }
+#endif
+}
+
+extern void phfwdTraceSetHook(PhfwdTraceHook hook) {
+#ifdef PHFWD_TRACE
+    atomic_store(&traceHook, hook);
+#else
+    (void) hook;
+#endif
+}
+
+extern void phfwdTraceSetSampling(unsigned log2Rate) {
+#ifdef PHFWD_TRACE
+    if (log2Rate > 31) {
+        log2Rate = 31;
+    }
+
+    atomic_store(&traceSampleMask, (uint32_t) ((1ull << log2Rate) - 1));
+#else
+    (void) log2Rate;
+#endif
+}
+
+extern void phfwdTraceExport(FILE *out) {
+    static char const *names[PHFWD_TRACE_POINTS] = {
+        "get", "reverse", "getReverse", "add", "remove",
+        "findLastFwd", "constructResult", "reverseOpen", "reverseMerge",
+        "cacheHit"
+    };
+
+    if (out == NULL) {
+        return;
+    }
+
+    fprintf(out, "%-18s %12s %10s %10s %10s %10s %10s %12s\n",
+            "point", "count", "mean", "p50", "p90", "p99", "p99.9", "max");
+
+    for (size_t p = 0; p < PHFWD_TRACE_POINTS; ++p) {
+        PhfwdHistogram hist;
+        if (!phfwdTraceSnapshot(p, &hist)) {
+            return;
+        }
+
+        uint64_t mean = (hist.count == 0 ? 0 : hist.sum / hist.count);
+        fprintf(out, "%-18s %12llu %10llu %10llu %10llu %10llu %10llu %12llu\n",
+                names[p],
+                (unsigned long long) hist.count,
+                (unsigned long long) mean,
+                (unsigned long long) phfwdHistogramPercentile(&hist, 50),
+                (unsigned long long) phfwdHistogramPercentile(&hist, 90),
+                (unsigned long long) phfwdHistogramPercentile(&hist, 99),
+                (unsigned long long) phfwdHistogramPercentile(&hist, 99.9),
+                (unsigned long long) hist.max);
+    }
+}
@@ -0,0 +1,250 @@
+/** @file trace.h
+ * Interfejs opcjonalnej instrumentacji czasów wykonania operacji.
+ *
+ * Instrumentacja jest włączana w czasie kompilacji makrem @p PHFWD_TRACE
+ * (opcja CMake o tej samej nazwie). Bez niego makra @ref TRACE_BEGIN
+ * i @ref TRACE_END rozwijają się do pustych instrukcji, a funkcje
+ * eksportujące zwracają puste wyniki.
+ *
+ * Czasy trafiają do histogramów w stylu HDR (czasy poniżej 32 ns mają
+ * własne kubełki, a każda kolejna potęga dwójki 16 kubełków, więc błąd
+ * względny nie przekracza 6,25%), osobnych dla każdego wątku,
+ * więc zapis próbki nie wymaga żadnej synchronizacji.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Punkty pomiarowe: całe operacje oraz ich poszczególne fazy.
+ */
+typedef enum PhfwdTracePoint {
+    /// Całe wywołanie @ref phfwdGet.
+    PHFWD_TRACE_GET,
+    /// Całe wywołanie @ref phfwdReverse.
+    PHFWD_TRACE_REVERSE,
+    /// Całe wywołanie @ref phfwdGetReverse.
+    PHFWD_TRACE_GET_REVERSE,
+    /// Całe wywołanie @ref phfwdAdd (również odrzucone lub nieudane).
+    PHFWD_TRACE_ADD,
+    /// Całe wywołanie @ref phfwdRemove (również odrzucone lub nieudane).
+    PHFWD_TRACE_REMOVE,
+    /// Faza: przejście drzewa w poszukiwaniu najdłuższego prefiksu.
+    PHFWD_TRACE_FIND_LAST_FWD,
+    /// Faza: budowa napisu wynikowego phfwdGet.
+    PHFWD_TRACE_CONSTRUCT_RESULT,
+    /// Faza: przygotowanie strumieni kursora phfwdReverse.
+    PHFWD_TRACE_REVERSE_OPEN,
+    /// Faza: scalanie strumieni kursora phfwdReverse.
+    PHFWD_TRACE_REVERSE_MERGE,
+    /// Faza: odczyt wyniku phfwdGet z pamięci podręcznej wyników
+    /// (zamiast przejścia drzewa i budowy napisu).
+    PHFWD_TRACE_CACHE_HIT,
+    /// Liczba punktów pomiarowych.
+    PHFWD_TRACE_POINTS
+} PhfwdTracePoint;
+
+/**
+ * Liczniki zdarzeń (zliczane przy każdym wystąpieniu, bez próbkowania).
+ */
+typedef enum PhfwdTraceCounter {
+    /// Wywołania przejścia drzewa w poszukiwaniu najdłuższego prefiksu.
+    PHFWD_TRACE_WALKS,
+    /// Wierzchołki odwiedzone przez te przejścia.
+    PHFWD_TRACE_WALK_STEPS,
+    /// Liczba liczników.
+    PHFWD_TRACE_COUNTERS
+} PhfwdTraceCounter;
+
+/// Liczba kubełków pojedynczego histogramu.
+#define PHFWD_TRACE_BUCKETS 976
+
+/**
+ * @brief Histogram czasów (w nanosekundach) jednego punktu pomiarowego.
+ */
+typedef struct PhfwdHistogram {
+    /// Liczba próbek.
+    uint64_t count;
+    /// Suma czasów wszystkich próbek.
+    uint64_t sum;
+    /// Najkrótszy zmierzony czas.
+    uint64_t min;
+    /// Najdłuższy zmierzony czas.
+    uint64_t max;
+    /// Liczności kolejnych kubełków.
+    uint64_t buckets[PHFWD_TRACE_BUCKETS];
+} PhfwdHistogram;
+
+/**
+ * Funkcja wywoływana przy każdej zarejestrowanej próbce.
+ */
+typedef void (*PhfwdTraceHook)(PhfwdTracePoint point, uint64_t nanos);
+
+/**
+ * @brief Zwraca bieżący czas monotoniczny w nanosekundach.
+ * @return Czas w nanosekundach.
+ */
+uint64_t traceNow(void);
+
+/**
+ * @brief Rozpoczyna pomiar, jeśli bieżąca operacja została wylosowana
+ * do próbkowania.
+ *
+ * @return Bieżący czas w nanosekundach (zawsze niezerowy)
+ *         lub 0, jeśli operacja nie jest mierzona.
+ */
+uint64_t traceStart(void);
+
+/**
+ * @brief Zapisuje próbkę w histogramie bieżącego wątku.
+ *
+ * @param[in] point - punkt pomiarowy;
+ * @param[in] nanos - zmierzony czas w nanosekundach.
+ */
+void traceRecord(PhfwdTracePoint point, uint64_t nanos);
+
+/**
+ * @brief Zwiększa licznik zdarzeń bieżącego wątku.
+ *
+ * @param[in] counter - licznik;
+ * @param[in] value - wartość do dodania.
+ */
+void traceCount(PhfwdTraceCounter counter, uint64_t value);
+
+#ifdef PHFWD_TRACE
+/// Rozpoczyna pomiar czasu zapamiętywany w zmiennej @p var
+/// (0 oznacza, że operacja nie została wylosowana do pomiaru).
+#define TRACE_BEGIN(var) uint64_t var = traceStart()
+/// Rozpoczyna pomiar w zmiennej @p var od znacznika @p from
+/// (bez ponownego odczytu zegara).
+#define TRACE_MARK(var, from) uint64_t var = (from)
+/// Kończy pomiar rozpoczęty w @p var i zapisuje go w punkcie @p point.
+#define TRACE_END(var, point) do { \
+        if ((var) != 0) { \
+            traceRecord((point), traceNow() - (var)); \
+        } \
+    } while (0)
+/// Zapisuje czas od @p var w punkcie @p point i przesuwa @p var na chwilę
+/// bieżącą, dzięki czemu kolejne fazy dzielą jeden odczyt zegara.
+#define TRACE_LAP(var, point) do { \
+        if ((var) != 0) { \
+            uint64_t traceLap_ = traceNow(); \
+            traceRecord((point), traceLap_ - (var)); \
+            (var) = traceLap_; \
+        } \
+    } while (0)
+/// Przesuwa trwający pomiar @p var na chwilę bieżącą
+/// (nic nie robi, jeśli pomiar nie jest prowadzony).
+#define TRACE_RESTART(var) do { \
+        if ((var) != 0) { \
+            (var) = traceNow(); \
+        } \
+    } while (0)
+/// Zapisuje w punkcie @p point czas od @p var do znacznika @p mark.
+#define TRACE_SINCE(var, mark, point) do { \
+        if ((var) != 0) { \
+            traceRecord((point), (mark) - (var)); \
+        } \
+    } while (0)
+/// Dodaje @p value do licznika @p counter.
+#define TRACE_COUNT(counter, value) traceCount((counter), (value))
+#else
+/// Pusta instrukcja (instrumentacja wyłączona).
+#define TRACE_BEGIN(var) ((void) 0)
+/// Pusta instrukcja (instrumentacja wyłączona).
+#define TRACE_MARK(var, from) ((void) 0)
+/// Pusta instrukcja (instrumentacja wyłączona).
+#define TRACE_END(var, point) ((void) 0)
+/// Pusta instrukcja (instrumentacja wyłączona).
+#define TRACE_LAP(var, point) ((void) 0)
+/// Pusta instrukcja (instrumentacja wyłączona).
+#define TRACE_RESTART(var) ((void) 0)
+/// Pusta instrukcja (instrumentacja wyłączona).
+#define TRACE_SINCE(var, mark, point) ((void) 0)
+/// Pusta instrukcja (instrumentacja wyłączona).
+#define TRACE_COUNT(counter, value) ((void) 0)
+#endif
+
+/**
+ * @brief Sprawdza, czy biblioteka została skompilowana z instrumentacją.
+ * @return Wartość @p true jeśli instrumentacja jest dostępna,
+ *         wartość @p false w przeciwnym wypadku.
+ */
+bool phfwdTraceEnabled(void);
+
+/**
+ * @brief Sumuje histogramy wszystkich wątków dla danego punktu pomiarowego.
+ *
+ * Odczyt nie zatrzymuje wątków zapisujących, więc migawka może nie zawierać
+ * próbek zapisywanych w trakcie jej wykonywania.
+ *
+ * @param[in] point - punkt pomiarowy;
+ * @param[out] out - wynikowy histogram.
+ * @return Wartość @p true jeśli migawka została wykonana,
+ *         wartość @p false jeśli instrumentacja jest wyłączona
+ *         lub parametry są niepoprawne.
+ */
+bool phfwdTraceSnapshot(PhfwdTracePoint point, PhfwdHistogram *out);
+
+/**
+ * @brief Wyznacza przybliżony percentyl histogramu.
+ *
+ * @param[in] hist - histogram;
+ * @param[in] percentile - percentyl z przedziału [0, 100].
+ * @return Dolna granica kubełka zawierającego percentyl (w nanosekundach),
+ *         0 dla pustego histogramu.
+ */
+uint64_t phfwdHistogramPercentile(PhfwdHistogram const *hist,
+                                  double percentile);
+
+/**
+ * @brief Sumuje wartości licznika zdarzeń ze wszystkich wątków.
+ *
+ * @param[in] counter - licznik.
+ * @return Suma wartości licznika lub 0, jeśli instrumentacja jest
+ *         wyłączona lub parametr jest niepoprawny.
+ */
+uint64_t phfwdTraceCounter(PhfwdTraceCounter counter);
+
+/**
+ * @brief Zeruje histogramy i liczniki zdarzeń wszystkich wątków.
+ */
+void phfwdTraceReset(void);
+
+/**
+ * @brief Ustawia funkcję wywoływaną przy każdej próbce.
+ *
+ * @param[in] hook - funkcja lub NULL, aby ją wyłączyć.
+ */
+void phfwdTraceSetHook(PhfwdTraceHook hook);
+
+/**
+ * @brief Ustawia częstotliwość próbkowania pomiarów.
+ *
+ * Każdy wątek mierzy co @f$2^{k}@f$-tą rozpoczynaną operację (lub fazę),
+ * co pozwala ograniczyć koszt odczytów zegara pod pełnym obciążeniem.
+ * Domyślnie mierzona jest każda operacja.
+ *
+ * @param[in] log2Rate - wykładnik @p k (co najwyżej 31).
+ */
+void phfwdTraceSetSampling(unsigned log2Rate);
+
+/**
+ * @brief Wypisuje podsumowanie wszystkich punktów pomiarowych.
+ *
+ * Każdy wiersz zawiera nazwę punktu, liczbę próbek, średnią,
+ * percentyle 50, 90, 99, 99.9 oraz maksimum (w nanosekundach).
+ *
+ * @param[in] out - strumień wyjściowy.
+ */
+void phfwdTraceExport(FILE *out);
+
+#endif /* __TRACE_H__ */
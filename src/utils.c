@@ -9,6 +9,9 @@
 #include <stdlib.h>
 #include <stdbool.h>
 
+#include "allocator.h"
+#include "utils.h"
+
 extern int toInt(char c) {
     if ('0' <= c && c <= '9') {
         return c - '0';
@@ -69,13 +72,13 @@ extern size_t stringLength(char const *string) {
     return length;
 }
 
-extern char *copyString(char const *num) {
+extern char *copyString(PhfwdAllocator const *alloc, char const *num) {
     if (!ifNumOk(num)) {
         return NULL;
     }
 
     size_t length = stringLength(num);
-    char *copy = malloc((length + 1) * sizeof(char));
+    char *copy = memAlloc(alloc, (length + 1) * sizeof(char));
     if (copy == NULL) {
         return NULL;
     }
@@ -107,4 +110,16 @@ extern bool areStringsEqual(char const *num1, char const *num2) {
     }
 
     return areEqual;
-}
\ No newline at end of file
+}
+extern int compareNumbers(char const *num1, size_t length1,
+                          char const *num2, size_t length2) {
+    size_t length = min(length1, length2);
+
+    for (size_t i = 0; i < length; ++i) {
+        if (num1[i] != num2[i]) {
+            return toInt(num1[i]) - toInt(num2[i]);
+        }
+    }
+
+    return (length1 > length2) - (length1 < length2);
+}
@@ -9,6 +9,8 @@
 #ifndef __UTILS_H__
 #define __UTILS_H__
 
+#include "allocator.h"
+
 /**
  * @brief Zamiana znaku na odpowiadającą mu liczbę.
  * 
@@ -49,10 +51,11 @@ size_t stringLength(char const *string);
 /**
  * @brief Utworzenie płytkiej kopii zadanego napisu.
  * 
+ * @param[in] alloc - alokator, którym alokujemy kopię;
  * @param[in] num - Zadany napis (numer).
  * @return Płytka kopia zadanego napisu (numeru).
  */
-char *copyString(char const *num);
+char *copyString(PhfwdAllocator const *alloc, char const *num);
 
 /**
  * @brief Zwraca maksimum z dwóch liczb. 
@@ -85,4 +88,19 @@ static inline size_t min(size_t a, size_t b) {
  */
 extern bool areStringsEqual(char const *num1, char const *num2);
 
+/**
+ * @brief Porównuje leksykograficznie dwa numery.
+ *
+ * Cyfry porządkowane są tak jak w @ref toInt ('*' oraz '#' po '9').
+ *
+ * @param[in] num1 - pierwszy numer;
+ * @param[in] length1 - długość pierwszego numeru;
+ * @param[in] num2 - drugi numer;
+ * @param[in] length2 - długość drugiego numeru.
+ * @return Wartość ujemna, zero lub dodatnia, jeśli pierwszy numer jest
+ *         odpowiednio mniejszy, równy lub większy od drugiego.
+ */
+extern int compareNumbers(char const *num1, size_t length1,
+                          char const *num2, size_t length2);
+
 #endif /* __UTILS_H__ */
\ No newline at end of file
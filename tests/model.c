@@ -0,0 +1,342 @@
+/** @file model.c
+ * Implementacja naiwnego modelu struktury przechowującej przekierowania.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "model.h"
+
+/**
+ * Największa długość numeru łańcucha, dla której model wyznacza wynik
+ * phfwdResolve.
+ */
+#define MODEL_RESOLVE_LENGTH 120
+
+/**
+ * Największa liczba zapamiętywanych numerów łańcucha w phfwdResolve.
+ */
+#define MODEL_RESOLVE_SEEN 64
+
+/**
+ * @brief Zamienia cyfrę na jej pozycję w kolejności numerów.
+ *
+ * @param[in] digit - cyfra.
+ * @return Pozycja cyfry.
+ */
+static int digitOrder(char digit) {
+    if (digit == '*') {
+        return 10;
+    }
+
+    if (digit == '#') {
+        return 11;
+    }
+
+    return digit - '0';
+}
+
+extern int modelCompare(char const *num1, char const *num2) {
+    while (*num1 != '\0' && *num1 == *num2) {
+        num1++;
+        num2++;
+    }
+
+    if (*num1 == '\0' || *num2 == '\0') {
+        return (*num1 != '\0') - (*num2 != '\0');
+    }
+
+    return digitOrder(*num1) - digitOrder(*num2);
+}
+
+/**
+ * @brief Sprawdza, czy napis jest prefiksem numeru.
+ *
+ * @param[in] prefix - prefiks;
+ * @param[in] num - numer.
+ * @return Wartość @p true, jeśli @p prefix jest prefiksem @p num.
+ */
+static bool isPrefix(char const *prefix, char const *num) {
+    return strncmp(prefix, num, strlen(prefix)) == 0;
+}
+
+/**
+ * @brief Kopiuje napis do nowo zaalokowanej pamięci.
+ *
+ * @param[in] string - napis.
+ * @return Kopia napisu.
+ */
+static char *duplicate(char const *string) {
+    char *copy = malloc(strlen(string) + 1);
+    if (copy == NULL) {
+        abort();
+    }
+
+    return strcpy(copy, string);
+}
+
+extern void modelInit(Model *model) {
+    model->forwards = NULL;
+    model->count = 0;
+    model->capacity = 0;
+}
+
+extern void modelClear(Model *model) {
+    free(model->forwards);
+    modelInit(model);
+}
+
+/**
+ * @brief Zapewnia miejsce na dany rozmiar tablicy przekierowań.
+ *
+ * @param[in, out] model - model;
+ * @param[in] count - wymagana liczba przekierowań.
+ */
+static void reserve(Model *model, size_t count) {
+    if (count <= model->capacity) {
+        return;
+    }
+
+    size_t capacity = (model->capacity == 0 ? 16 : 2 * model->capacity);
+    while (capacity < count) {
+        capacity *= 2;
+    }
+
+    model->forwards = realloc(model->forwards,
+                              capacity * sizeof(ModelForward));
+    if (model->forwards == NULL) {
+        abort();
+    }
+
+    model->capacity = capacity;
+}
+
+extern void modelAssign(Model *target, Model const *source) {
+    reserve(target, source->count);
+    if (source->count > 0) {
+        memcpy(target->forwards, source->forwards,
+               source->count * sizeof(ModelForward));
+    }
+
+    target->count = source->count;
+}
+
+extern void modelAdd(Model *model, char const *from, char const *to,
+                     size_t deadline) {
+    for (size_t i = 0; i < model->count; ++i) {
+        if (strcmp(model->forwards[i].from, from) == 0) {
+            strcpy(model->forwards[i].to, to);
+            model->forwards[i].deadline = deadline;
+            return;
+        }
+    }
+
+    reserve(model, model->count + 1);
+
+    ModelForward *forward = &model->forwards[model->count++];
+    strcpy(forward->from, from);
+    strcpy(forward->to, to);
+    forward->deadline = deadline;
+}
+
+extern void modelRemove(Model *model, char const *prefix) {
+    size_t kept = 0;
+
+    for (size_t i = 0; i < model->count; ++i) {
+        if (!isPrefix(prefix, model->forwards[i].from)) {
+            model->forwards[kept++] = model->forwards[i];
+        }
+    }
+
+    model->count = kept;
+}
+
+extern void modelErase(Model *model, char const *from) {
+    for (size_t i = 0; i < model->count; ++i) {
+        if (strcmp(model->forwards[i].from, from) == 0) {
+            model->forwards[i] = model->forwards[--model->count];
+            return;
+        }
+    }
+}
+
+extern char const *modelFind(Model const *model, char const *from) {
+    for (size_t i = 0; i < model->count; ++i) {
+        if (strcmp(model->forwards[i].from, from) == 0) {
+            return model->forwards[i].to;
+        }
+    }
+
+    return NULL;
+}
+
+extern void modelGet(Model const *model, char const *num, char *result) {
+    ModelForward const *best = NULL;
+    size_t bestLength = 0;
+
+    for (size_t i = 0; i < model->count; ++i) {
+        size_t length = strlen(model->forwards[i].from);
+
+        if (length > bestLength && isPrefix(model->forwards[i].from, num)) {
+            best = &model->forwards[i];
+            bestLength = length;
+        }
+    }
+
+    if (best == NULL) {
+        strcpy(result, num);
+    }
+    else {
+        sprintf(result, "%s%s", best->to, num + bestLength);
+    }
+}
+
+/**
+ * @brief Porównuje numery wskazywane przez elementy tablicy.
+ *
+ * @param[in] first - wskaźnik na pierwszy element;
+ * @param[in] second - wskaźnik na drugi element.
+ * @return Wynik @ref modelCompare.
+ */
+static int compareEntries(void const *first, void const *second) {
+    return modelCompare(*(char * const *) first, *(char * const *) second);
+}
+
+extern ModelNumbers modelReverse(Model const *model, char const *num) {
+    ModelNumbers result;
+    result.numbers = malloc((model->count + 1) * sizeof(char *));
+    if (result.numbers == NULL) {
+        abort();
+    }
+
+    size_t count = 0;
+    result.numbers[count++] = duplicate(num);
+
+    for (size_t i = 0; i < model->count; ++i) {
+        ModelForward const *forward = &model->forwards[i];
+
+        if (isPrefix(forward->to, num)) {
+            char buffer[2 * MODEL_MAX_LENGTH + 1];
+
+            sprintf(buffer, "%s%s", forward->from, num + strlen(forward->to));
+            result.numbers[count++] = duplicate(buffer);
+        }
+    }
+
+    qsort(result.numbers, count, sizeof(char *), compareEntries);
+
+    result.count = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (result.count > 0
+            && strcmp(result.numbers[result.count - 1],
+                      result.numbers[i]) == 0) {
+            free(result.numbers[i]);
+        }
+        else {
+            result.numbers[result.count++] = result.numbers[i];
+        }
+    }
+
+    return result;
+}
+
+extern ModelNumbers modelGetReverse(Model const *model, char const *num) {
+    ModelNumbers result = modelReverse(model, num);
+    size_t kept = 0;
+
+    for (size_t i = 0; i < result.count; ++i) {
+        char buffer[2 * MODEL_MAX_LENGTH + 1];
+
+        modelGet(model, result.numbers[i], buffer);
+        if (strcmp(buffer, num) == 0) {
+            result.numbers[kept++] = result.numbers[i];
+        }
+        else {
+            free(result.numbers[i]);
+        }
+    }
+
+    result.count = kept;
+
+    return result;
+}
+
+extern int modelResolve(Model const *model, char const *num, size_t maxHops,
+                        char *result) {
+    static char seen[MODEL_RESOLVE_SEEN][MODEL_RESOLVE_LENGTH + 1];
+    size_t seenCount = 0;
+    char current[2 * MODEL_MAX_LENGTH + 1];
+    char next[2 * MODEL_MAX_LENGTH + 1];
+
+    strcpy(current, num);
+
+    for (size_t hops = 0; ; ++hops) {
+        modelGet(model, current, next);
+
+        if (strcmp(next, current) == 0) {
+            strcpy(result, current);
+            return 1;
+        }
+
+        if (hops == maxHops) {
+            return 0;
+        }
+
+        if (strlen(next) > MODEL_RESOLVE_LENGTH) {
+            return -1;
+        }
+
+        for (size_t i = 0; i < seenCount; ++i) {
+            if (strcmp(seen[i], next) == 0) {
+                return 0;
+            }
+        }
+
+        if (seenCount == MODEL_RESOLVE_SEEN) {
+            return -1;
+        }
+
+        strcpy(seen[seenCount++], next);
+        strcpy(current, next);
+    }
+}
+
+extern size_t modelExpire(Model *model, size_t clock, Model *expired) {
+    size_t kept = 0;
+    size_t count = 0;
+
+    for (size_t i = 0; i < model->count; ++i) {
+        ModelForward const *forward = &model->forwards[i];
+
+        if (forward->deadline != 0 && forward->deadline <= clock) {
+            if (expired != NULL) {
+                modelAdd(expired, forward->from, forward->to,
+                         forward->deadline);
+            }
+
+            count++;
+        }
+        else {
+            model->forwards[kept++] = *forward;
+        }
+    }
+
+    model->count = kept;
+
+    return count;
+}
+
+extern void modelNumbersClear(ModelNumbers *numbers) {
+    for (size_t i = 0; i < numbers->count; ++i) {
+        free(numbers->numbers[i]);
+    }
+
+    free(numbers->numbers);
+    numbers->numbers = NULL;
+    numbers->count = 0;
+}
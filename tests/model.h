@@ -0,0 +1,187 @@
+/** @file model.h
+ * Interfejs naiwnego modelu struktury przechowującej przekierowania,
+ * z którym testy porównują wyniki biblioteki.
+ *
+ * Model przechowuje aktualne przekierowania w nieposortowanej tablicy
+ * i wyznacza wyniki zapytań wprost z definicji, przeglądając całą tablicę.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#ifndef __MODEL_H__
+#define __MODEL_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Największa długość numeru w modelu.
+ */
+#define MODEL_MAX_LENGTH 255
+
+/**
+ * @brief Przekierowanie w modelu.
+ */
+typedef struct ModelForward {
+    /// Prefiks przekierowywany.
+    char from[MODEL_MAX_LENGTH + 1];
+    /// Prefiks, na który prowadzi przekierowanie.
+    char to[MODEL_MAX_LENGTH + 1];
+    /// Termin wygaśnięcia (0, jeśli przekierowanie nie wygasa).
+    size_t deadline;
+} ModelForward;
+
+/**
+ * @brief Model struktury przechowującej przekierowania.
+ */
+typedef struct Model {
+    /// Aktualne przekierowania (w dowolnej kolejności).
+    ModelForward *forwards;
+    /// Liczba przekierowań.
+    size_t count;
+    /// Pojemność tablicy @p forwards.
+    size_t capacity;
+} Model;
+
+/**
+ * @brief Ciąg numerów wyznaczony przez model.
+ */
+typedef struct ModelNumbers {
+    /// Numery.
+    char **numbers;
+    /// Liczba numerów.
+    size_t count;
+} ModelNumbers;
+
+/**
+ * @brief Porównuje numery w kolejności zwracanej przez bibliotekę
+ * ('*' oraz '#' po '9').
+ *
+ * @param[in] num1 - pierwszy numer;
+ * @param[in] num2 - drugi numer.
+ * @return Wartość ujemna, zero lub dodatnia, jeśli @p num1 jest odpowiednio
+ *         mniejszy, równy lub większy od @p num2.
+ */
+int modelCompare(char const *num1, char const *num2);
+
+/**
+ * @brief Tworzy pusty model.
+ *
+ * @param[out] model - model.
+ */
+void modelInit(Model *model);
+
+/**
+ * @brief Zwalnia pamięć modelu.
+ *
+ * @param[in, out] model - model.
+ */
+void modelClear(Model *model);
+
+/**
+ * @brief Zastępuje zawartość modelu kopią innego modelu.
+ *
+ * @param[in, out] target - model zastępowany;
+ * @param[in] source - model kopiowany.
+ */
+void modelAssign(Model *target, Model const *source);
+
+/**
+ * @brief Dodaje lub zastępuje przekierowanie.
+ *
+ * @param[in, out] model - model;
+ * @param[in] from - prefiks przekierowywany;
+ * @param[in] to - prefiks, na który prowadzi przekierowanie;
+ * @param[in] deadline - termin wygaśnięcia (0, jeśli nie wygasa).
+ */
+void modelAdd(Model *model, char const *from, char const *to,
+              size_t deadline);
+
+/**
+ * @brief Usuwa przekierowania z numerów o danym prefiksie.
+ *
+ * @param[in, out] model - model;
+ * @param[in] prefix - prefiks.
+ */
+void modelRemove(Model *model, char const *prefix);
+
+/**
+ * @brief Usuwa przekierowanie z danego numeru.
+ *
+ * @param[in, out] model - model;
+ * @param[in] from - numer.
+ */
+void modelErase(Model *model, char const *from);
+
+/**
+ * @brief Wyszukuje przekierowanie z danego numeru.
+ *
+ * @param[in] model - model;
+ * @param[in] from - numer.
+ * @return Prefiks, na który prowadzi przekierowanie, lub NULL.
+ */
+char const *modelFind(Model const *model, char const *from);
+
+/**
+ * @brief Wyznacza wynik phfwdGet.
+ *
+ * @param[in] model - model;
+ * @param[in] num - numer;
+ * @param[out] result - bufor na wynik (co najmniej 2 * MODEL_MAX_LENGTH + 1
+ *                      znaków).
+ */
+void modelGet(Model const *model, char const *num, char *result);
+
+/**
+ * @brief Wyznacza wynik phfwdReverse.
+ *
+ * @param[in] model - model;
+ * @param[in] num - numer.
+ * @return Posortowane numery bez powtórzeń.
+ */
+ModelNumbers modelReverse(Model const *model, char const *num);
+
+/**
+ * @brief Wyznacza wynik phfwdGetReverse.
+ *
+ * @param[in] model - model;
+ * @param[in] num - numer.
+ * @return Posortowane numery bez powtórzeń.
+ */
+ModelNumbers modelGetReverse(Model const *model, char const *num);
+
+/**
+ * @brief Wyznacza wynik phfwdResolve.
+ *
+ * @param[in] model - model;
+ * @param[in] num - numer;
+ * @param[in] maxHops - największa liczba przekierowań;
+ * @param[out] result - bufor na wynik (co najmniej 2 * MODEL_MAX_LENGTH + 1
+ *                      znaków).
+ * @return 1, jeśli wynikiem jest numer zapisany w @p result, 0, jeśli
+ *         wynikiem jest pusty ciąg, -1, jeśli numery łańcucha są zbyt długie,
+ *         by model mógł wyznaczyć wynik.
+ */
+int modelResolve(Model const *model, char const *num, size_t maxHops,
+                 char *result);
+
+/**
+ * @brief Usuwa przekierowania, których termin wygaśnięcia minął.
+ *
+ * @param[in, out] model - model;
+ * @param[in] clock - bieżący zegar;
+ * @param[out] expired - usunięte przekierowania (lub NULL).
+ * @return Liczba usuniętych przekierowań.
+ */
+size_t modelExpire(Model *model, size_t clock, Model *expired);
+
+/**
+ * @brief Zwalnia ciąg numerów.
+ *
+ * @param[in, out] numbers - ciąg numerów.
+ */
+void modelNumbersClear(ModelNumbers *numbers);
+
+#endif /* __MODEL_H__ */
@@ -0,0 +1,2302 @@
+/** @file phone_forward_test.c
+ * Testy różnicowe biblioteki przekierowań numerów telefonów.
+ *
+ * Test wykonuje losowe ciągi operacji jednocześnie na bibliotece i na
+ * naiwnym modelu (zob. model.h) i porównuje wyniki wszystkich zapytań.
+ * Pierwszy argument to lista trybów oddzielonych przecinkami, które
+ * włączają kolejne podsystemy:
+ * - @p hash, @p arena, @p pool – silnik lub alokator struktury;
+ * - @p cache, @p jump – pamięć podręczna wyników i tablica skoków;
+ * - @p big – dłuższe numery i dłuższe ciągi operacji;
+ * - @p shard – równoległa struktura podzielona na części;
+ * - @p log – replika odtwarzana z dziennika zmian;
+ * - @p history, @p expiry – zapytania o przeszłość i wygasanie;
+ * - @p clone, @p each, @p diff, @p compact – kopiowanie, przeglądanie,
+ *   porównywanie i kompaktowanie struktury (@p compact z @p expiry
+ *   sprawdza też kompaktowanie przy tysiącach oczekujących terminów);
+ * - @p overlay, @p store – scenariusze nakładek i współdzielonego magazynu
+ *   (zamiast scenariusza pojedynczej struktury).
+ *
+ * Drugi argument to liczba ziaren generatora liczb losowych. Przy
+ * niezgodności test wypisuje opis błędu i kończy się kodem 1.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "phone_forward.h"
+#include "phone_forward_query.h"
+#include "phone_forward_reverse.h"
+#include "phone_forward_tuning.h"
+#include "phone_forward_bulk.h"
+#include "phone_forward_changelog.h"
+#include "phone_forward_history.h"
+#include "phone_forward_expiry.h"
+#include "phone_forward_overlay.h"
+#include "phone_forward_store.h"
+#include "phone_forward_sharded.h"
+#include "phone_forward_frozen.h"
+#include "allocator.h"
+#include "node.h"
+#include "utils.h"
+#include "model.h"
+
+/**
+ * Rozmiar buforów na losowane numery (z zapasem na znaki za numerem).
+ */
+#define NUMBER_BUFFER 64
+
+/**
+ * Rozmiar buforów na wyniki modelu.
+ */
+#define RESULT_BUFFER (2 * MODEL_MAX_LENGTH + 1)
+
+/**
+ * Liczba operacji w jednym przebiegu scenariusza pojedynczej struktury.
+ */
+#define ITERATIONS 600
+
+/**
+ * Liczba operacji w jednym przebiegu w trybie @p big.
+ */
+#define BIG_ITERATIONS 6000
+
+/**
+ * @brief Tryby testu wybrane w argumentach programu.
+ */
+typedef struct Options {
+    /// Struktura korzysta z silnika tablicy haszującej.
+    bool hash;
+    /// Struktura korzysta z alokatora areny.
+    bool arena;
+    /// Struktura korzysta z alokatora puli.
+    bool pool;
+    /// Włączona pamięć podręczna wyników.
+    bool cache;
+    /// Włączona tablica skoków.
+    bool jump;
+    /// Dłuższe numery i ciągi operacji.
+    bool big;
+    /// Równoległa struktura podzielona na części.
+    bool shard;
+    /// Replika odtwarzana z dziennika zmian.
+    bool log;
+    /// Włączona historia.
+    bool history;
+    /// Przekierowania z terminem wygaśnięcia.
+    bool expiry;
+    /// Zamiana struktury na jej kopię.
+    bool clone;
+    /// Sprawdzanie phfwdForEach.
+    bool each;
+    /// Sprawdzanie phfwdDiff.
+    bool diff;
+    /// Kompaktowanie struktury.
+    bool compact;
+    /// Scenariusz nakładek.
+    bool overlay;
+    /// Scenariusz współdzielonego magazynu.
+    bool store;
+} Options;
+
+/**
+ * @brief Kształt losowanych numerów.
+ */
+typedef struct Shape {
+    /// Liczba różnych cyfr (od 2 do 12).
+    size_t alphabet;
+    /// Największa długość numeru.
+    size_t maxLength;
+} Shape;
+
+/**
+ * @brief Rodzaj operacji zapisanej w dzienniku testu.
+ */
+typedef enum OperationKind {
+    /// Dodanie przekierowania.
+    OPERATION_ADD,
+    /// Usunięcie przekierowań o danym prefiksie.
+    OPERATION_REMOVE,
+    /// Wygaśnięcie pojedynczego przekierowania.
+    OPERATION_EXPIRE
+} OperationKind;
+
+/**
+ * @brief Operacja zapisana w dzienniku testu.
+ */
+typedef struct Operation {
+    /// Rodzaj operacji.
+    OperationKind kind;
+    /// Numer, którego dotyczy operacja.
+    char from[NUMBER_BUFFER];
+    /// Numer docelowy przekierowania (tylko dla dodania).
+    char to[NUMBER_BUFFER];
+    /// Czas struktury po wykonaniu operacji.
+    size_t time;
+} Operation;
+
+/**
+ * @brief Przedział czasów, w których stan modelu nie jest znany.
+ */
+typedef struct Interval {
+    /// Początek przedziału (stan znany).
+    size_t begin;
+    /// Koniec przedziału (stan znany).
+    size_t end;
+} Interval;
+
+/**
+ * @brief Bufor na zakodowane zmiany z dziennika.
+ */
+typedef struct Buffer {
+    /// Dane.
+    unsigned char *data;
+    /// Liczba bajtów danych.
+    size_t size;
+    /// Pojemność bufora.
+    size_t capacity;
+} Buffer;
+
+/**
+ * @brief Stan scenariusza pojedynczej struktury.
+ */
+typedef struct Test {
+    /// Tryby testu.
+    Options const *options;
+    /// Kształt numerów.
+    Shape shape;
+    /// Numer bieżącej operacji.
+    size_t iteration;
+
+    /// Testowana struktura.
+    PhoneForward *pf;
+    /// Alokator struktury (NULL dla domyślnego).
+    PhfwdAllocator *alloc;
+    /// Model struktury.
+    Model model;
+
+    /// Struktura podzielona na części (NULL, jeśli wyłączona).
+    PhfwdSharded *sharded;
+
+    /// Replika odtwarzana z dziennika zmian (NULL, jeśli jeszcze nie ma).
+    PhoneForward *replica;
+    /// Czas struktury, do którego odtworzona jest replika.
+    size_t replicaTime;
+    /// Bufor na zmiany przekazywane replice.
+    Buffer changes;
+
+    /// Bieżący zegar (dla przekierowań z terminem wygaśnięcia).
+    size_t clock;
+
+    /// Dziennik operacji (dla historii).
+    Operation *operations;
+    /// Liczba operacji w dzienniku.
+    size_t operationCount;
+    /// Pojemność dziennika.
+    size_t operationCapacity;
+    /// Przedziały czasów, w których wygasło kilka przekierowań naraz.
+    Interval *intervals;
+    /// Liczba przedziałów.
+    size_t intervalCount;
+    /// Pojemność tablicy przedziałów.
+    size_t intervalCapacity;
+
+    /// Zapamiętana kopia struktury (dla phfwdDiff).
+    PhoneForward *snapshot;
+    /// Model zapamiętanej kopii.
+    Model snapshotModel;
+} Test;
+
+/**
+ * @brief Zestaw zapytań o źródło przekierowań.
+ *
+ * Pozwala sprawdzać tym samym kodem strukturę, jej zamrożoną kopię,
+ * strukturę podzieloną na części, nakładkę i tabelę magazynu. Brakujące
+ * zapytania mają wartość NULL.
+ */
+typedef struct Queries {
+    /// Nazwa źródła (w komunikatach o błędach).
+    char const *name;
+    /// Odpowiednik phfwdGet.
+    PhoneNumbers * (*get)(void const *source, char const *num);
+    /// Odpowiednik phfwdReverse.
+    PhoneNumbers * (*reverse)(void const *source, char const *num);
+    /// Odpowiednik phfwdGetReverse.
+    PhoneNumbers * (*getReverse)(void const *source, char const *num);
+} Queries;
+
+/**
+ * @brief Struktura w ustalonej chwili historii.
+ */
+typedef struct HistoryPoint {
+    /// Struktura.
+    PhoneForward const *pf;
+    /// Czas.
+    size_t time;
+} HistoryPoint;
+
+/**
+ * @brief Kontekst zbierający wyniki phfwdForEach.
+ */
+typedef struct EachContext {
+    /// Zebrane przekierowania.
+    Model collected;
+    /// Liczba wywołań funkcji zwrotnej.
+    size_t calls;
+    /// Numer wywołania, w którym należy przerwać (SIZE_MAX, jeśli żadne).
+    size_t stop;
+} EachContext;
+
+/**
+ * @brief Różnica zgłoszona przez phfwdDiff.
+ */
+typedef struct DiffEntry {
+    /// Numer przekierowywany.
+    char num[NUMBER_BUFFER];
+    /// Przekierowanie w pierwszej strukturze (pusty napis, jeśli nie ma).
+    char before[NUMBER_BUFFER];
+    /// Przekierowanie w drugiej strukturze (pusty napis, jeśli nie ma).
+    char after[NUMBER_BUFFER];
+} DiffEntry;
+
+/**
+ * @brief Kontekst zbierający wyniki phfwdDiff.
+ */
+typedef struct DiffContext {
+    /// Zebrane różnice.
+    DiffEntry *entries;
+    /// Liczba różnic.
+    size_t count;
+    /// Pojemność tablicy różnic.
+    size_t capacity;
+} DiffContext;
+
+/**
+ * Stan generatora liczb losowych.
+ */
+static uint64_t randomState;
+
+/**
+ * @brief Ustawia ziarno generatora liczb losowych.
+ *
+ * @param[in] seed - ziarno.
+ */
+static void randomSeed(uint64_t seed) {
+    randomState = seed * UINT64_C(0x9E3779B97F4A7C15) + 1;
+}
+
+/**
+ * @brief Losuje liczbę (xorshift64*).
+ *
+ * @param[in] bound - ograniczenie (dodatnie).
+ * @return Liczba z przedziału [0, @p bound).
+ */
+static size_t randomBelow(size_t bound) {
+    randomState ^= randomState >> 12;
+    randomState ^= randomState << 25;
+    randomState ^= randomState >> 27;
+
+    return (size_t) ((randomState * UINT64_C(0x2545F4914F6CDD1D)) >> 11)
+           % bound;
+}
+
+/**
+ * @brief Wypisuje komunikat o niezgodności i kończy program.
+ *
+ * @param[in] format - format komunikatu (jak w printf).
+ */
+static void fail(char const *format, ...) {
+    va_list arguments;
+
+    va_start(arguments, format);
+    fprintf(stderr, "phone_forward_test: ");
+    vfprintf(stderr, format, arguments);
+    fprintf(stderr, "\n");
+    va_end(arguments);
+
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Zapewnia miejsce na kolejny element tablicy.
+ *
+ * @param[in] array - tablica (NULL, jeśli pusta);
+ * @param[in, out] capacity - pojemność tablicy;
+ * @param[in] count - liczba elementów tablicy;
+ * @param[in] size - rozmiar elementu.
+ * @return Tablica o pojemności większej niż @p count.
+ */
+static void *reserveNext(void *array, size_t *capacity, size_t count,
+                         size_t size) {
+    if (count < *capacity) {
+        return array;
+    }
+
+    *capacity = (*capacity == 0 ? 16 : 2 * *capacity);
+    array = realloc(array, *capacity * size);
+    if (array == NULL) {
+        abort();
+    }
+
+    return array;
+}
+
+/**
+ * @brief Losuje numer.
+ *
+ * @param[out] buffer - bufor na numer;
+ * @param[in] shape - kształt numeru;
+ * @param[in] maxLength - największa długość numeru.
+ */
+static void randomNumber(char *buffer, Shape shape, size_t maxLength) {
+    size_t length = 1 + randomBelow(maxLength);
+
+    for (size_t i = 0; i < length; ++i) {
+        buffer[i] = toChar((int) randomBelow(shape.alphabet));
+    }
+
+    buffer[length] = '\0';
+}
+
+/**
+ * @brief Sprawdza ciąg numerów z biblioteki z wynikiem modelu i zwalnia oba.
+ *
+ * @param[in] pnum - ciąg numerów z biblioteki;
+ * @param[in, out] expected - wynik modelu;
+ * @param[in] what - nazwa zapytania;
+ * @param[in] num - numer, którego dotyczyło zapytanie.
+ */
+static void checkNumbers(PhoneNumbers *pnum, ModelNumbers *expected,
+                         char const *what, char const *num) {
+    if (pnum == NULL) {
+        fail("%s(%s): NULL", what, num);
+    }
+
+    for (size_t i = 0; i < expected->count; ++i) {
+        char const *got = phnumGet(pnum, i);
+
+        if (got == NULL || strcmp(got, expected->numbers[i]) != 0) {
+            fail("%s(%s): index %zu got %s want %s", what, num, i,
+                 got == NULL ? "NULL" : got, expected->numbers[i]);
+        }
+    }
+
+    if (phnumGet(pnum, expected->count) != NULL) {
+        fail("%s(%s): extra %s", what, num,
+             phnumGet(pnum, expected->count));
+    }
+
+    phnumDelete(pnum);
+    modelNumbersClear(expected);
+}
+
+/**
+ * @brief Sprawdza wynik phfwdGet z wynikiem modelu i zwalnia go.
+ *
+ * @param[in] pnum - ciąg numerów z biblioteki;
+ * @param[in] model - model;
+ * @param[in] what - nazwa zapytania;
+ * @param[in] num - numer, którego dotyczyło zapytanie.
+ */
+static void checkGet(PhoneNumbers *pnum, Model const *model,
+                     char const *what, char const *num) {
+    char expected[RESULT_BUFFER];
+
+    modelGet(model, num, expected);
+    if (pnum == NULL) {
+        fail("%s(%s): NULL", what, num);
+    }
+
+    char const *got = phnumGet(pnum, 0);
+    if (got == NULL || strcmp(got, expected) != 0
+        || phnumGet(pnum, 1) != NULL) {
+        fail("%s(%s): got %s want %s", what, num,
+             got == NULL ? "NULL" : got, expected);
+    }
+
+    phnumDelete(pnum);
+}
+
+/**
+ * @brief Porównuje zapytania o losowe numery z wynikami modelu.
+ *
+ * @param[in] queries - zapytania;
+ * @param[in] source - źródło przekierowań;
+ * @param[in] model - model źródła;
+ * @param[in] shape - kształt numerów;
+ * @param[in] count - liczba numerów.
+ */
+static void checkQueries(Queries const *queries, void const *source,
+                         Model const *model, Shape shape, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        char num[NUMBER_BUFFER];
+        ModelNumbers expected;
+
+        randomNumber(num, shape, shape.maxLength + 1);
+        checkGet(queries->get(source, num), model, queries->name, num);
+
+        if (queries->reverse != NULL) {
+            expected = modelReverse(model, num);
+            checkNumbers(queries->reverse(source, num), &expected,
+                         queries->name, num);
+        }
+
+        if (queries->getReverse != NULL) {
+            expected = modelGetReverse(model, num);
+            checkNumbers(queries->getReverse(source, num), &expected,
+                         queries->name, num);
+        }
+    }
+}
+
+/**
+ * @brief phfwdGet dla zestawu zapytań.
+ *
+ * @param[in] source - struktura;
+ * @param[in] num - numer.
+ * @return Wynik zapytania.
+ */
+static PhoneNumbers *tableGet(void const *source, char const *num) {
+    return phfwdGet(source, num);
+}
+
+/**
+ * @brief phfwdReverse dla zestawu zapytań.
+ *
+ * @param[in] source - struktura;
+ * @param[in] num - numer.
+ * @return Wynik zapytania.
+ */
+static PhoneNumbers *tableReverse(void const *source, char const *num) {
+    return phfwdReverse(source, num);
+}
+
+/**
+ * @brief phfwdGetReverse dla zestawu zapytań.
+ *
+ * @param[in] source - struktura;
+ * @param[in] num - numer.
+ * @return Wynik zapytania.
+ */
+static PhoneNumbers *tableGetReverse(void const *source, char const *num) {
+    return phfwdGetReverse(source, num);
+}
+
+/**
+ * Zapytania o strukturę.
+ */
+static Queries const tableQueries = {
+    "table", tableGet, tableReverse, tableGetReverse
+};
+
+/**
+ * Zapytania o replikę odtworzoną z dziennika zmian.
+ */
+static Queries const replicaQueries = {
+    "replica", tableGet, tableReverse, tableGetReverse
+};
+
+/**
+ * Zapytania o strukturę wyeksportowaną z magazynu.
+ */
+static Queries const exportQueries = {
+    "export", tableGet, tableReverse, tableGetReverse
+};
+
+/**
+ * @brief phfwdFrozenGet dla zestawu zapytań.
+ *
+ * @param[in] source - zamrożona kopia struktury;
+ * @param[in] num - numer.
+ * @return Wynik zapytania.
+ */
+static PhoneNumbers *frozenGet(void const *source, char const *num) {
+    return phfwdFrozenGet(source, num);
+}
+
+/**
+ * @brief phfwdFrozenReverse dla zestawu zapytań.
+ *
+ * @param[in] source - zamrożona kopia struktury;
+ * @param[in] num - numer.
+ * @return Wynik zapytania.
+ */
+static PhoneNumbers *frozenReverse(void const *source, char const *num) {
+    return phfwdFrozenReverse(source, num);
+}
+
+/**
+ * @brief phfwdFrozenGetReverse dla zestawu zapytań.
+ *
+ * @param[in] source - zamrożona kopia struktury;
+ * @param[in] num - numer.
+ * @return Wynik zapytania.
+ */
+static PhoneNumbers *frozenGetReverse(void const *source, char const *num) {
+    return phfwdFrozenGetReverse(source, num);
+}
+
+/**
+ * Zapytania o zamrożoną kopię struktury.
+ */
+static Queries const frozenQueries = {
+    "frozen", frozenGet, frozenReverse, frozenGetReverse
+};
+
+/**
+ * @brief phfwdShardedGet dla zestawu zapytań.
+ *
+ * @param[in] source - struktura podzielona na części;
+ * @param[in] num - numer.
+ * @return Wynik zapytania.
+ */
+static PhoneNumbers *shardedGet(void const *source, char const *num) {
+    return phfwdShardedGet((PhfwdSharded *) source, num);
+}
+
+/**
+ * @brief phfwdShardedReverse dla zestawu zapytań.
+ *
+ * @param[in] source - struktura podzielona na części;
+ * @param[in] num - numer.
+ * @return Wynik zapytania.
+ */
+static PhoneNumbers *shardedReverse(void const *source, char const *num) {
+    return phfwdShardedReverse((PhfwdSharded *) source, num);
+}
+
+/**
+ * @brief phfwdShardedGetReverse dla zestawu zapytań.
+ *
+ * @param[in] source - struktura podzielona na części;
+ * @param[in] num - numer.
+ * @return Wynik zapytania.
+ */
+static PhoneNumbers *shardedGetReverse(void const *source, char const *num) {
+    return phfwdShardedGetReverse((PhfwdSharded *) source, num);
+}
+
+/**
+ * Zapytania o strukturę podzieloną na części.
+ */
+static Queries const shardedQueries = {
+    "sharded", shardedGet, shardedReverse, shardedGetReverse
+};
+
+/**
+ * @brief phfwdGetAt dla zestawu zapytań.
+ *
+ * @param[in] source - struktura w ustalonej chwili (HistoryPoint);
+ * @param[in] num - numer.
+ * @return Wynik zapytania.
+ */
+static PhoneNumbers *historyGet(void const *source, char const *num) {
+    HistoryPoint const *point = source;
+
+    return phfwdGetAt(point->pf, num, point->time);
+}
+
+/**
+ * @brief phfwdReverseAt dla zestawu zapytań.
+ *
+ * @param[in] source - struktura w ustalonej chwili (HistoryPoint);
+ * @param[in] num - numer.
+ * @return Wynik zapytania.
+ */
+static PhoneNumbers *historyReverse(void const *source, char const *num) {
+    HistoryPoint const *point = source;
+
+    return phfwdReverseAt(point->pf, num, point->time);
+}
+
+/**
+ * Zapytania o przeszły stan struktury.
+ */
+static Queries const historyQueries = {
+    "history", historyGet, historyReverse, NULL
+};
+
+/**
+ * @brief phfwdOverlayGet dla zestawu zapytań.
+ *
+ * @param[in] source - nakładka;
+ * @param[in] num - numer.
+ * @return Wynik zapytania.
+ */
+static PhoneNumbers *overlayGet(void const *source, char const *num) {
+    return phfwdOverlayGet(source, num);
+}
+
+/**
+ * @brief phfwdOverlayReverse dla zestawu zapytań.
+ *
+ * @param[in] source - nakładka;
+ * @param[in] num - numer.
+ * @return Wynik zapytania.
+ */
+static PhoneNumbers *overlayReverse(void const *source, char const *num) {
+    return phfwdOverlayReverse(source, num);
+}
+
+/**
+ * @brief phfwdOverlayGetReverse dla zestawu zapytań.
+ *
+ * @param[in] source - nakładka;
+ * @param[in] num - numer.
+ * @return Wynik zapytania.
+ */
+static PhoneNumbers *overlayGetReverse(void const *source, char const *num) {
+    return phfwdOverlayGetReverse(source, num);
+}
+
+/**
+ * Zapytania o nakładkę.
+ */
+static Queries const overlayQueries = {
+    "overlay", overlayGet, overlayReverse, overlayGetReverse
+};
+
+/**
+ * @brief phfwdStoreGet dla zestawu zapytań.
+ *
+ * @param[in] source - tabela magazynu;
+ * @param[in] num - numer.
+ * @return Wynik zapytania.
+ */
+static PhoneNumbers *storeGet(void const *source, char const *num) {
+    return phfwdStoreGet(source, num);
+}
+
+/**
+ * Zapytania o tabelę magazynu.
+ */
+static Queries const storeQueries = {
+    "store", storeGet, NULL, NULL
+};
+
+/**
+ * @brief Tworzy strukturę zgodnie z trybami testu.
+ *
+ * @param[in] options - tryby testu;
+ * @param[out] alloc - alokator struktury (NULL dla domyślnego).
+ * @return Nowa struktura.
+ */
+static PhoneForward *newTable(Options const *options, PhfwdAllocator **alloc) {
+    PhoneForward *pf;
+
+    *alloc = NULL;
+    if (options->hash) {
+        pf = phfwdNewWithEngine(PHFWD_ENGINE_HASH);
+    }
+    else if (options->arena || options->pool) {
+        *alloc = (options->arena ? phfwdArenaNew(4096) : phfwdPoolNew(0));
+        pf = phfwdNewWithAllocator(*alloc);
+    }
+    else {
+        pf = phfwdNew();
+    }
+
+    if (pf == NULL) {
+        fail("new: NULL");
+    }
+
+    if (options->cache && !phfwdEnableCache(pf, 16)) {
+        fail("enable cache");
+    }
+
+    if (options->jump && !phfwdEnableJumpTable(pf, 3)) {
+        fail("enable jump table");
+    }
+
+    return pf;
+}
+
+/**
+ * @brief Usuwa strukturę i jej alokator.
+ *
+ * @param[in] pf - struktura;
+ * @param[in] alloc - alokator struktury (NULL dla domyślnego).
+ * @param[in] options - tryby testu.
+ */
+static void deleteTable(PhoneForward *pf, PhfwdAllocator *alloc,
+                        Options const *options) {
+    phfwdDelete(pf);
+
+    if (alloc != NULL && options->arena) {
+        phfwdArenaDelete(alloc);
+    }
+    else if (alloc != NULL) {
+        phfwdPoolDelete(alloc);
+    }
+}
+
+/**
+ * @brief Zapisuje operację w dzienniku testu.
+ *
+ * @param[in, out] test - stan testu;
+ * @param[in] kind - rodzaj operacji;
+ * @param[in] from - numer, którego dotyczy operacja;
+ * @param[in] to - numer docelowy (NULL, jeśli nie dotyczy);
+ * @param[in] time - czas struktury po operacji.
+ */
+static void logOperation(Test *test, OperationKind kind, char const *from,
+                         char const *to, size_t time) {
+    test->operations = reserveNext(test->operations,
+                                   &test->operationCapacity,
+                                   test->operationCount, sizeof(Operation));
+
+    Operation *operation = &test->operations[test->operationCount++];
+    operation->kind = kind;
+    strcpy(operation->from, from);
+    strcpy(operation->to, (to == NULL ? "" : to));
+    operation->time = time;
+}
+
+/**
+ * @brief Odtwarza model w danej chwili z dziennika testu.
+ *
+ * @param[in] test - stan testu;
+ * @param[in] time - czas;
+ * @param[out] model - odtworzony model (zainicjowany).
+ */
+static void modelAt(Test const *test, size_t time, Model *model) {
+    model->count = 0;
+
+    for (size_t i = 0; i < test->operationCount; ++i) {
+        Operation const *operation = &test->operations[i];
+
+        if (operation->time > time) {
+            break;
+        }
+
+        switch (operation->kind) {
+            case OPERATION_ADD:
+                modelAdd(model, operation->from, operation->to, 0);
+                break;
+            case OPERATION_REMOVE:
+                modelRemove(model, operation->from);
+                break;
+            case OPERATION_EXPIRE:
+                modelErase(model, operation->from);
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Dodaje przekierowanie do struktury i do modelu.
+ *
+ * @param[in, out] test - stan testu;
+ * @param[in] num1 - numer przekierowywany;
+ * @param[in] num2 - numer docelowy.
+ */
+static void testAdd(Test *test, char const *num1, char const *num2) {
+    bool expected = strcmp(num1, num2) != 0;
+    size_t deadline = 0;
+
+    if (test->options->expiry && test->sharded == NULL
+        && randomBelow(2) == 0) {
+        deadline = test->clock + 1 + (randomBelow(8) != 0
+                                      ? randomBelow(50)
+                                      : (size_t) 1 << randomBelow(40));
+    }
+
+    bool added = (deadline != 0
+                  ? phfwdAddWithExpiry(test->pf, num1, num2, deadline)
+                  : phfwdAdd(test->pf, num1, num2));
+    if (added != expected) {
+        fail("add(%s, %s): got %d", num1, num2, added);
+    }
+
+    if (!expected) {
+        return;
+    }
+
+    modelAdd(&test->model, num1, num2, deadline);
+
+    if (test->options->history) {
+        logOperation(test, OPERATION_ADD, num1, num2, phfwdTime(test->pf));
+    }
+
+    if (test->sharded != NULL
+        && phfwdShardedAdd(test->sharded, num1, num2) != expected) {
+        fail("sharded add(%s, %s)", num1, num2);
+    }
+}
+
+/**
+ * @brief Usuwa przekierowania ze struktury i z modelu.
+ *
+ * @param[in, out] test - stan testu;
+ * @param[in] num - prefiks usuwanych numerów.
+ */
+static void testRemove(Test *test, char const *num) {
+    phfwdRemove(test->pf, num);
+    modelRemove(&test->model, num);
+
+    if (test->options->history) {
+        logOperation(test, OPERATION_REMOVE, num, NULL, phfwdTime(test->pf));
+    }
+
+    if (test->sharded != NULL) {
+        phfwdShardedRemove(test->sharded, num);
+    }
+}
+
+/**
+ * @brief Sprawdza phfwdGet, phfwdGetInto i phfwdResolve.
+ *
+ * @param[in, out] test - stan testu;
+ * @param[in] num - numer.
+ */
+static void testGet(Test *test, char const *num) {
+    char expected[RESULT_BUFFER];
+    char buffer[RESULT_BUFFER];
+    char padded[NUMBER_BUFFER];
+    size_t length = strlen(num);
+
+    checkGet(phfwdGet(test->pf, num), &test->model, "get", num);
+
+    // Znaki za numerem nie mogą wpływać na wynik.
+    memset(padded, 'x', sizeof padded);
+    memcpy(padded, num, length);
+    if (randomBelow(4) != 0) {
+        padded[length] = '\0';
+    }
+    else {
+        padded[length] = '5';
+    }
+
+    size_t size = (randomBelow(2) == 0 ? sizeof buffer : randomBelow(12));
+    size_t result = phfwdGetInto(test->pf, padded, length, buffer, size);
+
+    modelGet(&test->model, num, expected);
+    if (result != strlen(expected)
+        || (size > 0 && strncmp(buffer, expected, size - 1) != 0)
+        || (size > 0 && buffer[min(result, size - 1)] != '\0')) {
+        fail("getInto(%s, %zu): got %zu want %s", num, size, result,
+             expected);
+    }
+
+    size_t maxHops = randomBelow(12);
+    if (randomBelow(3) == 0) {
+        maxHops = (randomBelow(2) == 0 ? 300 : SIZE_MAX);
+    }
+
+    int status = modelResolve(&test->model, num, maxHops, buffer);
+    PhoneNumbers *pnum = phfwdResolve(test->pf, num, maxHops);
+
+    if (status >= 0) {
+        char const *got = (pnum == NULL ? NULL : phnumGet(pnum, 0));
+
+        if (pnum == NULL
+            || (status == 1 && (got == NULL || strcmp(got, buffer) != 0))
+            || phnumGet(pnum, (size_t) status) != NULL) {
+            fail("resolve(%s, %zu): got %s want %s", num, maxHops,
+                 got == NULL ? "NULL" : got, status == 1 ? buffer : "");
+        }
+    }
+
+    phnumDelete(pnum);
+}
+
+/**
+ * @brief Sprawdza phfwdReverse lub phfwdReverseRange.
+ *
+ * @param[in] test - stan testu;
+ * @param[in] num - numer.
+ */
+static void testReverse(Test const *test, char const *num) {
+    ModelNumbers expected = modelReverse(&test->model, num);
+
+    if (randomBelow(2) == 0) {
+        checkNumbers(phfwdReverse(test->pf, num), &expected, "reverse", num);
+        return;
+    }
+
+    char after[NUMBER_BUFFER];
+    if (expected.count > 0 && randomBelow(2) == 0) {
+        strcpy(after, expected.numbers[randomBelow(expected.count)]);
+    }
+    else {
+        randomNumber(after, test->shape, test->shape.maxLength + 1);
+    }
+
+    size_t limit = randomBelow(5);
+    size_t kept = 0;
+    for (size_t i = 0; i < expected.count; ++i) {
+        if (modelCompare(expected.numbers[i], after) > 0 && kept < limit) {
+            expected.numbers[kept++] = expected.numbers[i];
+        }
+        else {
+            free(expected.numbers[i]);
+        }
+    }
+
+    expected.count = kept;
+    checkNumbers(phfwdReverseRange(test->pf, num, after, limit), &expected,
+                 "reverseRange", num);
+}
+
+/**
+ * @brief Sprawdza kursor przekierowań wstecz.
+ *
+ * @param[in] test - stan testu;
+ * @param[in] num - numer.
+ */
+static void testCursor(Test const *test, char const *num) {
+    ModelNumbers expected = modelReverse(&test->model, num);
+    PhfwdReverseCursor *cursor;
+    size_t first = 0;
+
+    if (randomBelow(2) == 0) {
+        cursor = phfwdReverseOpen(test->pf, num);
+    }
+    else {
+        char after[NUMBER_BUFFER];
+
+        randomNumber(after, test->shape, test->shape.maxLength + 1);
+        while (first < expected.count
+               && modelCompare(expected.numbers[first], after) <= 0) {
+            first++;
+        }
+
+        cursor = phfwdReverseOpenAfter(test->pf, num, after);
+    }
+
+    if (cursor == NULL) {
+        fail("cursor(%s): NULL", num);
+    }
+
+    char const *got;
+    size_t i = first;
+    while ((got = phfwdReverseNext(cursor)) != NULL) {
+        if (i >= expected.count || strcmp(got, expected.numbers[i]) != 0) {
+            fail("cursor(%s): index %zu got %s", num, i, got);
+        }
+
+        i++;
+    }
+
+    if (i != expected.count) {
+        fail("cursor(%s): got %zu want %zu", num, i, expected.count);
+    }
+
+    phfwdReverseClose(cursor);
+    modelNumbersClear(&expected);
+}
+
+/**
+ * @brief Sprawdza phfwdGetReverse i liczniki przekierowań wstecz.
+ *
+ * @param[in] test - stan testu;
+ * @param[in] num - numer.
+ */
+static void testGetReverse(Test const *test, char const *num) {
+    ModelNumbers expected = modelGetReverse(&test->model, num);
+
+    if (phfwdGetReverseCount(test->pf, num) != expected.count) {
+        fail("getReverseCount(%s): got %zu want %zu", num,
+             phfwdGetReverseCount(test->pf, num), expected.count);
+    }
+
+    checkNumbers(phfwdGetReverse(test->pf, num), &expected, "getReverse",
+                 num);
+
+    expected = modelReverse(&test->model, num);
+    if (phfwdReverseCount(test->pf, num) != expected.count) {
+        fail("reverseCount(%s): got %zu want %zu", num,
+             phfwdReverseCount(test->pf, num), expected.count);
+    }
+
+    modelNumbersClear(&expected);
+}
+
+/**
+ * @brief Dopisuje zmiany z dziennika do bufora.
+ *
+ * @param[in, out] context - bufor (Buffer);
+ * @param[in] data - zakodowane zmiany;
+ * @param[in] size - liczba bajtów zmian.
+ * @return Wartość @p true.
+ */
+static bool collectChanges(void *context, void const *data, size_t size) {
+    Buffer *buffer = context;
+
+    if (buffer->size + size > buffer->capacity) {
+        buffer->capacity = 2 * (buffer->size + size);
+        buffer->data = realloc(buffer->data, buffer->capacity);
+        if (buffer->data == NULL) {
+            abort();
+        }
+    }
+
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+
+    return true;
+}
+
+/**
+ * @brief Odtwarza replikę z dziennika zmian i porównuje ją z modelem.
+ *
+ * Jeśli dziennik nie zawiera już potrzebnych zmian, replika jest budowana
+ * od nowa. Zmiany są stosowane trzykrotnie, by sprawdzić, że ponowne
+ * zastosowanie niczego nie zmienia.
+ *
+ * @param[in, out] test - stan testu.
+ */
+static void checkReplica(Test *test) {
+    if (test->replica == NULL) {
+        test->replica = phfwdNew();
+        test->replicaTime = 0;
+        if (!phfwdChangeLogEnable(test->pf, 64)) {
+            fail("changeLogEnable");
+        }
+    }
+
+    test->changes.size = 0;
+    if (!phfwdChangesSince(test->pf, test->replicaTime, collectChanges,
+                           &test->changes)) {
+        phfwdDelete(test->replica);
+        test->replica = phfwdNew();
+        for (size_t i = 0; i < test->model.count; ++i) {
+            phfwdAdd(test->replica, test->model.forwards[i].from,
+                     test->model.forwards[i].to);
+        }
+
+        test->replicaTime = phfwdTime(test->pf);
+    }
+    else {
+        size_t begin = test->replicaTime;
+
+        for (int repeat = 0; repeat < 3; ++repeat) {
+            test->replicaTime = begin;
+            if (!phfwdApplyChanges(test->replica, test->changes.data,
+                                   test->changes.size, &test->replicaTime)) {
+                fail("applyChanges");
+            }
+        }
+
+        if (test->replicaTime != phfwdTime(test->pf)) {
+            fail("applyChanges: time %zu want %zu", test->replicaTime,
+                 phfwdTime(test->pf));
+        }
+    }
+
+    checkQueries(&replicaQueries, test->replica, &test->model, test->shape,
+                 30);
+}
+
+/**
+ * @brief Przesuwa zegar i sprawdza wygaśnięcie przekierowań.
+ *
+ * @param[in, out] test - stan testu.
+ */
+static void advanceClock(Test *test) {
+    size_t clock = test->clock + (randomBelow(4) != 0
+                                  ? randomBelow(20)
+                                  : (size_t) 1 << randomBelow(42));
+
+    if (test->clock > 0 && phfwdAdvanceClock(test->pf, test->clock - 1)) {
+        fail("advanceClock: clock moved back");
+    }
+
+    size_t before = phfwdTime(test->pf);
+    if (!phfwdAdvanceClock(test->pf, clock) || phfwdClock(test->pf) != clock) {
+        fail("advanceClock(%zu)", clock);
+    }
+
+    test->clock = clock;
+
+    size_t after = phfwdTime(test->pf);
+    Model expired;
+    modelInit(&expired);
+    size_t count = modelExpire(&test->model, clock, &expired);
+
+    if (after - before != count) {
+        fail("advanceClock(%zu): expired %zu want %zu", clock,
+             after - before, count);
+    }
+
+    if (test->options->history) {
+        for (size_t i = 0; i < expired.count; ++i) {
+            logOperation(test, OPERATION_EXPIRE, expired.forwards[i].from,
+                         NULL, after);
+        }
+    }
+
+    // Kolejność wygaśnięć w jednym przesunięciu zegara nie jest określona,
+    // więc stany pośrednie nie są sprawdzane.
+    if (count > 1) {
+        test->intervals = reserveNext(test->intervals,
+                                      &test->intervalCapacity,
+                                      test->intervalCount, sizeof(Interval));
+        test->intervals[test->intervalCount].begin = before;
+        test->intervals[test->intervalCount].end = after;
+        test->intervalCount++;
+    }
+
+    modelClear(&expired);
+}
+
+/**
+ * @brief Porównuje przeszły stan struktury z modelem odtworzonym
+ * z dziennika testu.
+ *
+ * @param[in, out] test - stan testu.
+ */
+static void checkHistory(Test *test) {
+    size_t now = phfwdTime(test->pf);
+    size_t horizon = phfwdHistoryHorizon(test->pf);
+
+    if (horizon > now) {
+        fail("historyHorizon: %zu after %zu", horizon, now);
+    }
+
+    size_t time = horizon + randomBelow(now - horizon + 1);
+    if (randomBelow(3) == 0 && now > horizon) {
+        time = now - 1 - randomBelow(min(now - horizon, 4));
+    }
+
+    for (size_t i = 0; i < test->intervalCount; ++i) {
+        if (time > test->intervals[i].begin
+            && time < test->intervals[i].end) {
+            time = test->intervals[i].end;
+        }
+    }
+
+    Model past;
+    modelInit(&past);
+    modelAt(test, time, &past);
+
+    HistoryPoint point = {test->pf, time};
+    checkQueries(&historyQueries, &point, &past, test->shape,
+                 test->options->big ? 6 : 15);
+    modelClear(&past);
+
+    if (horizon > 0) {
+        PhoneNumbers *pnum = phfwdGetAt(test->pf, "0", horizon - 1);
+
+        if (pnum == NULL || phnumGet(pnum, 0) != NULL) {
+            fail("getAt before horizon");
+        }
+
+        phnumDelete(pnum);
+    }
+
+    if (randomBelow(6) == 0) {
+        size_t newHorizon = horizon + randomBelow(now - horizon + 1);
+
+        phfwdPruneHistory(test->pf, newHorizon);
+        if (phfwdHistoryHorizon(test->pf) != newHorizon) {
+            fail("pruneHistory(%zu)", newHorizon);
+        }
+    }
+}
+
+/**
+ * @brief Zastępuje strukturę jej kopią.
+ *
+ * Przed usunięciem oryginał jest modyfikowany, co nie może wpłynąć
+ * na kopię.
+ *
+ * @param[in, out] test - stan testu.
+ */
+static void swapClone(Test *test) {
+    PhoneForward *clone = phfwdClone(test->pf);
+
+    if (clone == NULL) {
+        fail("clone: NULL");
+    }
+
+    for (int i = 0; i < 20; ++i) {
+        char num1[NUMBER_BUFFER], num2[NUMBER_BUFFER];
+
+        randomNumber(num1, test->shape, test->shape.maxLength);
+        randomNumber(num2, test->shape, test->shape.maxLength);
+        if (randomBelow(3) != 0) {
+            phfwdAdd(test->pf, num1, num2);
+        }
+        else {
+            phfwdRemove(test->pf, num1);
+        }
+    }
+
+    if (test->options->expiry) {
+        phfwdAdvanceClock(test->pf, test->clock + 1000);
+    }
+
+    phfwdDelete(test->pf);
+    test->pf = clone;
+}
+
+/**
+ * @brief Zbiera przekierowania przekazywane przez phfwdForEach.
+ *
+ * @param[in, out] context - kontekst (EachContext);
+ * @param[in] num1 - numer przekierowywany;
+ * @param[in] num2 - numer docelowy.
+ * @return Wartość @p false, jeśli należy przerwać przeglądanie.
+ */
+static bool collectForward(void *context, char const *num1,
+                           char const *num2) {
+    EachContext *each = context;
+
+    if (each->calls++ == each->stop) {
+        return false;
+    }
+
+    if (strlen(num1) >= NUMBER_BUFFER || strlen(num2) >= NUMBER_BUFFER) {
+        fail("forEach: %s -> %s too long", num1, num2);
+    }
+
+    modelAdd(&each->collected, num1, num2, 0);
+
+    return true;
+}
+
+/**
+ * @brief Porównuje przekierowania według numerów przekierowywanych.
+ *
+ * @param[in] first - pierwsze przekierowanie;
+ * @param[in] second - drugie przekierowanie.
+ * @return Wynik @ref modelCompare.
+ */
+static int compareForwards(void const *first, void const *second) {
+    return modelCompare(((ModelForward const *) first)->from,
+                        ((ModelForward const *) second)->from);
+}
+
+/**
+ * @brief Sprawdza phfwdForEach dla losowego prefiksu.
+ *
+ * @param[in] test - stan testu.
+ */
+static void checkForEach(Test const *test) {
+    char prefix[NUMBER_BUFFER] = "";
+    if (randomBelow(2) == 0) {
+        randomNumber(prefix, test->shape,
+                     1 + randomBelow(test->shape.maxLength));
+    }
+
+    Model expected;
+    modelInit(&expected);
+    for (size_t i = 0; i < test->model.count; ++i) {
+        ModelForward const *forward = &test->model.forwards[i];
+
+        if (strncmp(prefix, forward->from, strlen(prefix)) == 0) {
+            modelAdd(&expected, forward->from, forward->to, 0);
+        }
+    }
+
+    if (expected.count > 0) {
+        qsort(expected.forwards, expected.count, sizeof(ModelForward),
+              compareForwards);
+    }
+
+    EachContext each = {{NULL, 0, 0}, 0, SIZE_MAX};
+    if (!phfwdForEach(test->pf, prefix, collectForward, &each)) {
+        fail("forEach(%s): false", prefix);
+    }
+
+    if (each.calls != expected.count
+        || each.collected.count != expected.count) {
+        fail("forEach(%s): got %zu want %zu", prefix, each.calls,
+             expected.count);
+    }
+
+    for (size_t i = 0; i < expected.count; ++i) {
+        ModelForward const *got = &each.collected.forwards[i];
+        ModelForward const *want = &expected.forwards[i];
+
+        if (strcmp(got->from, want->from) != 0
+            || strcmp(got->to, want->to) != 0) {
+            fail("forEach(%s): got %s -> %s want %s -> %s", prefix,
+                 got->from, got->to, want->from, want->to);
+        }
+    }
+
+    if (expected.count > 0) {
+        modelClear(&each.collected);
+        each.calls = 0;
+        each.stop = randomBelow(expected.count);
+
+        if (phfwdForEach(test->pf, prefix, collectForward, &each)
+            || each.calls != each.stop + 1) {
+            fail("forEach(%s): stop after %zu", prefix, each.stop);
+        }
+    }
+
+    if (phfwdForEach(test->pf, "1a", collectForward, &each)
+        || phfwdForEach(NULL, "", collectForward, &each)) {
+        fail("forEach: invalid arguments accepted");
+    }
+
+    modelClear(&each.collected);
+    modelClear(&expected);
+}
+
+/**
+ * @brief Zbiera różnice przekazywane przez phfwdDiff.
+ *
+ * @param[in, out] context - kontekst (DiffContext);
+ * @param[in] num - numer przekierowywany;
+ * @param[in] before - przekierowanie w pierwszej strukturze (lub NULL);
+ * @param[in] after - przekierowanie w drugiej strukturze (lub NULL).
+ * @return Wartość @p true.
+ */
+static bool collectDiff(void *context, char const *num, char const *before,
+                        char const *after) {
+    DiffContext *diff = context;
+
+    diff->entries = reserveNext(diff->entries, &diff->capacity, diff->count,
+                                sizeof(DiffEntry));
+
+    DiffEntry *entry = &diff->entries[diff->count++];
+    strcpy(entry->num, num);
+    strcpy(entry->before, (before == NULL ? "" : before));
+    strcpy(entry->after, (after == NULL ? "" : after));
+
+    return true;
+}
+
+/**
+ * @brief Porównuje numery wskazywane przez elementy tablicy.
+ *
+ * @param[in] first - wskaźnik na pierwszy element;
+ * @param[in] second - wskaźnik na drugi element.
+ * @return Wynik @ref modelCompare.
+ */
+static int compareKeys(void const *first, void const *second) {
+    return modelCompare(*(char const * const *) first,
+                        *(char const * const *) second);
+}
+
+/**
+ * @brief Porównuje wynik phfwdDiff z różnicą modeli.
+ *
+ * @param[in] first - pierwsza struktura;
+ * @param[in] firstModel - model pierwszej struktury;
+ * @param[in] second - druga struktura;
+ * @param[in] secondModel - model drugiej struktury;
+ * @param[in] what - nazwa porównania.
+ */
+static void checkDiffBetween(PhoneForward const *first,
+                             Model const *firstModel,
+                             PhoneForward const *second,
+                             Model const *secondModel, char const *what) {
+    size_t count = 0;
+    char const **keys = malloc((firstModel->count + secondModel->count + 1)
+                               * sizeof(char const *));
+    if (keys == NULL) {
+        abort();
+    }
+
+    for (size_t i = 0; i < firstModel->count; ++i) {
+        keys[count++] = firstModel->forwards[i].from;
+    }
+
+    for (size_t i = 0; i < secondModel->count; ++i) {
+        if (modelFind(firstModel, secondModel->forwards[i].from) == NULL) {
+            keys[count++] = secondModel->forwards[i].from;
+        }
+    }
+
+    qsort(keys, count, sizeof(char const *), compareKeys);
+
+    DiffContext diff = {NULL, 0, 0};
+    if (!phfwdDiff(first, second, collectDiff, &diff)) {
+        fail("diff %s: false", what);
+    }
+
+    size_t j = 0;
+    for (size_t i = 0; i < count; ++i) {
+        char const *before = modelFind(firstModel, keys[i]);
+        char const *after = modelFind(secondModel, keys[i]);
+
+        before = (before == NULL ? "" : before);
+        after = (after == NULL ? "" : after);
+        if (strcmp(before, after) == 0) {
+            continue;
+        }
+
+        if (j >= diff.count || strcmp(diff.entries[j].num, keys[i]) != 0
+            || strcmp(diff.entries[j].before, before) != 0
+            || strcmp(diff.entries[j].after, after) != 0) {
+            fail("diff %s: at %s want '%s' -> '%s'", what, keys[i], before,
+                 after);
+        }
+
+        j++;
+    }
+
+    if (j != diff.count) {
+        fail("diff %s: extra %s", what, diff.entries[j].num);
+    }
+
+    free(diff.entries);
+    free(keys);
+}
+
+/**
+ * @brief Wyszukuje wierzchołek reprezentujący numer.
+ *
+ * @param[in] root - korzeń drzewa;
+ * @param[in] num - numer.
+ * @return Wierzchołek lub NULL, jeśli nie istnieje.
+ */
+static Node const *findNode(Node const *root, char const *num) {
+    for (; *num != '\0' && root != NULL; num++) {
+        root = root->children[toInt(*num)];
+    }
+
+    return root;
+}
+
+/**
+ * @brief Sprawdza skróty zawartości wszystkich poddrzew struktury.
+ *
+ * Test białej skrzynki: skrót poddrzewa (zob. diff.h) musi być sumą
+ * skrótów aktualnych przekierowań modelu z numerów o danym prefiksie.
+ *
+ * @param[in] test - stan testu.
+ */
+static void checkHashes(Test const *test) {
+    Node const *root = test->pf->rootNode;
+    char num[NUMBER_BUFFER + 1];
+
+    for (Node const *node = root; node != NULL;
+         node = nodeNextPreorder(node)) {
+        Epoch cleared = 0;
+
+        for (Node const *up = node->father; up != NULL; up = up->father) {
+            if (up->deleteTime > cleared) {
+                cleared = up->deleteTime;
+            }
+        }
+
+        uint64_t got = (node->hashTime < cleared ? 0 : node->contentHash);
+
+        if (node->depth > NUMBER_BUFFER) {
+            fail("hash: node too deep");
+        }
+
+        num[nodeWrite(node, num)] = '\0';
+
+        uint64_t expected = 0;
+        for (size_t i = 0; i < test->model.count; ++i) {
+            ModelForward const *forward = &test->model.forwards[i];
+            size_t length = strlen(forward->from);
+
+            if (strncmp(num, forward->from, strlen(num)) == 0) {
+                expected += diffFwdHash(forward->from, length,
+                                        findNode(root, forward->to));
+            }
+        }
+
+        if (got != expected) {
+            fail("hash at '%s'", num);
+        }
+    }
+}
+
+/**
+ * @brief Sprawdza phfwdDiff względem zapamiętanej kopii i struktury
+ * zbudowanej od nowa.
+ *
+ * @param[in, out] test - stan testu.
+ */
+static void checkDiff(Test *test) {
+    if (test->snapshot != NULL) {
+        checkDiffBetween(test->snapshot, &test->snapshotModel, test->pf,
+                         &test->model, "snapshot");
+        checkDiffBetween(test->pf, &test->model, test->snapshot,
+                         &test->snapshotModel, "snapshot reversed");
+    }
+
+    if (!test->options->hash && randomBelow(3) == 0) {
+        checkHashes(test);
+    }
+
+    PhoneForward *rebuilt = phfwdNew();
+    for (size_t i = test->model.count; i-- > 0; ) {
+        phfwdAdd(rebuilt, test->model.forwards[i].from,
+                 test->model.forwards[i].to);
+    }
+
+    checkDiffBetween(test->pf, &test->model, rebuilt, &test->model,
+                     "rebuilt");
+    phfwdDelete(rebuilt);
+
+    if (randomBelow(2) == 0) {
+        phfwdDelete(test->snapshot);
+        test->snapshot = phfwdClone(test->pf);
+        modelAssign(&test->snapshotModel, &test->model);
+    }
+}
+
+/**
+ * @brief Porównuje zamrożoną kopię struktury z modelem.
+ *
+ * @param[in] test - stan testu.
+ */
+static void checkFrozen(Test const *test) {
+    PhfwdFrozen *frozen = phfwdFreeze(test->pf);
+
+    if (frozen == NULL) {
+        fail("freeze: NULL");
+    }
+
+    checkQueries(&frozenQueries, frozen, &test->model, test->shape, 40);
+    phfwdFrozenDelete(frozen);
+}
+
+/**
+ * @brief Wykonuje scenariusz pojedynczej struktury dla jednego ziarna.
+ *
+ * @param[in] options - tryby testu;
+ * @param[in] seed - ziarno generatora liczb losowych.
+ */
+static void runTable(Options const *options, uint64_t seed) {
+    Test test;
+
+    memset(&test, 0, sizeof test);
+    randomSeed(seed);
+    test.options = options;
+    test.shape.alphabet = 2 + randomBelow(11);
+    test.shape.maxLength = 1 + randomBelow(6);
+    if (options->big) {
+        test.shape.alphabet = 3 + randomBelow(4);
+        test.shape.maxLength = 9;
+    }
+
+    test.pf = newTable(options, &test.alloc);
+    modelInit(&test.model);
+    modelInit(&test.snapshotModel);
+
+    if (options->shard) {
+        test.sharded = phfwdShardedNew();
+    }
+
+    if (options->history && !phfwdHistoryEnable(test.pf)) {
+        fail("historyEnable");
+    }
+
+    size_t iterations = (options->big ? BIG_ITERATIONS : ITERATIONS);
+    for (test.iteration = 0; test.iteration < iterations; ++test.iteration) {
+        size_t it = test.iteration;
+        char num1[NUMBER_BUFFER], num2[NUMBER_BUFFER];
+
+        randomNumber(num1, test.shape, test.shape.maxLength);
+        randomNumber(num2, test.shape, options->big ? 1
+                                                    : test.shape.maxLength);
+
+        if (options->compact) {
+            phfwdCompact(test.pf, randomBelow(64));
+        }
+
+        size_t operation = randomBelow(10);
+        if (operation < 4) {
+            testAdd(&test, num1, num2);
+        }
+        else if (operation < 5) {
+            testRemove(&test, num1);
+        }
+        else if (operation < 7) {
+            testGet(&test, num1);
+        }
+        else if (operation < 8) {
+            testReverse(&test, num1);
+        }
+        else if (operation < 9) {
+            testCursor(&test, num1);
+        }
+        else {
+            testGetReverse(&test, num1);
+        }
+
+        if (options->log && it % 50 == 49) {
+            checkReplica(&test);
+        }
+
+        if (test.sharded != NULL && it % 7 == 0) {
+            checkQueries(&shardedQueries, test.sharded, &test.model,
+                         test.shape, 1);
+        }
+
+        if (options->expiry && test.sharded == NULL && randomBelow(6) == 0) {
+            advanceClock(&test);
+        }
+
+        if (options->history && it % (options->big ? 97 : 9) == 0) {
+            checkHistory(&test);
+        }
+
+        if (options->clone && it % 53 == 26) {
+            swapClone(&test);
+        }
+
+        if (options->each && it % 11 == 5) {
+            checkForEach(&test);
+        }
+
+        if (options->diff && it % 23 == 11) {
+            checkDiff(&test);
+        }
+
+        if (options->jump && it == iterations / 2
+            && !phfwdEnableJumpTable(test.pf, 2 + randomBelow(3))) {
+            fail("enable jump table");
+        }
+
+        if (it % 150 == 149) {
+            checkFrozen(&test);
+        }
+    }
+
+    phfwdDelete(test.snapshot);
+    phfwdDelete(test.replica);
+    phfwdShardedDelete(test.sharded);
+    deleteTable(test.pf, test.alloc, options);
+    modelClear(&test.model);
+    modelClear(&test.snapshotModel);
+    free(test.changes.data);
+    free(test.operations);
+    free(test.intervals);
+}
+
+/**
+ * @brief Wypełnia strukturę losowymi przekierowaniami.
+ *
+ * @param[in, out] pf - struktura;
+ * @param[in, out] model - model struktury;
+ * @param[in] options - tryby testu;
+ * @param[in] shape - kształt numerów;
+ * @param[in] count - liczba operacji.
+ */
+static void fillTable(PhoneForward *pf, Model *model, Options const *options,
+                      Shape shape, size_t count) {
+    size_t clock = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        char num1[NUMBER_BUFFER], num2[NUMBER_BUFFER];
+        size_t operation = randomBelow(10);
+
+        randomNumber(num1, shape, shape.maxLength);
+        randomNumber(num2, shape, shape.maxLength);
+
+        if (operation < 7) {
+            bool expected = strcmp(num1, num2) != 0;
+            size_t deadline = 0;
+
+            if (options->expiry && randomBelow(2) == 0) {
+                deadline = clock + 1 + randomBelow(30);
+            }
+
+            bool added = (deadline != 0
+                          ? phfwdAddWithExpiry(pf, num1, num2, deadline)
+                          : phfwdAdd(pf, num1, num2));
+            if (added != expected) {
+                fail("add(%s, %s): got %d", num1, num2, added);
+            }
+
+            if (expected) {
+                modelAdd(model, num1, num2, deadline);
+            }
+        }
+        else if (operation < 9) {
+            phfwdRemove(pf, num1);
+            modelRemove(model, num1);
+        }
+        else if (options->expiry) {
+            clock += randomBelow(10);
+            phfwdAdvanceClock(pf, clock);
+            modelExpire(model, clock, NULL);
+        }
+    }
+}
+
+/**
+ * @brief Wykonuje scenariusz nakładek dla jednego ziarna.
+ *
+ * Na jednej strukturze bazowej tworzonych jest kilka nakładek, każda
+ * modyfikowana niezależnie; struktura bazowa nie może się zmienić.
+ *
+ * @param[in] options - tryby testu;
+ * @param[in] seed - ziarno generatora liczb losowych.
+ */
+static void runOverlay(Options const *options, uint64_t seed) {
+    Shape shape;
+    Model base, model;
+    PhfwdAllocator *alloc;
+
+    randomSeed(seed);
+    shape.alphabet = 2 + randomBelow(11);
+    shape.maxLength = 1 + randomBelow(6);
+    modelInit(&base);
+    modelInit(&model);
+
+    PhoneForward *pf = newTable(options, &alloc);
+    fillTable(pf, &base, options, shape, randomBelow(400));
+    checkQueries(&tableQueries, pf, &base, shape, 20);
+
+    size_t count = 1 + randomBelow(3);
+    PhfwdOverlay *overlays[3];
+    for (size_t j = 0; j < count; ++j) {
+        overlays[j] = phfwdOverlayNew(pf);
+        if (overlays[j] == NULL) {
+            fail("overlayNew: NULL");
+        }
+    }
+
+    for (size_t j = 0; j < count; ++j) {
+        size_t operations = randomBelow(200);
+
+        modelAssign(&model, &base);
+        for (size_t i = 0; i < operations; ++i) {
+            char num1[NUMBER_BUFFER], num2[NUMBER_BUFFER];
+            size_t operation = randomBelow(10);
+
+            randomNumber(num1, shape, shape.maxLength);
+            randomNumber(num2, shape, shape.maxLength);
+
+            if (operation < 5) {
+                bool expected = strcmp(num1, num2) != 0;
+
+                if (phfwdOverlayAdd(overlays[j], num1, num2) != expected) {
+                    fail("overlayAdd(%s, %s)", num1, num2);
+                }
+
+                if (expected) {
+                    modelAdd(&model, num1, num2, 0);
+                }
+            }
+            else if (operation < 7) {
+                phfwdOverlayRemove(overlays[j], num1);
+                modelRemove(&model, num1);
+            }
+            else {
+                checkQueries(&overlayQueries, overlays[j], &model, shape, 1);
+            }
+        }
+
+        checkQueries(&overlayQueries, overlays[j], &model, shape, 30);
+    }
+
+    checkQueries(&tableQueries, pf, &base, shape, 30);
+
+    for (size_t j = 0; j < count; ++j) {
+        phfwdOverlayDelete(overlays[j]);
+    }
+
+    deleteTable(pf, alloc, options);
+    modelClear(&base);
+    modelClear(&model);
+}
+
+/**
+ * @brief Porównuje tabelę magazynu i jej eksport z modelem.
+ *
+ * @param[in] table - tabela magazynu;
+ * @param[in] model - model tabeli;
+ * @param[in] shape - kształt numerów;
+ * @param[in] count - liczba numerów.
+ */
+static void checkStoreTable(PhfwdStoreTable const *table, Model const *model,
+                            Shape shape, size_t count) {
+    checkQueries(&storeQueries, table, model, shape, count);
+
+    PhoneForward *exported = phfwdStoreExport(table);
+    if (exported == NULL) {
+        fail("storeExport: NULL");
+    }
+
+    checkQueries(&exportQueries, exported, model, shape, count);
+    phfwdDelete(exported);
+}
+
+/**
+ * @brief Wykonuje scenariusz współdzielonego magazynu dla jednego ziarna.
+ *
+ * Do magazynu importowanych jest kilka struktur (część z nich to kopie
+ * pierwszej z niewielkimi zmianami), a następnie tabele są modyfikowane
+ * i kopiowane. Zmiana jednej tabeli nie może wpłynąć na pozostałe.
+ *
+ * @param[in] options - tryby testu;
+ * @param[in] seed - ziarno generatora liczb losowych.
+ */
+static void runStore(Options const *options, uint64_t seed) {
+    Shape shape;
+    Model models[4];
+    PhfwdStoreTable *tables[4];
+    PhfwdStoreStats stats, statsAfter;
+
+    randomSeed(seed);
+    shape.alphabet = 2 + randomBelow(11);
+    shape.maxLength = 1 + randomBelow(6);
+
+    PhfwdStore *store = phfwdStoreNew();
+    size_t count = 1 + randomBelow(4);
+
+    for (size_t j = 0; j < count; ++j) {
+        PhfwdAllocator *alloc;
+        PhoneForward *pf = newTable(options, &alloc);
+        size_t operations = randomBelow(300);
+
+        modelInit(&models[j]);
+        if (j > 0 && randomBelow(2) == 0) {
+            modelAssign(&models[j], &models[0]);
+            for (size_t i = 0; i < models[j].count; ++i) {
+                phfwdAdd(pf, models[j].forwards[i].from,
+                         models[j].forwards[i].to);
+                models[j].forwards[i].deadline = 0;
+            }
+
+            operations /= 10;
+        }
+
+        fillTable(pf, &models[j], options, shape, operations);
+
+        tables[j] = phfwdStoreImport(store, pf);
+        if (tables[j] == NULL) {
+            fail("storeImport: NULL");
+        }
+
+        checkStoreTable(tables[j], &models[j], shape, 20);
+
+        // Ponowny import tej samej zawartości nie tworzy nowych wierzchołków.
+        phfwdStoreStats(store, &stats);
+        PhfwdStoreTable *duplicate = phfwdStoreImport(store, pf);
+        phfwdStoreStats(store, &statsAfter);
+        if (stats.nodes != statsAfter.nodes) {
+            fail("storeImport: duplicate not shared");
+        }
+
+        phfwdStoreRelease(duplicate);
+        deleteTable(pf, alloc, options);
+    }
+
+    for (int round = 0; round < 3; ++round) {
+        size_t j = randomBelow(count);
+
+        if (randomBelow(3) == 0) {
+            PhfwdStoreTable *copy = phfwdStoreCopy(tables[j]);
+
+            phfwdStoreRelease(tables[j]);
+            tables[j] = copy;
+        }
+
+        size_t operations = randomBelow(150);
+        for (size_t i = 0; i < operations; ++i) {
+            char num1[NUMBER_BUFFER], num2[NUMBER_BUFFER];
+
+            randomNumber(num1, shape, shape.maxLength);
+            randomNumber(num2, shape, shape.maxLength);
+
+            if (randomBelow(3) != 0) {
+                bool expected = strcmp(num1, num2) != 0;
+
+                if (phfwdStoreAdd(tables[j], num1, num2) != expected) {
+                    fail("storeAdd(%s, %s)", num1, num2);
+                }
+
+                if (expected) {
+                    modelAdd(&models[j], num1, num2, 0);
+                }
+            }
+            else {
+                phfwdStoreRemove(tables[j], num1);
+                modelRemove(&models[j], num1);
+            }
+
+            if (i % 10 == 0) {
+                checkStoreTable(tables[j], &models[j], shape, 3);
+            }
+        }
+
+        for (size_t k = 0; k < count; ++k) {
+            checkStoreTable(tables[k], &models[k], shape, 15);
+        }
+    }
+
+    phfwdStoreStats(store, &stats);
+    if (stats.tables != count
+        || stats.bytes > stats.unsharedBytes + 1000000) {
+        fail("storeStats: %zu tables, %zu bytes", stats.tables, stats.bytes);
+    }
+
+    for (size_t j = 0; j < count; ++j) {
+        phfwdStoreRelease(tables[j]);
+        modelClear(&models[j]);
+    }
+
+    phfwdStoreStats(store, &stats);
+    if (stats.nodes != 0 || stats.tables != 0) {
+        fail("storeStats: %zu nodes left", stats.nodes);
+    }
+
+    // Magazyn usuwany razem z tabelami, które nie zostały zwolnione.
+    PhoneForward *empty = phfwdNew();
+    tables[0] = phfwdStoreImport(store, empty);
+    phfwdDelete(empty);
+    tables[1] = phfwdStoreCopy(tables[0]);
+    phfwdStoreDelete(store);
+}
+
+/**
+ * @brief Sprawdza wynik phfwdResolve z nieograniczoną liczbą przekierowań.
+ *
+ * @param[in, out] pf - struktura;
+ * @param[in] num - numer;
+ * @param[in] expected - oczekiwany wynik (NULL dla pustego ciągu).
+ */
+static void checkResolve(PhoneForward *pf, char const *num,
+                         char const *expected) {
+    PhoneNumbers *pnum = phfwdResolve(pf, num, SIZE_MAX);
+    char const *got = (pnum == NULL ? NULL : phnumGet(pnum, 0));
+
+    if (pnum == NULL || phnumGet(pnum, expected != NULL) != NULL
+        || (expected != NULL
+            && (got == NULL || strcmp(got, expected) != 0))) {
+        fail("resolve(%s): got %s want %s", num, got == NULL ? "NULL" : got,
+             expected == NULL ? "" : expected);
+    }
+
+    phnumDelete(pnum);
+}
+
+/**
+ * @brief Sprawdza łańcuchy przekierowań rosnące w nieskończoność.
+ *
+ * Bez ich wykrywania phfwdResolve z nieograniczoną liczbą przekierowań
+ * budowałaby coraz dłuższe numery aż do wyczerpania pamięci.
+ *
+ * @param[in] options - tryby testu.
+ */
+static void checkGrowingChains(Options const *options) {
+    PhfwdAllocator *alloc;
+    PhoneForward *pf = newTable(options, &alloc);
+    char num1[NUMBER_BUFFER], num2[NUMBER_BUFFER];
+
+    phfwdAdd(pf, "1", "12");
+    checkResolve(pf, "1", NULL);
+    checkResolve(pf, "13", NULL);
+    checkResolve(pf, "2", "2");
+
+    // Łańcuch rośnie, dopóki nie dojdzie do dłuższego przekierowania.
+    phfwdAdd(pf, "122", "5");
+    checkResolve(pf, "1", "5");
+    checkResolve(pf, "13", "53");
+
+    // Łańcuch rośnie przez kilka przekierowań.
+    phfwdAdd(pf, "1", "23");
+    phfwdAdd(pf, "2", "14");
+    checkResolve(pf, "1", NULL);
+    checkResolve(pf, "20", NULL);
+
+    // Numery zbyt długie, by zapamiętać domknięcia przekierowań.
+    memset(num1, '3', 40);
+    num1[0] = '4';
+    num1[40] = '\0';
+    memset(num2, '5', 40);
+    num2[0] = '3';
+    num2[40] = '\0';
+    phfwdAdd(pf, "4", num1);
+    checkResolve(pf, "4", NULL);
+    phfwdRemove(pf, "4");
+    phfwdAdd(pf, "4", num2);
+    phfwdAdd(pf, "3", num1);
+    checkResolve(pf, "4", NULL);
+    checkResolve(pf, "6", "6");
+
+    deleteTable(pf, alloc, options);
+}
+
+/**
+ * Liczba przekierowań z terminem w teście kompaktowania
+ * (zob. checkCompactPinned).
+ */
+#define PINNED_FORWARDS 4000
+
+/**
+ * @brief Stan alokatora, który zlicza bloki i może odmawiać alokacji.
+ */
+typedef struct FailingAllocator {
+    /// Liczba niezwolnionych bloków.
+    size_t live;
+    /// Czy alokacje mają się nie udawać.
+    bool failing;
+} FailingAllocator;
+
+/**
+ * @brief Alokuje blok (zob. PhfwdAllocator).
+ *
+ * @param[in, out] ctx - stan alokatora (FailingAllocator);
+ * @param[in] size - rozmiar w bajtach.
+ * @return Wskaźnik na blok lub NULL.
+ */
+static void *failingAlloc(void *ctx, size_t size) {
+    FailingAllocator *state = ctx;
+    void *ptr = (state->failing ? NULL : malloc(size));
+
+    state->live += (ptr != NULL);
+
+    return ptr;
+}
+
+/**
+ * @brief Zmienia rozmiar bloku (zob. PhfwdAllocator).
+ *
+ * @param[in, out] ctx - stan alokatora (FailingAllocator);
+ * @param[in] ptr - blok (lub NULL);
+ * @param[in] size - nowy rozmiar w bajtach.
+ * @return Wskaźnik na blok lub NULL.
+ */
+static void *failingRealloc(void *ctx, void *ptr, size_t size) {
+    FailingAllocator *state = ctx;
+    void *result = (state->failing ? NULL : realloc(ptr, size));
+
+    state->live += (ptr == NULL && result != NULL);
+
+    return result;
+}
+
+/**
+ * @brief Zwalnia blok (zob. PhfwdAllocator).
+ *
+ * @param[in, out] ctx - stan alokatora (FailingAllocator);
+ * @param[in] ptr - blok (lub NULL).
+ */
+static void failingFree(void *ctx, void *ptr) {
+    FailingAllocator *state = ctx;
+
+    state->live -= (ptr != NULL);
+    free(ptr);
+}
+
+/**
+ * @brief Sprawdza wynik phfwdGet dla numeru o jednym wyniku.
+ *
+ * @param[in] pf - struktura;
+ * @param[in] num - numer;
+ * @param[in] expected - oczekiwany wynik.
+ */
+static void checkSingleGet(PhoneForward const *pf, char const *num,
+                           char const *expected) {
+    PhoneNumbers *pnum = phfwdGet(pf, num);
+    char const *got = phnumGet(pnum, 0);
+
+    if (got == NULL || strcmp(got, expected) != 0) {
+        fail("get(%s): got %s want %s", num, got == NULL ? "NULL" : got,
+             expected);
+    }
+
+    phnumDelete(pnum);
+}
+
+/**
+ * @brief Sprawdza kompaktowanie małymi krokami przy tysiącach oczekujących
+ * terminów.
+ *
+ * Krok kompaktowania nie może zależeć od liczby terminów ani alokować
+ * pamięci, gdy nie ma czego przenosić, więc przejście całego drzewa przy
+ * alokatorze odmawiającym alokacji musi się zakończyć po liczbie kroków
+ * wyznaczonej przez budżet. Wierzchołki z terminami zostają na miejscu
+ * (również te z kilkoma terminami), a po wygaśnięciu wszystkich terminów
+ * są zwalniane.
+ */
+static void checkCompactPinned(void) {
+    FailingAllocator state = {0, false};
+    PhfwdAllocator const alloc = {
+        failingAlloc, failingRealloc, failingFree, &state
+    };
+    PhoneForward *pf = phfwdNewWithAllocator(&alloc);
+    char num[NUMBER_BUFFER], target[NUMBER_BUFFER];
+
+    if (pf == NULL) {
+        fail("new: NULL");
+    }
+
+    for (size_t i = 0; i < PINNED_FORWARDS; ++i) {
+        snprintf(num, sizeof num, "1%zu", i);
+        snprintf(target, sizeof target, "9%zu", i);
+
+        // Co dziesiąte przekierowanie ma dwa oczekujące terminy.
+        if ((i % 10 == 0 && !phfwdAddWithExpiry(pf, num, target, 1 + i))
+            || !phfwdAddWithExpiry(pf, num, target, 2 + i)) {
+            fail("addWithExpiry(%s)", num);
+        }
+
+        snprintf(num, sizeof num, "2%zu", i);
+        phfwdAdd(pf, num, target);
+    }
+
+    snprintf(num, sizeof num, "1%d", 0);
+    Node const *node = findNode(pf->rootNode, num);
+    if (node == NULL || node->expiryPins != 2) {
+        fail("compact: %s pinned %u times", num,
+             node == NULL ? 0 : (unsigned) node->expiryPins);
+    }
+
+    // Pierwsze przejście przenosi wierzchołki bez terminów do bloków.
+    while (!phfwdCompact(pf, SIZE_MAX)) {
+    }
+
+    phfwdRemove(pf, "2");
+    state.failing = true;
+
+    size_t budget = 4;
+    size_t steps = 0;
+    size_t bound = (3 * PINNED_FORWARDS + budget - 1) / budget + 1;
+
+    while (!phfwdCompact(pf, budget)) {
+        if (++steps > bound) {
+            fail("compact: no progress with %d timers", PINNED_FORWARDS);
+        }
+    }
+
+    state.failing = false;
+
+    for (size_t i = 0; i < PINNED_FORWARDS; i += 97) {
+        snprintf(num, sizeof num, "1%zu", i);
+        snprintf(target, sizeof target, "9%zu", i);
+        checkSingleGet(pf, num, target);
+
+        snprintf(num, sizeof num, "2%zu", i);
+        checkSingleGet(pf, num, num);
+    }
+
+    size_t live = state.live;
+    size_t time = phfwdTime(pf);
+    if (!phfwdAdvanceClock(pf, PINNED_FORWARDS + 1)
+        || phfwdTime(pf) - time != PINNED_FORWARDS) {
+        fail("compact: timers of pinned nodes did not fire");
+    }
+
+    while (!phfwdCompact(pf, budget)) {
+    }
+
+    if (state.live >= live) {
+        fail("compact: expired nodes not released");
+    }
+
+    snprintf(num, sizeof num, "1%d", 0);
+    checkSingleGet(pf, num, num);
+
+    phfwdDelete(pf);
+    if (state.live != 0) {
+        fail("compact: %zu blocks leaked", state.live);
+    }
+}
+
+/**
+ * @brief Odczytuje tryby testu z listy oddzielonej przecinkami.
+ *
+ * @param[in] list - lista trybów;
+ * @param[out] options - tryby testu.
+ * @return Wartość @p true, jeśli wszystkie tryby są znane.
+ */
+static bool parseOptions(char const *list, Options *options) {
+    static struct {
+        char const *name;
+        size_t offset;
+    } const modes[] = {
+        {"hash", offsetof(Options, hash)},
+        {"arena", offsetof(Options, arena)},
+        {"pool", offsetof(Options, pool)},
+        {"cache", offsetof(Options, cache)},
+        {"jump", offsetof(Options, jump)},
+        {"big", offsetof(Options, big)},
+        {"shard", offsetof(Options, shard)},
+        {"log", offsetof(Options, log)},
+        {"history", offsetof(Options, history)},
+        {"expiry", offsetof(Options, expiry)},
+        {"clone", offsetof(Options, clone)},
+        {"each", offsetof(Options, each)},
+        {"diff", offsetof(Options, diff)},
+        {"compact", offsetof(Options, compact)},
+        {"overlay", offsetof(Options, overlay)},
+        {"store", offsetof(Options, store)},
+    };
+
+    memset(options, 0, sizeof *options);
+
+    while (*list != '\0') {
+        size_t length = strcspn(list, ",");
+        size_t i = 0;
+
+        while (i < sizeof modes / sizeof modes[0]
+               && (strlen(modes[i].name) != length
+                   || strncmp(modes[i].name, list, length) != 0)) {
+            i++;
+        }
+
+        if (i == sizeof modes / sizeof modes[0]) {
+            if (length == 0 || strncmp(list, "trie", length) != 0) {
+                return false;
+            }
+        }
+        else {
+            *(bool *) ((char *) options + modes[i].offset) = true;
+        }
+
+        list += length + (list[length] == ',');
+    }
+
+    return true;
+}
+
+/**
+ * @brief Uruchamia testy w trybach podanych w argumentach.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty: lista trybów i liczba ziaren.
+ * @return Kod wyjścia 0, jeśli wszystkie wyniki są zgodne z modelem.
+ */
+int main(int argc, char *argv[]) {
+    Options options;
+
+    if (argc < 2 || !parseOptions(argv[1], &options)) {
+        fprintf(stderr, "usage: %s MODE[,MODE...] [SEEDS]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    size_t seeds = (argc > 2 ? strtoul(argv[2], NULL, 10) : 200);
+
+    if (!options.overlay && !options.store) {
+        checkGrowingChains(&options);
+    }
+
+    if (options.compact && options.expiry) {
+        checkCompactPinned();
+    }
+
+    for (size_t seed = 0; seed < seeds; ++seed) {
+        if (options.overlay) {
+            runOverlay(&options, seed);
+        }
+        else if (options.store) {
+            runStore(&options, seed);
+        }
+        else {
+            runTable(&options, seed);
+        }
+    }
+
+    if (options.overlay
+        && (phfwdOverlayNew(NULL) != NULL
+            || phfwdOverlayGet(NULL, "1") != NULL)) {
+        fail("overlay: NULL accepted");
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,288 @@
+/** @file server_test.c
+ * Test serwera przekierowań (phone_forward_server).
+ *
+ * Test uruchamia serwer podany w argumencie na gnieździe w katalogu
+ * tymczasowym i wysyła jedną serią żądania, których odpowiedzi sprawdza:
+ * wynik phfwdGet dłuższy, niż mieści pole długości numeru, musi zostać
+ * zgłoszony błędem, a kolejne odpowiedzi połączenia muszą pozostać
+ * poprawnymi ramkami. Przy niezgodności test wypisuje opis błędu i kończy
+ * się kodem 1.
+ *
+ * @author Jagoda Bobińska (jb438249@students.mimuw.edu.pl)
+ * @copyright Uniwersytet Warszawski
+ * @date 2022
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "server_protocol.h"
+
+/// Długość przekierowywanego prefiksu.
+#define TEST_PREFIX 2
+/// Długość celu przekierowania.
+#define TEST_TARGET 60000
+/// Długość reszty numeru w zapytaniu o zbyt długi wynik.
+#define TEST_SUFFIX 10000
+
+/// Proces serwera (0, jeśli nie działa).
+static pid_t serverPid;
+
+/**
+ * @brief Wypisuje opis błędu, zatrzymuje serwer i kończy program.
+ *
+ * @param[in] format - format opisu (jak w printf);
+ * @param[in] ... - argumenty opisu.
+ */
+static void fail(char const *format, ...) {
+    va_list arguments;
+
+    va_start(arguments, format);
+    fprintf(stderr, "server_test: ");
+    vfprintf(stderr, format, arguments);
+    fprintf(stderr, "\n");
+    va_end(arguments);
+
+    if (serverPid > 0) {
+        kill(serverPid, SIGKILL);
+    }
+
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Łączy się z serwerem, czekając, aż zacznie nasłuchiwać.
+ *
+ * @param[in] path - ścieżka gniazda.
+ * @return Deskryptor gniazda.
+ */
+static int connectTo(char const *path) {
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    struct timespec pause = {0, 10 * 1000 * 1000};
+
+    strcpy(address.sun_path, path);
+
+    for (int attempt = 0; attempt < 500; ++attempt) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            fail("socket: %s", strerror(errno));
+        }
+
+        if (connect(fd, (struct sockaddr *) &address, sizeof(address)) == 0) {
+            return fd;
+        }
+
+        close(fd);
+        nanosleep(&pause, NULL);
+    }
+
+    fail("cannot connect to %s", path);
+    return -1;
+}
+
+/**
+ * @brief Dopisuje do bufora żądanie.
+ *
+ * @param[in, out] out - bufor;
+ * @param[in] op - operacja;
+ * @param[in] id - identyfikator żądania;
+ * @param[in] num1 - pierwszy numer;
+ * @param[in] num2 - drugi numer (NULL, jeśli operacja ma jeden argument).
+ */
+static void putRequest(ProtoBuffer *out, uint8_t op, uint32_t id,
+                       char const *num1, char const *num2) {
+    size_t length1 = strlen(num1);
+    size_t length2 = (num2 == NULL ? 0 : strlen(num2));
+    size_t size = PROTO_REQUEST_HEADER + 2 + length1
+                  + (num2 == NULL ? 0 : 2 + length2);
+
+    uint8_t *data = protoReserve(out, 4 + size);
+    if (data == NULL) {
+        fail("out of memory");
+    }
+
+    protoPut32(data, (uint32_t) size);
+    data[4] = op;
+    protoPut32(data + 5, id);
+    protoPut16(data + 9, (uint16_t) length1);
+    memcpy(data + 11, num1, length1);
+
+    if (num2 != NULL) {
+        protoPut16(data + 11 + length1, (uint16_t) length2);
+        memcpy(data + 13 + length1, num2, length2);
+    }
+
+    out->size += 4 + size;
+}
+
+/**
+ * @brief Odbiera dokładnie zadaną liczbę bajtów.
+ *
+ * @param[in] fd - gniazdo;
+ * @param[out] data - bufor;
+ * @param[in] size - liczba bajtów.
+ */
+static void receive(int fd, uint8_t *data, size_t size) {
+    while (size > 0) {
+        ssize_t got = recv(fd, data, size, 0);
+        if (got <= 0) {
+            fail("connection closed");
+        }
+
+        data += got;
+        size -= (size_t) got;
+    }
+}
+
+/**
+ * @brief Odbiera odpowiedź i sprawdza jej nagłówek.
+ *
+ * @param[in] fd - gniazdo;
+ * @param[in] id - oczekiwany identyfikator;
+ * @param[in] status - oczekiwany status;
+ * @param[in] count - oczekiwana liczba numerów.
+ * @return Treść odpowiedzi za nagłówkiem (do zwolnienia przez free).
+ */
+static uint8_t *expectResponse(int fd, uint32_t id, uint8_t status,
+                               uint32_t count) {
+    uint8_t prefix[4];
+    receive(fd, prefix, sizeof(prefix));
+
+    size_t size = protoGet32(prefix);
+    if (size < PROTO_RESPONSE_HEADER) {
+        fail("response %u: frame size %zu", id, size);
+    }
+
+    uint8_t *frame = malloc(size);
+    if (frame == NULL) {
+        fail("out of memory");
+    }
+
+    receive(fd, frame, size);
+
+    if (protoGet32(frame) != id || frame[4] != status
+        || protoGet32(frame + 5) != count) {
+        fail("response %u: got id %u status %u count %u", id,
+             protoGet32(frame), frame[4], protoGet32(frame + 5));
+    }
+
+    return frame;
+}
+
+/**
+ * @brief Tworzy numer z powtórzonej cyfry.
+ *
+ * @param[in] digit - cyfra;
+ * @param[in] length - długość numeru.
+ * @return Numer (do zwolnienia przez free).
+ */
+static char *repeated(char digit, size_t length) {
+    char *num = malloc(length + 1);
+    if (num == NULL) {
+        fail("out of memory");
+    }
+
+    memset(num, digit, length);
+    num[length] = '\0';
+
+    return num;
+}
+
+/**
+ * @brief Wykonuje test.
+ *
+ * @param[in] argc - liczba argumentów;
+ * @param[in] argv - argumenty: ścieżka programu serwera.
+ * @return Kod zakończenia programu.
+ */
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s SERVER\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    char directory[] = "/tmp/phone_forward_server_XXXXXX";
+    if (mkdtemp(directory) == NULL) {
+        fail("mkdtemp: %s", strerror(errno));
+    }
+
+    char path[sizeof(directory) + 8];
+    snprintf(path, sizeof(path), "%s/socket", directory);
+
+    serverPid = fork();
+    if (serverPid < 0) {
+        fail("fork: %s", strerror(errno));
+    }
+
+    if (serverPid == 0) {
+        execl(argv[1], argv[1], path, (char *) NULL);
+        _exit(127);
+    }
+
+    int fd = connectTo(path);
+
+    char *prefix = repeated('1', TEST_PREFIX);
+    char *target = repeated('3', TEST_TARGET);
+    char *longNum = repeated('1', TEST_PREFIX + TEST_SUFFIX);
+
+    ProtoBuffer out = {NULL, 0, 0, 0};
+    putRequest(&out, PROTO_ADD, 1, prefix, target);
+    putRequest(&out, PROTO_GET, 2, longNum, NULL);
+    putRequest(&out, PROTO_GET, 3, prefix, NULL);
+    putRequest(&out, PROTO_GET, 4, "7", NULL);
+
+    for (size_t sent = 0; sent < out.size;) {
+        ssize_t written = send(fd, out.data + sent, out.size - sent,
+                               MSG_NOSIGNAL);
+        if (written < 0) {
+            fail("send: %s", strerror(errno));
+        }
+
+        sent += (size_t) written;
+    }
+
+    free(expectResponse(fd, 1, PROTO_OK, 0));
+
+    // Wynik ma TEST_TARGET + TEST_SUFFIX > UINT16_MAX cyfr.
+    free(expectResponse(fd, 2, PROTO_ERROR, 0));
+
+    uint8_t *frame = expectResponse(fd, 3, PROTO_OK, 1);
+    if (protoGet16(frame + 9) != TEST_TARGET
+        || memcmp(frame + 11, target, TEST_TARGET) != 0) {
+        fail("response 3: wrong number");
+    }
+    free(frame);
+
+    frame = expectResponse(fd, 4, PROTO_OK, 1);
+    if (protoGet16(frame + 9) != 1 || frame[11] != '7') {
+        fail("response 4: wrong number");
+    }
+    free(frame);
+
+    close(fd);
+    kill(serverPid, SIGTERM);
+
+    int status;
+    if (waitpid(serverPid, &status, 0) < 0 || !WIFEXITED(status)
+        || WEXITSTATUS(status) != 0) {
+        serverPid = 0;
+        fail("server did not exit cleanly");
+    }
+
+    rmdir(directory);
+    protoFree(&out);
+    free(prefix);
+    free(target);
+    free(longNum);
+
+    return EXIT_SUCCESS;
+}